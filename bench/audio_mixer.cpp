@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+#include <audio_mixer.h>
+#include <audio_ring_buffer.h>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+// Same layout as GenericAudio: 2 BGM and 31 SE channels
+constexpr int num_channels = 33;
+constexpr int frequency = 44100;
+
+static std::vector<int16_t> MakeTone(int frames, int channels, float hz) {
+	std::vector<int16_t> samples(frames * channels);
+	for (int i = 0; i < frames; ++i) {
+		const auto value = static_cast<int16_t>(std::sin(i * hz * 6.2831853f / frequency) * 12000.0f);
+		for (int c = 0; c < channels; ++c) {
+			samples[i * channels + c] = value;
+		}
+	}
+	return samples;
+}
+
+static void BM_ConvertS16Stereo(benchmark::State& state) {
+	const int frames = state.range(0);
+	auto src = MakeTone(frames, 2, 440.0f);
+	std::vector<float> dst(frames * 2);
+	for (auto _: state) {
+		// Fade, the gain changes over the frames
+		AudioMixer::ConvertToStereo(dst.data(), reinterpret_cast<const uint8_t*>(src.data()), frames, AudioDecoder::Format::S16, 2, 1.0f, 0.9f);
+		benchmark::DoNotOptimize(dst.data());
+	}
+	state.SetItemsProcessed(state.iterations() * frames);
+}
+
+BENCHMARK(BM_ConvertS16Stereo)->Arg(1024)->Arg(4096);
+
+static void BM_ConvertS16Mono(benchmark::State& state) {
+	const int frames = state.range(0);
+	auto src = MakeTone(frames, 1, 440.0f);
+	std::vector<float> dst(frames * 2);
+	for (auto _: state) {
+		AudioMixer::ConvertToStereo(dst.data(), reinterpret_cast<const uint8_t*>(src.data()), frames, AudioDecoder::Format::S16, 1, 1.0f, 1.0f);
+		benchmark::DoNotOptimize(dst.data());
+	}
+	state.SetItemsProcessed(state.iterations() * frames);
+}
+
+BENCHMARK(BM_ConvertS16Mono)->Arg(1024)->Arg(4096);
+
+/**
+ * Work of one GenericAudio::Decode call with all channels playing: Mix
+ * every ring buffer into the bus and convert the bus to the output format.
+ * The rings are refilled outside of the measurement, like the decoder
+ * thread does.
+ */
+static void BM_MixCallback(benchmark::State& state) {
+	const int frames = state.range(0);
+
+	std::vector<std::unique_ptr<AudioRingBuffer>> rings;
+	std::vector<std::vector<float>> decoded;
+	for (int i = 0; i < num_channels; ++i) {
+		auto tone = MakeTone(frames, 2, 110.0f * (i + 1));
+		std::vector<float> frames_f(frames * 2);
+		AudioMixer::ConvertToStereo(frames_f.data(), reinterpret_cast<const uint8_t*>(tone.data()), frames, AudioDecoder::Format::S16, 2, 0.5f, 0.5f);
+		decoded.push_back(std::move(frames_f));
+
+		rings.push_back(std::make_unique<AudioRingBuffer>());
+		rings.back()->Resize(frames * 4);
+	}
+
+	std::vector<float> mix(frames * 2);
+	std::vector<int16_t> output(frames * 2);
+
+	for (auto _: state) {
+		state.PauseTiming();
+		for (int i = 0; i < num_channels; ++i) {
+			rings[i]->Write(decoded[i].data(), frames);
+		}
+		state.ResumeTiming();
+
+		mix.assign(frames * 2, 0.0f);
+		for (auto& ring : rings) {
+			ring->Sync();
+			ring->MixInto(mix.data(), frames, 0.8f, 0.9f);
+		}
+		AudioMixer::ConvertToS16(output.data(), mix.data(), frames * 2, num_channels * 0.5f);
+		benchmark::DoNotOptimize(output.data());
+	}
+	state.SetItemsProcessed(state.iterations() * frames);
+}
+
+BENCHMARK(BM_MixCallback)->Arg(512)->Arg(1024)->Arg(2048);
+
+BENCHMARK_MAIN();
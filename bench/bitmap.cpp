@@ -1,7 +1,10 @@
 #include <cmath>
+#include <vector>
 #include <benchmark/benchmark.h>
 #include <rect.h>
 #include <bitmap.h>
+#include <bitmap_kernels.h>
+#include <bitmap_scaler.h>
 #include <pixel_format.h>
 #include <transform.h>
 
@@ -290,6 +293,105 @@ static void BM_BlendBlit(benchmark::State& state) {
 
 BENCHMARK(BM_BlendBlit);
 
+/** Runs a kernel on a 320x240 image with the instruction set of the benchmark argument */
+template <typename F>
+static void RunKernel(benchmark::State& state, F&& kernel) {
+	const auto isa = static_cast<BitmapKernels::Isa>(state.range(0));
+	if (!BitmapKernels::IsSupported(isa)) {
+		state.SkipWithError("Not supported");
+		return;
+	}
+
+	constexpr int width = 320;
+	constexpr int height = 240;
+	std::vector<uint32_t> pixels(width * height);
+	uint32_t seed = 1;
+	for (auto& pixel: pixels) {
+		seed = seed * 1664525 + 1013904223;
+		pixel = seed | 0xFF;
+	}
+
+	const auto previous = BitmapKernels::GetIsa();
+	BitmapKernels::SetIsa(isa);
+	for (auto _: state) {
+		for (int y = 0; y < height; ++y) {
+			kernel(&pixels[y * width], width);
+		}
+	}
+	BitmapKernels::SetIsa(previous);
+
+	state.SetLabel(BitmapKernels::GetIsaName(isa));
+	state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+constexpr BitmapKernels::Layout kernel_layout = { 24, 16, 8, 0 };
+
+static void BM_ToneKernel(benchmark::State& state) {
+	RunKernel(state, [](uint32_t* row, int count) {
+		BitmapKernels::ToneRow(row, count, kernel_layout, Tone(255, 100, 30, 128), ImageOpacity::Alpha_8Bit);
+	});
+}
+
+BENCHMARK(BM_ToneKernel)->DenseRange(0, 3);
+
+static void BM_ToneGrayKernel(benchmark::State& state) {
+	RunKernel(state, [](uint32_t* row, int count) {
+		BitmapKernels::ToneRow(row, count, kernel_layout, Tone(255, 100, 30, 0), ImageOpacity::Alpha_8Bit);
+	});
+}
+
+BENCHMARK(BM_ToneGrayKernel)->DenseRange(0, 3);
+
+static void BM_HueKernel(benchmark::State& state) {
+	RunKernel(state, [](uint32_t* row, int count) {
+		BitmapKernels::HueRow(row, count, kernel_layout, 0x155);
+	});
+}
+
+BENCHMARK(BM_HueKernel)->DenseRange(0, 3);
+
+static void BM_BlendKernel(benchmark::State& state) {
+	RunKernel(state, [](uint32_t* row, int count) {
+		BitmapKernels::BlendRow(row, row, count, 0, 0x80402080, 0);
+	});
+}
+
+BENCHMARK(BM_BlendKernel)->DenseRange(0, 3);
+
+static void BM_OverKernel(benchmark::State& state) {
+	std::vector<uint32_t> src(320, 0x80402080);
+	RunKernel(state, [&](uint32_t* row, int count) {
+		BitmapKernels::OverRow(row, src.data(), count, 200, 0, 0);
+	});
+}
+
+BENCHMARK(BM_OverKernel)->DenseRange(0, 3);
+
+static void BM_SrcKernel(benchmark::State& state) {
+	std::vector<uint32_t> src(320, 0x80402080);
+	RunKernel(state, [&](uint32_t* row, int count) {
+		BitmapKernels::SrcRow(row, src.data(), count, 200, 0);
+	});
+}
+
+BENCHMARK(BM_SrcKernel)->DenseRange(0, 3);
+
+/** Blit, opacity blit and stretch with pixman (0) or the BitmapKernels (1) */
+static void BM_BlitDirect(benchmark::State& state) {
+	Bitmap::SetFormat(format);
+	auto dest = Bitmap::Create(320, 240);
+	auto src = Bitmap::Create(320, 240);
+	auto rect = src->GetRect();
+	Bitmap::SetDirectBlitEnabled(state.range(0) != 0);
+	for (auto _: state) {
+		dest->Blit(0, 0, *src, rect, opacity_50);
+		dest->StretchBlit(Rect(0, 0, 640, 480), *src, rect, opacity_100);
+	}
+	Bitmap::SetDirectBlitEnabled(true);
+}
+
+BENCHMARK(BM_BlitDirect)->DenseRange(0, 1);
+
 static void BM_Flip(benchmark::State& state) {
 	Bitmap::SetFormat(format);
 	auto dest = Bitmap::Create(320, 240);
@@ -374,6 +476,28 @@ static void BM_EffectsBlit(benchmark::State& state) {
 
 BENCHMARK(BM_EffectsBlit);
 
+static void BM_ScaleNearest4x(benchmark::State& state) {
+	Bitmap::SetFormat(format);
+	auto dest = Bitmap::Create(1280, 960);
+	auto src = Bitmap::Create(320, 240);
+	for (auto _: state) {
+		BitmapScaler::Scale(*dest, *src, ConfigEnum::ScalingMode::Nearest);
+	}
+}
+
+BENCHMARK(BM_ScaleNearest4x);
+
+static void BM_ScaleSharpBilinear(benchmark::State& state) {
+	Bitmap::SetFormat(format);
+	auto dest = Bitmap::Create(1440, 1080);
+	auto src = Bitmap::Create(320, 240);
+	for (auto _: state) {
+		BitmapScaler::Scale(*dest, *src, ConfigEnum::ScalingMode::Bilinear, state.range(0));
+	}
+}
+
+BENCHMARK(BM_ScaleSharpBilinear)->Arg(0)->Arg(1);
+
 
 
 BENCHMARK_MAIN();
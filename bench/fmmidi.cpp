@@ -0,0 +1,101 @@
+#include <benchmark/benchmark.h>
+#include <audio_decoder_midi.h>
+#include <decoder_fmmidi.h>
+#include <filesystem_stream.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#ifdef WANT_FMMIDI
+
+constexpr int frequency = 44100;
+
+static void WriteVarLen(std::vector<uint8_t>& out, uint32_t value) {
+	uint8_t bytes[4];
+	int n = 0;
+	do {
+		bytes[n++] = value & 0x7F;
+		value >>= 7;
+	} while (value > 0);
+	while (n > 1) {
+		out.push_back(bytes[--n] | 0x80);
+	}
+	out.push_back(bytes[0]);
+}
+
+/**
+ * Reference song: Every melodic channel plays four note chords, one per beat,
+ * which keeps about 60 notes sounding including their release.
+ */
+static std::vector<uint8_t> MakeSong() {
+	constexpr int ticks_per_beat = 480;
+	constexpr int beats = 16;
+
+	std::vector<uint8_t> track;
+	for (int ch = 0; ch < 16; ++ch) {
+		if (ch == 9) {
+			continue;
+		}
+		WriteVarLen(track, 0);
+		track.insert(track.end(), { static_cast<uint8_t>(0xC0 | ch), static_cast<uint8_t>(ch * 5) });
+	}
+	for (int beat = 0; beat < beats; ++beat) {
+		for (bool on : { true, false }) {
+			for (int ch = 0; ch < 16; ++ch) {
+				if (ch == 9) {
+					continue;
+				}
+				const int root = 36 + (ch * 3 + beat * 5) % 36;
+				for (int interval : { 0, 4, 7, 12 }) {
+					// The chord is released one beat after it started
+					WriteVarLen(track, !on && ch == 0 && interval == 0 ? ticks_per_beat : 0);
+					track.insert(track.end(), { static_cast<uint8_t>((on ? 0x90 : 0x80) | ch), static_cast<uint8_t>(root + interval), static_cast<uint8_t>(on ? 100 : 0) });
+				}
+			}
+		}
+	}
+	WriteVarLen(track, 0);
+	track.insert(track.end(), { 0xFF, 0x2F, 0x00 });
+
+	std::vector<uint8_t> song = { 'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, ticks_per_beat >> 8, ticks_per_beat & 0xFF };
+	song.insert(song.end(), { 'M', 'T', 'r', 'k' });
+	const auto size = static_cast<uint32_t>(track.size());
+	song.insert(song.end(), { static_cast<uint8_t>(size >> 24), static_cast<uint8_t>(size >> 16), static_cast<uint8_t>(size >> 8), static_cast<uint8_t>(size) });
+	song.insert(song.end(), track.begin(), track.end());
+	return song;
+}
+
+/**
+ * Decodes the reference song like the BGM channel of GenericAudio does.
+ * Argument 0 renders all notes on the decoding thread, argument 1 splits
+ * them between the threads of the synthesizer pool.
+ */
+static void BM_FmMidiDecode(benchmark::State& state) {
+	auto fmmidi = std::make_unique<FmMidiDecoder>();
+	if (state.range(0) == 0) {
+		fmmidi->synth->set_parallel_for(nullptr, 1);
+	}
+
+	AudioDecoderMidi decoder(std::move(fmmidi));
+	Filesystem_Stream::InputStream stream(new Filesystem_Stream::InputMemoryStreamBuf(MakeSong()), "bench.mid");
+	if (!decoder.Open(std::move(stream))) {
+		state.SkipWithError("Opening the song failed");
+		return;
+	}
+	decoder.SetFormat(frequency, AudioDecoderBase::Format::S16, 2);
+	decoder.SetLooping(true);
+
+	constexpr int frames = 1024;
+	std::vector<int16_t> buffer(frames * 2);
+	for (auto _: state) {
+		decoder.Decode(reinterpret_cast<uint8_t*>(buffer.data()), buffer.size() * sizeof(int16_t));
+		benchmark::DoNotOptimize(buffer.data());
+	}
+	state.SetItemsProcessed(state.iterations() * frames);
+}
+
+BENCHMARK(BM_FmMidiDecode)->Arg(0)->Arg(1);
+
+#endif
+
+BENCHMARK_MAIN();
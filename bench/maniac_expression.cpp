@@ -0,0 +1,78 @@
+#include <benchmark/benchmark.h>
+#include "game_interpreter_shared.h"
+#include "game_variables.h"
+#include "main_data.h"
+#include "maniac_patch.h"
+#include <lcf/data.h>
+#include <lcf/rpg/saveeventexecstate.h>
+
+constexpr int max_vars = 1024;
+
+namespace {
+class Context : public Game_BaseInterpreterContext {
+public:
+	int GetThisEventId() const override { return 0; }
+	Game_Character* GetCharacter(int, std::string_view) const override { return nullptr; }
+	const lcf::rpg::SaveEventExecState& GetState() const override { return state; }
+	const lcf::rpg::SaveEventExecFrame& GetFrame() const override { return frame; }
+
+	lcf::rpg::SaveEventExecState state;
+	lcf::rpg::SaveEventExecFrame frame;
+};
+
+// Packs the op-code bytes into int32 like they are stored in the event command
+std::vector<int32_t> Pack(std::vector<uint8_t> bytes) {
+	std::vector<int32_t> op_codes((bytes.size() + 3) / 4);
+	for (size_t i = 0; i < bytes.size(); ++i) {
+		op_codes[i / 4] |= static_cast<int32_t>(static_cast<uint32_t>(bytes[i]) << ((i % 4) * 8));
+	}
+	return op_codes;
+}
+
+// (v[1] + v[2] * 3) > 100 ? min(v[3], 50) : v[4] % 7
+const std::vector<int32_t> expression = Pack({
+	72,
+		61, 48, 8, 1, 1, 50, 8, 1, 2, 1, 3, 1, 100,
+		78, 12, 2, 8, 1, 3, 1, 50,
+		52, 8, 1, 4, 1, 7
+});
+
+void Setup() {
+	lcf::Data::variables.resize(max_vars);
+	Main_Data::game_variables = std::make_unique<Game_Variables>(Game_Variables::min_2k3, Game_Variables::max_2k3);
+	Main_Data::game_variables->SetRange(1, max_vars, 1);
+}
+}
+
+static void BM_ManiacExpressionInterpret(benchmark::State& state) {
+	Setup();
+	Context ctx;
+	volatile int x = 0;
+	for (auto _: state) {
+		x = ManiacPatch::InterpretExpression(MakeSpan(expression), ctx);
+	}
+}
+
+BENCHMARK(BM_ManiacExpressionInterpret);
+
+static void BM_ManiacExpressionCompiled(benchmark::State& state) {
+	Setup();
+	Context ctx;
+	volatile int x = 0;
+	for (auto _: state) {
+		x = ManiacPatch::ParseExpression(MakeSpan(expression), ctx);
+	}
+}
+
+BENCHMARK(BM_ManiacExpressionCompiled);
+
+static void BM_ManiacExpressionCompile(benchmark::State& state) {
+	for (auto _: state) {
+		ManiacPatch::Expression expr(MakeSpan(expression), false);
+		benchmark::DoNotOptimize(expr);
+	}
+}
+
+BENCHMARK(BM_ManiacExpressionCompile);
+
+BENCHMARK_MAIN();
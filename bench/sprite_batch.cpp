@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+#include <bitmap.h>
+#include <drawable_list.h>
+#include <drawable_mgr.h>
+#include <pixel_format.h>
+#include <sprite.h>
+#include <sprite_batch.h>
+
+constexpr int screen_width = 320;
+constexpr int screen_height = 240;
+
+static BitmapRef MakeCharset(int seed) {
+	// Charset layout: 12x8 frames of 24x32 pixels with transparent borders
+	auto charset = Bitmap::Create(288, 256, true);
+	for (int y = 0; y < 256; y += 32) {
+		for (int x = 0; x < 288; x += 24) {
+			auto c = static_cast<uint8_t>(x + y + seed * 67);
+			charset->FillRect(Rect(x + 4, y + 2, 16, 28), Color(c, 255 - c, c / 2, 255));
+			charset->FillRect(Rect(x + 8, y + 26, 8, 4), Color(0, 0, 0, 96));
+		}
+	}
+	return charset;
+}
+
+/**
+ * Records the commands of a busy map: Events walking on the screen, a few of
+ * them translucent, some animations and pictures.
+ */
+static std::vector<SpriteBatch::Command> RecordMap(Bitmap& dst) {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+
+	DrawableList list;
+	DrawableMgr::SetLocalList(&list);
+
+	std::vector<BitmapRef> charsets = { MakeCharset(0), MakeCharset(1), MakeCharset(2) };
+	auto picture = Bitmap::Create(96, 64, Color(40, 80, 160, 160));
+
+	std::vector<std::unique_ptr<Sprite>> sprites;
+	auto add = [&](BitmapRef bitmap, Rect src_rect, int x, int y, int opacity) {
+		auto sprite = std::make_unique<Sprite>();
+		sprite->SetBitmap(bitmap);
+		sprite->SetSrcRect(src_rect);
+		sprite->SetX(x);
+		sprite->SetY(y);
+		sprite->SetOpacity(opacity);
+		sprites.push_back(std::move(sprite));
+	};
+
+	for (int i = 0; i < 120; ++i) {
+		const int frame = i % 12;
+		const int dir = (i / 12) % 8;
+		add(charsets[i % 3], Rect(frame * 24, dir * 32, 24, 32), (i * 37) % (screen_width - 24), (i * 53) % (screen_height - 32), i % 10 == 0 ? 160 : 255);
+	}
+
+	// Map tiles shown by events, these are adjacent in source and on screen
+	for (int i = 0; i < 8; ++i) {
+		add(charsets[0], Rect(i * 24, 0, 24, 32), 40 + i * 24, 200, 255);
+	}
+
+	add(picture, picture->GetRect(), 20, 20, 200);
+	add(picture, picture->GetRect(), 200, 140, 120);
+
+	std::vector<SpriteBatch::Command> commands;
+	{
+		SpriteBatch batch(dst);
+		for (auto& sprite : sprites) {
+			sprite->Draw(dst);
+		}
+		commands = batch.GetCommands();
+	}
+
+	return commands;
+}
+
+static void BM_SpriteDirect(benchmark::State& state) {
+	auto dst = Bitmap::Create(screen_width, screen_height, true);
+	auto commands = RecordMap(*dst);
+
+	for (auto _: state) {
+		for (const auto& cmd : commands) {
+			dst->EffectsBlit(cmd.x, cmd.y, cmd.ox, cmd.oy, *cmd.src, cmd.src_rect, cmd.opacity,
+				cmd.zoom_x, cmd.zoom_y, cmd.angle, cmd.waver_depth, cmd.waver_phase, cmd.blend_mode);
+		}
+	}
+
+	state.counters["sprites/s"] = benchmark::Counter(static_cast<double>(commands.size()) * state.iterations(), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_SpriteDirect);
+
+static void BM_SpriteBatched(benchmark::State& state) {
+	auto dst = Bitmap::Create(screen_width, screen_height, true);
+	auto recorded = RecordMap(*dst);
+
+	std::vector<SpriteBatch::Command> commands;
+	for (auto _: state) {
+		// Execute reorders the commands, replay the recorded order every time
+		commands = recorded;
+		SpriteBatch::Execute(*dst, commands);
+	}
+
+	state.counters["sprites/s"] = benchmark::Counter(static_cast<double>(recorded.size()) * state.iterations(), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_SpriteBatched);
+
+BENCHMARK_MAIN();
@@ -64,5 +64,29 @@ static void BM_SwitchFlipRange(benchmark::State& state) {
 
 BENCHMARK(BM_SwitchFlipRange);
 
+static void BM_SwitchSetRangeUnaligned(benchmark::State& state) {
+	BM_SwitchOp(state, [](auto& s, auto, bool val) { s.SetRange(3, max_sws - 2, val); });
+}
+
+BENCHMARK(BM_SwitchSetRangeUnaligned);
+
+static void BM_SwitchFlipRangeUnaligned(benchmark::State& state) {
+	BM_SwitchOp(state, [](auto& s, auto, bool) { s.FlipRange(3, max_sws - 2); });
+}
+
+BENCHMARK(BM_SwitchFlipRangeUnaligned);
+
+static void BM_SwitchSetRangeLarge(benchmark::State& state) {
+	constexpr int size = 5000;
+	auto s = make(size);
+	int i = 0;
+	for (auto _: state) {
+		s.SetRange(1, size, i & 1);
+		s.FlipRange(1, size);
+		++i;
+	}
+}
+
+BENCHMARK(BM_SwitchSetRangeLarge);
 
 BENCHMARK_MAIN();
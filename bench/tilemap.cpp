@@ -0,0 +1,157 @@
+#include <benchmark/benchmark.h>
+#include <bitmap.h>
+#include <drawable_list.h>
+#include <game_actors.h>
+#include <drawable_mgr.h>
+#include <game_map.h>
+#include <game_party.h>
+#include <game_pictures.h>
+#include <game_player.h>
+#include <game_screen.h>
+#include <game_switches.h>
+#include <game_system.h>
+#include <game_variables.h>
+#include <main_data.h>
+#include <map_data.h>
+#include <pixel_format.h>
+#include <player.h>
+#include <tilemap_layer.h>
+#include <lcf/data.h>
+
+constexpr int map_width = 80;
+constexpr int map_height = 45;
+
+static void SetupMap() {
+	static bool initialized = false;
+	if (initialized) {
+		return;
+	}
+	initialized = true;
+
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+
+	lcf::Data::chipsets.push_back({});
+	lcf::Data::treemap.maps.push_back({});
+	lcf::Data::treemap.maps.back().type = lcf::rpg::TreeMap::MapType_root;
+	lcf::Data::treemap.maps.push_back({});
+	lcf::Data::treemap.maps.back().ID = 1;
+	lcf::Data::treemap.maps.back().type = lcf::rpg::TreeMap::MapType_map;
+
+	Main_Data::game_actors = std::make_unique<Game_Actors>();
+	Main_Data::game_party = std::make_unique<Game_Party>();
+	Game_Map::Init();
+	Main_Data::game_system = std::make_unique<Game_System>();
+	Main_Data::game_switches = std::make_unique<Game_Switches>();
+	Main_Data::game_variables = std::make_unique<Game_Variables>(Game_Variables::min_2k3, Game_Variables::max_2k3);
+	Main_Data::game_pictures = std::make_unique<Game_Pictures>();
+	Main_Data::game_screen = std::make_unique<Game_Screen>();
+	Main_Data::game_player = std::make_unique<Game_Player>();
+	Main_Data::game_player->SetMapId(1);
+
+	auto map = std::make_unique<lcf::rpg::Map>();
+	map->width = map_width;
+	map->height = map_height;
+	map->upper_layer.resize(map_width * map_height, BLOCK_F);
+	map->lower_layer.resize(map_width * map_height, BLOCK_E);
+	Game_Map::Setup(std::move(map));
+}
+
+static BitmapRef MakeChipset() {
+	auto chipset = Bitmap::Create(480, 256, true);
+	for (int y = 0; y < 256; y += TILE_SIZE) {
+		for (int x = 0; x < 480; x += TILE_SIZE) {
+			auto c = static_cast<uint8_t>(x + y);
+			chipset->FillRect(Rect(x, y, TILE_SIZE, TILE_SIZE), Color(c, 255 - c, c / 2, 255));
+		}
+	}
+	return chipset;
+}
+
+static void SetupLayer(TilemapLayer& layer) {
+	std::vector<short> data(map_width * map_height);
+	for (size_t i = 0; i < data.size(); ++i) {
+		data[i] = static_cast<short>(BLOCK_E + i % BLOCK_E_TILES);
+	}
+
+	layer.SetWidth(map_width);
+	layer.SetHeight(map_height);
+	layer.SetChipset(MakeChipset());
+	layer.SetMapData(std::move(data));
+	layer.SetOx(8);
+	layer.SetOy(8);
+}
+
+static void BM_TilemapDraw(benchmark::State& state) {
+	SetupMap();
+
+	const int width = state.range(0);
+	const int height = state.range(1);
+	TilemapLayer::SetParallelDraw(state.range(2) != 0);
+	TilemapLayer::SetChunkCache(false);
+
+	Player::screen_width = width;
+	Player::screen_height = height;
+
+	DrawableList list;
+	DrawableMgr::SetLocalList(&list);
+
+	TilemapLayer layer(0);
+	SetupLayer(layer);
+
+	auto dst = Bitmap::Create(width, height, true);
+	const int tiles = (width / TILE_SIZE + 1) * (height / TILE_SIZE + 1);
+
+	for (auto _: state) {
+		layer.Draw(*dst, 0, 0, 0);
+	}
+
+	state.counters["tiles/s"] = benchmark::Counter(static_cast<double>(tiles) * state.iterations(), benchmark::Counter::kIsRate);
+
+	TilemapLayer::SetParallelDraw(true);
+	TilemapLayer::SetChunkCache(true);
+}
+
+BENCHMARK(BM_TilemapDraw)
+	->ArgNames({"width", "height", "parallel"})
+	->Args({320, 240, 0})->Args({320, 240, 1})
+	->Args({640, 480, 0})->Args({640, 480, 1})
+	->Args({1280, 720, 0})->Args({1280, 720, 1});
+
+static void BM_TilemapDrawChunks(benchmark::State& state) {
+	SetupMap();
+
+	const int width = state.range(0);
+	const int height = state.range(1);
+	const bool scroll = state.range(2) != 0;
+
+	Player::screen_width = width;
+	Player::screen_height = height;
+
+	DrawableList list;
+	DrawableMgr::SetLocalList(&list);
+
+	TilemapLayer layer(0);
+	SetupLayer(layer);
+
+	auto dst = Bitmap::Create(width, height, true);
+	const int tiles = (width / TILE_SIZE + 1) * (height / TILE_SIZE + 1);
+
+	int ox = 0;
+	for (auto _: state) {
+		if (scroll) {
+			ox = (ox + 1) % (map_width * TILE_SIZE - width);
+			layer.SetOx(ox);
+		}
+		layer.Draw(*dst, 0, 0, 0);
+	}
+
+	state.counters["tiles/s"] = benchmark::Counter(static_cast<double>(tiles) * state.iterations(), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_TilemapDrawChunks)
+	->ArgNames({"width", "height", "scroll"})
+	->Args({320, 240, 0})->Args({320, 240, 1})
+	->Args({640, 480, 0})->Args({640, 480, 1})
+	->Args({1280, 720, 0})->Args({1280, 720, 1});
+
+BENCHMARK_MAIN();
@@ -106,6 +106,39 @@ static void BM_VariableModRange(benchmark::State& state) {
 
 BENCHMARK(BM_VariableModRange);
 
+static void BM_VariableBitXorRange(benchmark::State& state) {
+	BM_VariableOp(state, [](auto& v, auto, auto val) { v.BitXorRange(1, max_vars, val); });
+}
+
+BENCHMARK(BM_VariableBitXorRange);
+
+static void BM_VariableAddRangeVariable(benchmark::State& state) {
+	BM_VariableOp(state, [](auto& v, auto, auto val) { v.AddRangeVariable(1, max_vars, val); });
+}
+
+BENCHMARK(BM_VariableAddRangeVariable);
+
+// Unaligned range: Covers the scalar head and tail of the vectorized kernels
+static void BM_VariableAddRangeUnaligned(benchmark::State& state) {
+	BM_VariableOp(state, [](auto& v, auto, auto val) { v.AddRange(3, max_vars - 2, val); });
+}
+
+BENCHMARK(BM_VariableAddRangeUnaligned);
+
+// Games resetting large variable arrays every frame
+static void BM_VariableSetRangeLarge(benchmark::State& state) {
+	constexpr int size = 5000;
+	auto v = make(size);
+	int i = 0;
+	for (auto _: state) {
+		v.SetRange(1, size, i);
+		v.AddRange(1, size, i);
+		i = (i + 1) % max_vars;
+	}
+}
+
+BENCHMARK(BM_VariableSetRangeLarge);
+
 static void BM_VariableSetRangeVariable(benchmark::State& state) {
 	BM_VariableOp(state, [](auto& v, auto, auto val) { v.SetRangeVariable(1, max_vars, val); });
 }
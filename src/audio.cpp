@@ -95,6 +95,12 @@ Game_ConfigAudio AudioInterface::GetConfig() const {
 	return acfg;
 }
 
+void AudioInterface::SE_Preload(std::unique_ptr<AudioSeCache> se, int) {
+	if (se) {
+		se->CreateSeDecoder();
+	}
+}
+
 int AudioInterface::BGM_GetGlobalVolume() const {
 	return cfg.music_volume.Get();
 }
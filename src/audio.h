@@ -132,6 +132,15 @@ struct AudioInterface {
 	 */
 	virtual void SE_Play(std::unique_ptr<AudioSeCache> se, int volume, int pitch) = 0;
 
+	/**
+	 * Decodes a sound effect without playing it, the first SE_Play of it
+	 * is then answered from the cache.
+	 *
+	 * @param se se to decode.
+	 * @param pitch pitch the se is played with.
+	 */
+	virtual void SE_Preload(std::unique_ptr<AudioSeCache> se, int pitch);
+
 	/**
 	 * Stops the currently playing sound effect.
 	 */
@@ -174,6 +183,7 @@ public:
 	void BGM_Pitch(int) override {};
 	std::string BGM_GetType() const override { return {}; };
 	void SE_Play(std::unique_ptr<AudioSeCache>, int, int) override {}
+	void SE_Preload(std::unique_ptr<AudioSeCache>, int) override {}
 	void SE_Stop() override {}
 	void Update() override {}
 	void vGetConfig(Game_ConfigAudio& cfg) const override;
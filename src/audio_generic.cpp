@@ -17,50 +17,107 @@
 
 #include "system.h"
 
+#include <algorithm>
 #include <cstring>
 #include <cassert>
 #include <memory>
+#include <system_error>
 #include "audio_generic.h"
+#include "audio_mixer.h"
 #include "output.h"
+#include "instrumentation.h"
+
+namespace {
+	/**
+	 * Decodes stereo float frames.
+	 *
+	 * @param decoder decoder to read from
+	 * @param frames maximum number of frames
+	 * @param frequency output frequency, used for the fade of a BGM
+	 * @param is_bgm whether the decoder plays a BGM
+	 * @param scrap buffer for the decoder output
+	 * @param out receives the frames
+	 * @param gain volume at the end of the previous frames, negative to start
+	 *             at the volume of the decoder. Receives the volume at the end.
+	 * @return number of frames, -1 on error
+	 */
+	int DecodeFrames(AudioDecoderBase& decoder, int frames, int frequency, bool is_bgm, std::vector<uint8_t>& scrap, std::vector<float>& out, float& gain) {
+		int decoder_frequency;
+		AudioDecoder::Format format;
+		int channels;
+		decoder.GetFormat(decoder_frequency, format, channels);
+		const int frame_size = AudioDecoder::GetSamplesizeForFormat(format) * channels;
+
+		if (scrap.size() < static_cast<size_t>(frames * frame_size)) {
+			scrap.resize(frames * frame_size);
+		}
+		if (out.size() < static_cast<size_t>(frames * 2)) {
+			out.resize(frames * 2);
+		}
+
+		const int read_bytes = decoder.Decode(scrap.data(), frames * frame_size);
+		if (read_bytes <= 0) {
+			return -1;
+		}
+
+		const int read_frames = read_bytes / frame_size;
+		const float gain_start = gain < 0.0f ? decoder.GetVolume() / 100.0f : gain;
+
+		if (is_bgm) {
+			// Fades progress with the decoded audio
+			decoder.Update(std::chrono::microseconds(read_frames * INT64_C(1000000) / frequency));
+		}
+
+		// Volume changes and fades are ramped over the frames instead of stepping
+		gain = decoder.GetVolume() / 100.0f;
+		AudioMixer::ConvertToStereo(out.data(), scrap.data(), read_frames, format, channels, gain_start, gain);
+
+		return read_frames;
+	}
+
+	/** Commands are handled quickly, the timeout only matters for refilling */
+	constexpr auto decoder_thread_interval = std::chrono::milliseconds(5);
+}
 
 GenericAudio::GenericAudio(const Game_ConfigAudio& cfg) : AudioInterface(cfg) {
 	int i = 0;
 	for (auto& BGM_Channel : BGM_Channels) {
 		BGM_Channel.id = i++;
-		BGM_Channel.decoder.reset();
 		BGM_Channel.instance = this;
 	}
-	i = 0;
-	for (auto& SE_Channel : SE_Channels) {
-		SE_Channel.id = i++;
-		SE_Channel.decoder.reset();
-		SE_Channel.instance = this;
-	}
-	BGM_PlayedOnceIndicator = false;
 	midi_thread.reset();
 
+	AudioSeCache::SetBudget(static_cast<size_t>(cfg.se_cache_size.Get()) * 1024 * 1024);
+
 	// Initialize to some arbitrary (low-quality) format to prevent crashes
 	// when the inheriting class doesn't call SetFormat
 	SetFormat(12345, AudioDecoder::Format::S8, 1);
 }
 
+GenericAudio::~GenericAudio() {
+	StopLoaderThread();
+	StopDecoderThread();
+}
+
 void GenericAudio::BGM_Play(Filesystem_Stream::InputStream stream, int volume, int pitch, int fadein) {
 	if (!stream) {
 		Output::Warning("Couldn't play BGM {}: File not readable", stream.GetName());
 		return;
 	}
 
+	// Stop all running background music. The generation of a channel makes
+	// it reusable immediately, an unused one is only preferred.
+	for (auto& BGM_Channel : BGM_Channels) {
+		BGM_Channel.Stop();
+	}
+
 	for (auto& BGM_Channel : BGM_Channels) {
-		BGM_Channel.stopped = true; //Stop all running background music
 		if (!BGM_Channel.IsUsed()) {
-			// If there is an unused bgm channel
-			LockMutex();
-			BGM_PlayedOnceIndicator = false;
-			UnlockMutex();
 			PlayOnChannel(BGM_Channel, std::move(stream), volume, pitch, fadein);
 			return;
 		}
 	}
+	PlayOnChannel(BGM_Channels[0], std::move(stream), volume, pitch, fadein);
 }
 
 void GenericAudio::BGM_Pause() {
@@ -80,29 +137,32 @@ void GenericAudio::BGM_Resume() {
 }
 
 void GenericAudio::BGM_Stop() {
-	LockMutex();
 	for (auto& BGM_Channel : BGM_Channels) {
 		BGM_Channel.Stop();
 	}
-	BGM_PlayedOnceIndicator = false;
-	UnlockMutex();
 }
 
 bool GenericAudio::BGM_PlayedOnce() const {
-	if (BGM_PlayedOnceIndicator) {
-		return BGM_PlayedOnceIndicator;
-	}
-
-	LockMutex();
-	// Audio Decoders set this in the Decoding thread
 	for (auto& BGM_Channel : BGM_Channels) {
+		if (BGM_Channel.stopped) {
+			continue;
+		}
+
 		if (BGM_Channel.midi_out_used) {
-			BGM_PlayedOnceIndicator = midi_thread->GetMidiOut().GetLoopCount() > 0;
+			midi_thread->LockMutex();
+			bool played_once = midi_thread->GetMidiOut().GetLoopCount() > 0;
+			midi_thread->UnlockMutex();
+			return played_once;
+		}
+
+		// Set by the decoder thread, only valid for the current song
+		const auto& chan = channels[BGM_Channel.id];
+		if (chan.played_once_generation.load(std::memory_order_acquire) == chan.generation) {
+			return true;
 		}
 	}
-	UnlockMutex();
 
-	return BGM_PlayedOnceIndicator;
+	return false;
 }
 
 bool GenericAudio::BGM_IsPlaying() const {
@@ -116,59 +176,55 @@ bool GenericAudio::BGM_IsPlaying() const {
 
 int GenericAudio::BGM_GetTicks() const {
 	unsigned ticks = 0;
-	LockMutex();
 	for (auto& BGM_Channel : BGM_Channels) {
+		if (BGM_Channel.stopped) {
+			// Still used until the decoder thread handled the stop, the ticks are from the old song
+			continue;
+		}
+
 		int cur_ticks = BGM_Channel.GetTicks();
 		if (cur_ticks >= 0) {
 			ticks = static_cast<unsigned>(cur_ticks);
 		}
 	}
-	UnlockMutex();
 	return ticks;
 }
 
 void GenericAudio::BGM_Fade(int fade) {
-	LockMutex();
 	for (auto& BGM_Channel : BGM_Channels) {
 		BGM_Channel.SetFade(fade);
 	}
-	UnlockMutex();
 }
 
 void GenericAudio::BGM_Volume(int volume) {
-	LockMutex();
 	for (auto& BGM_Channel : BGM_Channels) {
 		BGM_Channel.SetVolume(volume);
 	}
-	UnlockMutex();
 }
 
 void GenericAudio::BGM_Pitch(int pitch) {
-	LockMutex();
 	for (auto& BGM_Channel : BGM_Channels) {
 		BGM_Channel.SetPitch(pitch);
 	}
-	UnlockMutex();
 }
 
 std::string GenericAudio::BGM_GetType() const {
-	std::string type;
-
-	LockMutex();
 	for (auto& BGM_Channel : BGM_Channels) {
 		if (BGM_Channel.IsUsed()) {
 			if (BGM_Channel.midi_out_used) {
-				type = "midi";
-				break;
-			} else {
-				type = BGM_Channel.decoder->GetType();
-				break;
+				return "midi";
+			}
+
+			// Empty while the loader opens the BGM
+			std::lock_guard<std::mutex> lock(loader_mutex);
+			if (BGM_Channel.type_generation == channels[BGM_Channel.id].generation) {
+				return BGM_Channel.type;
 			}
+			return {};
 		}
 	}
-	UnlockMutex();
 
-	return type;
+	return {};
 }
 
 void GenericAudio::SE_Play(std::unique_ptr<AudioSeCache> se, int volume, int pitch) {
@@ -177,10 +233,10 @@ void GenericAudio::SE_Play(std::unique_ptr<AudioSeCache> se, int volume, int pit
 		return;
 	}
 
-	for (auto& SE_Channel : SE_Channels) {
-		if (!SE_Channel.decoder) {
+	for (unsigned i = nr_of_bgm_channels; i < nr_of_channels; ++i) {
+		if (!channels[i].IsUsed()) {
 			//If there is an unused se channel
-			PlayOnChannel(SE_Channel, std::move(se), volume, pitch);
+			PlayOnChannel(i, std::move(se), volume, pitch);
 			return;
 		}
 	}
@@ -188,14 +244,29 @@ void GenericAudio::SE_Play(std::unique_ptr<AudioSeCache> se, int volume, int pit
 	Output::Debug("Couldn't play {} SE. No free channel available", se->GetName());
 }
 
+void GenericAudio::SE_Preload(std::unique_ptr<AudioSeCache> se, int pitch) {
+	if (se) {
+		se->CreateSeDecoder(pitch, output_format.frequency, output_format.format, output_format.channels);
+	}
+}
+
 void GenericAudio::SE_Stop() {
-	for (auto& SE_Channel : SE_Channels) {
-		SE_Channel.stopped = true; //Stop all running sound effects
+	for (unsigned i = nr_of_bgm_channels; i < nr_of_channels; ++i) {
+		StopChannel(i);
 	}
 }
 
 void GenericAudio::Update() {
-	// no-op, handled by the Decode function called through a thread
+	// Playback is handled by the decoder thread and the Decode function.
+	// Output is not thread safe, the warnings of the loader are shown here.
+	std::vector<std::string> warnings;
+	{
+		std::lock_guard<std::mutex> lock(loader_mutex);
+		warnings.swap(loader_warnings);
+	}
+	for (const auto& warning : warnings) {
+		Output::Warning("{}", warning);
+	}
 }
 
 GenericAudioMidiOut* GenericAudio::CreateAndGetMidiOut() {
@@ -212,14 +283,23 @@ GenericAudioMidiOut* GenericAudio::CreateAndGetMidiOut() {
 }
 
 void GenericAudio::SetFormat(int frequency, AudioDecoder::Format format, int channels) {
+	StopDecoderThread();
+
 	output_format.frequency = frequency;
 	output_format.format = format;
 	output_format.channels = channels;
+
+	// Enough for the largest callback buffers in use
+	for (auto& chan : this->channels) {
+		chan.ring.Resize(std::max(frequency / 4, 1024));
+	}
+
+	StartDecoderThread();
 }
 
 bool GenericAudio::PlayOnChannel(BgmChannel& chan, Filesystem_Stream::InputStream filestream, int volume, int pitch, int fadein) {
-	chan.paused = true; // Pause channel so the audio thread doesn't work on it
-	chan.stopped = false; // Unstop channel so the audio thread doesn't delete it
+	chan.paused = false;
+	chan.stopped = false;
 
 	if (!filestream) {
 		Output::Warning("BGM file not readable: {}", filestream.GetName());
@@ -227,14 +307,12 @@ bool GenericAudio::PlayOnChannel(BgmChannel& chan, Filesystem_Stream::InputStrea
 	}
 
 	// Midiout is only supported on channel 0 because this is an exclusive resource
-	if (chan.id == 0 && GenericAudioMidiOut::IsSupported(filestream)) {
-		chan.decoder.reset();
-
+	if (chan.id == 0 && Audio().GetNativeMidiEnabled() && GenericAudioMidiOut::IsSupported(filestream)) {
 		// Order is Fluidsynth, WildMidi, Native, FmMidi
 		bool fluidsynth = Audio().GetFluidsynthEnabled() && MidiDecoder::CreateFluidsynth(true);
 		bool wildmidi = Audio().GetWildMidiEnabled() && MidiDecoder::CreateWildMidi(true);
 
-		if (!fluidsynth && !wildmidi && Audio().GetNativeMidiEnabled()) {
+		if (!fluidsynth && !wildmidi) {
 			CreateAndGetMidiOut();
 
 			if (midi_thread) {
@@ -246,7 +324,6 @@ bool GenericAudio::PlayOnChannel(BgmChannel& chan, Filesystem_Stream::InputStrea
 					midi_out.SetFade(volume, std::chrono::milliseconds(fadein));
 					midi_out.SetLooping(true);
 					midi_out.Resume();
-					chan.paused = false;
 					chan.midi_out_used = true;
 					midi_thread->UnlockMutex();
 					return true;
@@ -259,238 +336,512 @@ bool GenericAudio::PlayOnChannel(BgmChannel& chan, Filesystem_Stream::InputStrea
 	if (midi_thread) {
 		midi_thread->GetMidiOut().Reset();
 	}
-
-	chan.decoder = AudioDecoder::Create(filestream);
 	chan.midi_out_used = false;
-	if (chan.decoder && chan.decoder->Open(std::move(filestream))) {
-		chan.decoder->SetPitch(pitch);
-		chan.decoder->SetFormat(output_format.frequency, output_format.format, output_format.channels);
-		chan.decoder->SetVolume(0);
-		chan.decoder->SetFade(volume, std::chrono::milliseconds(fadein));
-		chan.decoder->SetLooping(true);
-		chan.paused = false; // Unpause channel -> Play it.
 
+	// The channel is used from now on, the decoder follows when the loader opened it
+	DecoderCommand cmd;
+	cmd.type = DecoderCommand::Type::Load;
+	cmd.channel = chan.id;
+	if (!StartChannel(std::move(cmd))) {
+		return false;
+	}
+
+	auto request = std::make_unique<BgmOpenRequest>();
+	request->channel = chan.id;
+	request->generation = channels[chan.id].generation;
+	request->stream = std::move(filestream);
+	request->volume = volume;
+	request->pitch = pitch;
+	request->fadein = fadein;
+
+#if !defined(EMSCRIPTEN) || defined(__EMSCRIPTEN_PTHREADS__)
+	if (!loader_thread.joinable()) {
+		try {
+			loader_thread = std::thread(&GenericAudio::LoaderThreadFunction, this);
+		} catch (const std::system_error& e) {
+			Output::Debug("GenericAudio: Starting loader thread failed: {}", e.what());
+		}
+	}
+#endif
+
+	if (!loader_thread.joinable()) {
+		OpenBgm(std::move(*request));
 		return true;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(loader_mutex);
+		loader_request = std::move(request);
+	}
+	loader_cv.notify_one();
+
+	return true;
+}
+
+bool GenericAudio::PlayOnChannel(int channel, std::unique_ptr<AudioSeCache> se, int volume, int pitch) {
+	DecoderCommand cmd;
+	cmd.type = DecoderCommand::Type::Play;
+	cmd.channel = channel;
+	// Already resampled to the output format, the decoder thread only copies the sample
+	cmd.decoder = se->CreateSeDecoder(pitch, output_format.frequency, output_format.format, output_format.channels);
+	cmd.decoder->SetVolume(volume);
+
+	return StartChannel(std::move(cmd));
+}
+
+void GenericAudio::OpenBgm(BgmOpenRequest request) {
+	Instrumentation::ZoneScope zone("GenericAudio::OpenBgm");
+
+	DecoderCommand cmd;
+	cmd.type = DecoderCommand::Type::Loaded;
+	cmd.channel = request.channel;
+	cmd.generation = request.generation;
+
+	const std::string name = ToString(request.stream.GetName());
+	auto decoder = AudioDecoder::Create(request.stream);
+	if (decoder && decoder->Open(std::move(request.stream))) {
+		decoder->SetPitch(request.pitch);
+		decoder->SetFormat(output_format.frequency, output_format.format, output_format.channels);
+		decoder->SetVolume(0);
+		decoder->SetFade(request.volume, std::chrono::milliseconds(request.fadein));
+		decoder->SetLooping(true);
+
+		{
+			std::lock_guard<std::mutex> lock(loader_mutex);
+			auto& chan = BGM_Channels[request.channel];
+			chan.type = decoder->GetType();
+			chan.type_generation = request.generation;
+		}
+
+		// A few hundred ms, the playback must not start with an underrun
+		const int prebuffer_frames = std::min(output_format.frequency / 4, channels[request.channel].ring.GetCapacity() / 2);
+		std::vector<uint8_t> scrap;
+		float gain = -1.0f;
+		const int frames = DecodeFrames(*decoder, prebuffer_frames, output_format.frequency, true, scrap, cmd.frames, gain);
+		if (frames >= 0) {
+			cmd.frames.resize(frames * 2);
+			cmd.decoder = std::move(decoder);
+		}
 	} else {
-		Output::Warning("Couldn't play BGM {}. Format not supported", filestream.GetName());
+		std::lock_guard<std::mutex> lock(loader_mutex);
+		loader_warnings.push_back(fmt::format("Couldn't play BGM {}. Format not supported", name));
 	}
 
-	return false;
+	// Without a decoder the channel is released
+	if (!loaded_decoders.Push(std::move(cmd))) {
+		std::lock_guard<std::mutex> lock(loader_mutex);
+		loader_warnings.push_back(fmt::format("Couldn't play BGM {}. Audio command queue is full", name));
+		return;
+	}
+
+	if (decoder_thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(decoder_mutex);
+		}
+		decoder_cv.notify_one();
+	}
 }
 
-bool GenericAudio::PlayOnChannel(SeChannel& chan, std::unique_ptr<AudioSeCache> se, int volume, int pitch) {
-	chan.paused = true; // Pause channel so the audio thread doesn't work on it
-	chan.stopped = false; // Unstop channel so the audio thread doesn't delete it
+void GenericAudio::LoaderThreadFunction() {
+	while (true) {
+		std::unique_ptr<BgmOpenRequest> request;
+		{
+			std::unique_lock<std::mutex> lock(loader_mutex);
+			loader_cv.wait(lock, [this]() { return loader_thread_stop || loader_request; });
+			if (loader_thread_stop) {
+				return;
+			}
+			request = std::move(loader_request);
+		}
 
-	chan.decoder = se->CreateSeDecoder();
-	chan.decoder->SetPitch(pitch);
-	chan.decoder->SetFormat(output_format.frequency, output_format.format, output_format.channels);
-	chan.decoder->SetVolume(volume);
-	chan.paused = false; // Unpause channel -> Play it.
+		OpenBgm(std::move(*request));
+	}
+}
+
+void GenericAudio::StopLoaderThread() {
+	if (!loader_thread.joinable()) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(loader_mutex);
+		loader_thread_stop = true;
+	}
+	loader_cv.notify_one();
+	loader_thread.join();
+}
+
+bool GenericAudio::StartChannel(DecoderCommand cmd) {
+	// Both commands must be queued, otherwise the channel state is inconsistent
+	if (!decoder_commands.CanPush() || !mix_commands.CanPush()) {
+		Output::Debug("Audio command queue is full");
+		return false;
+	}
+
+	const int channel = cmd.channel;
+	auto& chan = channels[channel];
+	++chan.generation;
+
+	cmd.generation = chan.generation;
+	PushCommand(std::move(cmd));
+	PushCommand(MixCommand{ MixCommand::Type::Play, channel, chan.generation });
 	return true;
 }
 
-void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
-	bool channel_active = false;
-	float total_volume = 0;
-	int samples_per_frame = buffer_length / output_format.channels / 2;
+void GenericAudio::StopChannel(int channel) {
+	auto& chan = channels[channel];
+	if (!chan.IsUsed()) {
+		return;
+	}
 
-	assert(buffer_length > 0);
+	if (!decoder_commands.CanPush() || !mix_commands.CanPush()) {
+		Output::Debug("Audio command queue is full");
+		return;
+	}
+
+	++chan.generation;
+
+	DecoderCommand cmd;
+	cmd.type = DecoderCommand::Type::Stop;
+	cmd.channel = channel;
+	cmd.generation = chan.generation;
+	PushCommand(std::move(cmd));
+	PushCommand(MixCommand{ MixCommand::Type::Stop, channel, chan.generation });
+}
 
-	if (sample_buffer.size() != (size_t)buffer_length) {
-		sample_buffer.resize(buffer_length);
+void GenericAudio::PushDecoderCommand(DecoderCommand::Type type, int channel, int value) {
+	auto& chan = channels[channel];
+	if (!chan.IsUsed()) {
+		return;
 	}
-	if (mixer_buffer.size() != (size_t)buffer_length) {
-		mixer_buffer.resize(buffer_length);
+
+	DecoderCommand cmd;
+	cmd.type = type;
+	cmd.channel = channel;
+	cmd.generation = chan.generation;
+	cmd.value = value;
+	PushCommand(std::move(cmd));
+}
+
+void GenericAudio::PushCommand(DecoderCommand cmd) {
+	if (!decoder_commands.Push(std::move(cmd))) {
+		Output::Debug("Audio command queue is full");
+		return;
 	}
-	scrap_buffer_size = samples_per_frame * output_format.channels * sizeof(uint32_t);
-	if (scrap_buffer.size() != scrap_buffer_size) {
-		scrap_buffer.resize(scrap_buffer_size);
+
+	if (decoder_thread.joinable()) {
+		// Taking the mutex prevents a lost wakeup
+		{
+			std::lock_guard<std::mutex> lock(decoder_mutex);
+		}
+		decoder_cv.notify_one();
 	}
-	std::fill(mixer_buffer.begin(), mixer_buffer.end(), '\0');
+}
 
-	for (unsigned i = 0; i < nr_of_bgm_channels + nr_of_se_channels; i++) {
-		int read_bytes = 0;
-		int channels = 0;
-		int samplesize = 0;
-		int frequency = 0;
-		AudioDecoder::Format sampleformat;
-		float volume;
+void GenericAudio::PushCommand(MixCommand cmd) {
+	if (!mix_commands.Push(std::move(cmd))) {
+		Output::Debug("Audio command queue is full");
+	}
+}
 
-		// Mix BGM and SE together;
-		bool is_bgm_channel = i < nr_of_bgm_channels;
-		bool channel_used = false;
+void GenericAudio::StartDecoderThread() {
+#if defined(EMSCRIPTEN) && !defined(__EMSCRIPTEN_PTHREADS__)
+	// No thread support: Decode runs the decoders
+#else
+	decoder_thread_stop = false;
+	try {
+		decoder_thread = std::thread(&GenericAudio::DecoderThreadFunction, this);
+	} catch (const std::system_error& e) {
+		Output::Debug("GenericAudio: Starting decoder thread failed: {}", e.what());
+	}
+#endif
+}
 
-		if (is_bgm_channel) {
-			BgmChannel& currently_mixed_channel = BGM_Channels[i];
-			float current_master_volume = cfg.music_volume.Get() / 100.0f;
+void GenericAudio::StopDecoderThread() {
+	if (!decoder_thread.joinable()) {
+		return;
+	}
 
-			if (currently_mixed_channel.decoder && !currently_mixed_channel.paused) {
-				if (currently_mixed_channel.stopped) {
-					currently_mixed_channel.decoder.reset();
-				} else {
-					currently_mixed_channel.decoder->Update(std::chrono::microseconds(1000 * 1000 / 60));
-					volume = current_master_volume * (currently_mixed_channel.decoder->GetVolume() / 100.0);
-					currently_mixed_channel.decoder->GetFormat(frequency, sampleformat, channels);
-					samplesize = AudioDecoder::GetSamplesizeForFormat(sampleformat);
+	{
+		std::lock_guard<std::mutex> lock(decoder_mutex);
+		decoder_thread_stop = true;
+	}
+	decoder_cv.notify_one();
+	decoder_thread.join();
+}
 
-					total_volume += volume;
+void GenericAudio::DecoderThreadFunction() {
+	while (!decoder_thread_stop) {
+		ProcessDecoderCommands();
 
-					// determine how much data has to be read from this channel (but cap at the bounds of the scrap buffer)
-					unsigned bytes_to_read = (samplesize * channels * samples_per_frame);
-					bytes_to_read = (bytes_to_read < scrap_buffer_size) ? bytes_to_read : scrap_buffer_size;
+		bool decoded;
+		{
+			Instrumentation::ZoneScope zone("GenericAudio::FillChannels");
+			decoded = FillChannels(GetTargetFrames());
+		}
+		if (decoded) {
+			continue;
+		}
 
-					read_bytes = currently_mixed_channel.decoder->Decode(scrap_buffer.data(), bytes_to_read);
+		std::unique_lock<std::mutex> lock(decoder_mutex);
+		decoder_cv.wait_for(lock, decoder_thread_interval, [this]() {
+			return decoder_thread_stop || !decoder_commands.IsEmpty() || !loaded_decoders.IsEmpty();
+		});
+	}
+}
 
-					if (read_bytes <= 0) {
-						// An error occured when reading - the channel is faulty - discard
-						currently_mixed_channel.decoder.reset();
-						continue; // skip this loop run - there is nothing to mix
+void GenericAudio::ProcessDecoderCommands() {
+	auto apply = [](Channel& chan, DecoderCommand& cmd) {
+		if (cmd.type == DecoderCommand::Type::Fade) {
+			chan.decoder->SetFade(0, std::chrono::milliseconds(cmd.value));
+		} else if (cmd.type == DecoderCommand::Type::Volume) {
+			chan.decoder->SetVolume(cmd.value);
+		} else if (cmd.type == DecoderCommand::Type::Pitch) {
+			chan.decoder->SetPitch(cmd.value);
+		}
+	};
+
+	auto process_commands = [&]() {
+		DecoderCommand cmd;
+		while (decoder_commands.Pop(cmd)) {
+			auto& chan = channels[cmd.channel];
+
+			switch (cmd.type) {
+				case DecoderCommand::Type::Play:
+				case DecoderCommand::Type::Load:
+					chan.decoder = std::move(cmd.decoder);
+					chan.decoder_generation = cmd.generation;
+					chan.gain = -1.0f;
+					chan.draining = false;
+					chan.loading = cmd.type == DecoderCommand::Type::Load;
+					chan.prebuffer.clear();
+					chan.deferred.clear();
+					chan.ring.RequestFlush(cmd.generation);
+					if (!chan.decoder && !chan.loading) {
+						ReleaseChannel(chan);
 					}
-
-					if (!currently_mixed_channel.stopped) {
-						BGM_PlayedOnceIndicator = currently_mixed_channel.decoder->GetLoopCount() > 0;
+					break;
+				case DecoderCommand::Type::Stop:
+					chan.decoder_generation = cmd.generation;
+					chan.loading = false;
+					chan.prebuffer.clear();
+					chan.deferred.clear();
+					chan.ring.RequestFlush(cmd.generation);
+					ReleaseChannel(chan);
+					break;
+				default:
+					// Only applies to the song the game thread knew about
+					if (chan.decoder_generation != cmd.generation) {
+						break;
 					}
-
-					channel_used = true;
-				}
+					if (chan.loading) {
+						chan.deferred.push_back(std::move(cmd));
+					} else if (chan.decoder) {
+						apply(chan, cmd);
+					}
+					break;
 			}
-		} else {
-			SeChannel& currently_mixed_channel = SE_Channels[i - nr_of_bgm_channels];
-			float current_master_volume = cfg.sound_volume.Get() / 100.0f;
+		}
+	};
 
-			if (currently_mixed_channel.decoder && !currently_mixed_channel.paused) {
-				if (currently_mixed_channel.stopped) {
-					currently_mixed_channel.decoder.reset();
-				} else {
-					volume = current_master_volume * (currently_mixed_channel.decoder->GetVolume() / 100.0);
-					currently_mixed_channel.decoder->GetFormat(frequency, sampleformat, channels);
-					samplesize = AudioDecoder::GetSamplesizeForFormat(sampleformat);
+	process_commands();
 
-					total_volume += volume;
+	DecoderCommand loaded;
+	while (loaded_decoders.Pop(loaded)) {
+		// The Load command was queued before, make sure it was seen
+		process_commands();
 
-					// determine how much data has to be read from this channel (but cap at the bounds of the scrap buffer)
-					unsigned bytes_to_read = (samplesize * channels * samples_per_frame);
-					bytes_to_read = (bytes_to_read < scrap_buffer_size) ? bytes_to_read : scrap_buffer_size;
+		auto& chan = channels[loaded.channel];
+		if (!chan.loading || chan.decoder_generation != loaded.generation) {
+			// Stopped while loading
+			continue;
+		}
 
-					read_bytes = currently_mixed_channel.decoder->Decode(scrap_buffer.data(), bytes_to_read);
+		chan.loading = false;
+		chan.decoder = std::move(loaded.decoder);
+		chan.gain = -1.0f;
+		if (!chan.decoder) {
+			ReleaseChannel(chan);
+			continue;
+		}
 
-					if (read_bytes <= 0) {
-						// An error occured when reading - the channel is faulty - discard
-						currently_mixed_channel.decoder.reset();
-						continue; // skip this loop run - there is nothing to mix
-					}
+		chan.prebuffer = std::move(loaded.frames);
+		for (auto& cmd : chan.deferred) {
+			apply(chan, cmd);
+		}
+		chan.deferred.clear();
 
-					// Now decide what to do when a channel has reached its end
-					if (currently_mixed_channel.decoder->IsFinished()) {
-						// SE are only played once so free the se if finished
-						currently_mixed_channel.decoder.reset();
-					}
+		chan.ticks.store(chan.decoder->GetTicks(), std::memory_order_relaxed);
+		if (chan.decoder->GetLoopCount() > 0) {
+			chan.played_once_generation.store(chan.decoder_generation, std::memory_order_release);
+		}
+	}
+}
 
-					channel_used = true;
-				}
+bool GenericAudio::FillChannels(int target_frames) {
+	bool decoded = false;
+
+	for (unsigned i = 0; i < nr_of_channels; ++i) {
+		auto& chan = channels[i];
+		if (!chan.decoder || !chan.ring.IsFlushed(chan.decoder_generation)) {
+			continue;
+		}
+
+		if (!chan.prebuffer.empty()) {
+			// Empty after the flush, the prebuffer always fits
+			const int frames = std::min(static_cast<int>(chan.prebuffer.size() / 2), chan.ring.GetFree());
+			chan.ring.Write(chan.prebuffer.data(), frames);
+			chan.prebuffer.clear();
+			decoded = true;
+		}
+
+		if (chan.draining) {
+			// Finished, the channel is free when everything was played
+			if (chan.ring.GetFree() == chan.ring.GetCapacity()) {
+				ReleaseChannel(chan);
 			}
+			continue;
 		}
 
-		//--------------------------------------------------------------------------------------------------------------------//
-		// From here downwards the currently_mixed_channel decoder may already be freed - so don't use it below this comment. //
-		//--------------------------------------------------------------------------------------------------------------------//
+		const int buffered = chan.ring.GetCapacity() - chan.ring.GetFree();
+		const int frames = std::min(target_frames - buffered, chan.ring.GetFree());
+		if (frames > 0 && FillChannel(chan, frames, i < nr_of_bgm_channels) > 0) {
+			decoded = true;
+		}
+	}
 
-		if (channel_used) {
-			for (unsigned ii = 0; ii < (unsigned)(read_bytes / (samplesize * channels)); ii++) {
+	return decoded;
+}
 
-				float vall = volume;
-				float valr = vall;
+int GenericAudio::FillChannel(Channel& chan, int frames, bool is_bgm) {
+	const int read_frames = DecodeFrames(*chan.decoder, frames, output_format.frequency, is_bgm, scrap_buffer, frame_buffer, chan.gain);
+	if (read_frames < 0) {
+		// An error occured when reading - the channel is faulty - discard
+		ReleaseChannel(chan);
+		return 0;
+	}
 
-				// Convert to floating point
-				switch (sampleformat) {
-					case AudioDecoder::Format::S8:
-						vall *= (((int8_t *) scrap_buffer.data())[ii * channels] / 128.0);
-						valr *= (((int8_t *) scrap_buffer.data())[ii * channels + 1] / 128.0);
-						break;
-					case AudioDecoder::Format::U8:
-						vall *= (((uint8_t *) scrap_buffer.data())[ii * channels] / 128.0 - 1.0);
-						valr *= (((uint8_t *) scrap_buffer.data())[ii * channels + 1] / 128.0 - 1.0);
-						break;
-					case AudioDecoder::Format::S16:
-						vall *= (((int16_t *) scrap_buffer.data())[ii * channels] / 32768.0);
-						valr *= (((int16_t *) scrap_buffer.data())[ii * channels + 1] / 32768.0);
-						break;
-					case AudioDecoder::Format::U16:
-						vall *= (((uint16_t *) scrap_buffer.data())[ii * channels] / 32768.0 - 1.0);
-						valr *= (((uint16_t *) scrap_buffer.data())[ii * channels + 1] / 32768.0 - 1.0);
-						break;
-					case AudioDecoder::Format::S32:
-						vall *= (((int32_t *) scrap_buffer.data())[ii * channels] / 2147483648.0);
-						valr *= (((int32_t *) scrap_buffer.data())[ii * channels + 1] / 2147483648.0);
-						break;
-					case AudioDecoder::Format::U32:
-						vall *= (((uint32_t *) scrap_buffer.data())[ii * channels] / 2147483648.0 - 1.0);
-						valr *= (((uint32_t *) scrap_buffer.data())[ii * channels + 1] / 2147483648.0 - 1.0);
-						break;
-					case AudioDecoder::Format::F32:
-						vall *= (((float *) scrap_buffer.data())[ii * channels]);
-						valr *= (((float *) scrap_buffer.data())[ii * channels + 1]);
-						break;
-				}
+	chan.ring.Write(frame_buffer.data(), read_frames);
 
-				if (!channel_active) {
-					// first channel
-					mixer_buffer[ii * output_format.channels] = vall;
-					if (channels > 1) {
-						mixer_buffer[ii * output_format.channels + 1] = valr;
-					} else {
-						mixer_buffer[ii * output_format.channels + 1] = mixer_buffer[ii * output_format.channels];
-					}
-				} else {
-					mixer_buffer[ii * output_format.channels] += vall;
-					if (channels > 1) {
-						mixer_buffer[ii * output_format.channels + 1] += valr;
-					} else {
-						mixer_buffer[ii * output_format.channels + 1] = mixer_buffer[ii * output_format.channels];
-					}
-				}
+	chan.volume.store(chan.decoder->GetVolume() / 100.0f, std::memory_order_relaxed);
+	chan.ticks.store(chan.decoder->GetTicks(), std::memory_order_relaxed);
 
-			}
-			channel_active = true;
+	if (is_bgm) {
+		if (chan.decoder->GetLoopCount() > 0) {
+			chan.played_once_generation.store(chan.decoder_generation, std::memory_order_release);
 		}
+	} else if (chan.decoder->IsFinished()) {
+		// SE are only played once, keep the decoder until the frames were mixed
+		chan.draining = true;
 	}
 
-	if (channel_active) {
-		if (total_volume > 1.0) {
-			float threshold = 0.8f;
-			for (unsigned i = 0; i < (unsigned)(samples_per_frame * 2); i++) {
-				float sample = mixer_buffer[i];
-				float sign = (sample < 0) ? -1.0 : 1.0;
-				sample /= sign;
-				//dynamic range compression
-				if (sample > threshold) {
-					sample_buffer[i] = sign * 32768.0 * (threshold + (1.0 - threshold) * (sample - threshold) / (total_volume - threshold));
-				} else {
-					sample_buffer[i] = sign * sample * 32768.0;
+	return read_frames;
+}
+
+void GenericAudio::ReleaseChannel(Channel& chan) {
+	chan.decoder.reset();
+	chan.draining = false;
+	chan.ticks.store(-1, std::memory_order_relaxed);
+	chan.released_generation.store(chan.decoder_generation, std::memory_order_release);
+}
+
+int GenericAudio::GetTargetFrames() const {
+	// Two callbacks ahead, but at least 50 ms
+	const int frames = callback_frames.load(std::memory_order_relaxed) * 2;
+	return std::clamp(frames, output_format.frequency / 20, channels[0].ring.GetCapacity());
+}
+
+void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
+	// No profiler zones here, recording a zone locks a mutex which must not happen in the audio callback
+	bool channel_active = false;
+	float total_volume = 0;
+	int samples_per_frame = buffer_length / output_format.channels / 2;
+
+	assert(buffer_length > 0);
+
+	callback_frames.store(samples_per_frame, std::memory_order_relaxed);
+
+	// Output and mix bus are interleaved stereo
+	mixer_buffer.assign(samples_per_frame * 2, 0.0f);
+
+	if (!decoder_thread.joinable()) {
+		// Without a decoder thread the decoding happens here
+		ProcessDecoderCommands();
+		for (auto& chan : channels) {
+			chan.ring.Sync();
+		}
+		FillChannels(samples_per_frame);
+	}
+
+	MixCommand cmd;
+	while (mix_commands.Pop(cmd)) {
+		auto& chan = channels[cmd.channel];
+		switch (cmd.type) {
+			case MixCommand::Type::Play:
+				chan.mix_generation = cmd.generation;
+				chan.mix_playing = true;
+				chan.mix_paused = false;
+				chan.mix_volume = -1.0f;
+				break;
+			case MixCommand::Type::Stop:
+				chan.mix_generation = cmd.generation;
+				chan.mix_playing = false;
+				break;
+			case MixCommand::Type::Pause:
+			case MixCommand::Type::Resume:
+				if (chan.mix_generation == cmd.generation) {
+					chan.mix_paused = cmd.type == MixCommand::Type::Pause;
 				}
-			}
-		} else {
-			//No dynamic range compression necessary
-			for (unsigned i = 0; i < (unsigned)(samples_per_frame * 2); i++) {
-				sample_buffer[i] = mixer_buffer[i] * 32768.0;
-			}
+				break;
+		}
+	}
+
+	for (unsigned i = 0; i < nr_of_channels; i++) {
+		auto& chan = channels[i];
+
+		// Discards the frames of stopped songs
+		const uint32_t generation = chan.ring.Sync();
+		if (!chan.mix_playing || chan.mix_paused || generation != chan.mix_generation) {
+			continue;
+		}
+
+		const int frames = std::min(chan.ring.GetAvailable(), samples_per_frame);
+		if (frames <= 0) {
+			continue;
 		}
 
-		memcpy(output_buffer, sample_buffer.data(), buffer_length);
+		// Mix BGM and SE together, the frames already contain the volume of the decoder
+		const auto& master_volume = i < nr_of_bgm_channels ? cfg.music_volume : cfg.sound_volume;
+		const float volume = master_volume.Get() / 100.0f;
+		total_volume += volume * chan.volume.load(std::memory_order_relaxed);
+
+		// Changes of the master volume are ramped over the buffer
+		const float volume_start = chan.mix_volume < 0.0f ? volume : chan.mix_volume;
+		chan.ring.MixInto(mixer_buffer.data(), frames, volume_start, volume);
+		chan.mix_volume = volume;
+		channel_active = true;
+	}
+
+	if (channel_active) {
+		// Compresses the dynamic range when the channels together can clip
+		AudioMixer::ConvertToS16(reinterpret_cast<int16_t*>(output_buffer), mixer_buffer.data(), samples_per_frame * 2, total_volume);
 	} else {
 		memset(output_buffer, '\0', buffer_length);
 	}
 }
 
+bool GenericAudio::Channel::IsUsed() const {
+	return released_generation.load(std::memory_order_acquire) != generation;
+}
+
 void GenericAudio::BgmChannel::Stop() {
 	stopped = true;
 	if (midi_out_used) {
 		midi_out_used = false;
 		instance->midi_thread->GetMidiOut().Reset();
 		instance->midi_thread->GetMidiOut().Pause();
-	} else if (decoder) {
-		decoder.reset();
+	} else {
+		instance->StopChannel(id);
 	}
 }
 
@@ -502,14 +853,17 @@ void GenericAudio::BgmChannel::SetPaused(bool newPaused) {
 		} else {
 			instance->midi_thread->GetMidiOut().Resume();
 		}
+	} else {
+		const auto type = newPaused ? MixCommand::Type::Pause : MixCommand::Type::Resume;
+		instance->PushCommand(MixCommand{ type, id, instance->channels[id].generation });
 	}
 }
 
 int GenericAudio::BgmChannel::GetTicks() const {
 	if (midi_out_used) {
 		return instance->midi_thread->GetMidiOut().GetTicks();
-	} else if (decoder) {
-		return decoder->GetTicks();
+	} else if (instance->channels[id].IsUsed()) {
+		return instance->channels[id].ticks.load(std::memory_order_relaxed);
 	}
 	return -1;
 }
@@ -517,27 +871,27 @@ int GenericAudio::BgmChannel::GetTicks() const {
 void GenericAudio::BgmChannel::SetFade(int fade) {
 	if (midi_out_used) {
 		instance->midi_thread->GetMidiOut().SetFade(0, std::chrono::milliseconds(fade));
-	} else if (decoder) {
-		decoder->SetFade(0, std::chrono::milliseconds(fade));
+	} else {
+		instance->PushDecoderCommand(DecoderCommand::Type::Fade, id, fade);
 	}
 }
 
 void GenericAudio::BgmChannel::SetVolume(int volume) {
 	if (midi_out_used) {
 		instance->midi_thread->GetMidiOut().SetVolume(volume);
-	} else if (decoder) {
-		decoder->SetVolume(volume);
+	} else {
+		instance->PushDecoderCommand(DecoderCommand::Type::Volume, id, volume);
 	}
 }
 
 void GenericAudio::BgmChannel::SetPitch(int pitch) {
 	if (midi_out_used) {
 		instance->midi_thread->GetMidiOut().SetPitch(pitch);
-	} else if (decoder) {
-		decoder->SetPitch(pitch);
+	} else {
+		instance->PushDecoderCommand(DecoderCommand::Type::Pitch, id, pitch);
 	}
 }
 
 bool GenericAudio::BgmChannel::IsUsed() const {
-	return decoder || midi_out_used;
+	return midi_out_used || instance->channels[id].IsUsed();
 }
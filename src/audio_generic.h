@@ -22,26 +22,42 @@
 #include "audio_secache.h"
 #include "audio_decoder_base.h"
 #include "audio_generic_midiout.h"
+#include "audio_ring_buffer.h"
+#include "spsc_queue.h"
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 /**
  * A software implementation for handling EasyRPG Audio utilizing the
  * AudioDecoder for BGM and AudioSeCache for fast SE playback.
  *
+ * BGM are opened and prebuffered by a loader thread, BGM_Play does not wait
+ * for this. The decoders run on a decoder thread which fills a ring buffer of
+ * float frames per channel. Decode, invoked by the audio callback, only mixes
+ * these frames and never waits for the game thread or for a decoder.
+ * Commands of the game thread are passed through lock-free queues.
+ * Without thread support BGM_Play opens the BGM and the decoders run inside
+ * of Decode.
+ *
  * Inheriting implementations have to:
  * 1. Init the audio system in the constructor (and deinit in destructor)
  * 2. Start a thread (or a callback) which invokes the Decode function to
  *    fill the output buffer and controls access to the audio api of the
  *    target platform.
  * 3. Initialize the "output_format" (must match the format of the hardware)
+ *    before the first call of Decode
  * 4. Implement LockMutex and UnlockMutex. Locking and Unlocking when
- *    calling Decode must be done manually.
+ *    calling Decode must be done manually. The game thread does not use
+ *    this mutex anymore.
  * 5. Implement update function (optional)
  */
 class GenericAudio : public AudioInterface {
 public:
 	GenericAudio(const Game_ConfigAudio& cfg);
-	virtual ~GenericAudio() = default;
+	virtual ~GenericAudio();
 
 	void BGM_Play(Filesystem_Stream::InputStream stream, int volume, int pitch, int fadein) override;
 	void BGM_Pause() override;
@@ -56,6 +72,7 @@ public:
 	std::string BGM_GetType() const override;
 
 	void SE_Play(std::unique_ptr<AudioSeCache> se, int volume, int pitch) override;
+	void SE_Preload(std::unique_ptr<AudioSeCache> se, int pitch) override;
 	void SE_Stop() override;
 	virtual void Update() override;
 
@@ -63,21 +80,43 @@ public:
 
 	GenericAudioMidiOut* CreateAndGetMidiOut() override;
 
+	/**
+	 * Sets the format of the output buffer. Must not be called while Decode runs.
+	 *
+	 * @param frequency sample rate
+	 * @param format sample format
+	 * @param channels number of channels
+	 */
 	void SetFormat(int frequency, AudioDecoder::Format format, int channels);
 
 	virtual void LockMutex() const = 0;
 	virtual void UnlockMutex() const = 0;
 
+	/**
+	 * Mixes the decoded audio of all channels into the output buffer.
+	 * Real-time safe when the decoder thread is running.
+	 *
+	 * @param output_buffer buffer in the output format
+	 * @param buffer_length size of the buffer in bytes
+	 */
 	void Decode(uint8_t* output_buffer, int buffer_length);
 
 private:
+	static constexpr unsigned nr_of_se_channels = 31;
+	static constexpr unsigned nr_of_bgm_channels = 2;
+	static constexpr unsigned nr_of_channels = nr_of_bgm_channels + nr_of_se_channels;
+
+	/** Game thread state of a BGM channel */
 	struct BgmChannel {
 		int id;
-		std::unique_ptr<AudioDecoderBase> decoder;
 		GenericAudio* instance = nullptr;
-		bool paused;
-		bool stopped;
+		bool paused = false;
+		bool stopped = true;
 		bool midi_out_used = false;
+		/** Type of the decoder, reported by BGM_GetType. Guarded by loader_mutex */
+		std::string type;
+		/** Generation of the channel the type belongs to. Guarded by loader_mutex */
+		uint32_t type_generation = 0;
 		void Stop();
 		void SetPaused(bool newPaused);
 		int GetTicks() const;
@@ -86,13 +125,95 @@ private:
 		void SetPitch(int pitch);
 		bool IsUsed() const;
 	};
-	struct SeChannel {
-		int id;
+
+	/** Commands executed by the decoder thread */
+	struct DecoderCommand {
+		enum class Type {
+			/** Play the decoder */
+			Play,
+			/** Start a generation whose decoder is opened by the loader */
+			Load,
+			/** Play the decoder opened by the loader, sent by the loader */
+			Loaded,
+			Stop,
+			Fade,
+			Volume,
+			Pitch
+		};
+		Type type = Type::Stop;
+		int channel = 0;
+		uint32_t generation = 0;
+		int value = 0;
 		std::unique_ptr<AudioDecoderBase> decoder;
-		GenericAudio* instance = nullptr;
-		bool paused;
-		bool stopped;
+		/** Prebuffered stereo frames of a loaded decoder */
+		std::vector<float> frames;
+	};
+
+	/** State of a BGM or SE channel, each member is only written by one thread */
+	struct Channel {
+		/** Decoded frames, written by the decoder thread and read by Decode */
+		AudioRingBuffer ring;
+
+		/** Game thread: Generation of the last command */
+		uint32_t generation = 0;
+		/** Decoder thread: Last generation which finished playing */
+		std::atomic<uint32_t> released_generation = 0;
+
+		/** Decoder thread: Playing decoder */
+		std::unique_ptr<AudioDecoderBase> decoder;
+		/** Decoder thread: Generation of the decoder */
+		uint32_t decoder_generation = 0;
+		/** Decoder thread: The decoder finished, released when the ring is empty */
+		bool draining = false;
+		/** Decoder thread: The loader opens the decoder of the generation */
+		bool loading = false;
+		/** Decoder thread: Volume at the end of the last decoded frames, negative when not decoded yet */
+		float gain = -1.0f;
+		/** Decoder thread: Frames decoded by the loader, written before decoding more */
+		std::vector<float> prebuffer;
+		/** Decoder thread: Commands received while loading, applied to the opened decoder */
+		std::vector<DecoderCommand> deferred;
+		/** Decoder thread: Published state of the decoder */
+		std::atomic<float> volume = 0.0f;
+		std::atomic<int> ticks = -1;
+		/** Decoder thread: Last generation which looped */
+		std::atomic<uint32_t> played_once_generation = 0;
+
+		/** Decode: Generation of the frames which are mixed */
+		uint32_t mix_generation = 0;
+		/** Decode: Mixing state */
+		bool mix_playing = false;
+		bool mix_paused = false;
+		/** Decode: Master volume of the last mixed frames, negative when not mixed yet */
+		float mix_volume = -1.0f;
+
+		/** @return Game thread: Whether a decoder uses the channel */
+		bool IsUsed() const;
 	};
+
+	/** Commands executed by Decode */
+	struct MixCommand {
+		enum class Type {
+			Play,
+			Stop,
+			Pause,
+			Resume
+		};
+		Type type = Type::Stop;
+		int channel = 0;
+		uint32_t generation = 0;
+	};
+
+	/** BGM opened by the loader thread */
+	struct BgmOpenRequest {
+		int channel = 0;
+		uint32_t generation = 0;
+		Filesystem_Stream::InputStream stream;
+		int volume = 0;
+		int pitch = 0;
+		int fadein = 0;
+	};
+
 	struct Format {
 		int frequency;
 		AudioDecoder::Format format;
@@ -101,18 +222,88 @@ private:
 	Format output_format = {};
 
 	bool PlayOnChannel(BgmChannel& chan, Filesystem_Stream::InputStream stream, int volume, int pitch, int fadein);
-	bool PlayOnChannel(SeChannel& chan, std::unique_ptr<AudioSeCache> se, int volume, int pitch);
+	bool PlayOnChannel(int channel, std::unique_ptr<AudioSeCache> se, int volume, int pitch);
 
-	static constexpr unsigned nr_of_se_channels = 31;
-	static constexpr unsigned nr_of_bgm_channels = 2;
+	/**
+	 * Game thread: Starts a new generation on a channel.
+	 *
+	 * @param cmd Play with a decoder or Load, the generation is assigned
+	 * @return false when the command queues are full
+	 */
+	bool StartChannel(DecoderCommand cmd);
+	/** Game thread: Starts a new generation on a used channel which plays nothing */
+	void StopChannel(int channel);
+	/** Game thread: Changes the decoder of a used channel */
+	void PushDecoderCommand(DecoderCommand::Type type, int channel, int value);
+	void PushCommand(DecoderCommand cmd);
+	void PushCommand(MixCommand cmd);
+
+	/**
+	 * Opens and prebuffers a BGM and passes the decoder to the decoder thread.
+	 * Runs on the loader thread, or on the game thread without thread support.
+	 *
+	 * @param request BGM to open
+	 */
+	void OpenBgm(BgmOpenRequest request);
+	void LoaderThreadFunction();
+	void StopLoaderThread();
+
+	void StartDecoderThread();
+	void StopDecoderThread();
+	void DecoderThreadFunction();
+
+	/** Decoder thread: Executes the queued commands */
+	void ProcessDecoderCommands();
+	/**
+	 * Decoder thread: Decodes frames until the ring buffers contain enough.
+	 *
+	 * @param target_frames frames every ring buffer should contain
+	 * @return whether anything was decoded
+	 */
+	bool FillChannels(int target_frames);
+	/**
+	 * Decoder thread: Decodes frames into the ring buffer of a channel.
+	 *
+	 * @param chan channel with a decoder
+	 * @param frames maximum number of frames
+	 * @param is_bgm whether the channel is a BGM channel
+	 * @return number of decoded frames
+	 */
+	int FillChannel(Channel& chan, int frames, bool is_bgm);
+	void ReleaseChannel(Channel& chan);
+
+	/** @return Decoder thread: Frames the ring buffers should contain */
+	int GetTargetFrames() const;
 
 	BgmChannel BGM_Channels[nr_of_bgm_channels];
-	SeChannel SE_Channels[nr_of_se_channels];
-	mutable bool BGM_PlayedOnceIndicator;
+	Channel channels[nr_of_channels];
+
+	SpscQueue<DecoderCommand, 256> decoder_commands;
+	SpscQueue<MixCommand, 256> mix_commands;
+	/** Decoders opened by the loader thread */
+	SpscQueue<DecoderCommand, 16> loaded_decoders;
 
-	std::vector<int16_t> sample_buffer = {};
+	std::thread loader_thread;
+	mutable std::mutex loader_mutex;
+	std::condition_variable loader_cv;
+	bool loader_thread_stop = false;
+	/** Only the most recent BGM is opened, older requests were stopped already */
+	std::unique_ptr<BgmOpenRequest> loader_request;
+	/** Shown by Update on the game thread */
+	std::vector<std::string> loader_warnings;
+
+	std::thread decoder_thread;
+	std::mutex decoder_mutex;
+	std::condition_variable decoder_cv;
+	std::atomic<bool> decoder_thread_stop = false;
+	/** Frames requested by the last Decode call, the decoder thread stays ahead of this */
+	std::atomic<int> callback_frames = 0;
+
+	/** Decoder thread buffers */
 	std::vector<uint8_t> scrap_buffer = {};
-	unsigned scrap_buffer_size = 0;
+	std::vector<float> frame_buffer = {};
+
+	/** Decode: Mix bus */
 	std::vector<float> mixer_buffer = {};
 
 	std::unique_ptr<GenericAudioMidiOut> midi_thread;
@@ -0,0 +1,267 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <cmath>
+#include "audio_mixer.h"
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#  define EP_AUDIO_MIXER_SSE2
+#elif defined(__ARM_NEON)
+#  include <arm_neon.h>
+#  define EP_AUDIO_MIXER_NEON
+#endif
+
+namespace {
+	/** Samples above this amplitude are compressed when the mix can clip */
+	constexpr float compression_threshold = 0.8f;
+
+	/** Gain of frame i of a ramp, the vector kernels use the same formula */
+	inline float RampGain(float gain_start, float gain_step, int i) {
+		return gain_start + gain_step * static_cast<float>(i);
+	}
+
+	template <typename T>
+	void ConvertScalar(float* dst, const uint8_t* src, int first, int frames, int channels, float scale, float offset, float gain_start, float gain_step) {
+		const T* in = reinterpret_cast<const T*>(src);
+		for (int i = first; i < frames; ++i) {
+			const float gain = RampGain(gain_start, gain_step, i);
+			const float left = (static_cast<float>(in[i * channels]) * scale + offset) * gain;
+			const float right = channels > 1 ? (static_cast<float>(in[i * channels + 1]) * scale + offset) * gain : left;
+			dst[i * 2] = left;
+			dst[i * 2 + 1] = right;
+		}
+	}
+
+	void MixScalar(float* mix, const float* src, int first, int frames, float gain_start, float gain_step) {
+		for (int i = first; i < frames; ++i) {
+			const float gain = RampGain(gain_start, gain_step, i);
+			mix[i * 2] += src[i * 2] * gain;
+			mix[i * 2 + 1] += src[i * 2 + 1] * gain;
+		}
+	}
+
+	void ConvertToS16Scalar(int16_t* dst, const float* mix, int first, int samples, float ratio) {
+		for (int i = first; i < samples; ++i) {
+			const float sample = mix[i];
+			float amplitude = std::abs(sample);
+			if (amplitude > compression_threshold) {
+				amplitude = compression_threshold + (amplitude - compression_threshold) * ratio;
+			}
+			const float out = std::copysign(amplitude, sample) * 32768.0f;
+			dst[i] = static_cast<int16_t>(std::clamp(out, -32768.0f, 32767.0f));
+		}
+	}
+
+#if defined(EP_AUDIO_MIXER_SSE2)
+	using Vec = __m128;
+	using VecMask = __m128;
+
+	inline Vec VecLoad(const float* p) { return _mm_loadu_ps(p); }
+	inline void VecStore(float* p, Vec v) { _mm_storeu_ps(p, v); }
+	inline Vec VecSplat(float v) { return _mm_set1_ps(v); }
+	inline Vec VecSet(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+	inline Vec VecAdd(Vec a, Vec b) { return _mm_add_ps(a, b); }
+	inline Vec VecSub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+	inline Vec VecMul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+	inline Vec VecMin(Vec a, Vec b) { return _mm_min_ps(a, b); }
+	inline Vec VecMax(Vec a, Vec b) { return _mm_max_ps(a, b); }
+	inline Vec VecAbs(Vec v) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+	inline Vec VecCopySign(Vec magnitude, Vec sign) {
+		const Vec mask = _mm_set1_ps(-0.0f);
+		return _mm_or_ps(_mm_and_ps(mask, sign), magnitude);
+	}
+	inline VecMask VecGreater(Vec a, Vec b) { return _mm_cmpgt_ps(a, b); }
+	inline Vec VecSelect(VecMask mask, Vec a, Vec b) {
+		return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+	}
+	/** @return lanes 0 and 1 repeated: a a b b */
+	inline Vec VecDupLow(Vec v) { return _mm_unpacklo_ps(v, v); }
+	/** @return lanes 2 and 3 repeated: c c d d */
+	inline Vec VecDupHigh(Vec v) { return _mm_unpackhi_ps(v, v); }
+	inline Vec VecLoadS16(const int16_t* p) {
+		const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+		// Sign extension by shifting the sample from the upper half back
+		return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+	}
+	/** Truncates like the scalar cast, v must be in the S16 range */
+	inline void VecStoreS16(int16_t* p, Vec v) {
+		const __m128i i = _mm_cvttps_epi32(v);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(i, i));
+	}
+#elif defined(EP_AUDIO_MIXER_NEON)
+	using Vec = float32x4_t;
+	using VecMask = uint32x4_t;
+
+	inline Vec VecLoad(const float* p) { return vld1q_f32(p); }
+	inline void VecStore(float* p, Vec v) { vst1q_f32(p, v); }
+	inline Vec VecSplat(float v) { return vdupq_n_f32(v); }
+	inline Vec VecSet(float a, float b, float c, float d) {
+		const float values[4] = { a, b, c, d };
+		return vld1q_f32(values);
+	}
+	inline Vec VecAdd(Vec a, Vec b) { return vaddq_f32(a, b); }
+	inline Vec VecSub(Vec a, Vec b) { return vsubq_f32(a, b); }
+	inline Vec VecMul(Vec a, Vec b) { return vmulq_f32(a, b); }
+	inline Vec VecMin(Vec a, Vec b) { return vminq_f32(a, b); }
+	inline Vec VecMax(Vec a, Vec b) { return vmaxq_f32(a, b); }
+	inline Vec VecAbs(Vec v) { return vabsq_f32(v); }
+	inline Vec VecCopySign(Vec magnitude, Vec sign) { return vbslq_f32(vdupq_n_u32(0x80000000), sign, magnitude); }
+	inline VecMask VecGreater(Vec a, Vec b) { return vcgtq_f32(a, b); }
+	inline Vec VecSelect(VecMask mask, Vec a, Vec b) { return vbslq_f32(mask, a, b); }
+	inline Vec VecDupLow(Vec v) { return vzipq_f32(v, v).val[0]; }
+	inline Vec VecDupHigh(Vec v) { return vzipq_f32(v, v).val[1]; }
+	inline Vec VecLoadS16(const int16_t* p) { return vcvtq_f32_s32(vmovl_s16(vld1_s16(p))); }
+	inline void VecStoreS16(int16_t* p, Vec v) { vst1_s16(p, vqmovn_s32(vcvtq_s32_f32(v))); }
+#endif
+
+#if defined(EP_AUDIO_MIXER_SSE2) || defined(EP_AUDIO_MIXER_NEON)
+	/** Gains of the frames first to first + 3 */
+	inline Vec RampGain4(float gain_start, float gain_step, int first) {
+		const Vec index = VecAdd(VecSplat(static_cast<float>(first)), VecSet(0.0f, 1.0f, 2.0f, 3.0f));
+		return VecAdd(VecSplat(gain_start), VecMul(VecSplat(gain_step), index));
+	}
+
+	/** Gains of the frames first and first + 1 for their two samples */
+	inline Vec RampGain2x2(float gain_start, float gain_step, int first) {
+		const Vec index = VecAdd(VecSplat(static_cast<float>(first)), VecSet(0.0f, 0.0f, 1.0f, 1.0f));
+		return VecAdd(VecSplat(gain_start), VecMul(VecSplat(gain_step), index));
+	}
+
+	inline Vec Load(const float* p) { return VecLoad(p); }
+	inline Vec Load(const int16_t* p) { return VecLoadS16(p); }
+
+	/** @return number of converted frames, the remainder is left for the scalar loop */
+	template <typename T>
+	int ConvertVector(float* dst, const uint8_t* src, int frames, int channels, float scale, float gain_start, float gain_step) {
+		const T* in = reinterpret_cast<const T*>(src);
+		const Vec vscale = VecSplat(scale);
+		int i = 0;
+
+		if (channels == 2) {
+			for (; frames - i >= 2; i += 2) {
+				const Vec samples = VecMul(Load(in + i * 2), vscale);
+				VecStore(dst + i * 2, VecMul(samples, RampGain2x2(gain_start, gain_step, i)));
+			}
+		} else if (channels == 1) {
+			for (; frames - i >= 4; i += 4) {
+				const Vec samples = VecMul(VecMul(Load(in + i), vscale), RampGain4(gain_start, gain_step, i));
+				VecStore(dst + i * 2, VecDupLow(samples));
+				VecStore(dst + i * 2 + 4, VecDupHigh(samples));
+			}
+		}
+
+		return i;
+	}
+#endif
+
+	template <typename T>
+	void Convert(float* dst, const uint8_t* src, int frames, int channels, float scale, float offset, float gain_start, float gain_step) {
+		ConvertScalar<T>(dst, src, 0, frames, channels, scale, offset, gain_start, gain_step);
+	}
+
+#if defined(EP_AUDIO_MIXER_SSE2) || defined(EP_AUDIO_MIXER_NEON)
+	template <>
+	void Convert<int16_t>(float* dst, const uint8_t* src, int frames, int channels, float scale, float offset, float gain_start, float gain_step) {
+		const int first = ConvertVector<int16_t>(dst, src, frames, channels, scale, gain_start, gain_step);
+		ConvertScalar<int16_t>(dst, src, first, frames, channels, scale, offset, gain_start, gain_step);
+	}
+
+	template <>
+	void Convert<float>(float* dst, const uint8_t* src, int frames, int channels, float scale, float offset, float gain_start, float gain_step) {
+		const int first = ConvertVector<float>(dst, src, frames, channels, scale, gain_start, gain_step);
+		ConvertScalar<float>(dst, src, first, frames, channels, scale, offset, gain_start, gain_step);
+	}
+#endif
+}
+
+void AudioMixer::ConvertToStereo(float* dst, const uint8_t* src, int frames, AudioDecoder::Format format, int channels, float gain_start, float gain_end) {
+	if (frames <= 0) {
+		return;
+	}
+
+	const float gain_step = (gain_end - gain_start) / frames;
+
+	switch (format) {
+		case AudioDecoder::Format::S8:
+			Convert<int8_t>(dst, src, frames, channels, 1.0f / 128.0f, 0.0f, gain_start, gain_step);
+			break;
+		case AudioDecoder::Format::U8:
+			Convert<uint8_t>(dst, src, frames, channels, 1.0f / 128.0f, -1.0f, gain_start, gain_step);
+			break;
+		case AudioDecoder::Format::S16:
+			Convert<int16_t>(dst, src, frames, channels, 1.0f / 32768.0f, 0.0f, gain_start, gain_step);
+			break;
+		case AudioDecoder::Format::U16:
+			Convert<uint16_t>(dst, src, frames, channels, 1.0f / 32768.0f, -1.0f, gain_start, gain_step);
+			break;
+		case AudioDecoder::Format::S32:
+			Convert<int32_t>(dst, src, frames, channels, 1.0f / 2147483648.0f, 0.0f, gain_start, gain_step);
+			break;
+		case AudioDecoder::Format::U32:
+			Convert<uint32_t>(dst, src, frames, channels, 1.0f / 2147483648.0f, -1.0f, gain_start, gain_step);
+			break;
+		case AudioDecoder::Format::F32:
+			Convert<float>(dst, src, frames, channels, 1.0f, 0.0f, gain_start, gain_step);
+			break;
+	}
+}
+
+void AudioMixer::MixStereo(float* mix, const float* src, int frames, float gain_start, float gain_end) {
+	if (frames <= 0) {
+		return;
+	}
+
+	const float gain_step = (gain_end - gain_start) / frames;
+	int i = 0;
+
+#if defined(EP_AUDIO_MIXER_SSE2) || defined(EP_AUDIO_MIXER_NEON)
+	for (; frames - i >= 2; i += 2) {
+		const Vec samples = VecMul(VecLoad(src + i * 2), RampGain2x2(gain_start, gain_step, i));
+		VecStore(mix + i * 2, VecAdd(VecLoad(mix + i * 2), samples));
+	}
+#endif
+
+	MixScalar(mix, src, i, frames, gain_start, gain_step);
+}
+
+void AudioMixer::ConvertToS16(int16_t* dst, const float* mix, int samples, float peak) {
+	// Maps the threshold to itself and peak to 1. Without compression the
+	// formula is the identity.
+	const float ratio = peak > 1.0f ? (1.0f - compression_threshold) / (peak - compression_threshold) : 1.0f;
+	int i = 0;
+
+#if defined(EP_AUDIO_MIXER_SSE2) || defined(EP_AUDIO_MIXER_NEON)
+	const Vec threshold = VecSplat(compression_threshold);
+	const Vec vratio = VecSplat(ratio);
+	const Vec scale = VecSplat(32768.0f);
+	const Vec min = VecSplat(-32768.0f);
+	const Vec max = VecSplat(32767.0f);
+
+	for (; samples - i >= 4; i += 4) {
+		const Vec sample = VecLoad(mix + i);
+		const Vec amplitude = VecAbs(sample);
+		const Vec compressed = VecAdd(threshold, VecMul(VecSub(amplitude, threshold), vratio));
+		const Vec out = VecMul(VecCopySign(VecSelect(VecGreater(amplitude, threshold), compressed, amplitude), sample), scale);
+		VecStoreS16(dst + i, VecMin(VecMax(out, min), max));
+	}
+#endif
+
+	ConvertToS16Scalar(dst, mix, i, samples, ratio);
+}
@@ -0,0 +1,75 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_AUDIO_MIXER_H
+#define EP_AUDIO_MIXER_H
+
+// Headers
+#include <cstdint>
+#include "audio_decoder.h"
+
+/**
+ * Sample kernels of the GenericAudio mixer. The mix bus consists of
+ * interleaved stereo float frames with a nominal range of -1 to 1.
+ *
+ * Gains change linearly from the first to the last frame of a call. A volume
+ * change or fade is spread over the whole block instead of stepping at its
+ * start, which avoids audible clicks ("zipper noise").
+ *
+ * Four samples are processed per step when SSE2 or NEON is available.
+ */
+namespace AudioMixer {
+	/**
+	 * Converts interleaved samples to stereo float frames.
+	 * Mono is copied to both channels, further channels are ignored.
+	 *
+	 * @param dst receives frames * 2 samples
+	 * @param src samples to convert
+	 * @param frames number of frames
+	 * @param format sample format of src
+	 * @param channels number of channels of src
+	 * @param gain_start gain of the first frame
+	 * @param gain_end gain after the last frame
+	 */
+	void ConvertToStereo(float* dst, const uint8_t* src, int frames, AudioDecoder::Format format, int channels, float gain_start, float gain_end);
+
+	/**
+	 * Adds stereo frames multiplied with a gain to the mix.
+	 *
+	 * @param mix mix bus
+	 * @param src stereo frames to add
+	 * @param frames number of frames
+	 * @param gain_start gain of the first frame
+	 * @param gain_end gain after the last frame
+	 */
+	void MixStereo(float* mix, const float* src, int frames, float gain_start, float gain_end);
+
+	/**
+	 * Converts the mix to signed 16 bit samples.
+	 * When the mixed channels can exceed the range (peak > 1) samples above a
+	 * threshold are compressed, so that peak maps to full scale. Everything
+	 * outside of the range is clipped.
+	 *
+	 * @param dst receives the samples
+	 * @param mix mix bus
+	 * @param samples number of samples (frames * 2)
+	 * @param peak largest possible amplitude, the sum of all channel volumes
+	 */
+	void ConvertToS16(int16_t* dst, const float* mix, int samples, float peak);
+}
+
+#endif
@@ -0,0 +1,87 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include "audio_ring_buffer.h"
+#include "audio_mixer.h"
+
+void AudioRingBuffer::Resize(int frames) {
+	size_t capacity = 1;
+	while (capacity < static_cast<size_t>(std::max(frames, 1))) {
+		capacity *= 2;
+	}
+
+	samples.assign(capacity * 2, 0.0f);
+	mask = capacity - 1;
+	write_pos.store(0);
+	read_pos.store(0);
+	synced_generation.store(flush_generation.load());
+}
+
+void AudioRingBuffer::RequestFlush(uint32_t generation) {
+	// Release: The consumer sees every frame written before and discards them
+	flush_generation.store(generation, std::memory_order_release);
+}
+
+void AudioRingBuffer::Write(const float* frames, int count) {
+	assert(count <= GetFree());
+
+	const size_t pos = write_pos.load(std::memory_order_relaxed);
+	const size_t start = pos & mask;
+	const size_t first = std::min(static_cast<size_t>(count), mask + 1 - start);
+
+	memcpy(&samples[start * 2], frames, first * 2 * sizeof(float));
+	memcpy(&samples[0], frames + first * 2, (count - first) * 2 * sizeof(float));
+
+	write_pos.store(pos + count, std::memory_order_release);
+}
+
+uint32_t AudioRingBuffer::Sync() {
+	const uint32_t generation = flush_generation.load(std::memory_order_acquire);
+	if (generation != synced_generation.load(std::memory_order_relaxed)) {
+		read_pos.store(write_pos.load(std::memory_order_acquire), std::memory_order_relaxed);
+		// Release: The producer sees the new read position before writing again
+		synced_generation.store(generation, std::memory_order_release);
+	}
+	return generation;
+}
+
+void AudioRingBuffer::MixInto(float* mix, int count, float volume) {
+	MixInto(mix, count, volume, volume);
+}
+
+void AudioRingBuffer::MixInto(float* mix, int count, float volume_start, float volume_end) {
+	assert(count <= GetAvailable());
+
+	if (count <= 0) {
+		return;
+	}
+
+	const size_t pos = read_pos.load(std::memory_order_relaxed);
+	const size_t start = pos & mask;
+	const int first = static_cast<int>(std::min(static_cast<size_t>(count), mask + 1 - start));
+
+	// The ramp continues after the wrap around
+	const float volume_wrap = volume_start + (volume_end - volume_start) * first / count;
+	AudioMixer::MixStereo(mix, &samples[start * 2], first, volume_start, volume_wrap);
+	AudioMixer::MixStereo(mix + first * 2, &samples[0], count - first, volume_wrap, volume_end);
+
+	read_pos.store(pos + count, std::memory_order_release);
+}
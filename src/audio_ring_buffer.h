@@ -0,0 +1,139 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_AUDIO_RING_BUFFER_H
+#define EP_AUDIO_RING_BUFFER_H
+
+// Headers
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Lock-free single producer, single consumer buffer of stereo float frames.
+ *
+ * A decoder thread writes decoded frames and the audio callback mixes them.
+ * The content belongs to a generation: The producer requests a flush when
+ * it starts a new generation (e.g. another song) and must not write until
+ * the consumer discarded the old frames, which happens in Sync.
+ */
+class AudioRingBuffer {
+public:
+	AudioRingBuffer() = default;
+
+	AudioRingBuffer(const AudioRingBuffer&) = delete;
+	AudioRingBuffer& operator=(const AudioRingBuffer&) = delete;
+
+	/**
+	 * Discards the content and changes the capacity.
+	 * Not thread safe, neither side must use the buffer during the call.
+	 *
+	 * @param frames minimum capacity in frames, rounded up to a power of two
+	 */
+	void Resize(int frames);
+
+	/** @return capacity in frames */
+	int GetCapacity() const;
+
+	/**
+	 * Producer: Requests that the consumer discards all frames written so far.
+	 *
+	 * @param generation generation of the frames written afterwards
+	 */
+	void RequestFlush(uint32_t generation);
+
+	/**
+	 * Producer: Whether the consumer discarded the frames of older generations.
+	 *
+	 * @param generation generation passed to the last RequestFlush
+	 * @return whether writing is allowed
+	 */
+	bool IsFlushed(uint32_t generation) const;
+
+	/** @return Producer: Number of frames which can be written */
+	int GetFree() const;
+
+	/**
+	 * Producer: Appends frames.
+	 *
+	 * @param frames interleaved stereo samples
+	 * @param count number of frames, at most GetFree
+	 */
+	void Write(const float* frames, int count);
+
+	/**
+	 * Consumer: Discards the frames when a flush was requested.
+	 *
+	 * @return generation of the frames in the buffer
+	 */
+	uint32_t Sync();
+
+	/** @return Consumer: Number of frames which can be read */
+	int GetAvailable() const;
+
+	/**
+	 * Consumer: Adds frames multiplied with a volume to a mix buffer and
+	 * removes them.
+	 *
+	 * @param mix interleaved stereo mix buffer
+	 * @param count number of frames to mix, at most GetAvailable
+	 * @param volume factor for the samples
+	 */
+	void MixInto(float* mix, int count, float volume);
+
+	/**
+	 * Consumer: Like MixInto but the volume changes linearly over the frames.
+	 *
+	 * @param mix interleaved stereo mix buffer
+	 * @param count number of frames to mix, at most GetAvailable
+	 * @param volume_start factor for the first frame
+	 * @param volume_end factor after the last frame
+	 */
+	void MixInto(float* mix, int count, float volume_start, float volume_end);
+
+private:
+	std::vector<float> samples;
+	size_t mask = 0;
+
+	/** Frames written in total, written by the producer */
+	std::atomic<size_t> write_pos = 0;
+	/** Frames consumed in total, written by the consumer */
+	std::atomic<size_t> read_pos = 0;
+	/** Generation requested by the producer */
+	std::atomic<uint32_t> flush_generation = 0;
+	/** Generation the consumer flushed to */
+	std::atomic<uint32_t> synced_generation = 0;
+};
+
+inline int AudioRingBuffer::GetCapacity() const {
+	return static_cast<int>(mask + 1);
+}
+
+inline bool AudioRingBuffer::IsFlushed(uint32_t generation) const {
+	return synced_generation.load(std::memory_order_acquire) == generation;
+}
+
+inline int AudioRingBuffer::GetFree() const {
+	return GetCapacity() - static_cast<int>(write_pos.load(std::memory_order_relaxed) - read_pos.load(std::memory_order_acquire));
+}
+
+inline int AudioRingBuffer::GetAvailable() const {
+	return static_cast<int>(write_pos.load(std::memory_order_acquire) - read_pos.load(std::memory_order_relaxed));
+}
+
+#endif
@@ -16,64 +16,115 @@
  */
 
 // Headers
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <map>
 #include <memory>
-#include <set>
+#include <tuple>
+#include <vector>
 #include "audio_resampler.h"
 #include "audio_secache.h"
-#include "game_clock.h"
 #include "filefinder.h"
 #include "output.h"
 
-using namespace std::chrono_literals;
-
 namespace {
-	typedef std::map<std::string, AudioSeRef> cache_type;
+	// name, pitch, frequency, format, channels
+	// The decoded source sample has pitch 0
+	using cache_key_type = std::tuple<std::string, int, int, AudioDecoder::Format, int>;
+
+	struct CacheItem {
+		AudioSeRef se;
+		uint64_t last_access;
+	};
+	std::map<cache_key_type, CacheItem> cache;
+
+	AudioSeCache::Stats cache_stats;
+	uint64_t cache_access = 0;
 
-	cache_type cache;
+	size_t cache_limit = 16 * 1024 * 1024;
+
+	cache_key_type SourceKey(const std::string& name) {
+		return { name, 0, 0, AudioDecoder::Format::S8, 0 };
+	}
 
-	constexpr int cache_limit = 3 * 1024 * 1024;
-	int cache_size = 0;
+	AudioSeRef FindInCache(const cache_key_type& key) {
+		auto it = cache.find(key);
+		if (it == cache.end()) {
+			return {};
+		}
+
+		it->second.last_access = ++cache_access;
+		return it->second.se;
+	}
 
 	void FreeCacheMemory() {
-		auto cur_time = Game_Clock::GetFrameTime();
+		if (cache_stats.size <= cache_limit) {
+			return;
+		}
 
-		for (auto it = cache.begin(); it != cache.end(); ) {
-			if (it->second.use_count() > 1) {
-				// SE is currently playing
-				++it;
-				continue;
+		std::vector<decltype(cache)::iterator> candidates;
+		for (auto it = cache.begin(); it != cache.end(); ++it) {
+			// Otherwise the SE is currently playing
+			if (it->second.se.use_count() == 1) {
+				candidates.push_back(it);
 			}
+		}
 
-			if (cache_size <= cache_limit && cur_time - it->second->last_access < 3s) {
-				// Below memory limit and last access < 3s
-				++it;
-				continue;
+		std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+			return a->second.last_access < b->second.last_access;
+		});
+
+		for (auto it : candidates) {
+			if (cache_stats.size <= cache_limit) {
+				break;
 			}
 
 #ifdef CACHE_DEBUG
-			Output::Debug("SE: Freeing memory of {}", it->first);
+			Output::Debug("SE: Freeing memory of {} ({})", std::get<0>(it->first), std::get<1>(it->first));
 #endif
 
-			cache_size -= it->second->buffer.size();
-
-			it = cache.erase(it);
+			cache_stats.size -= it->second.se->buffer.size();
+			++cache_stats.evictions;
+			cache.erase(it);
 		}
 
 #ifdef CACHE_DEBUG
-		Output::Debug("SE cache size: {}", cache_size / 1024.0 / 1024);
+		Output::Debug("SE cache size: {} ({} hits, {} misses)", cache_stats.size / 1024.0 / 1024, cache_stats.hits, cache_stats.misses);
 #endif
 	}
+
+	void AddToCache(cache_key_type key, AudioSeRef se) {
+		cache_stats.size += se->buffer.size();
+		cache[std::move(key)] = { std::move(se), ++cache_access };
+
+		FreeCacheMemory();
+	}
+
+	std::unique_ptr<AudioDecoderBase> OpenSeDecoder(const AudioSeRef& se) {
+		std::unique_ptr<AudioDecoderBase> dec = std::make_unique<AudioSeDecoder>(se);
+		Filesystem_Stream::InputStream is;
+		dec->Open(std::move(is));
+		return dec;
+	}
+
+	/** Like OpenSeDecoder but with a resampler for samples not in the output format */
+	std::unique_ptr<AudioDecoderBase> OpenSourceDecoder(const AudioSeRef& se) {
+		std::unique_ptr<AudioDecoderBase> dec = std::make_unique<AudioSeDecoder>(se);
+#ifdef USE_AUDIO_RESAMPLER
+		dec = std::make_unique<AudioResampler>(std::move(dec));
+#endif
+		Filesystem_Stream::InputStream is;
+		dec->Open(std::move(is));
+		return dec;
+	}
 }
 
 std::unique_ptr<AudioSeCache> AudioSeCache::Create(Filesystem_Stream::InputStream stream, std::string_view name) {
 	auto se = std::make_unique<AudioSeCache>();
 	se->name = ToString(name);
 
-	auto const it = cache.find(ToString(name));
-	if (it == cache.end()) {
+	if (cache.find(SourceKey(se->name)) == cache.end()) {
 		// Not in cache
 		if (!stream) {
 			return {};
@@ -111,8 +162,7 @@ std::unique_ptr<AudioSeCache> AudioSeCache::GetCachedSe(std::string_view name) {
 	auto se = std::make_unique<AudioSeCache>();
 	se->name = ToString(name);
 
-	auto const it = cache.find(se->name);
-	if (it == cache.end()) {
+	if (cache.find(SourceKey(se->name)) == cache.end()) {
 		return {};
 	}
 
@@ -120,12 +170,12 @@ std::unique_ptr<AudioSeCache> AudioSeCache::GetCachedSe(std::string_view name) {
 }
 
 bool AudioSeCache::GetCachedFormat(int& frequency, AudioDecoder::Format& format, int& channels) const {
-	cache_type::const_iterator it = cache.find(name);
+	auto it = cache.find(SourceKey(name));
 
 	if (it != cache.end()) {
-		frequency = (*it).second->frequency;
-		format = (*it).second->format;
-		channels = (*it).second->channels;
+		frequency = it->second.se->frequency;
+		format = it->second.se->format;
+		channels = it->second.se->channels;
 
 		return true;
 	}
@@ -133,72 +183,113 @@ bool AudioSeCache::GetCachedFormat(int& frequency, AudioDecoder::Format& format,
 	return false;
 }
 
-std::unique_ptr<AudioDecoderBase> AudioSeCache::CreateSeDecoder() {
-	AudioSeRef se;
+AudioSeRef AudioSeCache::GetSourceSe(bool& decoded) {
+	AudioSeRef se = FindInCache(SourceKey(name));
+	decoded = !se;
 
-	auto it = cache.find(name);
-	if (it != cache.end()) {
-		se = it->second;
-		se->last_access = Game_Clock::GetFrameTime();
+	if (!se) {
+		// Not cached yet: Decode the sample without any resampling
+		se = std::make_shared<AudioSeData>();
 
-		std::unique_ptr<AudioDecoderBase> dec = std::make_unique<AudioSeDecoder>(se);
-#ifdef USE_AUDIO_RESAMPLER
-		dec = std::make_unique<AudioResampler>(std::move(dec));
-#endif
-		Filesystem_Stream::InputStream is;
-		dec->Open(std::move(is));
-		return dec;
+		assert(audio_decoder);
+
+		audio_decoder->GetFormat(se->frequency, se->format, se->channels);
+		se->buffer = audio_decoder->DecodeAll();
+
+		AddToCache(SourceKey(name), se);
 	}
 
-	// Not cached yet: Decode the sample without any resampling
+	return se;
+}
+
+std::unique_ptr<AudioDecoderBase> AudioSeCache::CreateSeDecoder() {
+	bool decoded;
+	AudioSeRef se = GetSourceSe(decoded);
 
-	if (!se) {
-		se.reset(new AudioSeData());
+	if (decoded) {
+		++cache_stats.misses;
+	} else {
+		++cache_stats.hits;
 	}
 
-	assert(audio_decoder);
+	return OpenSourceDecoder(se);
+}
 
-	audio_decoder->GetFormat(se->frequency, se->format, se->channels);
-	se->buffer = audio_decoder->DecodeAll();
+std::unique_ptr<AudioDecoderBase> AudioSeCache::CreateSeDecoder(int pitch, int frequency, AudioDecoder::Format format, int channels) {
+	cache_key_type key { name, pitch, frequency, format, channels };
 
-	cache.insert(std::make_pair(name, se));
+	if (AudioSeRef se = FindInCache(key)) {
+		++cache_stats.hits;
+		// GetCachedSe only checks the source, it must not be evicted before the converted copy
+		FindInCache(SourceKey(name));
+		return OpenSeDecoder(se);
+	}
 
-	cache_size += se->buffer.size();
+	bool decoded;
+	auto dec = OpenSourceDecoder(GetSourceSe(decoded));
+	const bool pitch_applied = dec->SetPitch(pitch);
+	dec->SetFormat(frequency, format, channels);
+
+	int dec_frequency;
+	AudioDecoder::Format dec_format;
+	int dec_channels;
+	dec->GetFormat(dec_frequency, dec_format, dec_channels);
+
+	if (dec_frequency != frequency || (pitch != 100 && !pitch_applied)) {
+		// No resampler available: Converting the sample in advance is not possible
+		if (decoded) {
+			++cache_stats.misses;
+		} else {
+			++cache_stats.hits;
+		}
+		return dec;
+	}
 
-#ifdef CACHE_DEBUG
-	Output::Debug("SE cache size (Add): {}", cache_size / 1024.0 / 1024.0);
-#endif
+	auto se = std::make_shared<AudioSeData>();
+	se->frequency = dec_frequency;
+	se->format = dec_format;
+	se->channels = dec_channels;
+	se->buffer = dec->DecodeAll();
 
-	FreeCacheMemory();
+	++cache_stats.misses;
+	AddToCache(std::move(key), se);
 
-	std::unique_ptr<AudioDecoderBase> dec = std::unique_ptr<AudioDecoderBase>(new AudioSeDecoder(se));
-#ifdef USE_AUDIO_RESAMPLER
-	dec = std::unique_ptr<AudioDecoderBase>(new AudioResampler(std::move(dec)));
-#endif
-	Filesystem_Stream::InputStream is;
-	dec->Open(std::move(is));
-	return dec;
+	return OpenSeDecoder(se);
 }
 
 AudioSeRef AudioSeCache::GetSeData() const {
-	auto it = cache.find(name);
+	auto it = cache.find(SourceKey(name));
 	assert(it != cache.end());
 
-	return it->second;
+	return it->second.se;
 };
 
 void AudioSeCache::Clear() {
-	cache_size = 0;
+	cache_stats.size = 0;
 	cache.clear();
 }
 
+AudioSeCache::Stats AudioSeCache::GetStats() {
+	auto stats = cache_stats;
+	stats.entries = cache.size();
+	return stats;
+}
+
+void AudioSeCache::SetBudget(size_t bytes) {
+	cache_limit = bytes;
+	FreeCacheMemory();
+}
+
+size_t AudioSeCache::GetBudget() {
+	return cache_limit;
+}
+
 std::string_view AudioSeCache::GetName() const {
 	return name;
 }
 
 AudioSeDecoder::AudioSeDecoder(const AudioSeRef& se) :
 	se(se) {
-	se->last_access = Game_Clock::GetFrameTime();
 }
 
 bool AudioSeDecoder::IsFinished() const {
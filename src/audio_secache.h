@@ -36,7 +36,6 @@ class AudioSeCache;
 class AudioSeData {
 public:
 	std::vector<uint8_t> buffer;
-	Game_Clock::time_point last_access;
 	int frequency;
 	AudioDecoder::Format format;
 	int channels;
@@ -70,8 +69,10 @@ private:
  * AudioSeCache provides an interface for accessing sound effects.
  * It also provides an automatic cache management, any SE is only decoded
  * once, otherwise returned from the cache.
- * The cache is flushed from recently (>10 seconds by default) unused
- * samples when it reaches the memory limit (5 MB by default).
+ * Besides the decoded sample the cache holds copies which are already
+ * converted to the output format of the audio backend, one per pitch.
+ * When the cache exceeds its memory budget the least recently used samples
+ * which are not playing are removed.
  * Uses an internal AudioDecoder for handling the decoding.
  */
 class AudioSeCache {
@@ -125,6 +126,22 @@ public:
 	 */
 	std::unique_ptr<AudioDecoderBase> CreateSeDecoder();
 
+	/**
+	 * Like CreateSeDecoder but the sample is resampled to the output format
+	 * and pitch once and cached in that form. Playing the SE again with the
+	 * same pitch does not run the resampler.
+	 * The pitch is already applied, only the volume must be set on the
+	 * returned AudioDecoder.
+	 *
+	 * @param pitch Pitch multiplier in percent (100 is normal)
+	 * @param frequency Output frequency
+	 * @param format Output format, the decoder can report another format when
+	 *               the resampler does not support it
+	 * @param channels Output channel count
+	 * @return Decoded sound effect
+	 */
+	std::unique_ptr<AudioDecoderBase> CreateSeDecoder(int pitch, int frequency, AudioDecoder::Format format, int channels);
+
 	/**
 	 * Returns the SE sample data handled by this SeCache.
 	 *
@@ -138,7 +155,44 @@ public:
 	std::string_view GetName() const;
 
 	static void Clear();
+
+	/** Statistics of the SE cache */
+	struct Stats {
+		/** Lookups answered by a cached sample */
+		uint64_t hits = 0;
+		/** Lookups which had to decode or resample the sample */
+		uint64_t misses = 0;
+		/** Samples removed to stay within the memory budget */
+		uint64_t evictions = 0;
+		/** Memory used by the cached samples in bytes */
+		size_t size = 0;
+		/** Number of cached samples */
+		size_t entries = 0;
+	};
+
+	/** @return statistics of the SE cache */
+	static Stats GetStats();
+
+	/**
+	 * Sets the memory budget. Samples which are playing are never removed,
+	 * so the budget can be exceeded temporarily.
+	 *
+	 * @param bytes Maximum memory used by the cached samples
+	 */
+	static void SetBudget(size_t bytes);
+
+	/** @return memory budget in bytes */
+	static size_t GetBudget();
 private:
+	/**
+	 * Returns the decoded sample without resampling, decodes and caches it
+	 * when not cached yet. Not counted in the statistics.
+	 *
+	 * @param decoded Set to true when the sample was decoded
+	 * @return Decoded sound effect
+	 */
+	AudioSeRef GetSourceSe(bool& decoded);
+
 	std::unique_ptr<AudioDecoderBase> audio_decoder;
 
 	std::string name;
@@ -19,6 +19,7 @@
 #include "baseui.h"
 #include "bitmap.h"
 #include "player.h"
+#include "platform/headless/ui.h"
 
 #if USE_SDL==3
 #  include "platform/sdl/sdl3_ui.h"
@@ -39,6 +40,10 @@
 std::shared_ptr<BaseUi> DisplayUi;
 
 std::shared_ptr<BaseUi> BaseUi::CreateUi(long width, long height, const Game_Config& cfg) {
+	if (Player::headless_flag) {
+		return std::make_shared<HeadlessUi>(width, height, cfg);
+	}
+
 #if USE_SDL==3
 	return std::make_shared<Sdl3Ui>(width, height, cfg);
 #elif USE_SDL==2
@@ -72,6 +77,18 @@ void BaseUi::CleanDisplay() {
 	main_surface->Clear();
 }
 
+const std::vector<Rect>& BaseUi::TakeDisplayDamage() {
+	if (!display_damage_set) {
+		display_damage.clear();
+		if (main_surface) {
+			display_damage.push_back(main_surface->GetRect());
+		}
+	}
+
+	display_damage_set = false;
+	return display_damage;
+}
+
 void BaseUi::SetGameResolution(ConfigEnum::GameResolution resolution) {
 	vcfg.game_resolution.Set(resolution);
 }
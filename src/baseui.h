@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <string>
 #include <bitset>
+#include <vector>
 
 #include "system.h"
 #include "color.h"
@@ -83,6 +84,32 @@ public:
 	 */
 	virtual void UpdateDisplay() = 0;
 
+	/**
+	 * Returns whether UpdateDisplay must be called even when the display
+	 * surface did not change, e.g. because the window was resized.
+	 * Backends which do not keep the presented image always return true.
+	 *
+	 * @return whether the display must be updated
+	 */
+	virtual bool IsDisplayUpdateRequired() const { return true; }
+
+	/**
+	 * Sets the areas of the display surface which changed since the previous
+	 * frame. Called by the compositor before UpdateDisplay.
+	 *
+	 * @param rects changed areas, empty when nothing changed
+	 */
+	void SetDisplayDamage(const std::vector<Rect>& rects);
+
+	/**
+	 * Returns the areas of the display surface which changed since the
+	 * previous frame and resets them. Used by UpdateDisplay to only upload
+	 * the changed areas. When no damage was set the whole surface is returned.
+	 *
+	 * @return changed areas, valid until the next call
+	 */
+	const std::vector<Rect>& TakeDisplayDamage();
+
 	/**
 	 * Gets a copy of the display surface.
 	 *
@@ -293,6 +320,10 @@ protected:
 	/** Surface used for zoom. */
 	BitmapRef main_surface;
 
+	/** Areas of main_surface which changed since the last UpdateDisplay */
+	std::vector<Rect> display_damage;
+	bool display_damage_set = false;
+
 	/** Mouse position on screen relative to the window. */
 	Point mouse_pos;
 
@@ -359,6 +390,11 @@ inline BitmapRef& BaseUi::GetDisplaySurface() {
 	return main_surface;
 }
 
+inline void BaseUi::SetDisplayDamage(const std::vector<Rect>& rects) {
+	display_damage = rects;
+	display_damage_set = true;
+}
+
 inline bool BaseUi::vChangeDisplaySurfaceResolution(int new_width, int new_height) {
 	(void)new_width;
 	(void)new_height;
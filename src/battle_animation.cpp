@@ -92,6 +92,10 @@ void BattleAnimation::OnBattle2SpriteReady(FileRequestResult* result) {
 	SetSrcRect(Rect(0, 0, 0, 0));
 }
 
+bool BattleAnimation::GetDamage(Rect& /* damage */) {
+	return false;
+}
+
 void BattleAnimation::DrawAt(Bitmap& dst, int x, int y) {
 	if (IsDone()) {
 		return;
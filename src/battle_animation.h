@@ -59,6 +59,9 @@ public:
 	/** @return true if the animation has finished **/
 	bool IsDone() const;
 
+	/** Animation cells are drawn directly, the damage is not tracked **/
+	bool GetDamage(Rect& damage) override;
+
 	/** @return true if the animation only plays audio and doesn't display **/
 	bool IsOnlySound() const;
 
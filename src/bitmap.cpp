@@ -37,8 +37,14 @@
 #include "font.h"
 #include "output.h"
 #include "util_macro.h"
-#include "bitmap_hslrgb.h"
+#include "bitmap_kernels.h"
 #include <iostream>
+#include <atomic>
+
+namespace {
+	// Revisions are global to make them unique across all bitmaps
+	std::atomic<uint64_t> next_revision{1};
+}
 
 BitmapRef Bitmap::Create(int width, int height, const Color& color) {
 	BitmapRef surface = Bitmap::Create(width, height, true);
@@ -78,6 +84,17 @@ BitmapRef Bitmap::Create(void *pixels, int width, int height, int pitch, const D
 	return std::make_shared<Bitmap>(pixels, width, height, pitch, format);
 }
 
+BitmapRef Bitmap::CreateRowView(int y, int height) {
+	auto* row = static_cast<uint8_t*>(pixels()) + y * pitch();
+	BitmapRef view = Create(row, width(), height, pitch(), format);
+
+	if (clipped) {
+		view->SetClipRect(Rect(clip_rect.x, clip_rect.y - y, clip_rect.width, clip_rect.height));
+	}
+
+	return view;
+}
+
 Bitmap::Bitmap(int width, int height, bool transparent) {
 	format = (transparent ? pixel_format : opaque_pixel_format);
 	pixman_format = find_format(format);
@@ -305,6 +322,8 @@ Color Bitmap::GetColorAt(int x, int y) const {
 }
 
 void Bitmap::HueChangeBlit(int x, int y, Bitmap const& src, Rect const& src_rect_, double hue_) {
+	MarkChanged();
+
 	Rect dst_rect(x, y, 0, 0), src_rect = src_rect_;
 
 	if (!Rect::AdjustRectangles(src_rect, dst_rect, src.GetRect()))
@@ -324,16 +343,7 @@ void Bitmap::HueChangeBlit(int x, int y, Bitmap const& src, Rect const& src_rect
 	Bitmap bmp(reinterpret_cast<void*>(&pixels.front()), src_rect.width, src_rect.height, src_rect.width * 4, format);
 	bmp.Blit(0, 0, src, src_rect, Opacity::Opaque());
 
-	for (std::vector<uint32_t>::iterator p = pixels.begin(); p != pixels.end(); ++p) {
-		uint32_t pixel = *p;
-		uint8_t r = (pixel>>24) & 0xFF;
-		uint8_t g = (pixel>>16) & 0xFF;
-		uint8_t b = (pixel>> 8) & 0xFF;
-		uint8_t a = pixel & 0xFF;
-		if (a > 0)
-			RGB_adjust_HSL(r, g, b, hue);
-		*p = ((uint32_t) r << 24) | ((uint32_t) g << 16) | ((uint32_t) b << 8) | (uint32_t) a;
-	}
+	BitmapKernels::HueRow(pixels.data(), static_cast<int>(pixels.size()), { 24, 16, 8, 0 }, hue);
 
 	Blit(dst_rect.x, dst_rect.y, bmp, bmp.GetRect(), Opacity::Opaque());
 }
@@ -533,6 +543,32 @@ void Bitmap::Init(int width, int height, void* data, int pitch, bool destroy) {
 
 	if (data != NULL && destroy)
 		pixman_image_set_destroy_function(bitmap.get(), destroy_func, data);
+
+	clip_rect = {};
+	clipped = false;
+	MarkChanged();
+}
+
+void Bitmap::MarkChanged() {
+	revision = next_revision.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Bitmap::SetClipRect(Rect const& rect) {
+	clip_rect = rect;
+	clip_rect.Adjust(GetRect());
+	clipped = true;
+
+	pixman_region32_t region;
+	pixman_region32_init_rect(&region, clip_rect.x, clip_rect.y,
+		std::max(clip_rect.width, 0), std::max(clip_rect.height, 0));
+	pixman_image_set_clip_region32(bitmap.get(), &region);
+	pixman_region32_fini(&region);
+}
+
+void Bitmap::ClearClipRect() {
+	clip_rect = {};
+	clipped = false;
+	pixman_image_set_clip_region32(bitmap.get(), nullptr);
 }
 
 void Bitmap::ConvertImage(int& width, int& height, void*& pixels, bool transparent) {
@@ -561,6 +597,9 @@ void* Bitmap::pixels() {
 		return nullptr;
 	}
 
+	// Direct access to the pixel data
+	MarkChanged();
+
 	return (void*) pixman_image_get_data(bitmap.get());
 }
 void const* Bitmap::pixels() const {
@@ -611,11 +650,168 @@ namespace {
 	}
 } // anonymous namespace
 
+/** Operation of a blit done by the BitmapKernels */
+struct Bitmap::DirectBlit {
+	/** OVER when true, otherwise SRC */
+	bool over = true;
+	int opacity = 255;
+	/** Alpha channel set on every source pixel when the source has no alpha */
+	uint32_t alpha_fill = 0;
+	int a_shift = 0;
+
+	void Row(uint32_t* dst, const uint32_t* src, int count) const {
+		if (over) {
+			BitmapKernels::OverRow(dst, src, count, opacity, alpha_fill, a_shift);
+		} else {
+			BitmapKernels::SrcRow(dst, src, count, opacity, alpha_fill);
+		}
+	}
+};
+
+bool Bitmap::direct_blit_enabled = true;
+
+void Bitmap::SetDirectBlitEnabled(bool enabled) {
+	direct_blit_enabled = enabled;
+}
+
+bool Bitmap::IsDirectBlitEnabled() {
+	return direct_blit_enabled;
+}
+
+bool Bitmap::GetDirectBlit(Bitmap const& src, Rect const& src_rect, Opacity const& opacity, BlendMode blend_mode, DirectBlit& blit) const {
+	if (!direct_blit_enabled || opacity.IsSplit() || &src == this
+		|| format.bytes != 4 || src.format.bytes != 4
+		|| format.r.mask != src.format.r.mask
+		|| format.g.mask != src.format.g.mask
+		|| format.b.mask != src.format.b.mask) {
+		return false;
+	}
+
+	// Pixels outside of the source are transparent in pixman, not worth handling
+	if (src_rect.x < 0 || src_rect.y < 0
+		|| src_rect.x + src_rect.width > src.width() || src_rect.y + src_rect.height > src.height()) {
+		return false;
+	}
+
+	// The alpha channel, or the unused byte of formats without alpha, must be at the same position
+	const uint32_t a_mask = ~(format.r.mask | format.g.mask | format.b.mask);
+	int a_shift = 0;
+	while (a_shift < 32 && (0xFFu << a_shift) != a_mask) {
+		a_shift += 8;
+	}
+	if (a_shift == 32
+		|| (format.alpha_type != PF::NoAlpha && format.a.mask != a_mask)
+		|| (src.format.alpha_type != PF::NoAlpha && src.format.a.mask != a_mask)) {
+		return false;
+	}
+
+	// Same as GetOperator
+	switch (blend_mode) {
+		case BlendMode::Default:
+			blit.over = !opacity.IsOpaque() || (src.GetTransparent() && src.GetImageOpacity() != ImageOpacity::Opaque);
+			break;
+		case BlendMode::Normal:
+			blit.over = true;
+			break;
+		case BlendMode::NormalWithoutAlpha:
+			blit.over = false;
+			break;
+		default:
+			return false;
+	}
+
+	blit.opacity = opacity.IsOpaque() ? 255 : opacity.Value();
+	blit.alpha_fill = src.format.alpha_type == PF::NoAlpha ? a_mask : 0;
+	blit.a_shift = a_shift;
+	return true;
+}
+
+void Bitmap::BlitRowsDirect(int x, int y, Bitmap const& src, Rect const& src_rect, DirectBlit const& blit, bool flip_x, bool flip_y) {
+	Rect dst_rect(x, y, src_rect.width, src_rect.height);
+	dst_rect.Adjust(clipped ? clip_rect : GetRect());
+	if (dst_rect.IsEmpty()) {
+		return;
+	}
+
+	std::vector<uint32_t> mirrored;
+	if (flip_x) {
+		mirrored.resize(dst_rect.width);
+	}
+
+	auto* dst_pixels = static_cast<uint8_t*>(pixels());
+	auto* src_pixels = static_cast<const uint8_t*>(src.pixels());
+
+	for (int dy = dst_rect.y; dy < dst_rect.y + dst_rect.height; ++dy) {
+		const int row = dy - y;
+		const int sy = src_rect.y + (flip_y ? src_rect.height - 1 - row : row);
+		auto* dst_row = reinterpret_cast<uint32_t*>(dst_pixels + dy * pitch()) + dst_rect.x;
+		auto* src_row = reinterpret_cast<const uint32_t*>(src_pixels + sy * src.pitch()) + src_rect.x;
+
+		if (flip_x) {
+			for (int i = 0; i < dst_rect.width; ++i) {
+				mirrored[i] = src_row[src_rect.width - 1 - (dst_rect.x - x + i)];
+			}
+			blit.Row(dst_row, mirrored.data(), dst_rect.width);
+		} else {
+			blit.Row(dst_row, src_row + (dst_rect.x - x), dst_rect.width);
+		}
+	}
+}
+
+void Bitmap::StretchRowsDirect(Rect const& dst_rect, Bitmap const& src, int src_x, int src_y, Transform const& xform, DirectBlit const& blit) {
+	Rect rect = dst_rect;
+	rect.Adjust(clipped ? clip_rect : GetRect());
+	if (rect.IsEmpty()) {
+		return;
+	}
+
+	// Nearest sampling of pixel centers with the rounding of pixman
+	auto sample = [](pixman_fixed_t scale, int i) {
+		const int64_t m = scale;
+		return static_cast<int>((m * i + ((m * 0x8000 + 0x8000) >> 16) - 1) >> 16);
+	};
+
+	std::vector<int> columns(rect.width);
+	for (int i = 0; i < rect.width; ++i) {
+		columns[i] = sample(xform.matrix.matrix[0][0], src_x + rect.x - dst_rect.x + i);
+	}
+
+	// Samples outside of the source are transparent
+	std::vector<uint32_t> row(rect.width);
+	DirectBlit row_blit = blit;
+	row_blit.alpha_fill = 0;
+
+	auto* src_pixels = static_cast<const uint8_t*>(src.pixels());
+	for (int dy = rect.y; dy < rect.y + rect.height; ++dy) {
+		const int sy = sample(xform.matrix.matrix[1][1], src_y + dy - dst_rect.y);
+		if (sy < 0 || sy >= src.height()) {
+			std::fill(row.begin(), row.end(), 0);
+		} else {
+			auto* src_row = reinterpret_cast<const uint32_t*>(src_pixels + sy * src.pitch());
+			for (int i = 0; i < rect.width; ++i) {
+				const int sx = columns[i];
+				row[i] = (sx < 0 || sx >= src.width()) ? 0 : src_row[sx] | blit.alpha_fill;
+			}
+		}
+
+		auto* dst_row = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(pixels()) + dy * pitch()) + rect.x;
+		row_blit.Row(dst_row, row.data(), rect.width);
+	}
+}
+
 void Bitmap::Blit(int x, int y, Bitmap const& src, Rect const& src_rect, Opacity const& opacity, Bitmap::BlendMode blend_mode) {
+	MarkChanged();
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
 
+	DirectBlit blit;
+	if (GetDirectBlit(src, src_rect, opacity, blend_mode, blit)) {
+		BlitRowsDirect(x, y, src, src_rect, blit);
+		return;
+	}
+
 	auto mask = CreateMask(opacity, src_rect);
 
 	pixman_image_composite32(src.GetOperator(mask.get(), blend_mode),
@@ -628,10 +824,18 @@ void Bitmap::Blit(int x, int y, Bitmap const& src, Rect const& src_rect, Opacity
 }
 
 void Bitmap::BlitFast(int x, int y, Bitmap const & src, Rect const & src_rect, Opacity const & opacity) {
+	MarkChanged();
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
 
+	DirectBlit blit;
+	if (GetDirectBlit(src, src_rect, Opacity::Opaque(), BlendMode::NormalWithoutAlpha, blit)) {
+		BlitRowsDirect(x, y, src, src_rect, blit);
+		return;
+	}
+
 	pixman_image_composite32(PIXMAN_OP_SRC,
 		src.bitmap.get(),
 		nullptr, bitmap.get(),
@@ -641,6 +845,22 @@ void Bitmap::BlitFast(int x, int y, Bitmap const & src, Rect const & src_rect, O
 		src_rect.width, src_rect.height);
 }
 
+bool Bitmap::BlitDirect(int x, int y, Bitmap const& src, Rect const& src_rect, int opacity) {
+	DirectBlit blit;
+	if (!GetDirectBlit(src, src_rect, Opacity(std::min(opacity, 255)), BlendMode::Normal, blit)) {
+		return false;
+	}
+
+	MarkChanged();
+
+	if (opacity <= 0) {
+		return true;
+	}
+
+	BlitRowsDirect(x, y, src, src_rect, blit);
+	return true;
+}
+
 PixmanImagePtr Bitmap::GetSubimage(Bitmap const& src, const Rect& src_rect) {
 	uint8_t* pixels = (uint8_t*) src.pixels() + src_rect.x * src.bpp() + src_rect.y * src.pitch();
 	return PixmanImagePtr{ pixman_image_create_bits(src.pixman_format, src_rect.width, src_rect.height,
@@ -652,6 +872,8 @@ void Bitmap::TiledBlit(Rect const& src_rect, Bitmap const& src, Rect const& dst_
 }
 
 void Bitmap::TiledBlit(int ox, int oy, Rect const& src_rect, Bitmap const& src, Rect const& dst_rect, Opacity const& opacity, Bitmap::BlendMode blend_mode) {
+	MarkChanged();
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
@@ -661,6 +883,32 @@ void Bitmap::TiledBlit(int ox, int oy, Rect const& src_rect, Bitmap const& src,
 	if (ox < 0) ox += src_rect.width  * ((-ox + src_rect.width  - 1) / src_rect.width);
 	if (oy < 0) oy += src_rect.height * ((-oy + src_rect.height - 1) / src_rect.height);
 
+	DirectBlit blit;
+	if (GetDirectBlit(src, src_rect, opacity, blend_mode, blit)) {
+		Rect rect = dst_rect;
+		rect.Adjust(clipped ? clip_rect : GetRect());
+		if (rect.IsEmpty()) {
+			return;
+		}
+
+		const int start_x = (ox + rect.x - dst_rect.x) % src_rect.width;
+		for (int dy = rect.y; dy < rect.y + rect.height; ++dy) {
+			const int sy = src_rect.y + (oy + dy - dst_rect.y) % src_rect.height;
+			auto* dst_row = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(pixels()) + dy * pitch());
+			auto* src_row = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(src.pixels()) + sy * src.pitch()) + src_rect.x;
+
+			// One run per repetition of the source row
+			int sx = start_x;
+			for (int dx = rect.x; dx < rect.x + rect.width;) {
+				const int count = std::min(src_rect.width - sx, rect.x + rect.width - dx);
+				blit.Row(dst_row + dx, src_row + sx, count);
+				dx += count;
+				sx = 0;
+			}
+		}
+		return;
+	}
+
 	auto src_bm = GetSubimage(src, src_rect);
 
 	pixman_image_set_repeat(src_bm.get(), PIXMAN_REPEAT_NORMAL);
@@ -680,6 +928,8 @@ void Bitmap::StretchBlit(Bitmap const&  src, Rect const& src_rect, Opacity const
 }
 
 void Bitmap::StretchBlit(Rect const& dst_rect, Bitmap const& src, Rect const& src_rect, Opacity const& opacity, Bitmap::BlendMode blend_mode) {
+	MarkChanged();
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
@@ -689,6 +939,12 @@ void Bitmap::StretchBlit(Rect const& dst_rect, Bitmap const& src, Rect const& sr
 
 	Transform xform = Transform::Scale(zoom_x, zoom_y);
 
+	DirectBlit blit;
+	if (GetDirectBlit(src, src.GetRect(), opacity, blend_mode, blit)) {
+		StretchRowsDirect(dst_rect, src, src_rect.x / zoom_x, src_rect.y / zoom_y, xform, blit);
+		return;
+	}
+
 	pixman_image_set_transform(src.bitmap.get(), &xform.matrix);
 
 	auto mask = CreateMask(opacity, src_rect, &xform);
@@ -704,22 +960,36 @@ void Bitmap::StretchBlit(Rect const& dst_rect, Bitmap const& src, Rect const& sr
 }
 
 void Bitmap::WaverBlit(int x, int y, double zoom_x, double zoom_y, Bitmap const& src, Rect const& src_rect, int depth, double phase, Opacity const& opacity, Bitmap::BlendMode blend_mode) {
+	MarkChanged();
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
 
 	Transform xform = Transform::Scale(1.0 / zoom_x, 1.0 / zoom_y);
 
+	int height = static_cast<int>(std::floor(src_rect.height * zoom_y));
+	int width  = static_cast<int>(std::floor(src_rect.width * zoom_x));
+	const auto yclip = y < 0 ? -y : 0;
+	const auto yend = std::min(height, this->height() - y);
+
+	// Without zoom every line is a plain blit of a source row
+	DirectBlit blit;
+	if (zoom_x == 1.0 && zoom_y == 1.0 && GetDirectBlit(src, src_rect, opacity, blend_mode, blit)) {
+		for (int i = yclip; i < yend; i++) {
+			const double sy = (i - yclip) * (2 * M_PI) / 32.0;
+			const int offset = 2 * depth * std::sin(phase + sy);
+			BlitRowsDirect(x + offset, y + i, src, Rect(src_rect.x, src_rect.y + i, src_rect.width, 1), blit);
+		}
+		return;
+	}
+
 	pixman_image_set_transform(src.bitmap.get(), &xform.matrix);
 
 	auto mask = CreateMask(opacity, src_rect, &xform);
 
-	int height = static_cast<int>(std::floor(src_rect.height * zoom_y));
-	int width  = static_cast<int>(std::floor(src_rect.width * zoom_x));
 	const auto xoff = src_rect.x * zoom_x;
 	const auto yoff = src_rect.y * zoom_y;
-	const auto yclip = y < 0 ? -y : 0;
-	const auto yend = std::min(height, this->height() - y);
 	for (int i = yclip; i < yend; i++) {
 		int dy = y + i;
 		// RPG_RT starts the effect from the top of the screen even if the image is clipped. The result
@@ -749,6 +1019,8 @@ static pixman_color_t PixmanColor(const Color &color) {
 }
 
 void Bitmap::Fill(const Color &color) {
+	MarkChanged();
+
 	pixman_color_t pcolor = PixmanColor(color);
 
 	pixman_box32_t box = { 0, 0, width(), height() };
@@ -757,6 +1029,8 @@ void Bitmap::Fill(const Color &color) {
 }
 
 void Bitmap::FillRect(Rect const& dst_rect, const Color &color) {
+	MarkChanged();
+
 	pixman_color_t pcolor = PixmanColor(color);
 
 	auto timage = PixmanImagePtr{pixman_image_create_solid_fill(&pcolor)};
@@ -770,15 +1044,24 @@ void Bitmap::FillRect(Rect const& dst_rect, const Color &color) {
 }
 
 void Bitmap::Clear() {
+	MarkChanged();
+
 	if (!pixels()) {
 		// Happens when height or width of bitmap are 0
 		return;
 	}
 
+	if (clipped) {
+		ClearRect(clip_rect);
+		return;
+	}
+
 	memset(pixels(), '\0', height() * pitch());
 }
 
 void Bitmap::ClearRect(Rect const& dst_rect) {
+	MarkChanged();
+
 	pixman_color_t pcolor = {};
 	pixman_box32_t box = {
 		dst_rect.x,
@@ -793,70 +1076,9 @@ void Bitmap::ClearRect(Rect const& dst_rect) {
 	pixman_image_fill_boxes(PIXMAN_OP_CLEAR, bitmap.get(), &pcolor, 1, &box);
 }
 
-// Hard light lookup table mapping source color to destination color
-// FIXME: Replace this with std::array<std::array<uint8_t,256>,256> when we have C++17
-struct HardLightTable {
-	uint8_t table[256][256] = {};
-};
-
-static constexpr HardLightTable make_hard_light_lookup() {
-	HardLightTable hl;
-	for (int i = 0; i < 256; ++i) {
-		for (int j = 0; j < 256; ++j) {
-			int res = 0;
-			if (i <= 128)
-				res = (2 * i * j) / 255;
-			else
-				res = 255 - 2 * (255 - i) * (255 - j) / 255;
-			hl.table[i][j] = res > 255 ? 255 : res < 0 ? 0 : res;
-		}
-	}
-	return hl;
-}
-
-constexpr auto hard_light = make_hard_light_lookup();
-
-
-// Saturation Tone Inline: Changes a pixel saturation
-static inline void saturation_tone(uint32_t &src_pixel, const int saturation, const int rs, const int gs, const int bs, const int as) {
-	// Algorithm from OpenPDN (MIT license)
-	// Transformation in Y'CbCr color space
-	uint8_t r = (src_pixel >> rs) & 0xFF;
-	uint8_t g = (src_pixel >> gs) & 0xFF;
-	uint8_t b = (src_pixel >> bs) & 0xFF;
-	uint8_t a = (src_pixel >> as) & 0xFF;
-
-	// Y' = 0.299 R' + 0.587 G' + 0.114 B'
-	uint8_t lum = (7471 * b + 38470 * g + 19595 * r) >> 16;
-
-	// Scale Cb/Cr by scale factor "sat"
-	int red = ((lum * 1024 + (r - lum) * saturation) >> 10);
-	red = red > 255 ? 255 : red < 0 ? 0 : red;
-	int green = ((lum * 1024 + (g - lum) * saturation) >> 10);
-	green = green > 255 ? 255 : green < 0 ? 0 : green;
-	int blue = ((lum * 1024 + (b - lum) * saturation) >> 10);
-	blue = blue > 255 ? 255 : blue < 0 ? 0 : blue;
-
-	src_pixel = ((uint32_t)red << rs) | ((uint32_t)green << gs) | ((uint32_t)blue << bs) | ((uint32_t)a << as);
-}
-
-// Color Tone Inline: Changes color of a pixel by hard light table
-static inline void color_tone(uint32_t &src_pixel, const Tone& tone, const int rs, const int gs, const int bs, const int as) {
-	src_pixel = ((uint32_t)hard_light.table[tone.red][(src_pixel >> rs) & 0xFF] << rs)
-		| ((uint32_t)hard_light.table[tone.green][(src_pixel >> gs) & 0xFF] << gs)
-		| ((uint32_t)hard_light.table[tone.blue][(src_pixel >> bs) & 0xFF] << bs)
-		| ((uint32_t)((src_pixel >> as) & 0xFF) << as);
-}
-
-static inline void color_tone_alpha(uint32_t &src_pixel, const Tone& tone, const int rs, const int gs, const int bs, const int as) {
-	uint8_t a = (src_pixel >> as) & 0xFF;
-	uint8_t r = ((uint32_t)hard_light.table[tone.red][(src_pixel >> rs) & 0xFF]) * a / 255;
-	uint8_t g = ((uint32_t)hard_light.table[tone.green][(src_pixel >> gs) & 0xFF]) * a / 255;
-	uint8_t b = ((uint32_t)hard_light.table[tone.blue][(src_pixel >> bs) & 0xFF]) * a / 255;
-	src_pixel = ((uint32_t)r << rs) | ((uint32_t)g << gs) | ((uint32_t)b << bs) | ((uint32_t)a << as);
-}
-
 void Bitmap::ToneBlit(int x, int y, Bitmap const& src, Rect const& src_rect, const Tone &tone, Opacity const& opacity) {
+	MarkChanged();
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
@@ -894,10 +1116,7 @@ void Bitmap::ToneBlit(int x, int y, Bitmap const& src, Rect const& src_rect, con
 		src_rect.width, src_rect.height);
 	}
 
-	const int as = pixel_format.a.shift;
-	const int rs = pixel_format.r.shift;
-	const int gs = pixel_format.g.shift;
-	const int bs = pixel_format.b.shift;
+	const BitmapKernels::Layout layout = { pixel_format.r.shift, pixel_format.g.shift, pixel_format.b.shift, pixel_format.a.shift };
 	int next_row = pitch() / sizeof(uint32_t);
 	uint32_t* pixels = (uint32_t*)this->pixels();
 	pixels = pixels + (y - 1) * next_row + x;
@@ -905,113 +1124,15 @@ void Bitmap::ToneBlit(int x, int y, Bitmap const& src, Rect const& src_rect, con
 	const uint16_t limit_height = std::min<uint16_t>(src_rect.height, height());
 	const uint16_t limit_width = std::min<uint16_t>(src_rect.width, width());
 
-	const bool apply_sat = tone.gray != 128;
-	const bool apply_tone = (tone.red != 128 || tone.green != 128 || tone.blue != 128);
-
-	// If Saturation + Color:
-	if (apply_sat && apply_tone) {
-		int sat = tone.gray > 128 ? 1024 + (tone.gray - 128) * 16 : tone.gray * 8;
-
-		if (src_opacity == ImageOpacity::Opaque) {
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					saturation_tone(pixels[j], sat, rs, gs, bs, as);
-					color_tone(pixels[j], tone, rs, gs, bs, as);
-				}
-			}
-		} else if (src_opacity == ImageOpacity::Alpha_1Bit) {
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					uint8_t a = (uint8_t)((pixels[j] >> as) & 0xFF);
-					if (a == 0)
-						continue;
-
-					saturation_tone(pixels[j], sat, rs, gs, bs, as);
-					color_tone(pixels[j], tone, rs, gs, bs, as);
-				}
-			}
-		} else { // 8 Bit Alpha
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					uint8_t a = (uint8_t)((pixels[j] >> as) & 0xFF);
-					if (a == 0) {
-						continue;
-					}
-
-					saturation_tone(pixels[j], sat, rs, gs, bs, as);
-					color_tone_alpha(pixels[j], tone, rs, gs, bs, as);
-				}
-			}
-		}
-	}
-
-	// If Only Saturation:
-	else if (apply_sat) {
-		int sat = tone.gray > 128 ? 1024 + (tone.gray - 128) * 16 : tone.gray * 8;
-
-		if (src_opacity == ImageOpacity::Opaque) {
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					saturation_tone(pixels[j], sat, rs, gs, bs, as);
-				}
-			}
-		} else { // Any kind of alpha
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					uint8_t a = (uint8_t)((pixels[j] >> as) & 0xFF);
-					if (a == 0)
-						continue;
-
-					saturation_tone(pixels[j], sat, rs, gs, bs, as);
-				}
-			}
-		}
-	}
-
-	// If Only Color:
-	else if (apply_tone) {
-		if (src_opacity == ImageOpacity::Opaque) {
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					color_tone(pixels[j], tone, rs, gs, bs, as);
-				}
-			}
-		} else if (src_opacity == ImageOpacity::Alpha_1Bit) {
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					uint8_t a = (uint8_t)((pixels[j] >> as) & 0xFF);
-					if (a == 0)
-						continue;
-
-					color_tone(pixels[j], tone, rs, gs, bs, as);
-				}
-			}
-		} else { // 8 Bit Alpha
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					uint8_t a = (uint8_t)((pixels[j] >> as) & 0xFF);
-					if (a == 0)
-						continue;
-					else if (a == 255) {
-						color_tone(pixels[j], tone, rs, gs, bs, as);
-					} else {
-						color_tone_alpha(pixels[j], tone, rs, gs, bs, as);
-					}
-				}
-			}
-		}
+	for (uint16_t i = 0; i < limit_height; ++i) {
+		pixels += next_row;
+		BitmapKernels::ToneRow(pixels, limit_width, layout, tone, src_opacity);
 	}
 }
 
 void Bitmap::BlendBlit(int x, int y, Bitmap const& src, Rect const& src_rect, const Color& color, Opacity const& opacity) {
+	MarkChanged();
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
@@ -1030,6 +1151,32 @@ void Bitmap::BlendBlit(int x, int y, Bitmap const& src, Rect const& src_rect, co
 								 x, y,
 								 src_rect.width, src_rect.height);
 
+	// Common 32 bit formats with 8 bit alpha are blended without pixman
+	if (direct_blit_enabled && format.bytes == 4 && src.format.bytes == 4
+		&& format.alpha_type != PF::NoAlpha && format.a.bits == 8
+		&& src.format.alpha_type != PF::NoAlpha && src.format.a.bits == 8
+		&& (&src != this || (x == src_rect.x && y == src_rect.y))) {
+		Rect dst_rect(x, y, src_rect.width, src_rect.height);
+		dst_rect.Adjust(Rect(x - src_rect.x, y - src_rect.y, src.width(), src.height()));
+		dst_rect.Adjust(clipped ? clip_rect : GetRect());
+		if (dst_rect.IsEmpty()) {
+			return;
+		}
+
+		// Same rounding as the solid color of pixman
+		const uint32_t pcolor = format.rgba_to_uint32_t(
+			(color.red * color.alpha) >> 8, (color.green * color.alpha) >> 8, (color.blue * color.alpha) >> 8, color.alpha);
+		const int sx = dst_rect.x - x + src_rect.x;
+		const int sy = dst_rect.y - y + src_rect.y;
+
+		for (int row = 0; row < dst_rect.height; ++row) {
+			auto* dst_pixels = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(pixels()) + (dst_rect.y + row) * pitch()) + dst_rect.x;
+			auto* src_pixels = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(src.pixels()) + (sy + row) * src.pitch()) + sx;
+			BitmapKernels::BlendRow(dst_pixels, src_pixels, dst_rect.width, src.format.a.shift, pcolor, format.a.shift);
+		}
+		return;
+	}
+
 	pixman_color_t tcolor = PixmanColor(color);
 	auto timage = PixmanImagePtr{ pixman_image_create_solid_fill(&tcolor) };
 
@@ -1042,10 +1189,18 @@ void Bitmap::BlendBlit(int x, int y, Bitmap const& src, Rect const& src_rect, co
 }
 
 void Bitmap::FlipBlit(int x, int y, Bitmap const& src, Rect const& src_rect, bool horizontal, bool vertical, Opacity const& opacity, Bitmap::BlendMode blend_mode) {
+	MarkChanged();
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
 
+	DirectBlit blit;
+	if (GetDirectBlit(src, src_rect, opacity, blend_mode, blit)) {
+		BlitRowsDirect(x, y, src, src_rect, blit, horizontal, vertical);
+		return;
+	}
+
 	bool has_xform = (horizontal || vertical);
 	const auto img_w = src.GetWidth();
 	const auto img_h = src.GetHeight();
@@ -1070,6 +1225,8 @@ void Bitmap::FlipBlit(int x, int y, Bitmap const& src, Rect const& src_rect, boo
 }
 
 void Bitmap::Flip(bool horizontal, bool vertical) {
+	MarkChanged();
+
 	if (!horizontal && !vertical) {
 		return;
 	}
@@ -1094,6 +1251,8 @@ void Bitmap::Flip(bool horizontal, bool vertical) {
 }
 
 void Bitmap::MaskedBlit(Rect const& dst_rect, Bitmap const& mask, int mx, int my, Color const& color) {
+	MarkChanged();
+
 	pixman_color_t tcolor = {
 		static_cast<uint16_t>(color.red << 8),
 		static_cast<uint16_t>(color.green << 8),
@@ -1111,6 +1270,8 @@ void Bitmap::MaskedBlit(Rect const& dst_rect, Bitmap const& mask, int mx, int my
 }
 
 void Bitmap::MaskedBlit(Rect const& dst_rect, Bitmap const& mask, int mx, int my, Bitmap const& src, int sx, int sy) {
+	MarkChanged();
+
 	pixman_image_composite32(PIXMAN_OP_OVER,
 							 src.bitmap.get(), mask.bitmap.get(), bitmap.get(),
 							 sx, sy,
@@ -1120,6 +1281,8 @@ void Bitmap::MaskedBlit(Rect const& dst_rect, Bitmap const& mask, int mx, int my
 }
 
 void Bitmap::Blit2x(Rect const& dst_rect, Bitmap const& src, Rect const& src_rect) {
+	MarkChanged();
+
 	Transform xform = Transform::Scale(0.5, 0.5);
 
 	pixman_image_set_transform(src.bitmap.get(), &xform.matrix);
@@ -1166,6 +1329,8 @@ void Bitmap::RotateZoomOpacityBlit(int x, int y, int ox, int oy,
 		Bitmap const& src, Rect const& src_rect,
 		double angle, double zoom_x, double zoom_y, Opacity const& opacity, Bitmap::BlendMode blend_mode)
 {
+	MarkChanged();
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
@@ -1271,6 +1436,8 @@ pixman_op_t Bitmap::GetOperator(pixman_image_t* mask, Bitmap::BlendMode blend_mo
 }
 
 void Bitmap::EdgeMirrorBlit(int x, int y, Bitmap const& src, Rect const& src_rect, bool mirror_x, bool mirror_y, Opacity const& opacity) {
+	MarkChanged();
+
 	if (opacity.IsTransparent())
 		return;
 
@@ -102,6 +102,18 @@ public:
 	 */
 	static BitmapRef Create(void *pixels, int width, int height, int pitch, const DynamicFormat& format);
 
+	/**
+	 * Creates a surface wrapper around a range of rows of this bitmap.
+	 * The clip rectangle is taken over. Drawing into views of rows which do
+	 * not overlap is possible from different threads.
+	 * The view must not outlive this bitmap.
+	 *
+	 * @param y first row.
+	 * @param height number of rows.
+	 * @return surface sharing the pixel data
+	 */
+	BitmapRef CreateRowView(int y, int height);
+
 	Bitmap(int width, int height, bool transparent);
 	Bitmap(Filesystem_Stream::InputStream stream, bool transparent, uint32_t flags);
 	Bitmap(const uint8_t* data, unsigned bytes, bool transparent, uint32_t flags);
@@ -240,6 +252,27 @@ public:
 	 */
 	int GetOriginalBpp() const;
 
+	/**
+	 * Returns a value that changes whenever the pixels of the bitmap are
+	 * modified. Revisions are unique across all bitmaps, so the pair
+	 * (bitmap, revision) identifies the content of a bitmap.
+	 *
+	 * @return revision
+	 */
+	uint64_t GetRevision() const;
+
+	/**
+	 * Restricts all drawing operations on this bitmap to the given rectangle.
+	 * Used by the compositor to redraw only the changed parts of the screen.
+	 * Note: ToneBlit with this bitmap as source ignores the clip rectangle.
+	 *
+	 * @param rect clip rectangle
+	 */
+	void SetClipRect(Rect const& rect);
+
+	/** Removes the clip rectangle set by SetClipRect. */
+	void ClearClipRect();
+
 	void CheckPixels(uint32_t flags);
 
 	/**
@@ -306,6 +339,20 @@ public:
 	void Blit(int x, int y, Bitmap const& src, Rect const& src_rect,
 		Opacity const& opacity, BlendMode blend_mode = BlendMode::Default);
 
+	/**
+	 * Blits source bitmap to this one with a uniform opacity without using
+	 * pixman. Produces the same result as Blit with BlendMode::Normal.
+	 * Only 32 bit formats using the same channel layout are supported.
+	 *
+	 * @param x x position.
+	 * @param y y position.
+	 * @param src source bitmap.
+	 * @param src_rect source bitmap rect.
+	 * @param opacity opacity for blending with bitmap.
+	 * @return false when the formats are not supported, nothing was drawn
+	 */
+	bool BlitDirect(int x, int y, Bitmap const& src, Rect const& src_rect, int opacity);
+
 	/**
 	 * Blits source bitmap to this one ignoring alpha (faster)
 	 *
@@ -591,6 +638,17 @@ public:
 	static DynamicFormat ChooseFormat(const DynamicFormat& format);
 	static void SetFormat(const DynamicFormat& format);
 
+	/**
+	 * Enables blits between the common 32 bit formats using the BitmapKernels
+	 * instead of pixman. Intended for tests and benchmarks comparing both.
+	 *
+	 * @param enabled whether to use the kernels, enabled by default
+	 */
+	static void SetDirectBlitEnabled(bool enabled);
+
+	/** @return whether blits use the BitmapKernels when possible */
+	static bool IsDirectBlitEnabled();
+
 	static DynamicFormat pixel_format;
 	static DynamicFormat opaque_pixel_format;
 	static DynamicFormat image_format;
@@ -626,6 +684,16 @@ protected:
 	PixmanImagePtr bitmap;
 	pixman_format_code_t pixman_format;
 
+	/** Changes whenever the bitmap data is modified */
+	uint64_t revision = 0;
+
+	/** Clip rectangle set by SetClipRect */
+	Rect clip_rect;
+	bool clipped = false;
+
+	/** Assigns a new revision, called by all functions modifying the bitmap data */
+	void MarkChanged();
+
 	void Init(int width, int height, void* data, int pitch = 0, bool destroy = true);
 	void ConvertImage(int& width, int& height, void*& pixels, bool transparent);
 
@@ -647,6 +715,44 @@ protected:
 
 	static pixman_format_code_t find_format(const DynamicFormat& format);
 
+	/** Operation of a blit done by the BitmapKernels */
+	struct DirectBlit;
+
+	static bool direct_blit_enabled;
+
+	/**
+	 * Checks whether a blit can be done by the BitmapKernels: Both formats use
+	 * 32 bit with the same channel layout, the source rect is inside of src
+	 * and the operator is SRC or OVER with a uniform opacity.
+	 *
+	 * @param src source bitmap.
+	 * @param src_rect source bitmap rect.
+	 * @param opacity opacity of the blit.
+	 * @param blend_mode blend mode of the blit.
+	 * @param blit filled with the operation when supported
+	 * @return whether the kernels can be used
+	 */
+	bool GetDirectBlit(Bitmap const& src, Rect const& src_rect, Opacity const& opacity, BlendMode blend_mode, DirectBlit& blit) const;
+
+	/**
+	 * Blits src_rect with the BitmapKernels, optionally mirrored.
+	 * Same result as Blit or FlipBlit.
+	 */
+	void BlitRowsDirect(int x, int y, Bitmap const& src, Rect const& src_rect, DirectBlit const& blit, bool flip_x = false, bool flip_y = false);
+
+	/**
+	 * Scales src into dst_rect with the BitmapKernels using nearest sampling.
+	 * Same result as the pixman composite done by StretchBlit.
+	 *
+	 * @param dst_rect destination rect.
+	 * @param src source bitmap.
+	 * @param src_x x origin passed to pixman.
+	 * @param src_y y origin passed to pixman.
+	 * @param xform scale from destination to source.
+	 * @param blit the operation.
+	 */
+	void StretchRowsDirect(Rect const& dst_rect, Bitmap const& src, int src_x, int src_y, Transform const& xform, DirectBlit const& blit);
+
 	/*
 	 * Determines the fastest operator for the operation.
 	 * When a blend_mode is specified the blend mode is used.
@@ -719,4 +825,8 @@ inline int Bitmap::GetOriginalBpp() const {
 	return original_bpp;
 }
 
+inline uint64_t Bitmap::GetRevision() const {
+	return revision;
+}
+
 #endif
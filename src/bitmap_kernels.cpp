@@ -0,0 +1,319 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <cassert>
+#include <cstring>
+#include <initializer_list>
+#include "bitmap_kernels.h"
+#include "bitmap_hslrgb.h"
+
+#if defined(EP_BITMAP_KERNELS_AVX2) && defined(_MSC_VER)
+#  include <intrin.h>
+#  include <immintrin.h>
+#endif
+
+namespace {
+	// Hard light lookup table mapping source color to destination color
+	// FIXME: Replace this with std::array<std::array<uint8_t,256>,256> when we have C++17
+	struct HardLightTable {
+		uint8_t table[256][256] = {};
+	};
+
+	constexpr HardLightTable make_hard_light_lookup() {
+		HardLightTable hl;
+		for (int i = 0; i < 256; ++i) {
+			for (int j = 0; j < 256; ++j) {
+				int res = 0;
+				if (i <= 128)
+					res = (2 * i * j) / 255;
+				else
+					res = 255 - 2 * (255 - i) * (255 - j) / 255;
+				hl.table[i][j] = res > 255 ? 255 : res < 0 ? 0 : res;
+			}
+		}
+		return hl;
+	}
+
+	constexpr auto hard_light = make_hard_light_lookup();
+
+	// Saturation Tone Inline: Changes a pixel saturation
+	inline void saturation_tone(uint32_t &src_pixel, const int saturation, const int rs, const int gs, const int bs, const int as) {
+		// Algorithm from OpenPDN (MIT license)
+		// Transformation in Y'CbCr color space
+		uint8_t r = (src_pixel >> rs) & 0xFF;
+		uint8_t g = (src_pixel >> gs) & 0xFF;
+		uint8_t b = (src_pixel >> bs) & 0xFF;
+		uint8_t a = (src_pixel >> as) & 0xFF;
+
+		// Y' = 0.299 R' + 0.587 G' + 0.114 B'
+		uint8_t lum = (7471 * b + 38470 * g + 19595 * r) >> 16;
+
+		// Scale Cb/Cr by scale factor "sat"
+		int red = ((lum * 1024 + (r - lum) * saturation) >> 10);
+		red = red > 255 ? 255 : red < 0 ? 0 : red;
+		int green = ((lum * 1024 + (g - lum) * saturation) >> 10);
+		green = green > 255 ? 255 : green < 0 ? 0 : green;
+		int blue = ((lum * 1024 + (b - lum) * saturation) >> 10);
+		blue = blue > 255 ? 255 : blue < 0 ? 0 : blue;
+
+		src_pixel = ((uint32_t)red << rs) | ((uint32_t)green << gs) | ((uint32_t)blue << bs) | ((uint32_t)a << as);
+	}
+
+	// Color Tone Inline: Changes color of a pixel by hard light table
+	inline void color_tone(uint32_t &src_pixel, const Tone& tone, const int rs, const int gs, const int bs, const int as) {
+		src_pixel = ((uint32_t)hard_light.table[tone.red][(src_pixel >> rs) & 0xFF] << rs)
+			| ((uint32_t)hard_light.table[tone.green][(src_pixel >> gs) & 0xFF] << gs)
+			| ((uint32_t)hard_light.table[tone.blue][(src_pixel >> bs) & 0xFF] << bs)
+			| ((uint32_t)((src_pixel >> as) & 0xFF) << as);
+	}
+
+	inline void color_tone_alpha(uint32_t &src_pixel, const Tone& tone, const int rs, const int gs, const int bs, const int as) {
+		uint8_t a = (src_pixel >> as) & 0xFF;
+		uint8_t r = ((uint32_t)hard_light.table[tone.red][(src_pixel >> rs) & 0xFF]) * a / 255;
+		uint8_t g = ((uint32_t)hard_light.table[tone.green][(src_pixel >> gs) & 0xFF]) * a / 255;
+		uint8_t b = ((uint32_t)hard_light.table[tone.blue][(src_pixel >> bs) & 0xFF]) * a / 255;
+		src_pixel = ((uint32_t)r << rs) | ((uint32_t)g << gs) | ((uint32_t)b << bs) | ((uint32_t)a << as);
+	}
+
+	bool CpuHasAvx2() {
+#if !defined(EP_BITMAP_KERNELS_AVX2)
+		return false;
+#elif defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) {
+			return false;
+		}
+		// AVX must be supported by the CPU and the state saved by the OS
+		__cpuid(info, 1);
+		if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6) {
+			return false;
+		}
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+
+	struct Kernels {
+		BitmapKernels::Isa isa;
+		decltype(&BitmapKernels::Scalar::ToneRow) tone;
+		decltype(&BitmapKernels::Scalar::HueRow) hue;
+		decltype(&BitmapKernels::Scalar::BlendRow) blend;
+		decltype(&BitmapKernels::Scalar::SrcRow) src;
+		decltype(&BitmapKernels::Scalar::OverRow) over;
+		decltype(&BitmapKernels::Scalar::LerpRow) lerp;
+	};
+
+	Kernels MakeKernels(BitmapKernels::Isa isa) {
+		using namespace BitmapKernels;
+
+		switch (isa) {
+#ifdef EP_BITMAP_KERNELS_SSE2
+			case Isa::SSE2:
+				return { isa, SSE2::ToneRow, SSE2::HueRow, SSE2::BlendRow, SSE2::SrcRow, SSE2::OverRow, SSE2::LerpRow };
+#endif
+#ifdef EP_BITMAP_KERNELS_AVX2
+			case Isa::AVX2:
+				return { isa, AVX2::ToneRow, AVX2::HueRow, AVX2::BlendRow, AVX2::SrcRow, AVX2::OverRow, AVX2::LerpRow };
+#endif
+#ifdef EP_BITMAP_KERNELS_NEON
+			case Isa::NEON:
+				return { isa, NEON::ToneRow, NEON::HueRow, NEON::BlendRow, NEON::SrcRow, NEON::OverRow, NEON::LerpRow };
+#endif
+			default:
+				return { Isa::Scalar, Scalar::ToneRow, Scalar::HueRow, Scalar::BlendRow, Scalar::SrcRow, Scalar::OverRow, Scalar::LerpRow };
+		}
+	}
+
+	Kernels& GetKernels() {
+		static Kernels kernels = MakeKernels(BitmapKernels::GetBestIsa());
+		return kernels;
+	}
+} // anonymous namespace
+
+bool BitmapKernels::IsSupported(Isa isa) {
+	switch (isa) {
+		case Isa::Scalar:
+			return true;
+		case Isa::SSE2:
+#ifdef EP_BITMAP_KERNELS_SSE2
+			return true;
+#else
+			return false;
+#endif
+		case Isa::AVX2: {
+			static const bool avx2 = CpuHasAvx2();
+			return avx2;
+		}
+		case Isa::NEON:
+#ifdef EP_BITMAP_KERNELS_NEON
+			return true;
+#else
+			return false;
+#endif
+	}
+	return false;
+}
+
+BitmapKernels::Isa BitmapKernels::GetBestIsa() {
+	for (auto isa: { Isa::AVX2, Isa::SSE2, Isa::NEON }) {
+		if (IsSupported(isa)) {
+			return isa;
+		}
+	}
+	return Isa::Scalar;
+}
+
+BitmapKernels::Isa BitmapKernels::GetIsa() {
+	return GetKernels().isa;
+}
+
+void BitmapKernels::SetIsa(Isa isa) {
+	assert(IsSupported(isa));
+	GetKernels() = MakeKernels(isa);
+}
+
+const char* BitmapKernels::GetIsaName(Isa isa) {
+	switch (isa) {
+		case Isa::Scalar:
+			return "Scalar";
+		case Isa::SSE2:
+			return "SSE2";
+		case Isa::AVX2:
+			return "AVX2";
+		case Isa::NEON:
+			return "NEON";
+	}
+	return "";
+}
+
+void BitmapKernels::ToneRow(uint32_t* pixels, int count, const Layout& layout, const Tone& tone, ImageOpacity opacity) {
+	GetKernels().tone(pixels, count, layout, tone, opacity);
+}
+
+void BitmapKernels::HueRow(uint32_t* pixels, int count, const Layout& layout, int hue) {
+	GetKernels().hue(pixels, count, layout, hue);
+}
+
+void BitmapKernels::BlendRow(uint32_t* pixels, const uint32_t* mask, int count, int mask_a_shift, uint32_t color, int a_shift) {
+	GetKernels().blend(pixels, mask, count, mask_a_shift, color, a_shift);
+}
+
+void BitmapKernels::SrcRow(uint32_t* dst, const uint32_t* src, int count, int opacity, uint32_t alpha_fill) {
+	GetKernels().src(dst, src, count, opacity, alpha_fill);
+}
+
+void BitmapKernels::OverRow(uint32_t* dst, const uint32_t* src, int count, int opacity, uint32_t alpha_fill, int a_shift) {
+	GetKernels().over(dst, src, count, opacity, alpha_fill, a_shift);
+}
+
+void BitmapKernels::LerpRow(uint32_t* dst, const uint32_t* a, const uint32_t* b, int count, int weight) {
+	GetKernels().lerp(dst, a, b, count, weight);
+}
+
+void BitmapKernels::Scalar::ToneRow(uint32_t* pixels, int count, const Layout& layout, const Tone& tone, ImageOpacity opacity) {
+	// Optimisations based on Opacity:
+	// Opaque: Alpha check can be skipped
+	// 1 Bit: Premultiplied Alpha can be skipped
+	// 8 Bit: No optimisations possible
+	const int rs = layout.r_shift;
+	const int gs = layout.g_shift;
+	const int bs = layout.b_shift;
+	const int as = layout.a_shift;
+
+	const bool apply_sat = tone.gray != 128;
+	const bool apply_tone = (tone.red != 128 || tone.green != 128 || tone.blue != 128);
+	const int sat = tone.gray > 128 ? 1024 + (tone.gray - 128) * 16 : tone.gray * 8;
+
+	for (int j = 0; j < count; ++j) {
+		uint8_t a = (uint8_t)((pixels[j] >> as) & 0xFF);
+		if (opacity != ImageOpacity::Opaque && a == 0) {
+			continue;
+		}
+
+		if (apply_sat) {
+			saturation_tone(pixels[j], sat, rs, gs, bs, as);
+		}
+
+		if (apply_tone) {
+			if (opacity == ImageOpacity::Alpha_8Bit && a != 255) {
+				color_tone_alpha(pixels[j], tone, rs, gs, bs, as);
+			} else {
+				color_tone(pixels[j], tone, rs, gs, bs, as);
+			}
+		}
+	}
+}
+
+void BitmapKernels::Scalar::HueRow(uint32_t* pixels, int count, const Layout& layout, int hue) {
+	for (int j = 0; j < count; ++j) {
+		uint32_t pixel = pixels[j];
+		uint8_t r = (pixel >> layout.r_shift) & 0xFF;
+		uint8_t g = (pixel >> layout.g_shift) & 0xFF;
+		uint8_t b = (pixel >> layout.b_shift) & 0xFF;
+		uint8_t a = (pixel >> layout.a_shift) & 0xFF;
+		if (a > 0)
+			RGB_adjust_HSL(r, g, b, hue);
+		pixels[j] = ((uint32_t) r << layout.r_shift) | ((uint32_t) g << layout.g_shift)
+			| ((uint32_t) b << layout.b_shift) | ((uint32_t) a << layout.a_shift);
+	}
+}
+
+void BitmapKernels::Scalar::BlendRow(uint32_t* pixels, const uint32_t* mask, int count, int mask_a_shift, uint32_t color, int a_shift) {
+	for (int j = 0; j < count; ++j) {
+		const uint32_t s = MulUn8x4(color, (mask[j] >> mask_a_shift) & 0xFF);
+		pixels[j] = AddUn8x4(s, MulUn8x4(pixels[j], 0xFF - ((s >> a_shift) & 0xFF)));
+	}
+}
+
+void BitmapKernels::Scalar::SrcRow(uint32_t* dst, const uint32_t* src, int count, int opacity, uint32_t alpha_fill) {
+	if (opacity >= 255 && alpha_fill == 0) {
+		memcpy(dst, src, count * sizeof(uint32_t));
+		return;
+	}
+
+	for (int j = 0; j < count; ++j) {
+		const uint32_t s = src[j] | alpha_fill;
+		dst[j] = opacity >= 255 ? s : MulUn8x4(s, opacity);
+	}
+}
+
+void BitmapKernels::Scalar::OverRow(uint32_t* dst, const uint32_t* src, int count, int opacity, uint32_t alpha_fill, int a_shift) {
+	for (int j = 0; j < count; ++j) {
+		uint32_t s = src[j] | alpha_fill;
+		if (opacity < 255) {
+			s = MulUn8x4(s, opacity);
+		}
+
+		const uint32_t sa = (s >> a_shift) & 0xFF;
+		if (sa == 0xFF) {
+			dst[j] = s;
+		} else if (s != 0) {
+			dst[j] = AddUn8x4(s, MulUn8x4(dst[j], 0xFF - sa));
+		}
+	}
+}
+
+void BitmapKernels::Scalar::LerpRow(uint32_t* dst, const uint32_t* a, const uint32_t* b, int count, int weight) {
+	for (int j = 0; j < count; ++j) {
+		dst[j] = LerpUn8x4(a[j], b[j], weight);
+	}
+}
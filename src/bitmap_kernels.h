@@ -0,0 +1,216 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_BITMAP_KERNELS_H
+#define EP_BITMAP_KERNELS_H
+
+// Headers
+#include <cstdint>
+#include "opacity.h"
+#include "tone.h"
+
+/**
+ * Per pixel kernels used by Bitmap for effects pixman cannot do and
+ * instead of pixman for blits between the common 32 bit formats.
+ *
+ * Every kernel has a scalar reference implementation and vectorized
+ * versions which produce bit identical results. The best version supported
+ * by the CPU is selected on first use.
+ */
+namespace BitmapKernels {
+	/** Instruction sets with kernel implementations */
+	enum class Isa {
+		Scalar,
+		SSE2,
+		AVX2,
+		NEON
+	};
+
+	/** Bit positions of the channels of a 32 bit pixel */
+	struct Layout {
+		int r_shift;
+		int g_shift;
+		int b_shift;
+		int a_shift;
+	};
+
+	/** @return fastest instruction set supported by the CPU */
+	Isa GetBestIsa();
+
+	/**
+	 * @param isa instruction set
+	 * @return whether the kernels for isa are compiled in and supported by the CPU
+	 */
+	bool IsSupported(Isa isa);
+
+	/** @return instruction set of the kernels in use */
+	Isa GetIsa();
+
+	/**
+	 * Selects the kernels to use. Intended for tests and benchmarks.
+	 *
+	 * @param isa instruction set, must be supported
+	 */
+	void SetIsa(Isa isa);
+
+	/**
+	 * @param isa instruction set
+	 * @return name of the instruction set
+	 */
+	const char* GetIsaName(Isa isa);
+
+	/**
+	 * Applies a tone to premultiplied pixels in place.
+	 * Transparent pixels are not modified unless the image is opaque.
+	 *
+	 * @param pixels pixels to modify
+	 * @param count number of pixels
+	 * @param layout channel layout
+	 * @param tone tone to apply, must not be the neutral tone
+	 * @param opacity opacity of the source image
+	 */
+	void ToneRow(uint32_t* pixels, int count, const Layout& layout, const Tone& tone, ImageOpacity opacity);
+
+	/**
+	 * Rotates the hue of pixels in place. Transparent pixels are not modified.
+	 *
+	 * @param pixels pixels to modify
+	 * @param count number of pixels
+	 * @param layout channel layout
+	 * @param hue hue rotation in 1/256 of 60 degrees, 0 to 0x600
+	 */
+	void HueRow(uint32_t* pixels, int count, const Layout& layout, int hue);
+
+	/**
+	 * Blends a color over pixels, weighted by the alpha of a mask.
+	 * Equal to a pixman OVER of a solid color with the mask.
+	 *
+	 * @param pixels pixels to modify
+	 * @param mask mask pixels, can be equal to pixels
+	 * @param count number of pixels
+	 * @param mask_a_shift bit position of the alpha channel of the mask
+	 * @param color premultiplied color in the layout of pixels
+	 * @param a_shift bit position of the alpha channel of pixels and color
+	 */
+	void BlendRow(uint32_t* pixels, const uint32_t* mask, int count, int mask_a_shift, uint32_t color, int a_shift);
+
+	/**
+	 * Copies pixels, equal to a pixman SRC with a solid mask.
+	 *
+	 * @param dst destination pixels
+	 * @param src source pixels
+	 * @param count number of pixels
+	 * @param opacity opacity, 0 to 255
+	 * @param alpha_fill bits set in every source pixel, the alpha channel for sources without alpha
+	 */
+	void SrcRow(uint32_t* dst, const uint32_t* src, int count, int opacity, uint32_t alpha_fill);
+
+	/**
+	 * Blends premultiplied pixels, equal to a pixman OVER with a solid mask.
+	 *
+	 * @param dst destination pixels
+	 * @param src source pixels
+	 * @param count number of pixels
+	 * @param opacity opacity, 0 to 255
+	 * @param alpha_fill bits set in every source pixel, the alpha channel for sources without alpha
+	 * @param a_shift bit position of the alpha channel
+	 */
+	void OverRow(uint32_t* dst, const uint32_t* src, int count, int opacity, uint32_t alpha_fill, int a_shift);
+
+	/**
+	 * Linear interpolation between two rows, used for bilinear scaling.
+	 *
+	 * @param dst destination pixels
+	 * @param a first row
+	 * @param b second row
+	 * @param count number of pixels
+	 * @param weight weight of b, 0 to 256
+	 */
+	void LerpRow(uint32_t* dst, const uint32_t* a, const uint32_t* b, int count, int weight);
+
+	// Same rounding as pixman, both channels of a pair are processed at once
+	constexpr uint32_t rb_mask = 0xFF00FF;
+	constexpr uint32_t rb_one_half = 0x800080;
+	constexpr uint32_t rb_mask_plus_one = 0x10000100;
+
+	/** @return x * a / 255 for every channel of x, rounded */
+	inline uint32_t MulUn8x4(uint32_t x, uint32_t a) {
+		uint32_t rb = (x & rb_mask) * a + rb_one_half;
+		rb = ((rb + ((rb >> 8) & rb_mask)) >> 8) & rb_mask;
+		uint32_t ag = ((x >> 8) & rb_mask) * a + rb_one_half;
+		ag = (ag + ((ag >> 8) & rb_mask)) & ~rb_mask;
+		return rb | ag;
+	}
+
+	/** @return x + y for every channel, saturated */
+	inline uint32_t AddUn8x4(uint32_t x, uint32_t y) {
+		uint32_t rb = (x & rb_mask) + (y & rb_mask);
+		rb = (rb | (rb_mask_plus_one - ((rb >> 8) & rb_mask))) & rb_mask;
+		uint32_t ag = ((x >> 8) & rb_mask) + ((y >> 8) & rb_mask);
+		ag = (ag | (rb_mask_plus_one - ((ag >> 8) & rb_mask))) & rb_mask;
+		return rb | (ag << 8);
+	}
+
+	/** @return (a * (256 - weight) + b * weight) / 256 for every channel, rounded down */
+	inline uint32_t LerpUn8x4(uint32_t a, uint32_t b, uint32_t weight) {
+		const uint32_t iweight = 256 - weight;
+		const uint32_t rb = (((a & rb_mask) * iweight + (b & rb_mask) * weight) >> 8) & rb_mask;
+		const uint32_t ag = (((a >> 8) & rb_mask) * iweight + ((b >> 8) & rb_mask) * weight) & ~rb_mask;
+		return rb | ag;
+	}
+
+	/** Reference implementations, used for the last pixels of a row by the vectorized kernels */
+	namespace Scalar {
+		void ToneRow(uint32_t* pixels, int count, const Layout& layout, const Tone& tone, ImageOpacity opacity);
+		void HueRow(uint32_t* pixels, int count, const Layout& layout, int hue);
+		void BlendRow(uint32_t* pixels, const uint32_t* mask, int count, int mask_a_shift, uint32_t color, int a_shift);
+		void SrcRow(uint32_t* dst, const uint32_t* src, int count, int opacity, uint32_t alpha_fill);
+		void OverRow(uint32_t* dst, const uint32_t* src, int count, int opacity, uint32_t alpha_fill, int a_shift);
+		void LerpRow(uint32_t* dst, const uint32_t* a, const uint32_t* b, int count, int weight);
+	}
+
+#define EP_BITMAP_KERNELS_DECLARE(ns) \
+	namespace ns { \
+		void ToneRow(uint32_t* pixels, int count, const Layout& layout, const Tone& tone, ImageOpacity opacity); \
+		void HueRow(uint32_t* pixels, int count, const Layout& layout, int hue); \
+		void BlendRow(uint32_t* pixels, const uint32_t* mask, int count, int mask_a_shift, uint32_t color, int a_shift); \
+		void SrcRow(uint32_t* dst, const uint32_t* src, int count, int opacity, uint32_t alpha_fill); \
+		void OverRow(uint32_t* dst, const uint32_t* src, int count, int opacity, uint32_t alpha_fill, int a_shift); \
+		void LerpRow(uint32_t* dst, const uint32_t* a, const uint32_t* b, int count, int weight); \
+	}
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define EP_BITMAP_KERNELS_SSE2
+	EP_BITMAP_KERNELS_DECLARE(SSE2)
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) \
+	&& (defined(__GNUC__) || defined(_MSC_VER)) && defined(EP_BITMAP_KERNELS_SSE2)
+#  define EP_BITMAP_KERNELS_AVX2
+	EP_BITMAP_KERNELS_DECLARE(AVX2)
+#endif
+
+// Hue rotation needs vector division, not available on 32 bit ARM
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#  define EP_BITMAP_KERNELS_NEON
+	EP_BITMAP_KERNELS_DECLARE(NEON)
+#endif
+
+#undef EP_BITMAP_KERNELS_DECLARE
+}
+
+#endif
@@ -0,0 +1,74 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "bitmap_kernels.h"
+
+#ifdef EP_BITMAP_KERNELS_NEON
+#include <arm_neon.h>
+
+namespace {
+	/** Four 32 bit lanes, comparisons return all bits set like on x86 */
+	struct NeonVec {
+		using T = int32x4_t;
+		static constexpr int lanes = 4;
+
+		static T Load(const uint32_t* p) { return vreinterpretq_s32_u32(vld1q_u32(p)); }
+		static void Store(uint32_t* p, T v) { vst1q_u32(p, vreinterpretq_u32_s32(v)); }
+		static T Set1(int x) { return vdupq_n_s32(x); }
+
+		static T Add(T a, T b) { return vaddq_s32(a, b); }
+		static T Sub(T a, T b) { return vsubq_s32(a, b); }
+		static T Mul16(T a, T b) {
+			return vreinterpretq_s32_u16(vmulq_u16(vreinterpretq_u16_s32(a), vreinterpretq_u16_s32(b)));
+		}
+		static T MulHi16(T a, T b) {
+			// The upper halves are 0, a 32 bit multiplication gives the same result
+			return vreinterpretq_s32_u32(vshrq_n_u32(vmulq_u32(vreinterpretq_u32_s32(a), vreinterpretq_u32_s32(b)), 16));
+		}
+		static T MulS16(T a, T b) { return vmulq_s32(a, b); }
+		static T Div(T a, T b) { return vcvtq_s32_f32(vdivq_f32(vcvtq_f32_s32(a), vcvtq_f32_s32(b))); }
+
+		static T And(T a, T b) { return vandq_s32(a, b); }
+		static T Or(T a, T b) { return vorrq_s32(a, b); }
+		static T Xor(T a, T b) { return veorq_s32(a, b); }
+		static T AndNot(T a, T b) { return vbicq_s32(b, a); }
+
+		static T Srl(T v, int n) {
+			return vreinterpretq_s32_u32(vshlq_u32(vreinterpretq_u32_s32(v), vdupq_n_s32(-n)));
+		}
+		static T Sll(T v, int n) { return vshlq_s32(v, vdupq_n_s32(n)); }
+		template <int N> static T Srli(T v) {
+			return vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(v), N));
+		}
+		template <int N> static T Slli(T v) { return vshlq_n_s32(v, N); }
+		template <int N> static T Srai(T v) { return vshrq_n_s32(v, N); }
+
+		static T CmpEq(T a, T b) { return vreinterpretq_s32_u32(vceqq_s32(a, b)); }
+		static T CmpGt(T a, T b) { return vreinterpretq_s32_u32(vcgtq_s32(a, b)); }
+		static T Select(T mask, T a, T b) { return vbslq_s32(vreinterpretq_u32_s32(mask), a, b); }
+		static T Min(T a, T b) { return vminq_s32(a, b); }
+		static T Max(T a, T b) { return vmaxq_s32(a, b); }
+	};
+} // anonymous namespace
+
+#define EP_BITMAP_KERNELS_NS NEON
+#define EP_BITMAP_KERNELS_VEC NeonVec
+#include "bitmap_kernels_simd.h"
+#undef EP_BITMAP_KERNELS_NS
+#undef EP_BITMAP_KERNELS_VEC
+#endif
@@ -0,0 +1,312 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Vectorized bitmap kernels, written against a vector of 32 bit lanes.
+ *
+ * This file is included once per instruction set, no include guard. Before
+ * including it define:
+ *  EP_BITMAP_KERNELS_NS  - namespace of the kernels (see bitmap_kernels.h)
+ *  EP_BITMAP_KERNELS_VEC - type providing the vector operations
+ *
+ * The kernels compute the same integer formulas as the scalar versions in
+ * bitmap_kernels.cpp, the last pixels of a row are passed to them.
+ *
+ * The 16 bit multiplications operate on both halves of a lane. All values
+ * fit into the lower half, so the upper half of the result is 0.
+ */
+
+namespace BitmapKernels {
+namespace EP_BITMAP_KERNELS_NS {
+namespace {
+	using V = EP_BITMAP_KERNELS_VEC;
+	using T = V::T;
+
+	inline T Channel(T v, int shift) {
+		return V::And(V::Srl(v, shift), V::Set1(0xFF));
+	}
+
+	/** @return v / 255 for 0 <= v <= 0xFFFF */
+	inline T Div255(T v) {
+		return V::Srli<7>(V::MulHi16(v, V::Set1(0x8081)));
+	}
+
+	inline T Clamp255(T v) {
+		return V::Min(V::Max(v, V::Set1(0)), V::Set1(255));
+	}
+
+	inline T Pack(T r, T g, T b, T a, const Layout& layout) {
+		return V::Or(V::Or(V::Sll(r, layout.r_shift), V::Sll(g, layout.g_shift)),
+			V::Or(V::Sll(b, layout.b_shift), V::Sll(a, layout.a_shift)));
+	}
+
+	/** Hard light of one channel, a tone i <= 128 is j * 2i / 255, otherwise the inverse of it */
+	struct HardLight {
+		T k;
+		T inv;
+
+		explicit HardLight(int i) :
+			k(V::Set1(i <= 128 ? 2 * i : 2 * (255 - i))),
+			inv(V::Set1(i <= 128 ? 0 : 0xFF)) {}
+
+		T operator()(T j) const {
+			const T q = V::Min(Div255(V::Mul16(V::Xor(j, inv), k)), V::Set1(255));
+			return V::Xor(q, inv);
+		}
+	};
+
+	/** Multiplies 8 bit channels by a, rounded like pixman */
+	inline T MulUn8x4(T x, T a) {
+		const T rb_mask_v = V::Set1(rb_mask);
+		const T half = V::Set1(rb_one_half);
+		// Both 16 bit halves of a lane are multiplied by a
+		const T a2 = V::Or(a, V::Slli<16>(a));
+
+		T rb = V::Add(V::Mul16(V::And(x, rb_mask_v), a2), half);
+		rb = V::And(V::Srli<8>(V::Add(rb, V::And(V::Srli<8>(rb), rb_mask_v))), rb_mask_v);
+		T ag = V::Add(V::Mul16(V::And(V::Srli<8>(x), rb_mask_v), a2), half);
+		ag = V::AndNot(rb_mask_v, V::Add(ag, V::And(V::Srli<8>(ag), rb_mask_v)));
+		return V::Or(rb, ag);
+	}
+
+	/** Adds 8 bit channels, saturated */
+	inline T AddUn8x4(T x, T y) {
+		const T rb_mask_v = V::Set1(rb_mask);
+		const T plus_one = V::Set1(rb_mask_plus_one);
+
+		T rb = V::Add(V::And(x, rb_mask_v), V::And(y, rb_mask_v));
+		rb = V::And(V::Or(rb, V::Sub(plus_one, V::And(V::Srli<8>(rb), rb_mask_v))), rb_mask_v);
+		T ag = V::Add(V::And(V::Srli<8>(x), rb_mask_v), V::And(V::Srli<8>(y), rb_mask_v));
+		ag = V::And(V::Or(ag, V::Sub(plus_one, V::And(V::Srli<8>(ag), rb_mask_v))), rb_mask_v);
+		return V::Or(rb, V::Slli<8>(ag));
+	}
+} // anonymous namespace
+
+void ToneRow(uint32_t* pixels, int count, const Layout& layout, const Tone& tone, ImageOpacity opacity) {
+	const bool apply_sat = tone.gray != 128;
+	const bool apply_tone = (tone.red != 128 || tone.green != 128 || tone.blue != 128);
+	const bool skip_transparent = opacity != ImageOpacity::Opaque;
+	const bool mul_alpha = apply_tone && opacity == ImageOpacity::Alpha_8Bit;
+
+	const T sat = V::Set1(tone.gray > 128 ? 1024 + (tone.gray - 128) * 16 : tone.gray * 8);
+	const HardLight red(tone.red);
+	const HardLight green(tone.green);
+	const HardLight blue(tone.blue);
+
+	int j = 0;
+	for (; j + V::lanes <= count; j += V::lanes) {
+		const T src = V::Load(pixels + j);
+		T r = Channel(src, layout.r_shift);
+		T g = Channel(src, layout.g_shift);
+		T b = Channel(src, layout.b_shift);
+		const T a = Channel(src, layout.a_shift);
+
+		if (apply_sat) {
+			// Y' = 0.299 R' + 0.587 G' + 0.114 B'
+			// 38470 does not fit a signed 16 bit multiplication, 2g * 19235 is the same
+			const T lum = V::Srli<16>(V::Add(V::Add(
+				V::MulS16(b, V::Set1(7471)), V::MulS16(V::Slli<1>(g), V::Set1(19235))), V::MulS16(r, V::Set1(19595))));
+			const T lum_scaled = V::Slli<10>(lum);
+
+			r = Clamp255(V::Srai<10>(V::Add(lum_scaled, V::MulS16(V::Sub(r, lum), sat))));
+			g = Clamp255(V::Srai<10>(V::Add(lum_scaled, V::MulS16(V::Sub(g, lum), sat))));
+			b = Clamp255(V::Srai<10>(V::Add(lum_scaled, V::MulS16(V::Sub(b, lum), sat))));
+		}
+
+		if (apply_tone) {
+			r = red(r);
+			g = green(g);
+			b = blue(b);
+
+			if (mul_alpha) {
+				r = Div255(V::Mul16(r, a));
+				g = Div255(V::Mul16(g, a));
+				b = Div255(V::Mul16(b, a));
+			}
+		}
+
+		T res = Pack(r, g, b, a, layout);
+		if (skip_transparent) {
+			res = V::Select(V::CmpEq(a, V::Set1(0)), src, res);
+		}
+		V::Store(pixels + j, res);
+	}
+
+	Scalar::ToneRow(pixels + j, count - j, layout, tone, opacity);
+}
+
+void HueRow(uint32_t* pixels, int count, const Layout& layout, int hue_) {
+	const T hue = V::Set1(hue_);
+	const T zero = V::Set1(0);
+	const T one = V::Set1(1);
+	const T c255 = V::Set1(0xFF);
+	const T c511 = V::Set1(0x1FF);
+	const T c600 = V::Set1(0x600);
+
+	int j = 0;
+	for (; j + V::lanes <= count; j += V::lanes) {
+		const T src = V::Load(pixels + j);
+		const T r = Channel(src, layout.r_shift);
+		const T g = Channel(src, layout.g_shift);
+		const T b = Channel(src, layout.b_shift);
+		const T a = Channel(src, layout.a_shift);
+
+		// RGB to HSL, the order of the channels decides the hue sector
+		const T r_g = V::CmpGt(r, g);
+		const T r_b = V::CmpGt(r, b);
+		const T b_g = V::CmpGt(b, g);
+		const T b_r = V::CmpGt(b, r);
+		const T g_b = V::CmpGt(g, b);
+
+		const T r_max = V::And(r_g, r_b);
+		const T b_max = V::Or(V::AndNot(r_b, r_g), V::AndNot(r_g, V::AndNot(g_b, b_r)));
+		const T order_rbg = V::And(r_max, b_g);
+
+		const T max = V::Max(V::Max(r, g), b);
+		const T min = V::Min(V::Min(r, g), b);
+		const T c = V::Sub(max, min);
+		const T l2 = V::Add(max, min);
+
+		const T num = V::Select(r_max, V::Sub(g, b), V::Select(b_max, V::Sub(r, g), V::Sub(b, r)));
+		const T base = V::Select(order_rbg, c600,
+			V::Select(r_max, zero, V::Select(b_max, V::Set1(0x400), V::Set1(0x200))));
+
+		// The hue does not matter when c is 0, all channels are equal
+		T h = V::Add(V::Div(V::Slli<8>(num), V::Max(c, one)), base);
+		const T d = V::Select(V::CmpGt(l2, c255), V::Sub(c511, l2), l2);
+		T s = V::Div(V::Slli<8>(c), V::Max(d, one));
+		const T l = V::Srli<1>(l2);
+
+		// Adjust
+		h = V::Add(h, hue);
+		h = V::Select(V::CmpGt(c600, h), h, V::Sub(h, c600));
+		s = V::Min(s, c255);
+
+		// HSL to RGB
+		const T hl2 = V::Slli<1>(l);
+		const T hd = V::Select(V::CmpGt(hl2, c255), V::Sub(c511, hl2), hl2);
+		const T hc = V::Srli<8>(V::Mul16(s, hd));
+		const T m = V::Srli<1>(V::Sub(hl2, hc));
+		const T h0 = V::And(h, c255);
+		const T h1 = V::Sub(c255, h0);
+		const T sector = V::Srli<8>(h);
+
+		const T x0 = V::And(V::Add(m, V::Srli<8>(V::Mul16(h0, hc))), c255);
+		const T x1 = V::And(V::Add(m, V::Srli<8>(V::Mul16(h1, hc))), c255);
+		const T mc = V::And(V::Add(m, hc), c255);
+		const T mm = V::And(m, c255);
+
+		const T s0 = V::CmpEq(sector, zero);
+		const T s1 = V::CmpEq(sector, one);
+		const T s2 = V::CmpEq(sector, V::Set1(2));
+		const T s3 = V::CmpEq(sector, V::Set1(3));
+		const T s4 = V::CmpEq(sector, V::Set1(4));
+		const T s5 = V::CmpEq(sector, V::Set1(5));
+
+		T nr = V::Select(V::Or(s0, s5), mc, V::Select(s1, x1, V::Select(s4, x0, mm)));
+		T ng = V::Select(V::Or(s1, s2), mc, V::Select(s0, x0, V::Select(s3, x1, mm)));
+		T nb = V::Select(V::Or(s3, s4), mc, V::Select(s2, x0, V::Select(s5, x1, mm)));
+
+		const T transparent = V::CmpEq(a, zero);
+		nr = V::Select(transparent, r, nr);
+		ng = V::Select(transparent, g, ng);
+		nb = V::Select(transparent, b, nb);
+
+		V::Store(pixels + j, Pack(nr, ng, nb, a, layout));
+	}
+
+	Scalar::HueRow(pixels + j, count - j, layout, hue_);
+}
+
+void BlendRow(uint32_t* pixels, const uint32_t* mask, int count, int mask_a_shift, uint32_t color, int a_shift) {
+	const T color_v = V::Set1(static_cast<int>(color));
+	const T c255 = V::Set1(0xFF);
+
+	int j = 0;
+	for (; j + V::lanes <= count; j += V::lanes) {
+		const T m = Channel(V::Load(mask + j), mask_a_shift);
+		const T dst = V::Load(pixels + j);
+
+		const T s = MulUn8x4(color_v, m);
+		const T ia = V::Sub(c255, Channel(s, a_shift));
+		V::Store(pixels + j, AddUn8x4(s, MulUn8x4(dst, ia)));
+	}
+
+	Scalar::BlendRow(pixels + j, mask + j, count - j, mask_a_shift, color, a_shift);
+}
+
+void SrcRow(uint32_t* dst, const uint32_t* src, int count, int opacity, uint32_t alpha_fill) {
+	if (opacity >= 255 && alpha_fill == 0) {
+		Scalar::SrcRow(dst, src, count, opacity, alpha_fill);
+		return;
+	}
+
+	const T opacity_v = V::Set1(opacity);
+	const T fill = V::Set1(static_cast<int>(alpha_fill));
+
+	int j = 0;
+	for (; j + V::lanes <= count; j += V::lanes) {
+		const T s = V::Or(V::Load(src + j), fill);
+		V::Store(dst + j, opacity >= 255 ? s : MulUn8x4(s, opacity_v));
+	}
+
+	Scalar::SrcRow(dst + j, src + j, count - j, opacity, alpha_fill);
+}
+
+void OverRow(uint32_t* dst, const uint32_t* src, int count, int opacity, uint32_t alpha_fill, int a_shift) {
+	const T opacity_v = V::Set1(opacity);
+	const T fill = V::Set1(static_cast<int>(alpha_fill));
+	const T c255 = V::Set1(0xFF);
+
+	int j = 0;
+	for (; j + V::lanes <= count; j += V::lanes) {
+		T s = V::Or(V::Load(src + j), fill);
+		if (opacity < 255) {
+			s = MulUn8x4(s, opacity_v);
+		}
+
+		// An opaque source gives s, a transparent one the destination
+		const T ia = V::Sub(c255, Channel(s, a_shift));
+		V::Store(dst + j, AddUn8x4(s, MulUn8x4(V::Load(dst + j), ia)));
+	}
+
+	Scalar::OverRow(dst + j, src + j, count - j, opacity, alpha_fill, a_shift);
+}
+
+void LerpRow(uint32_t* dst, const uint32_t* a, const uint32_t* b, int count, int weight) {
+	// Every channel of a channel pair is in its own 16 bit half, the products fit
+	const T weight_v = V::Set1(weight * 0x10001);
+	const T iweight_v = V::Set1((256 - weight) * 0x10001);
+	const T mask = V::Set1(static_cast<int>(rb_mask));
+
+	int j = 0;
+	for (; j + V::lanes <= count; j += V::lanes) {
+		const T av = V::Load(a + j);
+		const T bv = V::Load(b + j);
+
+		T rb = V::Add(V::Mul16(V::And(av, mask), iweight_v), V::Mul16(V::And(bv, mask), weight_v));
+		rb = V::And(V::Srli<8>(rb), mask);
+		T ag = V::Add(V::Mul16(V::And(V::Srli<8>(av), mask), iweight_v), V::Mul16(V::And(V::Srli<8>(bv), mask), weight_v));
+		ag = V::AndNot(mask, ag);
+		V::Store(dst + j, V::Or(rb, ag));
+	}
+
+	Scalar::LerpRow(dst + j, a + j, b + j, count - j, weight);
+}
+
+} // namespace EP_BITMAP_KERNELS_NS
+} // namespace BitmapKernels
@@ -0,0 +1,127 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "bitmap_kernels.h"
+
+#ifdef EP_BITMAP_KERNELS_SSE2
+#include <emmintrin.h>
+
+namespace {
+	/** Four 32 bit lanes */
+	struct Sse2Vec {
+		using T = __m128i;
+		static constexpr int lanes = 4;
+
+		static T Load(const uint32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+		static void Store(uint32_t* p, T v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+		static T Set1(int x) { return _mm_set1_epi32(x); }
+
+		static T Add(T a, T b) { return _mm_add_epi32(a, b); }
+		static T Sub(T a, T b) { return _mm_sub_epi32(a, b); }
+		static T Mul16(T a, T b) { return _mm_mullo_epi16(a, b); }
+		static T MulHi16(T a, T b) { return _mm_mulhi_epu16(a, b); }
+		// The upper half of b is 0, the sum of madd has only one term
+		static T MulS16(T a, T b) { return _mm_madd_epi16(a, b); }
+		static T Div(T a, T b) { return _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(a), _mm_cvtepi32_ps(b))); }
+
+		static T And(T a, T b) { return _mm_and_si128(a, b); }
+		static T Or(T a, T b) { return _mm_or_si128(a, b); }
+		static T Xor(T a, T b) { return _mm_xor_si128(a, b); }
+		static T AndNot(T a, T b) { return _mm_andnot_si128(a, b); }
+
+		static T Srl(T v, int n) { return _mm_srl_epi32(v, _mm_cvtsi32_si128(n)); }
+		static T Sll(T v, int n) { return _mm_sll_epi32(v, _mm_cvtsi32_si128(n)); }
+		template <int N> static T Srli(T v) { return _mm_srli_epi32(v, N); }
+		template <int N> static T Slli(T v) { return _mm_slli_epi32(v, N); }
+		template <int N> static T Srai(T v) { return _mm_srai_epi32(v, N); }
+
+		static T CmpEq(T a, T b) { return _mm_cmpeq_epi32(a, b); }
+		static T CmpGt(T a, T b) { return _mm_cmpgt_epi32(a, b); }
+		static T Select(T mask, T a, T b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+		static T Min(T a, T b) { return Select(_mm_cmpgt_epi32(a, b), b, a); }
+		static T Max(T a, T b) { return Select(_mm_cmpgt_epi32(a, b), a, b); }
+	};
+} // anonymous namespace
+
+#define EP_BITMAP_KERNELS_NS SSE2
+#define EP_BITMAP_KERNELS_VEC Sse2Vec
+#include "bitmap_kernels_simd.h"
+#undef EP_BITMAP_KERNELS_NS
+#undef EP_BITMAP_KERNELS_VEC
+#endif
+
+#ifdef EP_BITMAP_KERNELS_AVX2
+#include <immintrin.h>
+
+// Compiled for AVX2 without changing the flags of the file, only called when
+// the CPU supports it
+#if defined(__clang__)
+#  pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#  pragma GCC push_options
+#  pragma GCC target("avx2")
+#endif
+
+namespace {
+	/** Eight 32 bit lanes */
+	struct Avx2Vec {
+		using T = __m256i;
+		static constexpr int lanes = 8;
+
+		static T Load(const uint32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+		static void Store(uint32_t* p, T v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+		static T Set1(int x) { return _mm256_set1_epi32(x); }
+
+		static T Add(T a, T b) { return _mm256_add_epi32(a, b); }
+		static T Sub(T a, T b) { return _mm256_sub_epi32(a, b); }
+		static T Mul16(T a, T b) { return _mm256_mullo_epi16(a, b); }
+		static T MulHi16(T a, T b) { return _mm256_mulhi_epu16(a, b); }
+		static T MulS16(T a, T b) { return _mm256_madd_epi16(a, b); }
+		static T Div(T a, T b) { return _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(a), _mm256_cvtepi32_ps(b))); }
+
+		static T And(T a, T b) { return _mm256_and_si256(a, b); }
+		static T Or(T a, T b) { return _mm256_or_si256(a, b); }
+		static T Xor(T a, T b) { return _mm256_xor_si256(a, b); }
+		static T AndNot(T a, T b) { return _mm256_andnot_si256(a, b); }
+
+		static T Srl(T v, int n) { return _mm256_srl_epi32(v, _mm_cvtsi32_si128(n)); }
+		static T Sll(T v, int n) { return _mm256_sll_epi32(v, _mm_cvtsi32_si128(n)); }
+		template <int N> static T Srli(T v) { return _mm256_srli_epi32(v, N); }
+		template <int N> static T Slli(T v) { return _mm256_slli_epi32(v, N); }
+		template <int N> static T Srai(T v) { return _mm256_srai_epi32(v, N); }
+
+		static T CmpEq(T a, T b) { return _mm256_cmpeq_epi32(a, b); }
+		static T CmpGt(T a, T b) { return _mm256_cmpgt_epi32(a, b); }
+		static T Select(T mask, T a, T b) { return _mm256_blendv_epi8(b, a, mask); }
+		static T Min(T a, T b) { return _mm256_min_epi32(a, b); }
+		static T Max(T a, T b) { return _mm256_max_epi32(a, b); }
+	};
+} // anonymous namespace
+
+#define EP_BITMAP_KERNELS_NS AVX2
+#define EP_BITMAP_KERNELS_VEC Avx2Vec
+#include "bitmap_kernels_simd.h"
+#undef EP_BITMAP_KERNELS_NS
+#undef EP_BITMAP_KERNELS_VEC
+
+#if defined(__clang__)
+#  pragma clang attribute pop
+#elif defined(__GNUC__)
+#  pragma GCC pop_options
+#endif
+#endif
@@ -0,0 +1,216 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "bitmap_scaler.h"
+#include "bitmap.h"
+#include "bitmap_kernels.h"
+#include "instrumentation.h"
+#include "worker_pool.h"
+
+namespace {
+	/** Bands smaller than this are not worth a thread */
+	constexpr int min_band_rows = 32;
+
+	/** Source position of a destination pixel on one axis */
+	struct Sample {
+		/** First source pixel */
+		int index;
+		/** Weight of the pixel after index, 0 to 256 */
+		int weight;
+	};
+
+	std::vector<Sample> GetNearestSamples(int src_size, int dst_size) {
+		std::vector<Sample> samples(dst_size);
+		for (int i = 0; i < dst_size; ++i) {
+			// Source pixel below the center of the destination pixel
+			const int64_t index = (2 * static_cast<int64_t>(i) + 1) * src_size / (2 * static_cast<int64_t>(dst_size));
+			samples[i] = { static_cast<int>(index), 0 };
+		}
+		return samples;
+	}
+
+	std::vector<Sample> GetSharpBilinearSamples(int src_size, int dst_size) {
+		// Same as the common sharp bilinear shader: Inside of the area a source
+		// pixel covers after the integer prescale the pixel is not filtered
+		const double scale = std::max(1, dst_size / src_size);
+		const double region = 0.5 - 0.5 / scale;
+
+		std::vector<Sample> samples(dst_size);
+		for (int i = 0; i < dst_size; ++i) {
+			const double texel = (i + 0.5) * src_size / dst_size;
+			const double texel_floor = std::floor(texel);
+			const double center = texel - texel_floor - 0.5;
+			const double offset = (center - std::clamp(center, -region, region)) * scale + 0.5;
+
+			// Bilinear filtering between the centers of the neighbouring pixels
+			const double pos = texel_floor + offset - 0.5;
+			int index = static_cast<int>(std::floor(pos));
+			int weight = static_cast<int>(std::lround((pos - index) * 256));
+			if (weight == 256) {
+				++index;
+				weight = 0;
+			}
+
+			if (index < 0) {
+				index = 0;
+				weight = 0;
+			} else if (index >= src_size - 1) {
+				index = src_size - 1;
+				weight = 0;
+			}
+			samples[i] = { index, weight };
+		}
+		return samples;
+	}
+
+	/** Repeats every pixel N times, written for the compiler to vectorize */
+	template <int N>
+	void ExpandRow(uint32_t* dst, const uint32_t* src, int count) {
+		for (int i = 0; i < count; ++i) {
+			for (int k = 0; k < N; ++k) {
+				dst[i * N + k] = src[i];
+			}
+		}
+	}
+
+	struct ScaleJob {
+		const uint8_t* src_pixels;
+		int src_pitch;
+		int src_width;
+		uint8_t* dst_pixels;
+		int dst_pitch;
+		int dst_width;
+		std::vector<Sample> columns;
+		std::vector<Sample> rows;
+		/** Integer factor of the width for nearest neighbour, otherwise 0 */
+		int factor_x;
+		bool filter_x;
+
+		void ScaleRow(uint32_t* dst, const uint32_t* src) const {
+			switch (factor_x) {
+				case 1: memcpy(dst, src, dst_width * sizeof(uint32_t)); return;
+				case 2: ExpandRow<2>(dst, src, src_width); return;
+				case 3: ExpandRow<3>(dst, src, src_width); return;
+				case 4: ExpandRow<4>(dst, src, src_width); return;
+				case 5: ExpandRow<5>(dst, src, src_width); return;
+				case 6: ExpandRow<6>(dst, src, src_width); return;
+				default: break;
+			}
+
+			if (!filter_x) {
+				for (int i = 0; i < dst_width; ++i) {
+					dst[i] = src[columns[i].index];
+				}
+				return;
+			}
+
+			for (int i = 0; i < dst_width; ++i) {
+				const auto& col = columns[i];
+				dst[i] = col.weight == 0 ? src[col.index]
+					: BitmapKernels::LerpUn8x4(src[col.index], src[col.index + 1], col.weight);
+			}
+		}
+
+		void Draw(int first_row, int last_row) const {
+			// Horizontally scaled source rows. Neighbouring rows have a different
+			// parity, a row and the one after it are always cached together.
+			std::vector<uint32_t> cache[2] = {
+				std::vector<uint32_t>(dst_width), std::vector<uint32_t>(dst_width) };
+			int cached_row[2] = { -1, -1 };
+
+			auto get_row = [&](int y) {
+				auto& row = cache[y & 1];
+				if (cached_row[y & 1] != y) {
+					ScaleRow(row.data(), reinterpret_cast<const uint32_t*>(src_pixels + y * src_pitch));
+					cached_row[y & 1] = y;
+				}
+				return row.data();
+			};
+
+			for (int y = first_row; y < last_row; ++y) {
+				auto* dst = reinterpret_cast<uint32_t*>(dst_pixels + y * dst_pitch);
+				const auto& row = rows[y];
+				if (row.weight == 0) {
+					memcpy(dst, get_row(row.index), dst_width * sizeof(uint32_t));
+				} else {
+					BitmapKernels::LerpRow(dst, get_row(row.index), get_row(row.index + 1), dst_width, row.weight);
+				}
+			}
+		}
+	};
+}
+
+int BitmapScaler::GetIntegerFactor(int src_width, int src_height, int dst_width, int dst_height) {
+	if (src_width <= 0 || src_height <= 0) {
+		return 1;
+	}
+	return std::clamp(std::min(dst_width / src_width, dst_height / src_height), 1, max_factor);
+}
+
+void BitmapScaler::Scale(Bitmap& dst, const Bitmap& src, ConfigEnum::ScalingMode mode, bool threaded) {
+	Instrumentation::ZoneScope zone("BitmapScaler::Scale");
+
+	if (dst.GetWidth() <= 0 || dst.GetHeight() <= 0 || src.GetWidth() <= 0 || src.GetHeight() <= 0) {
+		return;
+	}
+
+	if (dst.bpp() != 4 || src.bpp() != 4) {
+		dst.StretchBlit(src, src.GetRect(), Opacity::Opaque(), Bitmap::BlendMode::NormalWithoutAlpha);
+		return;
+	}
+
+	ScaleJob job;
+	job.src_pixels = static_cast<const uint8_t*>(src.pixels());
+	job.src_pitch = src.pitch();
+	job.src_width = src.GetWidth();
+	job.dst_pixels = static_cast<uint8_t*>(dst.pixels());
+	job.dst_pitch = dst.pitch();
+	job.dst_width = dst.GetWidth();
+
+	if (mode == ConfigEnum::ScalingMode::Bilinear) {
+		job.columns = GetSharpBilinearSamples(src.GetWidth(), dst.GetWidth());
+		job.rows = GetSharpBilinearSamples(src.GetHeight(), dst.GetHeight());
+	} else {
+		job.columns = GetNearestSamples(src.GetWidth(), dst.GetWidth());
+		job.rows = GetNearestSamples(src.GetHeight(), dst.GetHeight());
+	}
+
+	job.filter_x = std::any_of(job.columns.begin(), job.columns.end(), [](const Sample& s) { return s.weight != 0; });
+	job.factor_x = 0;
+	if (!job.filter_x && dst.GetWidth() % src.GetWidth() == 0 && dst.GetWidth() / src.GetWidth() <= max_factor) {
+		job.factor_x = dst.GetWidth() / src.GetWidth();
+	}
+
+	const int height = dst.GetHeight();
+	auto& pool = WorkerPool::Instance();
+	const int num_bands = threaded ? std::min(pool.GetNumThreads(), height / min_band_rows) : 1;
+
+	if (num_bands <= 1) {
+		job.Draw(0, height);
+		return;
+	}
+
+	// Every band writes its own rows, the result matches the serial path
+	pool.ParallelFor(num_bands, [&](int i) {
+		job.Draw(height * i / num_bands, height * (i + 1) / num_bands);
+	});
+}
@@ -0,0 +1,62 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_BITMAP_SCALER_H
+#define EP_BITMAP_SCALER_H
+
+// Headers
+#include "game_config.h"
+
+class Bitmap;
+
+/**
+ * Upscaler for the composed frame, used by the frontends which have no
+ * fast scaling of their own.
+ */
+namespace BitmapScaler {
+	/** Largest integer scaling factor */
+	constexpr int max_factor = 6;
+
+	/**
+	 * Calculates the largest integer factor at which an image fits into an area.
+	 *
+	 * @param src_width image width
+	 * @param src_height image height
+	 * @param dst_width area width
+	 * @param dst_height area height
+	 * @return factor from 1 to max_factor
+	 */
+	int GetIntegerFactor(int src_width, int src_height, int dst_width, int dst_height);
+
+	/**
+	 * Scales src to the size of dst. Both bitmaps must use the same 32 bit format.
+	 *
+	 * Nearest and Integer use nearest neighbour sampling, with a fast path
+	 * when dst is an integer multiple of src.
+	 * Bilinear is sharp bilinear: Equal to nearest neighbour scaling by the
+	 * largest integer factor followed by bilinear filtering to the size of dst.
+	 * Only the edges of the source pixels are blurred.
+	 *
+	 * @param dst destination bitmap
+	 * @param src source bitmap
+	 * @param mode scaling method
+	 * @param threaded split the rows into bands drawn by the WorkerPool
+	 */
+	void Scale(Bitmap& dst, const Bitmap& src, ConfigEnum::ScalingMode mode, bool threaded = false);
+}
+
+#endif
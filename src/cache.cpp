@@ -20,6 +20,7 @@
 #  pragma warning(disable: 4003)
 #endif
 
+#include <algorithm>
 #include <map>
 #include <tuple>
 #include <chrono>
@@ -81,9 +82,23 @@ namespace {
 	using tile_key_type = std::string;
 	std::unordered_map<tile_key_type, std::weak_ptr<Bitmap>> cache_tiles;
 
-	// rect, flip_x, flip_y, tone, blend
-	using effect_key_type = std::tuple<std::string, bool, Rect, bool, bool, Tone, Color>;
-	std::map<effect_key_type, std::weak_ptr<Bitmap>> cache_effects;
+	// id, revision, transparent, rect, flip_x, flip_y, tone, blend
+	using effect_key_type = std::tuple<std::string, uint64_t, bool, Rect, bool, bool, Tone, Color>;
+
+	struct EffectItem {
+		BitmapRef bitmap;
+		uint64_t last_access;
+	};
+	std::map<effect_key_type, EffectItem> cache_effects;
+
+	/** Evicted effect bitmaps whose memory is reused for new effects */
+	std::vector<BitmapRef> effect_pool;
+
+	Cache::EffectCacheStats effect_stats;
+	uint64_t effect_access = 0;
+
+	constexpr size_t effect_cache_limit = 8 * 1024 * 1024;
+	constexpr size_t effect_pool_limit = 32;
 
 	std::string system_name;
 
@@ -129,6 +144,57 @@ namespace {
 #endif
 	}
 
+	void FreeEffectMemory() {
+		// Free the least recently used effects until 3/4 of the budget are used.
+		// This way the cache is not scanned on every miss.
+		std::vector<decltype(cache_effects)::iterator> candidates;
+		for (auto it = cache_effects.begin(); it != cache_effects.end(); ++it) {
+			if (it->second.bitmap.use_count() == 1) {
+				candidates.push_back(it);
+			}
+		}
+
+		std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+			return a->second.last_access < b->second.last_access;
+		});
+
+		for (auto it : candidates) {
+			if (effect_stats.size <= effect_cache_limit * 3 / 4) {
+				break;
+			}
+
+			auto& bitmap = it->second.bitmap;
+			effect_stats.size -= bitmap->GetSize();
+			++effect_stats.evictions;
+
+			if (effect_pool.size() < effect_pool_limit) {
+				effect_pool.push_back(std::move(bitmap));
+			}
+
+			cache_effects.erase(it);
+		}
+
+#ifdef CACHE_DEBUG
+		Output::Debug("Effect cache size: {} ({} hits, {} misses)", effect_stats.size / 1024.0 / 1024, effect_stats.hits, effect_stats.misses);
+#endif
+	}
+
+	BitmapRef CreateEffectBitmap(int width, int height) {
+		auto it = std::find_if(effect_pool.begin(), effect_pool.end(), [&](const BitmapRef& bitmap) {
+			return bitmap->GetWidth() == width && bitmap->GetHeight() == height;
+		});
+
+		if (it == effect_pool.end()) {
+			return Bitmap::Create(width, height, true);
+		}
+
+		BitmapRef bitmap = std::move(*it);
+		effect_pool.erase(it);
+		bitmap->Clear();
+		++effect_stats.recycled;
+		return bitmap;
+	}
+
 	BitmapRef AddToCache(const std::string& key, BitmapRef bmp) {
 		if (bmp) {
 			cache_size += bmp->GetSize();
@@ -474,6 +540,8 @@ BitmapRef Cache::SpriteEffect(const BitmapRef& src_bitmap, const Rect& rect, boo
 
 	const effect_key_type key {
 		id,
+		// Cached effects are kept after the sprites released them: Do not return outdated pixels
+		src_bitmap->GetRevision(),
 		src_bitmap->GetTransparent(),
 		rect,
 		flip_x,
@@ -482,13 +550,17 @@ BitmapRef Cache::SpriteEffect(const BitmapRef& src_bitmap, const Rect& rect, boo
 		blend
 	};
 
+	++effect_access;
+
 	const auto it = cache_effects.find(key);
 
-	if (it == cache_effects.end() || it->second.expired()) {
+	if (it == cache_effects.end()) {
+		++effect_stats.misses;
+
 		BitmapRef bitmap_effects;
 
 		auto create = [&rect] () -> BitmapRef {
-			return Bitmap::Create(rect.width, rect.height, true);
+			return CreateEffectBitmap(rect.width, rect.height);
 		};
 
 		if (tone != Tone()) {
@@ -518,12 +590,31 @@ BitmapRef Cache::SpriteEffect(const BitmapRef& src_bitmap, const Rect& rect, boo
 
 		assert(bitmap_effects && "Effect cache used but no effect applied!");
 
-		return(cache_effects[key] = bitmap_effects).lock();
-	} else { return it->second.lock(); }
+		effect_stats.size += bitmap_effects->GetSize();
+		cache_effects[key] = { bitmap_effects, effect_access };
+
+		if (effect_stats.size > effect_cache_limit) {
+			FreeEffectMemory();
+		}
+
+		return bitmap_effects;
+	} else {
+		++effect_stats.hits;
+		it->second.last_access = effect_access;
+		return it->second.bitmap;
+	}
+}
+
+Cache::EffectCacheStats Cache::GetEffectCacheStats() {
+	auto stats = effect_stats;
+	stats.entries = cache_effects.size();
+	return stats;
 }
 
 void Cache::Clear() {
 	cache_effects.clear();
+	effect_pool.clear();
+	effect_stats.size = 0;
 	cache.clear();
 	cache_size = 0;
 
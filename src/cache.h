@@ -58,6 +58,25 @@ namespace Cache {
 	BitmapRef Tile(std::string_view filename, int tile_id);
 	BitmapRef SpriteEffect(const BitmapRef& src_bitmap, const Rect& rect, bool flip_x, bool flip_y, const Tone& tone, const Color& blend);
 
+	/** Statistics of the sprite effect cache */
+	struct EffectCacheStats {
+		/** Lookups answered by a cached bitmap */
+		uint64_t hits = 0;
+		/** Lookups which had to render the effect */
+		uint64_t misses = 0;
+		/** Misses which reused the memory of an evicted bitmap */
+		uint64_t recycled = 0;
+		/** Bitmaps removed to stay within the memory budget */
+		uint64_t evictions = 0;
+		/** Memory used by the cached bitmaps in bytes */
+		size_t size = 0;
+		/** Number of cached bitmaps */
+		size_t entries = 0;
+	};
+
+	/** @return statistics of the sprite effect cache */
+	EffectCacheStats GetEffectCacheStats();
+
 	void Clear();
 	void ClearAll();
 
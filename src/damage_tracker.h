@@ -0,0 +1,122 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_DAMAGE_TRACKER_H
+#define EP_DAMAGE_TRACKER_H
+
+// Headers
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "bitmap.h"
+#include "drawable.h"
+#include "memory_management.h"
+#include "rect.h"
+
+/**
+ * Helper for implementing Drawable::GetDamage.
+ *
+ * Records every value the Draw function of a drawable depends on and
+ * compares it with the values of the previous frame. When anything changed
+ * the bounds of the previous and of the current frame are damaged.
+ */
+class DamageTracker {
+public:
+	/**
+	 * Starts recording the state of the current frame.
+	 * The z value, visibility and render offset of the drawable are recorded
+	 * automatically.
+	 *
+	 * @param drawable drawable being tracked
+	 * @return this
+	 */
+	DamageTracker& Begin(const Drawable& drawable);
+
+	/**
+	 * Appends a value to the recorded state.
+	 * Values are compared bytewise.
+	 *
+	 * @param value value to record
+	 * @return this
+	 */
+	template <typename T>
+	DamageTracker& operator<<(const T& value);
+
+	/**
+	 * Appends a bitmap to the recorded state.
+	 * Modifying the pixels of the bitmap changes the state.
+	 *
+	 * @param bitmap bitmap to record, can be null
+	 * @return this
+	 */
+	DamageTracker& operator<<(const BitmapRef& bitmap);
+
+	/**
+	 * Finishes recording and compares against the previous frame.
+	 *
+	 * @param bounds screen area covered by the drawable in this frame
+	 * @return damaged area, empty when nothing changed
+	 */
+	Rect End(const Rect& bounds);
+
+private:
+	std::vector<uint8_t> state;
+	std::vector<uint8_t> last_state;
+	Rect last_bounds;
+	bool visible = false;
+	bool valid = false;
+};
+
+inline DamageTracker& DamageTracker::Begin(const Drawable& drawable) {
+	state.clear();
+	visible = drawable.IsVisible();
+	return *this << drawable.GetZ() << visible << drawable.GetRenderOx() << drawable.GetRenderOy();
+}
+
+template <typename T>
+inline DamageTracker& DamageTracker::operator<<(const T& value) {
+	static_assert(std::has_unique_object_representations<T>::value || std::is_floating_point<T>::value,
+		"Only types without padding can be compared bytewise");
+
+	auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+	state.insert(state.end(), bytes, bytes + sizeof(T));
+	return *this;
+}
+
+inline DamageTracker& DamageTracker::operator<<(const BitmapRef& bitmap) {
+	const Bitmap* ptr = bitmap.get();
+	return *this << ptr << (ptr ? ptr->GetRevision() : 0);
+}
+
+inline Rect DamageTracker::End(const Rect& bounds) {
+	const Rect current = visible ? bounds : Rect();
+
+	Rect damage;
+	if (!valid || state != last_state || current != last_bounds) {
+		damage = last_bounds.GetUnion(current);
+	}
+
+	// Swap instead of copy to reuse the allocated memory in the next frame
+	std::swap(state, last_state);
+	last_bounds = current;
+	valid = true;
+
+	return damage;
+}
+
+#endif
@@ -20,16 +20,40 @@
 #ifdef WANT_FMMIDI
 
 // Headers
+#include <algorithm>
 #include <cstdio>
 #include <cassert>
 #include "audio_decoder.h"
 #include "output.h"
 #include "decoder_fmmidi.h"
+#include "worker_pool.h"
+
+namespace {
+	/**
+	 * Pool rendering the notes of the synthesizers. It is separate from the
+	 * renderer pool, so that audio decoding never waits for a frame to draw.
+	 */
+	WorkerPool& GetSynthPool() {
+#if defined(EMSCRIPTEN) && !defined(__EMSCRIPTEN_PTHREADS__)
+		static WorkerPool pool(0);
+#else
+		static WorkerPool pool(std::clamp(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0, 3));
+#endif
+		return pool;
+	}
+}
 
 FmMidiDecoder::FmMidiDecoder() {
 	note_factory.reset(new midisynth::fm_note_factory());
 	synth.reset(new midisynth::synthesizer(note_factory.get()));
 
+	WorkerPool& pool = GetSynthPool();
+	if (pool.GetNumThreads() > 1) {
+		synth->set_parallel_for([&pool](int count, const std::function<void(int)>& func) {
+			pool.ParallelFor(count, func);
+		}, pool.GetNumThreads());
+	}
+
 	load_programs();
 }
 
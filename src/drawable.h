@@ -20,6 +20,7 @@
 
 #include <cstdint>
 #include <memory>
+#include "rect.h"
 
 class Bitmap;
 class Drawable;
@@ -44,6 +45,8 @@ public:
 		Shared = 2,
 		/** This flag indicates the drawable should not be drawn */
 		Invisible = 4,
+		/** Draw only records commands into the active SpriteBatch and never draws directly */
+		Batched = 8,
 		/** The default flag set */
 		Default = None
 	};
@@ -57,6 +60,17 @@ public:
 
 	virtual void Draw(Bitmap& dst) = 0;
 
+	/**
+	 * Reports the area of the screen which changed since the last call.
+	 * Called once per frame before drawing. Drawables which do not track
+	 * their state return false, this forces a redraw of the whole screen
+	 * while they are visible.
+	 *
+	 * @param damage set to the changed area, empty when nothing changed
+	 * @return true when the drawable tracks its damage
+	 */
+	virtual bool GetDamage(Rect& damage);
+
 	Z_t GetZ() const;
 
 	void SetZ(Z_t z);
@@ -70,6 +84,9 @@ public:
 	/** @return true if the drawable is currently visible */
 	bool IsVisible() const;
 
+	/** @return true if the drawable draws through the active SpriteBatch */
+	bool IsBatched() const;
+
 	/**
 	 * Set if the drawable should be visible
 	 *
@@ -142,6 +159,10 @@ inline Drawable::Drawable(Z_t z, Flags flags)
 {
 }
 
+inline bool Drawable::GetDamage(Rect& /* damage */) {
+	return false;
+}
+
 inline Drawable::Z_t Drawable::GetZ() const {
 	return _z;
 }
@@ -158,6 +179,10 @@ inline bool Drawable::IsVisible() const {
 	return !static_cast<bool>(_flags & Flags::Invisible);
 }
 
+inline bool Drawable::IsBatched() const {
+	return static_cast<bool>(_flags & Flags::Batched);
+}
+
 inline void Drawable::SetVisible(bool value) {
 	_flags = value ? _flags & ~Flags::Invisible : _flags | Flags::Invisible;
 }
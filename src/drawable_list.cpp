@@ -18,6 +18,7 @@
 // Headers
 #include "drawable_list.h"
 #include "drawable_mgr.h"
+#include "sprite_batch.h"
 #include <algorithm>
 #include <cassert>
 
@@ -33,6 +34,7 @@ DrawableList::~DrawableList() {
 
 void DrawableList::Clear() {
 	_list.clear();
+	++_generation;
 	SetClean();
 }
 
@@ -54,6 +56,7 @@ void DrawableList::Append(Drawable* ptr) {
 	const bool ordered = _list.empty() || !DrawCmp(ptr, _list.back());
 
 	_list.push_back(ptr);
+	++_generation;
 
 	if (!ordered) {
 		SetDirty();
@@ -69,6 +72,7 @@ Drawable* DrawableList::Take(Drawable* ptr) {
 	auto ret = *iter;
 	// FIXME: Can we remove this O(N) operation here?
 	_list.erase(iter);
+	++_generation;
 	return ret;
 
 	// Removing doesn't change sorted order, so not dirty flag.
@@ -86,6 +90,9 @@ void DrawableList::TakeFrom(DrawableList& other) noexcept {
 	_list.insert(_list.end(), olist.begin(), olist.end());
 	olist.clear();
 
+	++_generation;
+	++other._generation;
+
 	SetDirty();
 	other.SetClean();
 }
@@ -97,6 +104,8 @@ void DrawableList::Draw(Bitmap& dst, Drawable::Z_t min_z, Drawable::Z_t max_z) {
 		assert(IsSorted());
 	}
 
+	SpriteBatch batch(dst);
+
 	for (auto* drawable : _list) {
 		auto z = drawable->GetZ();
 		if (z < min_z) {
@@ -106,6 +115,10 @@ void DrawableList::Draw(Bitmap& dst, Drawable::Z_t min_z, Drawable::Z_t max_z) {
 			break;
 		}
 		if (drawable->IsVisible()) {
+			if (!drawable->IsBatched()) {
+				// Keep the drawing order: Draw recorded sprites before drawing directly
+				batch.Flush();
+			}
 			drawable->Draw(dst);
 		}
 	}
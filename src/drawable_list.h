@@ -92,6 +92,9 @@ class DrawableList {
 		/** Mark the list as dirty. It will be sorted the next time Draw() is called */
 		void SetDirty();
 
+		/** @return a counter which changes whenever drawables are added or removed */
+		uint32_t GetGeneration() const;
+
 		/** @return an iterator to the beginning */
 		iterator begin() const { return _list.begin(); }
 
@@ -133,6 +136,7 @@ class DrawableList {
 
 	private:
 		std::vector<Drawable*> _list;
+		uint32_t _generation = 0;
 		bool _dirty = false;
 
 		void SetClean();
@@ -169,6 +173,8 @@ void DrawableList::TakeFrom(DrawableList& other, F&& cond) noexcept {
 	}
 	olist.resize(olist.size() - shift);
 
+	++_generation;
+	++other._generation;
 	SetDirty();
 	if (olist.empty()) {
 		other.SetClean();
@@ -183,6 +189,10 @@ inline void DrawableList::SetDirty() {
 	_dirty = true;
 }
 
+inline uint32_t DrawableList::GetGeneration() const {
+	return _generation;
+}
+
 inline void DrawableList::SetClean() {
 	_dirty = false;
 }
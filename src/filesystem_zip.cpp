@@ -28,6 +28,8 @@
 #include <sstream>
 #include <cassert>
 #include <algorithm>
+#include <limits>
+#include <memory>
 #include <fmt/format.h>
 
 constexpr char end_of_central_directory[] = "\x50\x4b\x05\x06";
@@ -52,6 +54,277 @@ static std::string normalize_path(std::string_view path) {
 	return inner_path;
 }
 
+namespace {
+	/** Entries up to this size are read into memory, larger entries are streamed */
+	constexpr uint32_t stream_threshold = 64 * 1024;
+	/** A copy of the inflate state is kept every time this amount of data was inflated */
+	constexpr uint32_t inflate_checkpoint_interval = 1024 * 1024;
+
+	/**
+	 * Streambuf reading a window of a ZIP archive stream.
+	 * Seeking is lazy: Only the read position changes, the subclass fetches on underflow.
+	 */
+	class ZipEntryStreamBuf : public std::streambuf {
+	public:
+		ZipEntryStreamBuf(Filesystem_Stream::InputStream is, uint32_t offset, uint32_t size, size_t buffer_size)
+			: is(std::move(is)), offset(offset), size(size), buffer(buffer_size) {
+			setg(buffer.data(), buffer.data(), buffer.data());
+		}
+
+	protected:
+		pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode mode) override {
+			if (dir == std::ios_base::cur) {
+				off += Tell();
+			} else if (dir == std::ios_base::end) {
+				off += size;
+			}
+			return seekpos(off, mode);
+		}
+
+		pos_type seekpos(pos_type pos, std::ios_base::openmode) override {
+			auto target = static_cast<uint32_t>(Utils::Clamp<std::streamoff>(pos, 0, size));
+			if (target >= buffer_start && target <= buffer_start + (egptr() - eback())) {
+				setg(eback(), eback() + (target - buffer_start), egptr());
+			} else {
+				buffer_start = target;
+				setg(buffer.data(), buffer.data(), buffer.data());
+			}
+			return pos_type(target);
+		}
+
+		/** @return position of gptr in the entry */
+		uint32_t Tell() const {
+			return buffer_start + static_cast<uint32_t>(gptr() - eback());
+		}
+
+		/** Makes the buffer contain [start, start + len) with gptr at pos */
+		int_type SetBuffer(uint32_t start, size_t len, uint32_t pos) {
+			buffer_start = start;
+			setg(buffer.data(), buffer.data() + (pos - start), buffer.data() + len);
+			return traits_type::to_int_type(*gptr());
+		}
+
+		Filesystem_Stream::InputStream is;
+		uint32_t offset;
+		uint32_t size;
+		std::vector<char> buffer;
+		/** Position in the entry of the first byte in buffer */
+		uint32_t buffer_start = 0;
+	};
+
+	/** Stored entry: Reads directly from the archive, large reads bypass the buffer */
+	class ZipStoredStreamBuf final : public ZipEntryStreamBuf {
+	public:
+		ZipStoredStreamBuf(Filesystem_Stream::InputStream is, uint32_t offset, uint32_t size)
+			: ZipEntryStreamBuf(std::move(is), offset, size, 16 * 1024) {}
+
+	protected:
+		int_type underflow() override {
+			if (gptr() < egptr()) {
+				return traits_type::to_int_type(*gptr());
+			}
+			uint32_t pos = Tell();
+			size_t len = Read(buffer.data(), pos, buffer.size());
+			if (len == 0) {
+				return traits_type::eof();
+			}
+			return SetBuffer(pos, len, pos);
+		}
+
+		std::streamsize xsgetn(char* s, std::streamsize n) override {
+			std::streamsize avail = egptr() - gptr();
+			if (n <= avail || n - avail < static_cast<std::streamsize>(buffer.size())) {
+				return std::streambuf::xsgetn(s, n);
+			}
+
+			// Copy what is buffered, read the rest directly into the destination
+			std::copy(gptr(), egptr(), s);
+			uint32_t pos = Tell() + static_cast<uint32_t>(avail);
+			size_t len = Read(s + avail, pos, static_cast<size_t>(n - avail));
+			buffer_start = pos + static_cast<uint32_t>(len);
+			setg(buffer.data(), buffer.data(), buffer.data());
+			return avail + static_cast<std::streamsize>(len);
+		}
+
+	private:
+		size_t Read(char* dst, uint32_t pos, size_t len) {
+			len = std::min<size_t>(len, size - pos);
+			if (len == 0) {
+				return 0;
+			}
+			if (pos != file_pos) {
+				is.clear();
+				is.seekg(offset + pos);
+			}
+			is.read(dst, len);
+			len = static_cast<size_t>(is.gcount());
+			file_pos = pos + static_cast<uint32_t>(len);
+			return len;
+		}
+
+		/** Position in the entry the archive stream is at */
+		uint32_t file_pos = std::numeric_limits<uint32_t>::max();
+	};
+
+	/**
+	 * Deflate entry: Inflates into a bounded buffer.
+	 * Forward seeks inflate and discard, backward seeks resume from the nearest
+	 * checkpoint (a copy of the inflate state) or restart the stream.
+	 */
+	class ZipInflateStreamBuf final : public ZipEntryStreamBuf {
+	public:
+		ZipInflateStreamBuf(Filesystem_Stream::InputStream is, uint32_t offset, uint32_t compressed_size, uint32_t size, std::string name)
+			: ZipEntryStreamBuf(std::move(is), offset, size, 32 * 1024), compressed_size(compressed_size), in_buffer(16 * 1024), name(std::move(name)) {
+			valid = inflateInit2(&zlib_stream, -MAX_WBITS) == Z_OK;
+			this->is.seekg(offset);
+		}
+
+		~ZipInflateStreamBuf() override {
+			if (valid) {
+				inflateEnd(&zlib_stream);
+			}
+			for (auto& cp: checkpoints) {
+				inflateEnd(&cp->zlib_stream);
+			}
+		}
+
+		bool IsValid() const {
+			return valid;
+		}
+
+	protected:
+		int_type underflow() override {
+			if (gptr() < egptr()) {
+				return traits_type::to_int_type(*gptr());
+			}
+			uint32_t pos = Tell();
+			if (!valid || pos >= size) {
+				return traits_type::eof();
+			}
+
+			// Resume from a checkpoint when seeking backwards or far ahead
+			auto cp = std::upper_bound(checkpoints.begin(), checkpoints.end(), pos, [](uint32_t p, const auto& c) {
+				return p < c->out_pos;
+			});
+			const Checkpoint* resume = cp == checkpoints.begin() ? nullptr : std::prev(cp)->get();
+			if (pos < out_pos || (resume && resume->out_pos > out_pos)) {
+				if (!Rewind(resume)) {
+					return traits_type::eof();
+				}
+			}
+
+			while (true) {
+				uint32_t start = out_pos;
+				size_t len = Inflate();
+				if (len == 0) {
+					return traits_type::eof();
+				}
+				if (out_pos > pos) {
+					return SetBuffer(start, len, pos);
+				}
+			}
+		}
+
+	private:
+		/** Allocated separately: zlib rejects a z_stream that was moved in memory */
+		struct Checkpoint {
+			z_stream zlib_stream;
+			/** Compressed bytes consumed */
+			uint32_t in_pos;
+			/** Uncompressed position */
+			uint32_t out_pos;
+		};
+
+		/** Inflates the next chunk into the buffer, @return amount of bytes inflated */
+		size_t Inflate() {
+			zlib_stream.next_out = reinterpret_cast<Bytef*>(buffer.data());
+			zlib_stream.avail_out = static_cast<uInt>(buffer.size());
+
+			while (zlib_stream.avail_out > 0 && out_pos + (buffer.size() - zlib_stream.avail_out) < size) {
+				if (zlib_stream.avail_in == 0) {
+					size_t len = std::min<size_t>(in_buffer.size(), compressed_size - in_pos);
+					is.read(in_buffer.data(), len);
+					len = static_cast<size_t>(is.gcount());
+					if (len == 0) {
+						Fail("Unexpected end of data (Archive corrupted?)");
+						break;
+					}
+					in_pos += static_cast<uint32_t>(len);
+					zlib_stream.next_in = reinterpret_cast<Bytef*>(in_buffer.data());
+					zlib_stream.avail_in = static_cast<uInt>(len);
+				}
+
+				int zlib_error = inflate(&zlib_stream, Z_NO_FLUSH);
+				if (zlib_error == Z_STREAM_END) {
+					break;
+				} else if (zlib_error != Z_OK) {
+					Fail(fmt::format("{} ({})", zlib_error, zlib_stream.msg ? zlib_stream.msg : "No error message"));
+					break;
+				}
+			}
+
+			size_t len = buffer.size() - zlib_stream.avail_out;
+			out_pos += static_cast<uint32_t>(len);
+
+			uint32_t last_checkpoint = checkpoints.empty() ? 0 : checkpoints.back()->out_pos;
+			if (valid && out_pos < size && out_pos >= last_checkpoint + inflate_checkpoint_interval) {
+				AddCheckpoint();
+			}
+
+			return len;
+		}
+
+		void AddCheckpoint() {
+			auto cp = std::make_unique<Checkpoint>();
+			if (inflateCopy(&cp->zlib_stream, &zlib_stream) != Z_OK) {
+				return;
+			}
+			// The copy continues reading the archive after the consumed data
+			cp->zlib_stream.next_in = nullptr;
+			cp->zlib_stream.avail_in = 0;
+			cp->in_pos = in_pos - zlib_stream.avail_in;
+			cp->out_pos = out_pos;
+			checkpoints.push_back(std::move(cp));
+		}
+
+		/** Restarts inflating at the checkpoint or at the beginning when cp is null */
+		bool Rewind(const Checkpoint* cp) {
+			if (cp) {
+				inflateEnd(&zlib_stream);
+				valid = inflateCopy(&zlib_stream, const_cast<z_stream*>(&cp->zlib_stream)) == Z_OK;
+				in_pos = cp->in_pos;
+				out_pos = cp->out_pos;
+			} else {
+				valid = inflateReset(&zlib_stream) == Z_OK;
+				in_pos = 0;
+				out_pos = 0;
+			}
+			zlib_stream.next_in = nullptr;
+			zlib_stream.avail_in = 0;
+			is.clear();
+			is.seekg(offset + in_pos);
+			return valid;
+		}
+
+		void Fail(std::string_view msg) {
+			Output::Warning("ZipFS: zlib failed for {}: {}", name, msg);
+			inflateEnd(&zlib_stream);
+			valid = false;
+		}
+
+		z_stream zlib_stream = {};
+		bool valid = false;
+		uint32_t compressed_size;
+		/** Compressed bytes read from the archive */
+		uint32_t in_pos = 0;
+		/** Uncompressed bytes inflated */
+		uint32_t out_pos = 0;
+		std::vector<char> in_buffer;
+		std::vector<std::unique_ptr<Checkpoint>> checkpoints;
+		std::string name;
+	};
+}
+
 ZipFilesystem::ZipFilesystem(std::string base_path, FilesystemView parent_fs, std::string_view enc) :
 	Filesystem(base_path, parent_fs) {
 	zip_is = parent_fs.OpenInputStream(GetPath());
@@ -394,7 +667,27 @@ std::streambuf* ZipFilesystem::CreateInputStreambuffer(std::string_view path, st
 				return nullptr;
 			}
 
-			zip_is.seekg(central_entry->fileoffset + local_entry.fileoffset);
+			uint32_t data_offset = central_entry->fileoffset + local_entry.fileoffset;
+			if (local_entry.uncompressed_size > stream_threshold &&
+					(method == StorageMethod::Plain || method == StorageMethod::Deflate)) {
+				// Large entries (e.g. music) are streamed with their own handle on the archive
+				auto is = GetParent().OpenInputStream(GetPath());
+				if (!is) {
+					Output::Warning("ZipFS: Reopening archive failed for {}", path_normalized);
+					return nullptr;
+				}
+				if (method == StorageMethod::Plain) {
+					return new ZipStoredStreamBuf(std::move(is), data_offset, local_entry.uncompressed_size);
+				}
+				auto buf = std::make_unique<ZipInflateStreamBuf>(std::move(is), data_offset, local_entry.compressed_size, local_entry.uncompressed_size, path_normalized);
+				if (!buf->IsValid()) {
+					Output::Warning("ZipFS: zlib init failed for {}", path_normalized);
+					return nullptr;
+				}
+				return buf.release();
+			}
+
+			zip_is.seekg(data_offset);
 			if (method == StorageMethod::Plain) {
 				auto data = std::vector<uint8_t>(local_entry.uncompressed_size);
 				zip_is.read(reinterpret_cast<char*>(data.data()), data.size());
@@ -15,6 +15,7 @@
  * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <sstream>
 
 #include "fps_overlay.h"
@@ -24,6 +25,9 @@
 #include "input.h"
 #include "font.h"
 #include "drawable_mgr.h"
+#include "instrumentation.h"
+#include "player.h"
+#include <fmt/format.h>
 
 using namespace std::chrono_literals;
 
@@ -40,7 +44,26 @@ FpsOverlay::FpsOverlay() :
 void FpsOverlay::UpdateText() {
 	auto fps = Utils::RoundTo<int>(Game_Clock::GetFPS());
 	text = "FPS: " + std::to_string(fps);
+	if (Game_Clock::IsTurboMode()) {
+		auto lps = Utils::RoundTo<int>(Game_Clock::GetLogicFPS());
+		text += " LPS: " + std::to_string(lps);
+	}
 	fps_dirty = true;
+
+	if (Instrumentation::IsProfilerEnabled()) {
+		std::chrono::microseconds frame_time;
+		auto summary = Instrumentation::GetSummary(frame_time);
+
+		profiler_text.clear();
+		profiler_text.push_back(fmt::format("Frame {:.2f}ms", frame_time.count() / 1000.0));
+		for (auto& zone: summary) {
+			profiler_text.push_back(fmt::format("{:{}}{} {:.2f}ms", "", zone.depth * 2 + 1, zone.name, zone.time.count() / 1000.0));
+		}
+		profiler_dirty = true;
+	} else if (!profiler_text.empty()) {
+		profiler_text.clear();
+		profiler_dirty = true;
+	}
 }
 
 bool FpsOverlay::Update() {
@@ -62,6 +85,35 @@ bool FpsOverlay::Update() {
 	return true;
 }
 
+bool FpsOverlay::GetDamage(Rect& damage) {
+	const bool draw_profiler = draw_fps && !profiler_text.empty();
+	const bool draw_speedup = last_speed_mod > 1;
+
+	damage_tracker.Begin(*this) << draw_fps << draw_profiler << draw_speedup
+		<< fps_dirty << profiler_dirty << speedup_dirty
+		<< fps_bitmap << profiler_bitmap << speedup_bitmap
+		<< fps_rect << profiler_rect << speedup_rect;
+
+	Rect bounds;
+	if (fps_dirty || profiler_dirty || speedup_dirty) {
+		// The size of the text is only known after drawing it
+		bounds = Rect(0, 0, Player::screen_width, Player::screen_height);
+	} else {
+		if (draw_fps) {
+			bounds = bounds.GetUnion(Rect(1, 2, fps_rect.width, fps_rect.height));
+		}
+		if (draw_profiler) {
+			bounds = bounds.GetUnion(Rect(1, 2 + fps_rect.height + 1, profiler_rect.width, profiler_rect.height));
+		}
+		if (draw_speedup) {
+			bounds = bounds.GetUnion(Rect(Player::screen_width - speedup_rect.width - 1, 2, speedup_rect.width, speedup_rect.height));
+		}
+	}
+
+	damage = damage_tracker.End(bounds);
+	return true;
+}
+
 void FpsOverlay::Draw(Bitmap& dst) {
 	if (draw_fps) {
 		if (fps_dirty) {
@@ -82,6 +134,29 @@ void FpsOverlay::Draw(Bitmap& dst) {
 		}
 
 		dst.Blit(1, 2, *fps_bitmap, fps_rect, 255);
+
+		if (!profiler_text.empty()) {
+			if (profiler_dirty) {
+				const int line_height = fps_rect.height;
+				int width = 0;
+				for (auto& line: profiler_text) {
+					width = std::max(width, Text::GetSize(*Font::DefaultBitmapFont(), line).width + 1);
+				}
+
+				profiler_bitmap = Bitmap::Create(width, line_height * static_cast<int>(profiler_text.size()), true);
+				profiler_bitmap->Fill(Color(0, 0, 0, 128));
+				int y = 0;
+				for (auto& line: profiler_text) {
+					Text::Draw(*profiler_bitmap, 1, y, *Font::DefaultBitmapFont(), Color(255, 255, 255, 255), line);
+					y += line_height;
+				}
+
+				profiler_rect = profiler_bitmap->GetRect();
+				profiler_dirty = false;
+			}
+
+			dst.Blit(1, 2 + fps_rect.height + 1, *profiler_bitmap, profiler_rect, 255);
+		}
 	}
 
 	// Always drawn when speedup is on independent of FPS
@@ -20,6 +20,8 @@
 
 #include <deque>
 #include <string>
+#include <vector>
+#include "damage_tracker.h"
 #include "drawable.h"
 #include "memory_management.h"
 #include "rect.h"
@@ -35,6 +37,8 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	bool GetDamage(Rect& damage) override;
+
 	/**
 	 * Update the fps overlay.
 	 *
@@ -61,18 +65,25 @@ private:
 
 	BitmapRef fps_bitmap;
 	BitmapRef speedup_bitmap;
+	BitmapRef profiler_bitmap;
 	Game_Clock::time_point last_refresh_time;
 
 	/** Rect to draw on screen */
 	Rect fps_rect;
 	Rect speedup_rect;
+	Rect profiler_rect;
 
 	std::string text;
+	/** Lines of the profiler summary, empty when the profiler is disabled */
+	std::vector<std::string> profiler_text;
 
 	int last_speed_mod = 1;
 	bool speedup_dirty = true;
 	bool fps_dirty = true;
+	bool profiler_dirty = false;
 	bool draw_fps = true;
+
+	DamageTracker damage_tracker;
 };
 
 inline std::string FpsOverlay::GetFpsString() const {
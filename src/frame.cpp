@@ -47,6 +47,13 @@ void Frame::Draw(Bitmap& dst) {
 	}
 }
 
+bool Frame::GetDamage(Rect& damage) {
+	damage_tracker.Begin(*this) << frame_bitmap;
+
+	damage = damage_tracker.End(frame_bitmap ? frame_bitmap->GetRect() : Rect());
+	return true;
+}
+
 void Frame::OnFrameGraphicReady(FileRequestResult* result) {
 	frame_bitmap = Cache::Frame(result->file);
 }
@@ -20,6 +20,7 @@
 
 // Headers
 #include <string>
+#include "damage_tracker.h"
 #include "drawable.h"
 #include "system.h"
 #include "async_handler.h"
@@ -32,6 +33,7 @@ public:
 	Frame();
 
 	void Draw(Bitmap& dst) override;
+	bool GetDamage(Rect& damage) override;
 	void Update();
 
 private:
@@ -39,6 +41,8 @@ private:
 
 	BitmapRef frame_bitmap;
 
+	DamageTracker damage_tracker;
+
 	FileRequestBinding request_id;
 };
 
@@ -41,6 +41,10 @@ Game_Character::Game_Character(Type type, lcf::rpg::SaveMapEventBase* d) :
 {
 }
 
+void Game_Character::OnEventPositionChanged() {
+	Game_Map::OnEventPositionChanged(static_cast<Game_Event&>(*this));
+}
+
 void Game_Character::SanitizeData(std::string_view name) {
 	SanitizeMoveRoute(name, data()->move_route, data()->move_route_index, "move_route_index");
 }
@@ -943,6 +943,8 @@ protected:
 	void IncAnimFrame();
 	void UpdateFlash();
 	bool BeginMoveRouteJump(int32_t& current_index, const lcf::rpg::MoveRoute& current_route);
+	/** Keeps the tile index of Game_Map in sync, called by SetX and SetY of events */
+	void OnEventPositionChanged();
 
 	lcf::rpg::SaveMapEventBase* data();
 	const lcf::rpg::SaveMapEventBase* data() const;
@@ -1000,6 +1002,9 @@ inline int Game_Character::GetX() const {
 
 inline void Game_Character::SetX(int new_x) {
 	data()->position_x = new_x;
+	if (GetType() == Event) {
+		OnEventPositionChanged();
+	}
 }
 
 inline int Game_Character::GetY() const {
@@ -1008,6 +1013,9 @@ inline int Game_Character::GetY() const {
 
 inline void Game_Character::SetY(int new_y) {
 	data()->position_y = new_y;
+	if (GetType() == Event) {
+		OnEventPositionChanged();
+	}
 }
 
 inline int Game_Character::GetMapId() const {
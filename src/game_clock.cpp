@@ -32,14 +32,32 @@ Game_Clock::duration Game_Clock::OnNextFrame(time_point now) {
 
 	const auto dt = now - data.frame_time;
 	data.frame_time = now;
-	data.frame_accumulator += std::chrono::duration_cast<duration>(dt * data.speed);
-	data.frame_accumulator = std::min(data.frame_accumulator, mfa);
+	if (data.turbo_steps > 0) {
+		// Turbo: Fixed batch of steps, not limited by the max game time per frame
+		data.frame_accumulator = GetTargetGameTimeStep() * data.turbo_steps;
+	} else {
+		if (data.fixed_step) {
+			data.frame_accumulator += std::chrono::duration_cast<duration>(GetTargetGameTimeStep() * data.speed);
+		} else {
+			data.frame_accumulator += std::chrono::duration_cast<duration>(dt * data.speed);
+		}
+		data.frame_accumulator = std::min(data.frame_accumulator, mfa);
+	}
 
 	const auto fps = (1.0f / std::chrono::duration<float>(dt).count());
 	data.fps = (data.fps * _fps_smooth) + (fps * (1.0f - _fps_smooth));
 
 	++data.frame;
 
+	const auto counter_dt = std::chrono::duration<float>(now - data.counter_time).count();
+	if (counter_dt >= 1.0f) {
+		data.logic_fps = data.logic_frames / counter_dt;
+		data.render_fps = data.render_frames / counter_dt;
+		data.logic_frames = 0;
+		data.render_frames = 0;
+		data.counter_time = now;
+	}
+
 	return dt;
 }
 
@@ -47,6 +65,9 @@ void Game_Clock::ResetFrame(time_point now, bool reset_frame_counter) {
 	data.frame_time = now;
 	data.frame_accumulator = {};
 	data.fps = 0.0;
+	data.counter_time = now;
+	data.logic_frames = 0;
+	data.render_frames = 0;
 	if (reset_frame_counter) {
 		data.frame = 0;
 	}
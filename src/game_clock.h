@@ -76,6 +76,42 @@ public:
 	/** @return the speed up or slowdown factor we'll use to run the game. */
 	static float GetGameSpeedFactor();
 
+	/**
+	 * Enable or disable fixed time stepping. When enabled, each frame advances
+	 * the simulation by exactly one logical time step (multiplied by the speed
+	 * factor) instead of the real time that has passed.
+	 *
+	 * @param enabled whether to use fixed time stepping
+	 */
+	static void SetFixedTimeStep(bool enabled);
+
+	/** @return whether fixed time stepping is enabled */
+	static bool IsFixedTimeStep();
+
+	/**
+	 * Enable or disable turbo mode. In turbo mode each frame runs exactly the
+	 * given amount of logical time steps back-to-back, independent of the real
+	 * time that has passed and of the speed factor.
+	 *
+	 * @param steps_per_frame logical steps per frame, 0 disables turbo mode
+	 */
+	static void SetTurboMode(int steps_per_frame);
+
+	/** @return whether turbo mode is enabled */
+	static bool IsTurboMode();
+
+	/** Call after each logical frame. Used for the logic frames per second counter. */
+	static void OnLogicFrame();
+
+	/** Call after each rendered frame. Used for the render frames per second counter. */
+	static void OnRenderFrame();
+
+	/** @return the measured logical frames per second */
+	static float GetLogicFPS();
+
+	/** @return the measured rendered frames per second */
+	static float GetRenderFPS();
+
 	/** Get the time of the current frame */
 	static time_point GetFrameTime();
 
@@ -117,6 +153,14 @@ private:
 		float speed = 1.0;
 		float fps = 0.0;
 		int frame = 0;
+		bool fixed_step = false;
+		int turbo_steps = 0;
+
+		time_point counter_time;
+		int logic_frames = 0;
+		int render_frames = 0;
+		float logic_fps = 0.0;
+		float render_fps = 0.0;
 	};
 	static Data data;
 };
@@ -180,4 +224,36 @@ inline float Game_Clock::GetGameSpeedFactor() {
 	return data.speed;
 }
 
+inline void Game_Clock::SetFixedTimeStep(bool enabled) {
+	data.fixed_step = enabled;
+}
+
+inline bool Game_Clock::IsFixedTimeStep() {
+	return data.fixed_step;
+}
+
+inline void Game_Clock::SetTurboMode(int steps_per_frame) {
+	data.turbo_steps = std::max(steps_per_frame, 0);
+}
+
+inline bool Game_Clock::IsTurboMode() {
+	return data.turbo_steps > 0;
+}
+
+inline void Game_Clock::OnLogicFrame() {
+	++data.logic_frames;
+}
+
+inline void Game_Clock::OnRenderFrame() {
+	++data.render_frames;
+}
+
+inline float Game_Clock::GetLogicFPS() {
+	return data.logic_fps;
+}
+
+inline float Game_Clock::GetRenderFPS() {
+	return data.render_fps;
+}
+
 #endif
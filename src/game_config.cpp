@@ -613,6 +613,8 @@ void Game_Config::LoadFromStream(Filesystem_Stream::InputStream& is) {
 	audio.wildmidi_midi.FromIni(ini);
 	audio.native_midi.FromIni(ini);
 	audio.soundfont.FromIni(ini);
+	audio.se_cache_size.FromIni(ini);
+	audio.se_preload.FromIni(ini);
 
 	/** INPUT SECTION */
 	input.buttons = Input::GetDefaultButtonMappings();
@@ -714,6 +716,8 @@ void Game_Config::WriteToStream(Filesystem_Stream::OutputStream& os) const {
 	audio.wildmidi_midi.ToIni(os);
 	audio.native_midi.ToIni(os);
 	audio.soundfont.ToIni(os);
+	audio.se_cache_size.ToIni(os);
+	audio.se_preload.ToIni(os);
 
 	os << "\n";
 
@@ -152,6 +152,8 @@ struct Game_ConfigAudio {
 	BoolConfigParam native_midi { "Native MIDI", "Play MIDI through the operating system ", "Audio", "NativeMidi", true };
 	LockedConfigParam<std::string> fmmidi_midi { "FmMidi", "Play MIDI using the built-in MIDI synthesizer", "[Always ON]" };
 	PathConfigParam soundfont { "Soundfont", "Soundfont to use for " EP_FLUID_NAME, "Audio", "Soundfont", "" };
+	RangeConfigParam<int> se_cache_size { "SE Cache Size", "Memory for decoded sound effects (MiB)", "Audio", "SeCacheSize", 16, 1, 1024 };
+	BoolConfigParam se_preload { "Preload SE", "Decode the sound effects of the database when the game starts", "Audio", "SePreload", false };
 
 	void Hide();
 };
@@ -71,6 +71,7 @@
 #include "baseui.h"
 #include "algo.h"
 #include "rand.h"
+#include "instrumentation.h"
 
 using namespace Game_Interpreter_Shared;
 
@@ -78,6 +79,12 @@ enum BranchSubcommand {
 	eOptionBranchElse = 1
 };
 
+namespace {
+	// Special values of FrameProgram::jump_targets
+	constexpr int jump_unresolved = -1;
+	constexpr int jump_invalid = -2;
+}
+
 Game_Interpreter::Game_Interpreter(bool _main_flag) {
 	main_flag = _main_flag;
 
@@ -90,6 +97,7 @@ Game_Interpreter::~Game_Interpreter() {
 // Clear.
 void Game_Interpreter::Clear() {
 	_state = {};
+	_frame_programs.clear();
 	_keyinput = {};
 	_async_op = {};
 }
@@ -130,6 +138,11 @@ void Game_Interpreter::Push(
 	}
 
 	_state.stack.push_back(std::move(frame));
+
+	// Discard the program of a previous frame at this depth
+	if (_frame_programs.size() >= _state.stack.size()) {
+		_frame_programs[_state.stack.size() - 1] = {};
+	}
 }
 
 
@@ -360,6 +373,8 @@ int Game_Interpreter::GetSubcommandIndex(int indent) const {
 
 // Update
 void Game_Interpreter::Update(bool reset_loop_count) {
+	Instrumentation::ZoneScope zone("Game_Interpreter::Update");
+
 	if (reset_loop_count) {
 		loop_count = 0;
 	}
@@ -568,6 +583,12 @@ void Game_Interpreter::SkipToNextConditional(std::initializer_list<Cmd> codes, i
 		return;
 	}
 
+	auto& target = GetFrameProgram().jump_targets[index];
+	if (target != jump_unresolved) {
+		index = target;
+		return;
+	}
+
 	for (++index; index < static_cast<int>(list.size()); ++index) {
 		const auto& com = list[index];
 		if (com.indent > indent) {
@@ -577,232 +598,263 @@ void Game_Interpreter::SkipToNextConditional(std::initializer_list<Cmd> codes, i
 			break;
 		}
 	}
+	target = index;
 }
 
 // Execute Command.
 bool Game_Interpreter::ExecuteCommand() {
 	auto& frame = GetFrame();
 	const auto& com = frame.commands[frame.current_command];
-	return ExecuteCommand(com);
+
+	auto& handler = GetFrameProgram().handlers[frame.current_command];
+	if (!handler) {
+		handler = ResolveCommand(static_cast<Cmd>(com.code));
+	}
+
+	// Copy: The handler can push a frame which reallocates the programs
+	const auto fn = handler;
+	return fn(*this, com);
 }
 
 bool Game_Interpreter::ExecuteCommand(lcf::rpg::EventCommand const& com) {
-	switch (static_cast<Cmd>(com.code)) {
+	return ResolveCommand(static_cast<Cmd>(com.code))(*this, com);
+}
+
+Game_Interpreter::FrameProgram& Game_Interpreter::GetFrameProgram() {
+	auto& frame = GetFrame();
+	const size_t depth = _state.stack.size() - 1;
+	if (_frame_programs.size() <= depth) {
+		_frame_programs.resize(depth + 1);
+	}
+
+	auto& program = _frame_programs[depth];
+	if (program.commands != frame.commands.data() || program.handlers.size() != frame.commands.size()) {
+		program.commands = frame.commands.data();
+		program.handlers.assign(frame.commands.size(), nullptr);
+		program.jump_targets.assign(frame.commands.size(), jump_unresolved);
+		program.labels.clear();
+		program.labels_built = false;
+	}
+	return program;
+}
+
+Game_Interpreter::CommandHandler Game_Interpreter::ResolveCommand(Cmd code) const {
+	switch (code) {
 		case Cmd::ShowMessage:
-			return CmdSetup<&Game_Interpreter::CommandShowMessage, 0>(com);
+			return &CmdHandler<&Game_Interpreter::CommandShowMessage, 0>;
 		case Cmd::MessageOptions:
-			return CmdSetup<&Game_Interpreter::CommandMessageOptions, 4>(com);
+			return &CmdHandler<&Game_Interpreter::CommandMessageOptions, 4>;
 		case Cmd::ChangeFaceGraphic:
-			return CmdSetup<&Game_Interpreter::CommandChangeFaceGraphic, 3>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeFaceGraphic, 3>;
 		case Cmd::ShowChoice:
-			return CmdSetup<&Game_Interpreter::CommandShowChoices, 1>(com);
+			return &CmdHandler<&Game_Interpreter::CommandShowChoices, 1>;
 		case Cmd::ShowChoiceOption:
-			return CmdSetup<&Game_Interpreter::CommandShowChoiceOption, 1>(com);
+			return &CmdHandler<&Game_Interpreter::CommandShowChoiceOption, 1>;
 		case Cmd::ShowChoiceEnd:
-			return CmdSetup<&Game_Interpreter::CommandShowChoiceEnd, 0>(com);
+			return &CmdHandler<&Game_Interpreter::CommandShowChoiceEnd, 0>;
 		case Cmd::InputNumber:
-			return CmdSetup<&Game_Interpreter::CommandInputNumber, 2>(com);
+			return &CmdHandler<&Game_Interpreter::CommandInputNumber, 2>;
 		case Cmd::ControlSwitches:
-			return CmdSetup<&Game_Interpreter::CommandControlSwitches, 4>(com);
+			return &CmdHandler<&Game_Interpreter::CommandControlSwitches, 4>;
 		case Cmd::ControlVars:
-			return CmdSetup<&Game_Interpreter::CommandControlVariables, 7>(com);
+			return &CmdHandler<&Game_Interpreter::CommandControlVariables, 7>;
 		case Cmd::TimerOperation:
-			return CmdSetup<&Game_Interpreter::CommandTimerOperation, 5>(com);
+			return &CmdHandler<&Game_Interpreter::CommandTimerOperation, 5>;
 		case Cmd::ChangeGold:
-			return CmdSetup<&Game_Interpreter::CommandChangeGold, 3>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeGold, 3>;
 		case Cmd::ChangeItems:
-			return CmdSetup<&Game_Interpreter::CommandChangeItems, 5>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeItems, 5>;
 		case Cmd::ChangePartyMembers:
-			return CmdSetup<&Game_Interpreter::CommandChangePartyMember, 3>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangePartyMember, 3>;
 		case Cmd::ChangeExp:
-			return CmdSetup<&Game_Interpreter::CommandChangeExp, 6>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeExp, 6>;
 		case Cmd::ChangeLevel:
-			return CmdSetup<&Game_Interpreter::CommandChangeLevel, 6>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeLevel, 6>;
 		case Cmd::ChangeParameters:
-			return CmdSetup<&Game_Interpreter::CommandChangeParameters, 6>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeParameters, 6>;
 		case Cmd::ChangeSkills:
-			return CmdSetup<&Game_Interpreter::CommandChangeSkills, 5>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeSkills, 5>;
 		case Cmd::ChangeEquipment:
-			return CmdSetup<&Game_Interpreter::CommandChangeEquipment, 5>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeEquipment, 5>;
 		case Cmd::ChangeHP:
-			return CmdSetup<&Game_Interpreter::CommandChangeHP, 6>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeHP, 6>;
 		case Cmd::ChangeSP:
-			return CmdSetup<&Game_Interpreter::CommandChangeSP, 5>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeSP, 5>;
 		case Cmd::ChangeCondition:
-			return CmdSetup<&Game_Interpreter::CommandChangeCondition, 4>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeCondition, 4>;
 		case Cmd::FullHeal:
-			return CmdSetup<&Game_Interpreter::CommandFullHeal, 2>(com);
+			return &CmdHandler<&Game_Interpreter::CommandFullHeal, 2>;
 		case Cmd::SimulatedAttack:
-			return CmdSetup<&Game_Interpreter::CommandSimulatedAttack, 8>(com);
+			return &CmdHandler<&Game_Interpreter::CommandSimulatedAttack, 8>;
 		case Cmd::Wait:
-			return CmdSetup<&Game_Interpreter::CommandWait, 1>(com);
+			return &CmdHandler<&Game_Interpreter::CommandWait, 1>;
 		case Cmd::PlayBGM:
-			return CmdSetup<&Game_Interpreter::CommandPlayBGM, 4>(com);
+			return &CmdHandler<&Game_Interpreter::CommandPlayBGM, 4>;
 		case Cmd::FadeOutBGM:
-			return CmdSetup<&Game_Interpreter::CommandFadeOutBGM, 1>(com);
+			return &CmdHandler<&Game_Interpreter::CommandFadeOutBGM, 1>;
 		case Cmd::PlaySound:
-			return CmdSetup<&Game_Interpreter::CommandPlaySound, 3>(com);
+			return &CmdHandler<&Game_Interpreter::CommandPlaySound, 3>;
 		case Cmd::EndEventProcessing:
-			return CmdSetup<&Game_Interpreter::CommandEndEventProcessing, 0>(com);
+			return &CmdHandler<&Game_Interpreter::CommandEndEventProcessing, 0>;
 		case Cmd::Comment:
 		case Cmd::Comment_2:
-			return CmdSetup<&Game_Interpreter::CommandComment, 0>(com);
+			return &CmdHandler<&Game_Interpreter::CommandComment, 0>;
 		case Cmd::GameOver:
-			return CmdSetup<&Game_Interpreter::CommandGameOver, 0>(com);
+			return &CmdHandler<&Game_Interpreter::CommandGameOver, 0>;
 		case Cmd::ChangeHeroName:
-			return CmdSetup<&Game_Interpreter::CommandChangeHeroName, 1>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeHeroName, 1>;
 		case Cmd::ChangeHeroTitle:
-			return CmdSetup<&Game_Interpreter::CommandChangeHeroTitle, 1>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeHeroTitle, 1>;
 		case Cmd::ChangeSpriteAssociation:
-			return CmdSetup<&Game_Interpreter::CommandChangeSpriteAssociation, 3>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeSpriteAssociation, 3>;
 		case Cmd::ChangeActorFace:
-			return CmdSetup<&Game_Interpreter::CommandChangeActorFace, 2>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeActorFace, 2>;
 		case Cmd::ChangeVehicleGraphic:
-			return CmdSetup<&Game_Interpreter::CommandChangeVehicleGraphic, 2>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeVehicleGraphic, 2>;
 		case Cmd::ChangeSystemBGM:
-			return CmdSetup<&Game_Interpreter::CommandChangeSystemBGM, 5>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeSystemBGM, 5>;
 		case Cmd::ChangeSystemSFX:
-			return CmdSetup<&Game_Interpreter::CommandChangeSystemSFX, 4>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeSystemSFX, 4>;
 		case Cmd::ChangeSystemGraphics:
-			return CmdSetup<&Game_Interpreter::CommandChangeSystemGraphics, 2>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeSystemGraphics, 2>;
 		case Cmd::ChangeScreenTransitions:
-			return CmdSetup<&Game_Interpreter::CommandChangeScreenTransitions, 2>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeScreenTransitions, 2>;
 		case Cmd::MemorizeLocation:
-			return CmdSetup<&Game_Interpreter::CommandMemorizeLocation, 3>(com);
+			return &CmdHandler<&Game_Interpreter::CommandMemorizeLocation, 3>;
 		case Cmd::SetVehicleLocation:
-			return CmdSetup<&Game_Interpreter::CommandSetVehicleLocation, 5>(com);
+			return &CmdHandler<&Game_Interpreter::CommandSetVehicleLocation, 5>;
 		case Cmd::ChangeEventLocation:
-			return CmdSetup<&Game_Interpreter::CommandChangeEventLocation, 4>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeEventLocation, 4>;
 		case Cmd::TradeEventLocations:
-			return CmdSetup<&Game_Interpreter::CommandTradeEventLocations, 2>(com);
+			return &CmdHandler<&Game_Interpreter::CommandTradeEventLocations, 2>;
 		case Cmd::StoreTerrainID:
-			return CmdSetup<&Game_Interpreter::CommandStoreTerrainID, 4>(com);
+			return &CmdHandler<&Game_Interpreter::CommandStoreTerrainID, 4>;
 		case Cmd::StoreEventID:
-			return CmdSetup<&Game_Interpreter::CommandStoreEventID, 4>(com);
+			return &CmdHandler<&Game_Interpreter::CommandStoreEventID, 4>;
 		case Cmd::EraseScreen:
-			return CmdSetup<&Game_Interpreter::CommandEraseScreen, 1>(com);
+			return &CmdHandler<&Game_Interpreter::CommandEraseScreen, 1>;
 		case Cmd::ShowScreen:
-			return CmdSetup<&Game_Interpreter::CommandShowScreen, 1>(com);
+			return &CmdHandler<&Game_Interpreter::CommandShowScreen, 1>;
 		case Cmd::TintScreen:
-			return CmdSetup<&Game_Interpreter::CommandTintScreen, 6>(com);
+			return &CmdHandler<&Game_Interpreter::CommandTintScreen, 6>;
 		case Cmd::FlashScreen:
-			return CmdSetup<&Game_Interpreter::CommandFlashScreen, 6>(com);
+			return &CmdHandler<&Game_Interpreter::CommandFlashScreen, 6>;
 		case Cmd::ShakeScreen:
-			return CmdSetup<&Game_Interpreter::CommandShakeScreen, 4>(com);
+			return &CmdHandler<&Game_Interpreter::CommandShakeScreen, 4>;
 		case Cmd::WeatherEffects:
-			return CmdSetup<&Game_Interpreter::CommandWeatherEffects, 2>(com);
+			return &CmdHandler<&Game_Interpreter::CommandWeatherEffects, 2>;
 		case Cmd::ShowPicture:
-			return CmdSetup<&Game_Interpreter::CommandShowPicture, 14>(com);
+			return &CmdHandler<&Game_Interpreter::CommandShowPicture, 14>;
 		case Cmd::MovePicture:
-			return CmdSetup<&Game_Interpreter::CommandMovePicture, 16>(com);
+			return &CmdHandler<&Game_Interpreter::CommandMovePicture, 16>;
 		case Cmd::ErasePicture:
-			return CmdSetup<&Game_Interpreter::CommandErasePicture, 1>(com);
+			return &CmdHandler<&Game_Interpreter::CommandErasePicture, 1>;
 		case Cmd::PlayerVisibility:
-			return CmdSetup<&Game_Interpreter::CommandPlayerVisibility, 1>(com);
+			return &CmdHandler<&Game_Interpreter::CommandPlayerVisibility, 1>;
 		case Cmd::MoveEvent:
-			return CmdSetup<&Game_Interpreter::CommandMoveEvent, 4>(com);
+			return &CmdHandler<&Game_Interpreter::CommandMoveEvent, 4>;
 		case Cmd::MemorizeBGM:
-			return CmdSetup<&Game_Interpreter::CommandMemorizeBGM, 0>(com);
+			return &CmdHandler<&Game_Interpreter::CommandMemorizeBGM, 0>;
 		case Cmd::PlayMemorizedBGM:
-			return CmdSetup<&Game_Interpreter::CommandPlayMemorizedBGM, 0>(com);
+			return &CmdHandler<&Game_Interpreter::CommandPlayMemorizedBGM, 0>;
 		case Cmd::KeyInputProc:
-			return CmdSetup<&Game_Interpreter::CommandKeyInputProc, 5>(com);
+			return &CmdHandler<&Game_Interpreter::CommandKeyInputProc, 5>;
 		case Cmd::ChangeMapTileset:
-			return CmdSetup<&Game_Interpreter::CommandChangeMapTileset, 1>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeMapTileset, 1>;
 		case Cmd::ChangePBG:
-			return CmdSetup<&Game_Interpreter::CommandChangePBG, 6>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangePBG, 6>;
 		case Cmd::ChangeEncounterSteps:
-			return CmdSetup<&Game_Interpreter::CommandChangeEncounterSteps, 1>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeEncounterSteps, 1>;
 		case Cmd::TileSubstitution:
-			return CmdSetup<&Game_Interpreter::CommandTileSubstitution, 3>(com);
+			return &CmdHandler<&Game_Interpreter::CommandTileSubstitution, 3>;
 		case Cmd::TeleportTargets:
-			return CmdSetup<&Game_Interpreter::CommandTeleportTargets, 6>(com);
+			return &CmdHandler<&Game_Interpreter::CommandTeleportTargets, 6>;
 		case Cmd::ChangeTeleportAccess:
-			return CmdSetup<&Game_Interpreter::CommandChangeTeleportAccess, 1>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeTeleportAccess, 1>;
 		case Cmd::EscapeTarget:
-			return CmdSetup<&Game_Interpreter::CommandEscapeTarget, 5>(com);
+			return &CmdHandler<&Game_Interpreter::CommandEscapeTarget, 5>;
 		case Cmd::ChangeEscapeAccess:
-			return CmdSetup<&Game_Interpreter::CommandChangeEscapeAccess, 1>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeEscapeAccess, 1>;
 		case Cmd::ChangeSaveAccess:
-			return CmdSetup<&Game_Interpreter::CommandChangeSaveAccess, 1>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeSaveAccess, 1>;
 		case Cmd::ChangeMainMenuAccess:
-			return CmdSetup<&Game_Interpreter::CommandChangeMainMenuAccess, 1>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeMainMenuAccess, 1>;
 		case Cmd::ConditionalBranch:
-			return CmdSetup<&Game_Interpreter::CommandConditionalBranch, 6>(com);
+			return &CmdHandler<&Game_Interpreter::CommandConditionalBranch, 6>;
 		case Cmd::Label:
-			return true;
+			return &CmdSkip;
 		case Cmd::JumpToLabel:
-			return CmdSetup<&Game_Interpreter::CommandJumpToLabel, 1>(com);
+			return &CmdHandler<&Game_Interpreter::CommandJumpToLabel, 1>;
 		case Cmd::Loop:
-			return CmdSetup<&Game_Interpreter::CommandLoop, 0>(com);
+			return &CmdHandler<&Game_Interpreter::CommandLoop, 0>;
 		case Cmd::BreakLoop:
-			return CmdSetup<&Game_Interpreter::CommandBreakLoop, 0>(com);
+			return &CmdHandler<&Game_Interpreter::CommandBreakLoop, 0>;
 		case Cmd::EndLoop:
-			return CmdSetup<&Game_Interpreter::CommandEndLoop, 0>(com);
+			return &CmdHandler<&Game_Interpreter::CommandEndLoop, 0>;
 		case Cmd::EraseEvent:
-			return CmdSetup<&Game_Interpreter::CommandEraseEvent, 0>(com);
+			return &CmdHandler<&Game_Interpreter::CommandEraseEvent, 0>;
 		case Cmd::CallEvent:
-			return CmdSetup<&Game_Interpreter::CommandCallEvent, 3>(com);
+			return &CmdHandler<&Game_Interpreter::CommandCallEvent, 3>;
 		case Cmd::ReturntoTitleScreen:
-			return CmdSetup<&Game_Interpreter::CommandReturnToTitleScreen, 0>(com);
+			return &CmdHandler<&Game_Interpreter::CommandReturnToTitleScreen, 0>;
 		case Cmd::ChangeClass:
-			return CmdSetup<&Game_Interpreter::CommandChangeClass, 7>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeClass, 7>;
 		case Cmd::ChangeBattleCommands:
-			return CmdSetup<&Game_Interpreter::CommandChangeBattleCommands, 4>(com);
+			return &CmdHandler<&Game_Interpreter::CommandChangeBattleCommands, 4>;
 		case Cmd::ElseBranch:
-			return CmdSetup<&Game_Interpreter::CommandElseBranch, 0>(com);
+			return &CmdHandler<&Game_Interpreter::CommandElseBranch, 0>;
 		case Cmd::EndBranch:
-			return CmdSetup<&Game_Interpreter::CommandEndBranch, 0>(com);
+			return &CmdHandler<&Game_Interpreter::CommandEndBranch, 0>;
 		case Cmd::ExitGame:
-			return CmdSetup<&Game_Interpreter::CommandExitGame, 0>(com);
+			return &CmdHandler<&Game_Interpreter::CommandExitGame, 0>;
 		case Cmd::ToggleFullscreen:
-			return CmdSetup<&Game_Interpreter::CommandToggleFullscreen, 0>(com);
+			return &CmdHandler<&Game_Interpreter::CommandToggleFullscreen, 0>;
 		case Cmd::OpenVideoOptions:
-			return CmdSetup<&Game_Interpreter::CommandOpenVideoOptions, 0>(com);
+			return &CmdHandler<&Game_Interpreter::CommandOpenVideoOptions, 0>;
 		case Cmd::Maniac_GetSaveInfo:
-			return CmdSetup<&Game_Interpreter::CommandManiacGetSaveInfo, 12>(com);
+			return &CmdHandler<&Game_Interpreter::CommandManiacGetSaveInfo, 12>;
 		case Cmd::Maniac_Load:
-			return CmdSetup<&Game_Interpreter::CommandManiacLoad, 3>(com);
+			return &CmdHandler<&Game_Interpreter::CommandManiacLoad, 3>;
 		case Cmd::Maniac_Save:
-			return CmdSetup<&Game_Interpreter::CommandManiacSave, 3>(com);
+			return &CmdHandler<&Game_Interpreter::CommandManiacSave, 3>;
 		case Cmd::Maniac_EndLoadProcess:
-			return CmdSetup<&Game_Interpreter::CommandManiacEndLoadProcess, 0>(com);
+			return &CmdHandler<&Game_Interpreter::CommandManiacEndLoadProcess, 0>;
 		case Cmd::Maniac_GetMousePosition:
-			return CmdSetup<&Game_Interpreter::CommandManiacGetMousePosition, 2>(com);
+			return &CmdHandler<&Game_Interpreter::CommandManiacGetMousePosition, 2>;
 		case Cmd::Maniac_SetMousePosition:
-			return CmdSetup<&Game_Interpreter::CommandManiacSetMousePosition, 3>(com);
+			return &CmdHandler<&Game_Interpreter::CommandManiacSetMousePosition, 3>;
 		case Cmd::Maniac_ShowStringPicture:
-			return CmdSetup<&Game_Interpreter::CommandManiacShowStringPicture, 23>(com);
+			return &CmdHandler<&Game_Interpreter::CommandManiacShowStringPicture, 23>;
 		case Cmd::Maniac_GetPictureInfo:
-			return CmdSetup<&Game_Interpreter::CommandManiacGetPictureInfo, 8>(com);
+			return &CmdHandler<&Game_Interpreter::CommandManiacGetPictureInfo, 8>;
 		case Cmd::Maniac_ControlVarArray:
-			return CmdSetup<&Game_Interpreter::CommandManiacControlVarArray, 5>(com);
+			return &CmdHandler<&Game_Interpreter::CommandManiacControlVarArray, 5>;
 		case Cmd::Maniac_KeyInputProcEx:
-			return CmdSetup<&Game_Interpreter::CommandManiacKeyInputProcEx, 4>(com);
+			return &CmdHandler<&Game_Interpreter::CommandManiacKeyInputProcEx, 4>;
 		case Cmd::Maniac_RewriteMap:
-			return CmdSetup<&Game_Interpreter::CommandManiacRewriteMap, 9>(com);
+			return &CmdHandler<&Game_Interpreter::CommandManiacRewriteMap, 9>;
 		case Cmd::Maniac_ControlGlobalSave:
-			return CmdSetup<&Game_Interpreter::CommandManiacControlGlobalSave, 6>(com);
+			return &CmdHandler<&Game_Interpreter::CommandManiacControlGlobalSave, 6>;
 		case Cmd::Maniac_ChangePictureId:
-			return CmdSetup<&Game_Interpreter::CommandManiacChangePictureId, 6>(com);
+			return &CmdHandler<&Game_Interpreter::CommandManiacChangePictureId, 6>;
 		case Cmd::Maniac_SetGameOption:
-			return CmdSetup<&Game_Interpreter::CommandManiacSetGameOption, 4>(com);
+			return &CmdHandler<&Game_Interpreter::CommandManiacSetGameOption, 4>;
 		case Cmd::Maniac_ControlStrings:
-			return CmdSetup<&Game_Interpreter::CommandManiacControlStrings, 8>(com);
+			return &CmdHandler<&Game_Interpreter::CommandManiacControlStrings, 8>;
 		case Cmd::Maniac_CallCommand:
-			return CmdSetup<&Game_Interpreter::CommandManiacCallCommand, 6>(com);
+			return &CmdHandler<&Game_Interpreter::CommandManiacCallCommand, 6>;
 		case Cmd::Maniac_GetGameInfo:
-			return CmdSetup<&Game_Interpreter::CommandManiacGetGameInfo, 8>(com);
+			return &CmdHandler<&Game_Interpreter::CommandManiacGetGameInfo, 8>;
 		case Cmd::EasyRpg_SetInterpreterFlag:
-			return CmdSetup<&Game_Interpreter::CommandEasyRpgSetInterpreterFlag, 2>(com);
+			return &CmdHandler<&Game_Interpreter::CommandEasyRpgSetInterpreterFlag, 2>;
 		case Cmd::EasyRpg_ProcessJson:
-			return CmdSetup<&Game_Interpreter::CommandEasyRpgProcessJson, 8>(com);
+			return &CmdHandler<&Game_Interpreter::CommandEasyRpgProcessJson, 8>;
 		case Cmd::EasyRpg_CloneMapEvent:
-			return CmdSetup<&Game_Interpreter::CommandEasyRpgCloneMapEvent, 10>(com);
+			return &CmdHandler<&Game_Interpreter::CommandEasyRpgCloneMapEvent, 10>;
 		case Cmd::EasyRpg_DestroyMapEvent:
-			return CmdSetup<&Game_Interpreter::CommandEasyRpgDestroyMapEvent, 2>(com);
+			return &CmdHandler<&Game_Interpreter::CommandEasyRpgDestroyMapEvent, 2>;
 		default:
-			return true;
+			return &CmdSkip;
 	}
 }
 
@@ -1067,7 +1119,7 @@ bool Game_Interpreter::CommandControlSwitches(lcf::rpg::EventCommand const& com)
 			} else {
 				Main_Data::game_switches->FlipRange(start, end);
 			}
-			Game_Map::SetNeedRefresh(true);
+			Game_Map::SetNeedRefreshForSwitchRangeChange(start, end);
 		}
 	}
 	return true;
@@ -1349,7 +1401,7 @@ bool Game_Interpreter::CommandControlVariables(lcf::rpg::EventCommand const& com
 					Main_Data::game_variables->BitShiftRightRangeVariable(start, end, var_id);
 					break;
 			}
-			Game_Map::SetNeedRefresh(true);
+			Game_Map::SetNeedRefreshForVarRangeChange(start, end);
 		} else if (com.parameters[4] == 2) {
 			// Multiple variables - Indirect variable lookup
 			int var_id = com.parameters[5];
@@ -1388,7 +1440,7 @@ bool Game_Interpreter::CommandControlVariables(lcf::rpg::EventCommand const& com
 					Main_Data::game_variables->BitShiftRightRangeVariableIndirect(start, end, var_id);
 					break;
 			}
-			Game_Map::SetNeedRefresh(true);
+			Game_Map::SetNeedRefreshForVarRangeChange(start, end);
 		} else if (com.parameters[4] == 3) {
 			// Multiple variables - random
 			int rmax = max(com.parameters[5], com.parameters[6]);
@@ -1428,7 +1480,7 @@ bool Game_Interpreter::CommandControlVariables(lcf::rpg::EventCommand const& com
 					Main_Data::game_variables->BitShiftRightRangeRandom(start, end, rmin, rmax);
 					break;
 			}
-			Game_Map::SetNeedRefresh(true);
+			Game_Map::SetNeedRefreshForVarRangeChange(start, end);
 		} else {
 			// Multiple variables - constant
 			switch (operation) {
@@ -1466,7 +1518,7 @@ bool Game_Interpreter::CommandControlVariables(lcf::rpg::EventCommand const& com
 					Main_Data::game_variables->BitShiftRightRange(start, end, value);
 					break;
 			}
-			Game_Map::SetNeedRefresh(true);
+			Game_Map::SetNeedRefreshForVarRangeChange(start, end);
 		}
 	}
 
@@ -1603,17 +1655,12 @@ bool Game_Interpreter::CommandChangeItems(lcf::rpg::EventCommand const& com) { /
 		}
 	}
 
-	if (com.parameters[1] == 0) {
-		// Item by const number
-		Main_Data::game_party->AddItem(com.parameters[2], value);
-	} else {
-		// Item by variable
-		Main_Data::game_party->AddItem(
-			Main_Data::game_variables->Get(com.parameters[2]),
-			value
-		);
-	}
-	Game_Map::SetNeedRefresh(true);
+	// Item by const number or by variable
+	const int item_id = com.parameters[1] == 0
+		? com.parameters[2]
+		: Main_Data::game_variables->Get(com.parameters[2]);
+	Main_Data::game_party->AddItem(item_id, value);
+	Game_Map::SetNeedRefreshForItemChange(item_id);
 	// Continue
 	return true;
 }
@@ -1639,7 +1686,7 @@ bool Game_Interpreter::CommandChangePartyMember(lcf::rpg::EventCommand const& co
 	}
 
 	CheckGameOver();
-	Game_Map::SetNeedRefresh(true);
+	Game_Map::SetNeedRefreshForPartyChange(id);
 
 	// Continue
 	return true;
@@ -3743,13 +3790,22 @@ bool Game_Interpreter::CommandJumpToLabel(lcf::rpg::EventCommand const& com) { /
 
 	int label_id = com.parameters[0];
 
-	for (int idx = 0; (size_t)idx < list.size(); idx++) {
-		if (static_cast<Cmd>(list[idx].code) != Cmd::Label)
-			continue;
-		if (list[idx].parameters.empty() || list[idx].parameters[0] != label_id)
-			continue;
-		index = idx;
-		break;
+	auto& program = GetFrameProgram();
+	if (!program.labels_built) {
+		for (int idx = 0; (size_t)idx < list.size(); idx++) {
+			if (static_cast<Cmd>(list[idx].code) != Cmd::Label)
+				continue;
+			if (list[idx].parameters.empty())
+				continue;
+			// The first label with this id wins
+			program.labels.emplace(list[idx].parameters[0], idx);
+		}
+		program.labels_built = true;
+	}
+
+	auto it = program.labels.find(label_id);
+	if (it != program.labels.end()) {
+		index = it->second;
 	}
 
 	return true;
@@ -3833,6 +3889,12 @@ bool Game_Interpreter::CommandBreakLoop(lcf::rpg::EventCommand const& /* com */)
 
 	// This emulates an RPG_RT bug where break loop ignores scopes and
 	// unconditionally jumps to the next EndLoop command.
+	auto& target = GetFrameProgram().jump_targets[index];
+	if (target != jump_unresolved) {
+		index = target;
+		return true;
+	}
+
 	auto pcode = static_cast<Cmd>(list[index].code);
 	for (++index; index < (int)list.size(); ++index) {
 		if (pcode == Cmd::EndLoop) {
@@ -3840,6 +3902,7 @@ bool Game_Interpreter::CommandBreakLoop(lcf::rpg::EventCommand const& /* com */)
 		}
 		pcode = static_cast<Cmd>(list[index].code);
 	}
+	target = index;
 
 	return true;
 }
@@ -3903,16 +3966,27 @@ bool Game_Interpreter::CommandEndLoop(lcf::rpg::EventCommand const& com) { // co
 	}
 
 	// Restart the loop
-	for (int idx = index; idx >= 0; idx--) {
-		if (list[idx].indent > indent)
-			continue;
-		if (list[idx].indent < indent)
-			return false;
-		if (static_cast<Cmd>(list[idx].code) != Cmd::Loop)
-			continue;
-		index = idx;
-		break;
+	auto& target = GetFrameProgram().jump_targets[index];
+	if (target == jump_unresolved) {
+		// Stays on the EndLoop when there is no Loop
+		target = index;
+		for (int idx = index; idx >= 0; idx--) {
+			if (list[idx].indent > indent)
+				continue;
+			if (list[idx].indent < indent) {
+				target = jump_invalid;
+				break;
+			}
+			if (static_cast<Cmd>(list[idx].code) != Cmd::Loop)
+				continue;
+			target = idx;
+			break;
+		}
+	}
+	if (target == jump_invalid) {
+		return false;
 	}
+	index = target;
 
 	// Jump past the Cmd::Loop to the first command.
 	if (index < (int)frame.commands.size()) {
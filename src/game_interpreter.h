@@ -21,6 +21,7 @@
 #include <cstdint>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "async_handler.h"
 #include "game_character.h"
@@ -45,6 +46,7 @@ class Game_Interpreter : public Game_BaseInterpreterContext
 {
 public:
 	using Cmd = lcf::rpg::EventCommand::Code;
+	using CommandHandler = bool (*)(Game_Interpreter&, lcf::rpg::EventCommand const&);
 
 	static Game_Interpreter& GetForegroundInterpreter();
 
@@ -78,7 +80,16 @@ public:
 	void SetupChoices(const std::vector<std::string>& choices, int indent, PendingMessage& pm);
 
 	bool ExecuteCommand();
-	virtual bool ExecuteCommand(lcf::rpg::EventCommand const& com);
+	bool ExecuteCommand(lcf::rpg::EventCommand const& com);
+
+	/**
+	 * Maps a command code to the function executing it.
+	 * The interpreter loop caches the result per stack frame.
+	 *
+	 * @param code command code
+	 * @return handler of the command, CmdSkip for unsupported commands
+	 */
+	virtual CommandHandler ResolveCommand(Cmd code) const;
 
 
 	/**
@@ -159,6 +170,8 @@ protected:
 	 * with com.indent <= indent.
 	 * The <= protects against broken game code which terminates without
 	 * a proper conditional.
+	 * The target is cached per command, a command must always pass the
+	 * same codes and indent.
 	 *
 	 * @param codes which codes to check.
 	 * @param indent the indentation level to check
@@ -351,6 +364,31 @@ protected:
 	KeyInputState _keyinput;
 	AsyncOp _async_op = {};
 
+	/** Per stack frame data derived from the command list, filled on first use */
+	struct FrameProgram {
+		const lcf::rpg::EventCommand* commands = nullptr;
+		std::vector<CommandHandler> handlers;
+		/** Command index reached by the branch or loop navigation of each command */
+		std::vector<int> jump_targets;
+		/** Label id to the index of the first Label command with this id */
+		std::unordered_map<int, int> labels;
+		bool labels_built = false;
+	};
+	/** Indexed like _state.stack */
+	std::vector<FrameProgram> _frame_programs;
+
+	/** @return the program of the current frame, rebuilt when the frame changed */
+	FrameProgram& GetFrameProgram();
+
+	template <auto CMDFN, size_t MIN_SIZE>
+	static bool CmdHandler(Game_Interpreter& interpreter, lcf::rpg::EventCommand const& com) {
+		return interpreter.CmdSetup<CMDFN, MIN_SIZE>(com);
+	}
+
+	static bool CmdSkip(Game_Interpreter&, lcf::rpg::EventCommand const&) {
+		return true;
+	}
+
 	friend class Scene_Debug;
 };
 
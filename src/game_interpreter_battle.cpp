@@ -218,45 +218,45 @@ int Game_Interpreter_Battle::ScheduleNextPage(lcf::rpg::TroopPageCondition::Flag
 	return 0;
 }
 
-// Execute Command.
-bool Game_Interpreter_Battle::ExecuteCommand(lcf::rpg::EventCommand const& com) {
-	switch (static_cast<Cmd>(com.code)) {
+// Resolve Command.
+Game_Interpreter::CommandHandler Game_Interpreter_Battle::ResolveCommand(Cmd code) const {
+	switch (code) {
 		case Cmd::CallCommonEvent:
-			return CmdSetup<&Game_Interpreter_Battle::CommandCallCommonEvent, 1>(com);
+			return &CmdHandler<&Game_Interpreter_Battle::CommandCallCommonEvent, 1>;
 		case Cmd::ForceFlee:
-			return CmdSetup<&Game_Interpreter_Battle::CommandForceFlee, 3>(com);
+			return &CmdHandler<&Game_Interpreter_Battle::CommandForceFlee, 3>;
 		case Cmd::EnableCombo:
-			return CmdSetup<&Game_Interpreter_Battle::CommandEnableCombo, 3>(com);
+			return &CmdHandler<&Game_Interpreter_Battle::CommandEnableCombo, 3>;
 		case Cmd::ChangeMonsterHP:
-			return CmdSetup<&Game_Interpreter_Battle::CommandChangeMonsterHP, 5>(com);
+			return &CmdHandler<&Game_Interpreter_Battle::CommandChangeMonsterHP, 5>;
 		case Cmd::ChangeMonsterMP:
-			return CmdSetup<&Game_Interpreter_Battle::CommandChangeMonsterMP, 4>(com);
+			return &CmdHandler<&Game_Interpreter_Battle::CommandChangeMonsterMP, 4>;
 		case Cmd::ChangeMonsterCondition:
-			return CmdSetup<&Game_Interpreter_Battle::CommandChangeMonsterCondition, 3>(com);
+			return &CmdHandler<&Game_Interpreter_Battle::CommandChangeMonsterCondition, 3>;
 		case Cmd::ShowHiddenMonster:
-			return CmdSetup<&Game_Interpreter_Battle::CommandShowHiddenMonster, 1>(com);
+			return &CmdHandler<&Game_Interpreter_Battle::CommandShowHiddenMonster, 1>;
 		case Cmd::ChangeBattleBG:
-			return CmdSetup<&Game_Interpreter_Battle::CommandChangeBattleBG, 0>(com);
+			return &CmdHandler<&Game_Interpreter_Battle::CommandChangeBattleBG, 0>;
 		case Cmd::ShowBattleAnimation_B:
-			return CmdSetup<&Game_Interpreter_Battle::CommandShowBattleAnimation, 3>(com);
+			return &CmdHandler<&Game_Interpreter_Battle::CommandShowBattleAnimation, 3>;
 		case Cmd::TerminateBattle:
-			return CmdSetup<&Game_Interpreter_Battle::CommandTerminateBattle, 0>(com);
+			return &CmdHandler<&Game_Interpreter_Battle::CommandTerminateBattle, 0>;
 		case Cmd::ConditionalBranch_B:
-			return CmdSetup<&Game_Interpreter_Battle::CommandConditionalBranchBattle, 5>(com);
+			return &CmdHandler<&Game_Interpreter_Battle::CommandConditionalBranchBattle, 5>;
 		case Cmd::ElseBranch_B:
-			return CmdSetup<&Game_Interpreter_Battle::CommandElseBranchBattle, 0>(com);
+			return &CmdHandler<&Game_Interpreter_Battle::CommandElseBranchBattle, 0>;
 		case Cmd::EndBranch_B:
-			return CmdSetup<&Game_Interpreter_Battle::CommandEndBranchBattle, 0>(com);
+			return &CmdHandler<&Game_Interpreter_Battle::CommandEndBranchBattle, 0>;
 		case Cmd::Maniac_ControlBattle:
-			return CmdSetup<&Game_Interpreter_Battle::CommandManiacControlBattle, 4>(com);
+			return &CmdHandler<&Game_Interpreter_Battle::CommandManiacControlBattle, 4>;
 		case Cmd::Maniac_ControlAtbGauge:
-			return CmdSetup<&Game_Interpreter_Battle::CommandManiacControlAtbGauge, 7>(com);
+			return &CmdHandler<&Game_Interpreter_Battle::CommandManiacControlAtbGauge, 7>;
 		case Cmd::Maniac_ChangeBattleCommandEx:
-			return CmdSetup<&Game_Interpreter_Battle::CommandManiacChangeBattleCommandEx, 2>(com);
+			return &CmdHandler<&Game_Interpreter_Battle::CommandManiacChangeBattleCommandEx, 2>;
 		case Cmd::Maniac_GetBattleInfo:
-			return CmdSetup<&Game_Interpreter_Battle::CommandManiacGetBattleInfo, 5>(com);
+			return &CmdHandler<&Game_Interpreter_Battle::CommandManiacGetBattleInfo, 5>;
 		default:
-			return Game_Interpreter::ExecuteCommand(com);
+			return Game_Interpreter::ResolveCommand(code);
 	}
 }
 
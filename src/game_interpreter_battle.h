@@ -59,7 +59,7 @@ public:
 
 	bool IsForceFleeEnabled() const;
 
-	bool ExecuteCommand(lcf::rpg::EventCommand const& com) override;
+	CommandHandler ResolveCommand(Cmd code) const override;
 
 	static void InitBattle();
 
@@ -28,6 +28,7 @@
 #include "async_handler.h"
 #include "options.h"
 #include "system.h"
+#include "game_actors.h"
 #include "game_battle.h"
 #include "game_battler.h"
 #include "game_map.h"
@@ -56,6 +57,7 @@
 #include <lcf/rpg/save.h>
 #include "scene_gameover.h"
 #include "feature.h"
+#include "instrumentation.h"
 
 namespace {
 	// Intended bad value, Game_Map::Init sets them correctly
@@ -66,6 +68,9 @@ namespace {
 	lcf::rpg::SavePanorama panorama;
 
 	bool need_refresh;
+	// When false only the events in refresh_event_ids are refreshed
+	bool need_full_refresh;
+	std::vector<int> refresh_event_ids;
 
 	int animation_type;
 	bool animation_fast;
@@ -74,6 +79,7 @@ namespace {
 	std::vector<Game_Event> events;
 	std::vector<Game_CommonEvent> common_events;
 	std::unique_ptr<Game_Map::Caching::MapCache> map_cache;
+	Game_Map::Caching::EventTileIndex event_tile_index;
 
 	std::unique_ptr<lcf::rpg::Map> map;
 
@@ -131,6 +137,7 @@ void Game_Map::InitCommonEvents() {
 }
 
 void Game_Map::Dispose() {
+	event_tile_index.Clear();
 	events.clear();
 	map.reset();
 	map_info = {};
@@ -281,6 +288,8 @@ void Game_Map::SetupFromSave(
 		}
 		UpdateUnderlyingEventReferences();
 	}
+	// SetSaveData replaced the event positions
+	RebuildEventTileIndex();
 	map_info.events.clear();
 	interpreter->Clear();
 
@@ -390,11 +399,19 @@ void Game_Map::SetupCommon() {
 }
 
 void Game_Map::CreateMapEvents() {
+	event_tile_index.Clear();
+
 	events.reserve(map->events.size());
 	for (auto& ev : map->events) {
 		events.emplace_back(GetMapId(), &ev);
 		AddEventToCache(ev);
 	}
+
+	RebuildEventTileIndex();
+}
+
+void Game_Map::RebuildEventTileIndex() {
+	event_tile_index.Rebuild(events, GetTilesX(), GetTilesY());
 }
 
 void Game_Map::AddEventToCache(const lcf::rpg::Event& ev) {
@@ -410,6 +427,18 @@ void Game_Map::AddEventToCache(const lcf::rpg::Event& ev) {
 		if (pg.condition.flags.variable) {
 			map_cache->AddEventAsRefreshTarget<Op::VarSet>(pg.condition.variable_id, ev);
 		}
+		if (pg.condition.flags.item) {
+			map_cache->AddEventAsRefreshTarget<Op::ItemSet>(pg.condition.item_id, ev);
+		}
+		if (pg.condition.flags.actor) {
+			map_cache->AddEventAsRefreshTarget<Op::ActorSet>(pg.condition.actor_id, ev);
+		}
+		if (pg.condition.flags.timer) {
+			map_cache->AddEventAsRefreshTarget<Op::TimerSet>(Game_Party::Timer1, ev);
+		}
+		if (pg.condition.flags.timer2) {
+			map_cache->AddEventAsRefreshTarget<Op::TimerSet>(Game_Party::Timer2, ev);
+		}
 	}
 }
 
@@ -426,6 +455,18 @@ void Game_Map::RemoveEventFromCache(const lcf::rpg::Event& ev) {
 		if (pg.condition.flags.variable) {
 			map_cache->RemoveEventAsRefreshTarget<Op::VarSet>(pg.condition.variable_id, ev);
 		}
+		if (pg.condition.flags.item) {
+			map_cache->RemoveEventAsRefreshTarget<Op::ItemSet>(pg.condition.item_id, ev);
+		}
+		if (pg.condition.flags.actor) {
+			map_cache->RemoveEventAsRefreshTarget<Op::ActorSet>(pg.condition.actor_id, ev);
+		}
+		if (pg.condition.flags.timer) {
+			map_cache->RemoveEventAsRefreshTarget<Op::TimerSet>(Game_Party::Timer1, ev);
+		}
+		if (pg.condition.flags.timer2) {
+			map_cache->RemoveEventAsRefreshTarget<Op::TimerSet>(Game_Party::Timer2, ev);
+		}
 	}
 }
 
@@ -490,6 +531,7 @@ bool Game_Map::CloneMapEvent(int src_map_id, int src_event_id, int target_x, int
 			return e.GetId() < e2.GetId();
 		}), std::move(game_event));
 
+	RebuildEventTileIndex();
 	UpdateUnderlyingEventReferences();
 
 	AddEventToCache(new_event);
@@ -523,6 +565,7 @@ bool Game_Map::DestroyMapEvent(const int event_id, bool from_clone) {
 			break;
 		}
 	}
+	RebuildEventTileIndex();
 
 	// Remove event from map
 	for (auto it = map->events.begin(); it != map->events.end(); ++it) {
@@ -638,12 +681,24 @@ std::vector<uint8_t> Game_Map::GetTilesLayer(int layer) {
 
 void Game_Map::Refresh() {
 	if (GetMapId() > 0) {
-		for (Game_Event& ev : events) {
-			ev.RefreshPage();
+		if (need_full_refresh || !need_refresh) {
+			for (Game_Event& ev : events) {
+				ev.RefreshPage();
+			}
+		} else {
+			// Only events which observe a changed switch, variable, item, actor or timer
+			std::sort(refresh_event_ids.begin(), refresh_event_ids.end());
+			for (Game_Event& ev : events) {
+				if (std::binary_search(refresh_event_ids.begin(), refresh_event_ids.end(), ev.GetId())) {
+					ev.RefreshPage();
+				}
+			}
 		}
 	}
 
 	need_refresh = false;
+	need_full_refresh = false;
+	refresh_event_ids.clear();
 }
 
 Game_Interpreter_Map& Game_Map::GetInterpreter() {
@@ -882,17 +937,40 @@ bool Game_Map::CheckOrMakeWayEx(const Game_Character& self,
 	}
 	if (vehicle_type != Game_Vehicle::Airship && check_events_and_vehicles) {
 		// Check for collision with events on the target tile.
-		if (ignore_some_events_by_id.empty()) {
-			for (auto& other: GetEvents()) {
-				if (CheckOrMakeCollideEvent(other)) {
+		auto IsIgnored = [&](const Game_Event* other) {
+			return !ignore_some_events_by_id.empty()
+				&& std::find(ignore_some_events_by_id.begin(), ignore_some_events_by_id.end(), other->GetId()) != ignore_some_events_by_id.end();
+		};
+		if (make_way) {
+			// MakeWayCollideEvent can move events onto or off the tile, which modifies the bucket.
+			// Like a scan over all events in ID order, continue with the next higher ID on the tile,
+			// so that events moved there by an earlier update are checked as well.
+			const Game_Event* last = nullptr;
+			while (true) {
+				const auto& others_at = GetEventsAt(to_x, to_y);
+				auto it = others_at.begin();
+				if (last) {
+					// Pointer order equals ID order
+					it = std::upper_bound(others_at.begin(), others_at.end(), last, std::less<const Game_Event*>());
+				}
+				if (it == others_at.end()) {
+					break;
+				}
+				Game_Event* other = *it;
+				last = other;
+				if (IsIgnored(other)) {
+					continue;
+				}
+				if (CheckOrMakeCollideEvent(*other)) {
 					return false;
 				}
 			}
 		} else {
-			for (auto& other: GetEvents()) {
-				if (std::find(ignore_some_events_by_id.begin(), ignore_some_events_by_id.end(), other.GetId()) != ignore_some_events_by_id.end())
+			for (auto* other: GetEventsAt(to_x, to_y)) {
+				if (IsIgnored(other)) {
 					continue;
-				if (CheckOrMakeCollideEvent(other)) {
+				}
+				if (CheckOrMakeCollideEvent(*other)) {
 					return false;
 				}
 			}
@@ -952,10 +1030,10 @@ bool Game_Map::CanLandAirship(int x, int y) {
 		return false;
 	}
 
-	for (auto& ev: events) {
-		if (ev.IsInPosition(x, y)
-				&& ev.IsActive()
-				&& ev.GetActivePage() != nullptr) {
+	for (auto* ev: GetEventsAt(x, y)) {
+		if (ev->IsInPosition(x, y)
+				&& ev->IsActive()
+				&& ev->GetActivePage() != nullptr) {
 			return false;
 		}
 	}
@@ -990,11 +1068,11 @@ bool Game_Map::CanDisembarkShip(Game_Player& player, int x, int y) {
 		return false;
 	}
 
-	for (auto& ev: GetEvents()) {
-		if (ev.IsInPosition(x, y)
-			&& ev.GetLayer() == lcf::rpg::EventPage::Layers_same
-			&& ev.IsActive()
-			&& ev.GetActivePage() != nullptr) {
+	for (auto* ev: GetEventsAt(x, y)) {
+		if (ev->IsInPosition(x, y)
+			&& ev->GetLayer() == lcf::rpg::EventPage::Layers_same
+			&& ev->IsActive()
+			&& ev->GetActivePage() != nullptr) {
 			return false;
 		}
 	}
@@ -1068,16 +1146,16 @@ bool Game_Map::IsPassableTile(
 
 		// Highest ID event with layer=below, not through, and a tile graphic wins.
 		int event_tile_id = 0;
-		for (auto& ev: events) {
-			if (self == &ev) {
+		for (auto* ev: GetEventsAt(x, y)) {
+			if (self == ev) {
 				continue;
 			}
-			if (!ev.IsActive() || ev.GetActivePage() == nullptr || ev.GetThrough()) {
+			if (!ev->IsActive() || ev->GetActivePage() == nullptr || ev->GetThrough()) {
 				continue;
 			}
-			if (ev.IsInPosition(x, y) && ev.GetLayer() == lcf::rpg::EventPage::Layers_below) {
-				if (ev.HasTileSprite()) {
-					event_tile_id = ev.GetTileId();
+			if (ev->IsInPosition(x, y) && ev->GetLayer() == lcf::rpg::EventPage::Layers_below) {
+				if (ev->HasTileSprite()) {
+					event_tile_id = ev->GetTileId();
 				}
 			}
 		}
@@ -1182,16 +1260,24 @@ int Game_Map::GetTerrainTag(int x, int y) {
 }
 
 Game_Event* Game_Map::GetEventAt(int x, int y, bool require_active) {
-	auto& events = GetEvents();
+	auto& events = GetEventsAt(x, y);
 	for (auto iter = events.rbegin(); iter != events.rend(); ++iter) {
-		auto& ev = *iter;
-		if (ev.IsInPosition(x, y) && (!require_active || ev.IsActive())) {
-			return &ev;
+		auto* ev = *iter;
+		if (ev->IsInPosition(x, y) && (!require_active || ev->IsActive())) {
+			return ev;
 		}
 	}
 	return nullptr;
 }
 
+const std::vector<Game_Event*>& Game_Map::GetEventsAt(int x, int y) {
+	return event_tile_index.GetEventsAt(x, y);
+}
+
+void Game_Map::OnEventPositionChanged(Game_Event& ev) {
+	event_tile_index.UpdateEvent(ev);
+}
+
 bool Game_Map::LoopHorizontal() {
 	return map->scroll_type == lcf::rpg::Map::ScrollType_horizontal || map->scroll_type == lcf::rpg::Map::ScrollType_both;
 }
@@ -1251,6 +1337,8 @@ int Game_Map::CheckEvent(int x, int y) {
 }
 
 void Game_Map::Update(MapUpdateAsyncContext& actx, bool is_preupdate) {
+	Instrumentation::ZoneScope zone("Game_Map::Update");
+
 	if (GetNeedRefresh()) {
 		Refresh();
 	}
@@ -1743,20 +1831,40 @@ bool Game_Map::GetNeedRefresh() {
 
 void Game_Map::SetNeedRefresh(bool refresh) {
 	need_refresh = refresh;
+	need_full_refresh = refresh;
+	if (!refresh) {
+		refresh_event_ids.clear();
+	}
 }
 
-void Game_Map::SetNeedRefreshForSwitchChange(int switch_id) {
-	if (need_refresh)
+template <Game_Map::Caching::ObservedVarOps Op>
+static void SetNeedRefreshForChange(int first_id, int last_id) {
+	if (need_full_refresh || !map_cache)
 		return;
-	if (map_cache->GetNeedRefresh<Caching::ObservedVarOps::SwitchSet>(switch_id))
-		SetNeedRefresh(true);
+
+	const auto old_size = refresh_event_ids.size();
+	map_cache->CollectRefreshTargets<Op>(first_id, last_id, refresh_event_ids);
+	if (refresh_event_ids.size() == old_size)
+		return;
+
+	need_refresh = true;
+
+	// Games changing the same switch in a loop would grow the list forever
+	if (refresh_event_ids.size() > 2 * events.size()) {
+		std::sort(refresh_event_ids.begin(), refresh_event_ids.end());
+		refresh_event_ids.erase(std::unique(refresh_event_ids.begin(), refresh_event_ids.end()), refresh_event_ids.end());
+		if (refresh_event_ids.size() >= events.size()) {
+			Game_Map::SetNeedRefresh(true);
+		}
+	}
+}
+
+void Game_Map::SetNeedRefreshForSwitchChange(int switch_id) {
+	SetNeedRefreshForChange<Caching::ObservedVarOps::SwitchSet>(switch_id, switch_id);
 }
 
 void Game_Map::SetNeedRefreshForVarChange(int var_id) {
-	if (need_refresh)
-		return;
-	if (map_cache->GetNeedRefresh<Caching::ObservedVarOps::VarSet>(var_id))
-		SetNeedRefresh(true);
+	SetNeedRefreshForChange<Caching::ObservedVarOps::VarSet>(var_id, var_id);
 }
 
 void Game_Map::SetNeedRefreshForSwitchChange(std::initializer_list<int> switch_ids) {
@@ -1771,6 +1879,40 @@ void Game_Map::SetNeedRefreshForVarChange(std::initializer_list<int> var_ids) {
 	}
 }
 
+void Game_Map::SetNeedRefreshForSwitchRangeChange(int first_switch_id, int last_switch_id) {
+	SetNeedRefreshForChange<Caching::ObservedVarOps::SwitchSet>(first_switch_id, last_switch_id);
+}
+
+void Game_Map::SetNeedRefreshForVarRangeChange(int first_var_id, int last_var_id) {
+	SetNeedRefreshForChange<Caching::ObservedVarOps::VarSet>(first_var_id, last_var_id);
+}
+
+void Game_Map::SetNeedRefreshForItemChange(int item_id) {
+	SetNeedRefreshForChange<Caching::ObservedVarOps::ItemSet>(item_id, item_id);
+}
+
+void Game_Map::SetNeedRefreshForActorChange(int actor_id) {
+	SetNeedRefreshForChange<Caching::ObservedVarOps::ActorSet>(actor_id, actor_id);
+}
+
+void Game_Map::SetNeedRefreshForPartyChange(int actor_id) {
+	SetNeedRefreshForActorChange(actor_id);
+
+	// Item conditions count the equipment of all party members
+	const auto* actor = Main_Data::game_actors->GetActor(actor_id);
+	if (actor) {
+		for (int item_id: actor->GetWholeEquipment()) {
+			if (item_id > 0) {
+				SetNeedRefreshForItemChange(item_id);
+			}
+		}
+	}
+}
+
+void Game_Map::SetNeedRefreshForTimerChange(int which) {
+	SetNeedRefreshForChange<Caching::ObservedVarOps::TimerSet>(which, which);
+}
+
 std::vector<unsigned char>& Game_Map::GetPassagesDown() {
 	return passages_down;
 }
@@ -2002,6 +2144,71 @@ void Game_Map::Caching::MapEventCache::RemoveEvent(const lcf::rpg::Event& ev) {
 	}
 }
 
+// EventTileIndex
+//////////////////
+void Game_Map::Caching::EventTileIndex::Rebuild(std::vector<Game_Event>& events, int width, int height) {
+	this->width = width;
+	this->height = height;
+
+	buckets.clear();
+	buckets.resize(width * height + 1);
+	event_buckets.resize(events.size());
+	events_begin = events.data();
+
+	// The events vector is sorted by ID, so appending keeps each bucket sorted
+	for (size_t i = 0; i < events.size(); ++i) {
+		const int bucket = GetBucket(events[i].GetX(), events[i].GetY());
+		buckets[bucket].push_back(&events[i]);
+		event_buckets[i] = bucket;
+	}
+}
+
+void Game_Map::Caching::EventTileIndex::UpdateEvent(Game_Event& ev) {
+	// Ignore events which are not (yet) part of the map, e.g. during construction
+	std::less<const Game_Event*> less;
+	if (less(&ev, events_begin) || !less(&ev, events_begin + event_buckets.size())) {
+		return;
+	}
+
+	const auto idx = &ev - events_begin;
+	const int bucket = GetBucket(ev.GetX(), ev.GetY());
+	const int old_bucket = event_buckets[idx];
+	if (bucket == old_bucket) {
+		return;
+	}
+
+	auto& old_events = buckets[old_bucket];
+	old_events.erase(std::find(old_events.begin(), old_events.end(), &ev));
+
+	// Pointer order equals ID order
+	auto& new_events = buckets[bucket];
+	new_events.insert(std::upper_bound(new_events.begin(), new_events.end(), &ev, less), &ev);
+	event_buckets[idx] = bucket;
+}
+
+const std::vector<Game_Event*>& Game_Map::Caching::EventTileIndex::GetEventsAt(int x, int y) const {
+	static const std::vector<Game_Event*> empty;
+	if (buckets.empty()) {
+		return empty;
+	}
+	return buckets[GetBucket(x, y)];
+}
+
+void Game_Map::Caching::EventTileIndex::Clear() {
+	buckets.clear();
+	event_buckets.clear();
+	events_begin = nullptr;
+	width = 0;
+	height = 0;
+}
+
+int Game_Map::Caching::EventTileIndex::GetBucket(int x, int y) const {
+	if (x < 0 || x >= width || y < 0 || y >= height) {
+		return width * height;
+	}
+	return x + y * width;
+}
+
 // Parallax
 /////////////
 
@@ -120,6 +120,7 @@ namespace Game_Map {
 
 	void TranslateMapMessages(int mapId, lcf::rpg::Map& map);
 	void CreateMapEvents();
+	void RebuildEventTileIndex();
 	void UpdateUnderlyingEventReferences();
 	void AddEventToCache(const lcf::rpg::Event& ev);
 	void RemoveEventFromCache(const lcf::rpg::Event& ev);
@@ -607,6 +608,25 @@ namespace Game_Map {
 	 */
 	Game_Event* GetEventAt(int x, int y, bool require_active);
 
+	/**
+	 * Looks up the events on a tile using the tile index.
+	 * Positions outside of the map share one bucket, callers must
+	 * verify the position with IsInPosition.
+	 *
+	 * @param x x position on the map
+	 * @param y y position on the map
+	 * @return events at (x,y) ordered by ID
+	 */
+	const std::vector<Game_Event*>& GetEventsAt(int x, int y);
+
+	/**
+	 * Updates the tile index after the position of a map event changed.
+	 * Called by Game_Character::SetX and SetY.
+	 *
+	 * @param ev the moved event
+	 */
+	void OnEventPositionChanged(Game_Event& ev);
+
 	bool LoopHorizontal();
 	bool LoopVertical();
 
@@ -718,6 +738,8 @@ namespace Game_Map {
 			void AddEvent(const lcf::rpg::Event& ev);
 			void RemoveEvent(const lcf::rpg::Event& ev);
 
+			const std::vector<int>& GetEventIds() const;
+
 		private:
 			std::vector<int> event_ids;
 		};
@@ -727,6 +749,9 @@ namespace Game_Map {
 		enum ObservedVarOps {
 			SwitchSet = 0,
 			VarSet,
+			ItemSet,
+			ActorSet,
+			TimerSet,
 
 			ObservedVarOps_END
 		};
@@ -742,16 +767,60 @@ namespace Game_Map {
 			template <ObservedVarOps Op>
 			bool GetNeedRefresh(int var_id);
 
+			/**
+			 * Appends the IDs of all events with a page condition on an id in
+			 * the range [first_id, last_id].
+			 */
+			template <ObservedVarOps Op>
+			void CollectRefreshTargets(int first_id, int last_id, std::vector<int>& event_ids) const;
+
 			void Clear();
 		private:
 			MapEventCacheData_t refresh_targets_by_varid[ObservedVarOps_END];
 		};
+
+		/**
+		 * Maps tiles to the events standing on them, replacing linear scans
+		 * over all map events in the collision and trigger checks.
+		 */
+		class EventTileIndex {
+		public:
+			/**
+			 * Rebuilds the index. Required whenever the events vector was
+			 * modified, as the index stores pointers into it.
+			 */
+			void Rebuild(std::vector<Game_Event>& events, int width, int height);
+
+			/** Moves ev into the bucket of its current position */
+			void UpdateEvent(Game_Event& ev);
+
+			const std::vector<Game_Event*>& GetEventsAt(int x, int y) const;
+
+			void Clear();
+		private:
+			int GetBucket(int x, int y) const;
+
+			/** One bucket per tile, the last bucket holds events outside of the map */
+			std::vector<std::vector<Game_Event*>> buckets;
+			/** Current bucket of each event, indexed like the events vector */
+			std::vector<int> event_buckets;
+			Game_Event* events_begin = nullptr;
+			int width = 0;
+			int height = 0;
+		};
 	}
 
 	void SetNeedRefreshForSwitchChange(int switch_id);
 	void SetNeedRefreshForVarChange(int var_id);
 	void SetNeedRefreshForSwitchChange(std::initializer_list<int> switch_ids);
 	void SetNeedRefreshForVarChange(std::initializer_list<int> var_ids);
+	void SetNeedRefreshForSwitchRangeChange(int first_switch_id, int last_switch_id);
+	void SetNeedRefreshForVarRangeChange(int first_var_id, int last_var_id);
+	void SetNeedRefreshForItemChange(int item_id);
+	void SetNeedRefreshForActorChange(int actor_id);
+	/** Refreshes the events observing the actor or one of its equipped items */
+	void SetNeedRefreshForPartyChange(int actor_id);
+	void SetNeedRefreshForTimerChange(int which);
 
 	namespace Parallax {
 		struct Params {
@@ -927,4 +996,35 @@ inline bool Game_Map::Caching::MapCache::GetNeedRefresh(int var_id) {
 	return events_cache.find(var_id) != events_cache.end();
 }
 
+template <Game_Map::Caching::ObservedVarOps Op>
+inline void Game_Map::Caching::MapCache::CollectRefreshTargets(int first_id, int last_id, std::vector<int>& event_ids) const {
+	static_assert(static_cast<int>(Op) >= 0 && Op < ObservedVarOps_END);
+
+	const auto& events_cache = refresh_targets_by_varid[static_cast<int>(Op)];
+	const auto append = [&](const MapEventCache& cache) {
+		const auto& ids = cache.GetEventIds();
+		event_ids.insert(event_ids.end(), ids.begin(), ids.end());
+	};
+
+	// Large ranges are cheaper to resolve by scanning the observed ids
+	if (static_cast<size_t>(last_id - first_id) >= events_cache.size()) {
+		for (const auto& it: events_cache) {
+			if (it.first >= first_id && it.first <= last_id) {
+				append(it.second);
+			}
+		}
+	} else {
+		for (int id = first_id; id <= last_id; ++id) {
+			auto it = events_cache.find(id);
+			if (it != events_cache.end()) {
+				append(it->second);
+			}
+		}
+	}
+}
+
+inline const std::vector<int>& Game_Map::Caching::MapEventCache::GetEventIds() const {
+	return event_ids;
+}
+
 #endif
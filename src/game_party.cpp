@@ -536,11 +536,11 @@ void Game_Party::SetTimer(int which, int seconds) {
 	switch (which) {
 		case Timer1:
 			data.timer1_frames = seconds * DEFAULT_FPS + (DEFAULT_FPS - 1);
-			Game_Map::SetNeedRefresh(true);
+			Game_Map::SetNeedRefreshForTimerChange(Timer1);
 			break;
 		case Timer2:
 			data.timer2_frames = seconds * DEFAULT_FPS + (DEFAULT_FPS -1);
-			Game_Map::SetNeedRefresh(true);
+			Game_Map::SetNeedRefreshForTimerChange(Timer2);
 			break;
 	}
 }
@@ -575,14 +575,15 @@ void Game_Party::StopTimer(int which) {
 
 void Game_Party::UpdateTimers() {
 	const bool battle = Game_Battle::IsBattleRunning();
-	bool seconds_changed = false;
 
 	if (data.timer1_active && (data.timer1_battle || !battle) && data.timer1_frames > 0) {
 		data.timer1_frames = data.timer1_frames - 1;
 
 		const int seconds = data.timer1_frames / DEFAULT_FPS;
 		const int mod_frames = data.timer1_frames % DEFAULT_FPS;
-		seconds_changed |= (mod_frames == (DEFAULT_FPS - 1));
+		if (mod_frames == (DEFAULT_FPS - 1)) {
+			Game_Map::SetNeedRefreshForTimerChange(Timer1);
+		}
 
 		if (seconds == 0) {
 			StopTimer(Timer1);
@@ -594,16 +595,14 @@ void Game_Party::UpdateTimers() {
 
 		const int seconds = data.timer2_frames / DEFAULT_FPS;
 		const int mod_frames = data.timer2_frames % DEFAULT_FPS;
-		seconds_changed |= (mod_frames == (DEFAULT_FPS - 1));
+		if (mod_frames == (DEFAULT_FPS - 1)) {
+			Game_Map::SetNeedRefreshForTimerChange(Timer2);
+		}
 
 		if (seconds == 0) {
 			StopTimer(Timer2);
 		}
 	}
-
-	if (seconds_changed) {
-		Game_Map::SetNeedRefresh(true);
-	}
 }
 
 int Game_Party::GetTimerSeconds(int which) {
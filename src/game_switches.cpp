@@ -21,11 +21,63 @@
 #include <lcf/reader_util.h>
 #include <lcf/data.h>
 
+void Game_Switches::SetData(const Switches_t& s) {
+	_size = static_cast<int>(s.size());
+	_words.assign((s.size() + kWordBits - 1) / kWordBits, 0);
+	for (size_t i = 0; i < s.size(); ++i) {
+		if (s[i]) {
+			_words[i / kWordBits] |= Word_t(1) << (i % kWordBits);
+		}
+	}
+}
+
+Game_Switches::Switches_t Game_Switches::GetData() const {
+	Switches_t s(_size);
+	for (int i = 0; i < _size; ++i) {
+		s[i] = (_words[i / kWordBits] >> (i % kWordBits)) & 1;
+	}
+	return s;
+}
+
 void Game_Switches::WarnGet(int variable_id) const {
 	Output::Debug("Invalid read sw[{}]!", variable_id);
 	--_warnings;
 }
 
+void Game_Switches::Resize(int size) {
+	if (size > _size) {
+		_words.resize((size + kWordBits - 1) / kWordBits, 0);
+		_size = size;
+	}
+}
+
+template <typename F>
+void Game_Switches::WriteRange(int first_id, int last_id, F&& op) {
+	// Half-open range of bit indices
+	const int begin = std::max(0, first_id - 1);
+	const int end = last_id;
+	if (begin >= end) {
+		return;
+	}
+
+	const int first_word = begin / kWordBits;
+	const int last_word = (end - 1) / kWordBits;
+	const Word_t first_mask = ~Word_t(0) << (begin % kWordBits);
+	const Word_t last_mask = ~Word_t(0) >> (kWordBits - 1 - (end - 1) % kWordBits);
+
+	if (first_word == last_word) {
+		op(_words[first_word], first_mask & last_mask);
+		return;
+	}
+
+	op(_words[first_word], first_mask);
+	// Full words, the constant mask allows the compiler to vectorize this loop
+	for (int i = first_word + 1; i < last_word; ++i) {
+		op(_words[i], ~Word_t(0));
+	}
+	op(_words[last_word], last_mask);
+}
+
 bool Game_Switches::Set(int switch_id, bool value) {
 	if (EP_UNLIKELY(ShouldWarn(switch_id, switch_id))) {
 		Output::Debug("Invalid write sw[{}] = {}!", switch_id, value);
@@ -34,11 +86,11 @@ bool Game_Switches::Set(int switch_id, bool value) {
 	if (switch_id <= 0) {
 		return false;
 	}
-	auto& ss = _switches;
-	if (switch_id > static_cast<int>(ss.size())) {
-		ss.resize(switch_id);
-	}
-	ss[switch_id - 1] = value;
+	Resize(switch_id);
+	const int idx = switch_id - 1;
+	const Word_t bit = Word_t(1) << (idx % kWordBits);
+	auto& word = _words[idx / kWordBits];
+	word = value ? (word | bit) : (word & ~bit);
 	return value;
 }
 
@@ -47,12 +99,11 @@ void Game_Switches::SetRange(int first_id, int last_id, bool value) {
 		Output::Debug("Invalid write sw[{},{}] = {}!", first_id, last_id, value);
 		--_warnings;
 	}
-	auto& ss = _switches;
-	if (last_id > static_cast<int>(ss.size())) {
-		ss.resize(last_id, false);
-	}
-	for (int i = std::max(0, first_id - 1); i < last_id; ++i) {
-		ss[i] = value;
+	Resize(last_id);
+	if (value) {
+		WriteRange(first_id, last_id, [](Word_t& word, Word_t mask) { word |= mask; });
+	} else {
+		WriteRange(first_id, last_id, [](Word_t& word, Word_t mask) { word &= ~mask; });
 	}
 }
 
@@ -64,12 +115,11 @@ bool Game_Switches::Flip(int switch_id) {
 	if (switch_id <= 0) {
 		return false;
 	}
-	auto& ss = _switches;
-	if (switch_id > static_cast<int>(ss.size())) {
-		ss.resize(switch_id);
-	}
-	ss[switch_id - 1].flip();
-	return ss[switch_id - 1];
+	Resize(switch_id);
+	const int idx = switch_id - 1;
+	auto& word = _words[idx / kWordBits];
+	word ^= Word_t(1) << (idx % kWordBits);
+	return (word >> (idx % kWordBits)) & 1;
 }
 
 void Game_Switches::FlipRange(int first_id, int last_id) {
@@ -77,13 +127,8 @@ void Game_Switches::FlipRange(int first_id, int last_id) {
 		Output::Debug("Invalid flip sw[{},{}]!", first_id, last_id);
 		--_warnings;
 	}
-	auto& ss = _switches;
-	if (last_id > static_cast<int>(ss.size())) {
-		ss.resize(last_id);
-	}
-	for (int i = std::max(0, first_id - 1); i < last_id; ++i) {
-		ss[i].flip();
-	}
+	Resize(last_id);
+	WriteRange(first_id, last_id, [](Word_t& word, Word_t mask) { word ^= mask; });
 }
 
 std::string_view Game_Switches::GetName(int _id) const {
@@ -18,6 +18,7 @@
 // Headers
 #include <fstream>
 #include <functional>
+#include <set>
 #include "game_system.h"
 #include "async_handler.h"
 #include "game_battle.h"
@@ -199,6 +200,55 @@ void Game_System::SePlay(const lcf::rpg::Animation &animation) {
 	}
 }
 
+void Game_System::PreloadSe() {
+	// Name and tempo, every tempo is cached separately
+	std::set<std::pair<std::string, int>> sounds;
+
+	auto add_sound = [&](const lcf::rpg::Sound& se) {
+		if (!se.name.empty() && se.volume > 0) {
+			sounds.emplace(ToString(se.name), Utils::Clamp<int32_t>(se.tempo, 10, 400));
+		}
+	};
+
+	for (int i = 0; i < SFX_Count; ++i) {
+		add_sound(GetSystemSE(i));
+	}
+	for (const auto& animation : lcf::Data::animations) {
+		for (const auto& timing : animation.timings) {
+			add_sound(timing.se);
+		}
+	}
+
+	int preloaded = 0;
+	for (const auto& [name, tempo] : sounds) {
+		if (AudioSeCache::GetStats().size >= AudioSeCache::GetBudget()) {
+			// Further sounds would evict the ones decoded before
+			break;
+		}
+
+		if (EndsWith(name, ".script") || EndsWith(name, ".link")) {
+			// Ineluki patch files, not sounds
+			continue;
+		}
+
+		auto se_cache = AudioSeCache::GetCachedSe(name);
+		if (!se_cache) {
+			Filesystem_Stream::InputStream stream;
+			if (IsStopSoundFilename(name, stream) || !stream) {
+				continue;
+			}
+			se_cache = AudioSeCache::Create(std::move(stream), name);
+		}
+
+		if (se_cache) {
+			Audio().SE_Preload(std::move(se_cache), tempo);
+			++preloaded;
+		}
+	}
+
+	Output::Debug("Preloaded {} of {} sound effects", preloaded, sounds.size());
+}
+
 std::string_view Game_System::GetSystemName() {
 	return !data.graphics_name.empty() ?
 		std::string_view(data.graphics_name) : std::string_view(lcf::Data::system.system_name);
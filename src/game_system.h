@@ -135,6 +135,12 @@ public:
 	 */
 	void SePlay(const lcf::rpg::Animation& animation);
 
+	/**
+	 * Decodes the system sounds and the sounds of the battle animations in
+	 * advance, until the SE cache is full.
+	 */
+	void PreloadSe();
+
 	/** @return system graphic filename.  */
 	std::string_view GetSystemName();
 
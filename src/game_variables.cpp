@@ -22,8 +22,17 @@
 #include <lcf/data.h>
 #include "utils.h"
 #include "rand.h"
+#include <algorithm>
 #include <cmath>
 
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#  define EP_VARIABLES_SSE2
+#elif defined(__ARM_NEON)
+#  include <arm_neon.h>
+#  define EP_VARIABLES_NEON
+#endif
+
 namespace {
 using Var_t = Game_Variables::Var_t;
 
@@ -128,6 +137,104 @@ constexpr Var_t VarBitShiftRight(Var_t n, Var_t d) {
 	return n >> d;
 };
 
+/*
+ * Range kernels: Apply an operation with a constant operand to [it, end) and
+ * clamp the results to [min, max].
+ * Four variables are processed per step when SSE2 or NEON is available.
+ * The remainder and all other targets use the scalar operation.
+ */
+#if defined(EP_VARIABLES_SSE2)
+using VarVec = __m128i;
+
+inline VarVec VecLoad(const Var_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+inline void VecStore(Var_t* p, VarVec v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+inline VarVec VecSplat(Var_t v) { return _mm_set1_epi32(v); }
+
+inline VarVec VecSelect(VarVec mask, VarVec a, VarVec b) {
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+inline VarVec VecClamp(VarVec v, VarVec lo, VarVec hi) {
+	v = VecSelect(_mm_cmplt_epi32(v, lo), lo, v);
+	return VecSelect(_mm_cmpgt_epi32(v, hi), hi, v);
+}
+
+// Saturated value on overflow depends only on the sign of the left operand
+inline VarVec VecSaturated(VarVec l) {
+	return _mm_xor_si128(_mm_srai_epi32(l, 31), _mm_set1_epi32(std::numeric_limits<Var_t>::max()));
+}
+
+inline VarVec VecAdd(VarVec l, VarVec r) {
+	VarVec res = _mm_add_epi32(l, r);
+	VarVec overflow = _mm_srai_epi32(_mm_and_si128(_mm_xor_si128(l, res), _mm_xor_si128(r, res)), 31);
+	return VecSelect(overflow, VecSaturated(l), res);
+}
+
+inline VarVec VecSub(VarVec l, VarVec r) {
+	VarVec res = _mm_sub_epi32(l, r);
+	VarVec overflow = _mm_srai_epi32(_mm_and_si128(_mm_xor_si128(l, r), _mm_xor_si128(l, res)), 31);
+	return VecSelect(overflow, VecSaturated(l), res);
+}
+
+inline VarVec VecBitOr(VarVec l, VarVec r) { return _mm_or_si128(l, r); }
+inline VarVec VecBitAnd(VarVec l, VarVec r) { return _mm_and_si128(l, r); }
+inline VarVec VecBitXor(VarVec l, VarVec r) { return _mm_xor_si128(l, r); }
+#elif defined(EP_VARIABLES_NEON)
+using VarVec = int32x4_t;
+
+inline VarVec VecLoad(const Var_t* p) { return vld1q_s32(p); }
+inline void VecStore(Var_t* p, VarVec v) { vst1q_s32(p, v); }
+inline VarVec VecSplat(Var_t v) { return vdupq_n_s32(v); }
+inline VarVec VecClamp(VarVec v, VarVec lo, VarVec hi) { return vminq_s32(vmaxq_s32(v, lo), hi); }
+inline VarVec VecAdd(VarVec l, VarVec r) { return vqaddq_s32(l, r); }
+inline VarVec VecSub(VarVec l, VarVec r) { return vqsubq_s32(l, r); }
+inline VarVec VecBitOr(VarVec l, VarVec r) { return vorrq_s32(l, r); }
+inline VarVec VecBitAnd(VarVec l, VarVec r) { return vandq_s32(l, r); }
+inline VarVec VecBitXor(VarVec l, VarVec r) { return veorq_s32(l, r); }
+#endif
+
+template <Var_t (*op)(Var_t, Var_t)>
+void RangeScalar(Var_t* it, Var_t* end, Var_t value, Var_t min, Var_t max) {
+	for (; it != end; ++it) {
+		*it = Utils::Clamp(op(*it, value), min, max);
+	}
+}
+
+#if defined(EP_VARIABLES_SSE2) || defined(EP_VARIABLES_NEON)
+template <VarVec (*vec_op)(VarVec, VarVec), Var_t (*op)(Var_t, Var_t)>
+void RangeVector(Var_t* it, Var_t* end, Var_t value, Var_t min, Var_t max) {
+	const VarVec vvalue = VecSplat(value);
+	const VarVec vmin = VecSplat(min);
+	const VarVec vmax = VecSplat(max);
+	for (; end - it >= 4; it += 4) {
+		VecStore(it, VecClamp(vec_op(VecLoad(it), vvalue), vmin, vmax));
+	}
+	RangeScalar<op>(it, end, value, min, max);
+}
+
+constexpr auto RangeAdd = RangeVector<VecAdd, VarAdd>;
+constexpr auto RangeSub = RangeVector<VecSub, VarSub>;
+constexpr auto RangeBitOr = RangeVector<VecBitOr, VarBitOr>;
+constexpr auto RangeBitAnd = RangeVector<VecBitAnd, VarBitAnd>;
+constexpr auto RangeBitXor = RangeVector<VecBitXor, VarBitXor>;
+#else
+constexpr auto RangeAdd = RangeScalar<VarAdd>;
+constexpr auto RangeSub = RangeScalar<VarSub>;
+constexpr auto RangeBitOr = RangeScalar<VarBitOr>;
+constexpr auto RangeBitAnd = RangeScalar<VarBitAnd>;
+constexpr auto RangeBitXor = RangeScalar<VarBitXor>;
+#endif
+
+void RangeSet(Var_t* it, Var_t* end, Var_t value, Var_t min, Var_t max) {
+	std::fill(it, end, Utils::Clamp(value, min, max));
+}
+
+constexpr auto RangeMult = RangeScalar<VarMult>;
+constexpr auto RangeDiv = RangeScalar<VarDiv>;
+constexpr auto RangeMod = RangeScalar<VarMod>;
+constexpr auto RangeBitShiftLeft = RangeScalar<VarBitShiftLeft>;
+constexpr auto RangeBitShiftRight = RangeScalar<VarBitShiftRight>;
+
 }
 
 Game_Variables::Game_Variables(Var_t minval, Var_t maxval)
@@ -198,6 +305,14 @@ void Game_Variables::WriteRange(const int first_id, const int last_id, V&& value
 	}
 }
 
+void Game_Variables::WriteRangeKernel(const int first_id, const int last_id, Var_t value, RangeKernel kernel) {
+	const int first = std::max(0, first_id - 1);
+	if (first >= last_id) {
+		return;
+	}
+	kernel(_variables.data() + first, _variables.data() + last_id, value, _min, _max);
+}
+
 template <typename F>
 void Game_Variables::WriteArray(const int first_id_a, const int last_id_a, const int first_id_b, F&& op) {
 	auto& vv = _variables;
@@ -263,124 +378,123 @@ Game_Variables::Var_t Game_Variables::BitShiftRight(int variable_id, Var_t value
 
 void Game_Variables::SetRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] = {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarSet);
+	WriteRangeKernel(first_id, last_id, value, RangeSet);
 }
 
 void Game_Variables::AddRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] += {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarAdd);
+	WriteRangeKernel(first_id, last_id, value, RangeAdd);
 }
 
 void Game_Variables::SubRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] -= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarSub);
+	WriteRangeKernel(first_id, last_id, value, RangeSub);
 }
 
 void Game_Variables::MultRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] *= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarMult);
+	WriteRangeKernel(first_id, last_id, value, RangeMult);
 }
 
 void Game_Variables::DivRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] /= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarDiv);
+	WriteRangeKernel(first_id, last_id, value, RangeDiv);
 }
 
 void Game_Variables::ModRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] %= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarMod);
+	WriteRangeKernel(first_id, last_id, value, RangeMod);
 }
 
 void Game_Variables::BitOrRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] |= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarBitOr);
+	WriteRangeKernel(first_id, last_id, value, RangeBitOr);
 }
 
 void Game_Variables::BitAndRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] &= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarBitAnd);
+	WriteRangeKernel(first_id, last_id, value, RangeBitAnd);
 }
 
 void Game_Variables::BitXorRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] ^= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarBitXor);
+	WriteRangeKernel(first_id, last_id, value, RangeBitXor);
 }
 
 void Game_Variables::BitShiftLeftRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] <<= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarBitShiftLeft);
+	WriteRangeKernel(first_id, last_id, value, RangeBitShiftLeft);
 }
 
 void Game_Variables::BitShiftRightRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] >>= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarBitShiftRight);
+	WriteRangeKernel(first_id, last_id, value, RangeBitShiftRight);
 }
 
-template <typename F>
-void Game_Variables::WriteRangeVariable(int first_id, const int last_id, const int var_id, F&& op) {
+void Game_Variables::WriteRangeVariable(int first_id, const int last_id, const int var_id, RangeKernel kernel) {
 	if (var_id >= first_id && var_id <= last_id) {
 		auto value = Get(var_id);
-		WriteRange(first_id, var_id, [value](){ return value; }, std::forward<F>(op));
+		WriteRangeKernel(first_id, var_id, value, kernel);
 		first_id = var_id + 1;
 	}
 	auto value = Get(var_id);
-	WriteRange(first_id, last_id, [value](){ return value; }, std::forward<F>(op));
+	WriteRangeKernel(first_id, last_id, value, kernel);
 }
 
 
 void Game_Variables::SetRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] = Var({})!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarSet);
+	WriteRangeVariable(first_id, last_id, var_id, RangeSet);
 }
 
 void Game_Variables::AddRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] += var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarAdd);
+	WriteRangeVariable(first_id, last_id, var_id, RangeAdd);
 }
 
 void Game_Variables::SubRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] -= var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarSub);
+	WriteRangeVariable(first_id, last_id, var_id, RangeSub);
 }
 
 void Game_Variables::MultRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] *= var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarMult);
+	WriteRangeVariable(first_id, last_id, var_id, RangeMult);
 }
 
 void Game_Variables::DivRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] /= var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarDiv);
+	WriteRangeVariable(first_id, last_id, var_id, RangeDiv);
 }
 
 void Game_Variables::ModRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] /= var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarMod);
+	WriteRangeVariable(first_id, last_id, var_id, RangeMod);
 }
 
 void Game_Variables::BitOrRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] |= var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarBitOr);
+	WriteRangeVariable(first_id, last_id, var_id, RangeBitOr);
 }
 
 void Game_Variables::BitAndRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] &= var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarBitAnd);
+	WriteRangeVariable(first_id, last_id, var_id, RangeBitAnd);
 }
 
 void Game_Variables::BitXorRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] ^= var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarBitXor);
+	WriteRangeVariable(first_id, last_id, var_id, RangeBitXor);
 }
 
 void Game_Variables::BitShiftLeftRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] <<= var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarBitShiftLeft);
+	WriteRangeVariable(first_id, last_id, var_id, RangeBitShiftLeft);
 }
 
 void Game_Variables::BitShiftRightRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] >>= var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarBitShiftRight);
+	WriteRangeVariable(first_id, last_id, var_id, RangeBitShiftRight);
 }
 
 void Game_Variables::SetRangeVariableIndirect(int first_id, int last_id, int var_id) {
@@ -152,8 +152,10 @@ private:
 		void PrepareArray(const int first_id_a, const int last_id_a, const int first_id_b, const char* warn, Args... args);
 	template <typename V, typename F>
 		void WriteRange(const int first_id, const int last_id, V&& value, F&& op);
-	template <typename F>
-		void WriteRangeVariable(const int first_id, const int last_id, int var_id, F&& op);
+	/** Applies an operation with a constant operand to [it, end) and clamps to [min, max] */
+	using RangeKernel = void (*)(Var_t* it, Var_t* end, Var_t value, Var_t min, Var_t max);
+	void WriteRangeKernel(const int first_id, const int last_id, Var_t value, RangeKernel kernel);
+	void WriteRangeVariable(const int first_id, const int last_id, int var_id, RangeKernel kernel);
 	template <typename F>
 		void WriteArray(const int first_id_a, const int last_id_a, const int first_id_b, F&& op);
 
@@ -19,6 +19,7 @@
 #include <memory>
 #include <sstream>
 #include <chrono>
+#include <limits>
 
 #include "graphics.h"
 #include "cache.h"
@@ -30,6 +31,9 @@
 #include "drawable_mgr.h"
 #include "baseui.h"
 #include "game_clock.h"
+#include "game_system.h"
+#include "main_data.h"
+#include "instrumentation.h"
 
 using namespace std::chrono_literals;
 
@@ -42,6 +46,28 @@ namespace Graphics {
 	std::unique_ptr<FpsOverlay> fps_overlay;
 
 	std::string window_title_key;
+
+	/** Maximum amount of damage rectangles redrawn separately */
+	constexpr size_t max_damage_rects = 8;
+
+	/** Above this percentage of the screen a full redraw is cheaper */
+	constexpr int max_damage_percent = 60;
+
+	/** State of the previous frame used by the dirty rectangle compositor */
+	struct ComposeState {
+		const DrawableList* list = nullptr;
+		uint32_t list_generation = 0;
+		const Scene* scene = nullptr;
+		uint64_t dst_revision = 0;
+		Color background_color;
+		bool untracked_visible = false;
+	};
+	ComposeState last_compose;
+
+	std::vector<Rect> damage_rects;
+
+	void AddDamage(Rect rect);
+	bool CollectDamage(Bitmap& dst, DrawableList& drawable_list);
 }
 
 void Graphics::Init() {
@@ -63,6 +89,8 @@ void Graphics::Quit() {
 }
 
 void Graphics::Update() {
+	Instrumentation::ZoneScope zone("Graphics::Update");
+
 	fps_overlay->SetDrawFps(DisplayUi->RenderFps());
 
 	//Update Graphics:
@@ -104,18 +132,130 @@ void Graphics::UpdateTitle() {
 #endif
 }
 
-void Graphics::Draw(Bitmap& dst) {
+bool Graphics::Draw(Bitmap& dst) {
+	Instrumentation::ZoneScope zone("Graphics::Draw");
+
 	auto& transition = Transition::instance();
+	auto& drawable_list = DrawableMgr::GetLocalList();
 
 	auto min_z = std::numeric_limits<Drawable::Z_t>::min();
 	auto max_z = std::numeric_limits<Drawable::Z_t>::max();
+
+	// Damage must be collected every frame to keep the state of all drawables current
+	bool partial = CollectDamage(dst, drawable_list);
+
 	if (transition.IsActive()) {
 		min_z = transition.GetZ();
+		partial = false;
 	} else if (transition.IsErasedNotActive()) {
 		min_z = transition.GetZ() + 1;
+		partial = false;
 		dst.Clear();
 	}
-	LocalDraw(dst, min_z, max_z);
+
+	if (!partial) {
+		LocalDraw(dst, min_z, max_z);
+
+		damage_rects.assign(1, dst.GetRect());
+	} else if (!damage_rects.empty()) {
+		// Only redraw the changed areas, everything outside of them is still valid
+		for (const auto& rect : damage_rects) {
+			dst.SetClipRect(rect);
+			LocalDraw(dst, min_z, max_z);
+		}
+		dst.ClearClipRect();
+	}
+
+	last_compose.dst_revision = dst.GetRevision();
+
+	if (DisplayUi) {
+		DisplayUi->SetDisplayDamage(damage_rects);
+	}
+
+	return !damage_rects.empty();
+}
+
+void Graphics::AddDamage(Rect rect) {
+	if (rect.IsEmpty()) {
+		return;
+	}
+
+	// Merge with every overlapping rectangle. A merged rectangle can overlap
+	// rectangles checked before, so start over until nothing overlaps.
+	for (size_t i = 0; i < damage_rects.size();) {
+		if (!damage_rects[i].IsOutOfBounds(rect)) {
+			rect = rect.GetUnion(damage_rects[i]);
+			damage_rects.erase(damage_rects.begin() + i);
+			i = 0;
+		} else {
+			++i;
+		}
+	}
+
+	if (damage_rects.size() < max_damage_rects) {
+		damage_rects.push_back(rect);
+		return;
+	}
+
+	// Too many rectangles: Merge with the one that grows the least
+	auto area = [](const Rect& r) { return static_cast<int64_t>(r.width) * r.height; };
+	size_t best = 0;
+	int64_t best_growth = std::numeric_limits<int64_t>::max();
+	for (size_t i = 0; i < damage_rects.size(); ++i) {
+		const auto& other = damage_rects[i];
+		int64_t growth = area(other.GetUnion(rect)) - area(other);
+		if (growth < best_growth) {
+			best = i;
+			best_growth = growth;
+		}
+	}
+
+	auto merged = damage_rects[best].GetUnion(rect);
+	damage_rects.erase(damage_rects.begin() + best);
+	AddDamage(merged);
+}
+
+bool Graphics::CollectDamage(Bitmap& dst, DrawableList& drawable_list) {
+	const Rect screen_rect = dst.GetRect();
+	damage_rects.clear();
+
+	bool untracked_visible = false;
+	for (auto* drawable : drawable_list) {
+		Rect damage;
+		if (!drawable->GetDamage(damage)) {
+			untracked_visible |= drawable->IsVisible();
+			continue;
+		}
+		damage.Adjust(screen_rect);
+		AddDamage(damage);
+	}
+
+	auto background_color = Main_Data::game_system ? Main_Data::game_system->GetBackgroundColor() : Color();
+
+	// Anything the drawables cannot report requires a full redraw
+	bool partial = !untracked_visible && !last_compose.untracked_visible
+		&& last_compose.list == &drawable_list
+		&& last_compose.list_generation == drawable_list.GetGeneration()
+		&& last_compose.scene == current_scene.get()
+		&& last_compose.dst_revision == dst.GetRevision()
+		&& last_compose.background_color == background_color;
+
+	last_compose.list = &drawable_list;
+	last_compose.list_generation = drawable_list.GetGeneration();
+	last_compose.scene = current_scene.get();
+	last_compose.background_color = background_color;
+	last_compose.untracked_visible = untracked_visible;
+
+	if (!partial) {
+		return false;
+	}
+
+	int64_t damage_area = 0;
+	for (const auto& rect : damage_rects) {
+		damage_area += static_cast<int64_t>(rect.width) * rect.height;
+	}
+
+	return damage_area * 100 <= static_cast<int64_t>(screen_rect.width) * screen_rect.height * max_damage_percent;
 }
 
 void Graphics::LocalDraw(Bitmap& dst, Drawable::Z_t min_z, Drawable::Z_t max_z) {
@@ -48,7 +48,13 @@ namespace Graphics {
 	 */
 	void Update();
 
-	void Draw(Bitmap& dst);
+	/**
+	 * Composes the current frame.
+	 *
+	 * @param dst display surface
+	 * @return whether the display surface changed
+	 */
+	bool Draw(Bitmap& dst);
 
 	void LocalDraw(Bitmap& dst, Drawable::Z_t min_z, Drawable::Z_t max_z);
 
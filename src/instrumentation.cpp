@@ -18,10 +18,85 @@
 #include "instrumentation.h"
 #include "utils.h"
 
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <thread>
+#include <tuple>
+
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 __itt_domain* Instrumentation::domain = nullptr;
 #endif
 
+std::atomic<bool> Instrumentation::profiler_enabled = false;
+
+namespace {
+	// Amount of frames kept in the ring buffer
+	constexpr size_t frame_history = 120;
+
+	struct ZoneRecord {
+		const char* name;
+		int tid;
+		Instrumentation::clock::time_point start;
+		Instrumentation::clock::time_point end;
+	};
+
+	struct FrameRecord {
+		Instrumentation::clock::time_point start;
+		Instrumentation::clock::time_point end;
+		std::vector<ZoneRecord> zones;
+	};
+
+	struct ProfilerData {
+		std::mutex mutex;
+		std::array<FrameRecord, frame_history> frames;
+		/** Index of the next frame to overwrite */
+		size_t frame_index = 0;
+		size_t frame_count = 0;
+		FrameRecord current;
+		bool in_frame = false;
+		Instrumentation::clock::time_point epoch;
+		std::vector<std::thread::id> threads;
+	};
+
+	ProfilerData& Data() {
+		static ProfilerData data;
+		return data;
+	}
+
+	int GetThreadIndex(ProfilerData& data) {
+		auto id = std::this_thread::get_id();
+		auto it = std::find(data.threads.begin(), data.threads.end(), id);
+		if (it != data.threads.end()) {
+			return static_cast<int>(it - data.threads.begin());
+		}
+		data.threads.push_back(id);
+		return static_cast<int>(data.threads.size()) - 1;
+	}
+
+	/** Calls fn(frame) for all recorded frames from oldest to newest */
+	template <typename F>
+	void ForEachFrame(ProfilerData& data, F&& fn) {
+		size_t first = (data.frame_index + frame_history - data.frame_count) % frame_history;
+		for (size_t i = 0; i < data.frame_count; ++i) {
+			fn(data.frames[(first + i) % frame_history]);
+		}
+	}
+
+	void WriteJsonString(std::ostream& os, std::string_view s) {
+		os << '"';
+		for (char c: s) {
+			if (c == '"' || c == '\\') {
+				os << '\\';
+			}
+			os << c;
+		}
+		os << '"';
+	}
+}
+
 void Instrumentation::Init(const char* name) {
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 	assert(!domain);
@@ -34,3 +109,152 @@ void Instrumentation::Init(const char* name) {
 	(void)name;
 #endif
 }
+
+void Instrumentation::SetProfilerEnabled(bool enabled) {
+	auto& data = Data();
+	std::lock_guard<std::mutex> lock(data.mutex);
+
+	if (enabled && !IsProfilerEnabled()) {
+		data.epoch = clock::now();
+		data.frame_index = 0;
+		data.frame_count = 0;
+		data.current.zones.clear();
+		data.in_frame = false;
+	}
+
+	profiler_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Instrumentation::ProfilerFrameBegin() {
+	auto& data = Data();
+	std::lock_guard<std::mutex> lock(data.mutex);
+
+	data.current.zones.clear();
+	data.current.start = clock::now();
+	data.in_frame = true;
+}
+
+void Instrumentation::ProfilerFrameEnd() {
+	auto& data = Data();
+	std::lock_guard<std::mutex> lock(data.mutex);
+
+	if (!data.in_frame) {
+		return;
+	}
+
+	data.current.end = clock::now();
+	data.in_frame = false;
+
+	// Swap to reuse the zone storage of the overwritten frame
+	std::swap(data.frames[data.frame_index], data.current);
+	data.frame_index = (data.frame_index + 1) % frame_history;
+	data.frame_count = std::min(data.frame_count + 1, frame_history);
+}
+
+void Instrumentation::RecordZone(const char* name, clock::time_point start, clock::time_point end) {
+	auto& data = Data();
+	std::lock_guard<std::mutex> lock(data.mutex);
+
+	// Zones outside of a frame (e.g. the audio thread between frames) are attributed to the next frame
+	data.current.zones.push_back({ name, GetThreadIndex(data), start, end });
+}
+
+std::vector<Instrumentation::ZoneSummary> Instrumentation::GetSummary(std::chrono::microseconds& frame_time) {
+	using namespace std::chrono;
+
+	auto& data = Data();
+	std::lock_guard<std::mutex> lock(data.mutex);
+
+	struct Accum {
+		const char* name;
+		int depth;
+		clock::duration time;
+		int calls;
+	};
+	std::vector<Accum> accum;
+	std::vector<ZoneRecord> zones;
+	std::vector<clock::time_point> stack;
+	clock::duration total_frame_time = {};
+
+	ForEachFrame(data, [&](const FrameRecord& frame) {
+		total_frame_time += frame.end - frame.start;
+
+		// Zones are recorded when they end: Restore start order to determine the nesting
+		zones = frame.zones;
+		std::stable_sort(zones.begin(), zones.end(), [](const ZoneRecord& l, const ZoneRecord& r) {
+			// On equal start the enclosing (longer) zone comes first
+			return std::tie(l.tid, l.start, r.end) < std::tie(r.tid, r.start, l.end);
+		});
+
+		int tid = -1;
+		for (auto& zone: zones) {
+			if (zone.tid != tid) {
+				tid = zone.tid;
+				stack.clear();
+			}
+			while (!stack.empty() && stack.back() <= zone.start) {
+				stack.pop_back();
+			}
+			int depth = static_cast<int>(stack.size());
+			stack.push_back(zone.end);
+
+			auto it = std::find_if(accum.begin(), accum.end(), [&](const Accum& a) {
+				return a.depth == depth && std::string_view(a.name) == zone.name;
+			});
+			if (it == accum.end()) {
+				accum.push_back({ zone.name, depth, {}, 0 });
+				it = accum.end() - 1;
+			}
+			it->time += zone.end - zone.start;
+			++it->calls;
+		}
+	});
+
+	std::vector<ZoneSummary> summary;
+	if (data.frame_count == 0) {
+		frame_time = {};
+		return summary;
+	}
+
+	const auto n = static_cast<int>(data.frame_count);
+	frame_time = duration_cast<microseconds>(total_frame_time / n);
+	for (auto& a: accum) {
+		summary.push_back({ a.name, a.depth, duration_cast<microseconds>(a.time / n), static_cast<float>(a.calls) / n });
+	}
+	return summary;
+}
+
+bool Instrumentation::WriteChromeTrace(std::ostream& os) {
+	using namespace std::chrono;
+
+	auto& data = Data();
+	std::lock_guard<std::mutex> lock(data.mutex);
+
+	auto ts = [&](clock::time_point t) {
+		return duration_cast<microseconds>(t - data.epoch).count();
+	};
+	auto dur = [](clock::time_point start, clock::time_point end) {
+		return duration_cast<microseconds>(end - start).count();
+	};
+
+	bool first = true;
+	auto write_event = [&](std::string_view name, const char* cat, int tid, clock::time_point start, clock::time_point end) {
+		os << (first ? "\n" : ",\n");
+		first = false;
+		os << "{\"name\":";
+		WriteJsonString(os, name);
+		os << ",\"cat\":\"" << cat << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+			<< ",\"ts\":" << ts(start) << ",\"dur\":" << dur(start, end) << "}";
+	};
+
+	os << "{\"traceEvents\":[";
+	ForEachFrame(data, [&](const FrameRecord& frame) {
+		write_event("Frame", "frame", 0, frame.start, frame.end);
+		for (auto& zone: frame.zones) {
+			write_event(zone.name, "zone", zone.tid, zone.start, zone.end);
+		}
+	});
+	os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	return os.good();
+}
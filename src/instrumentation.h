@@ -25,10 +25,16 @@
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 #include <ittnotify.h>
 #endif
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
 
 class Instrumentation {
 public:
+	using clock = std::chrono::steady_clock;
 	/**
 	 * Must be called once on startup to initialize the instrumentation framework.
 	 *
@@ -73,23 +79,114 @@ public:
 		bool begun = false;
 	};
 
+	/**
+	 * Enables or disables the built-in profiler.
+	 * When disabled all zones are no-ops.
+	 *
+	 * @param enabled whether to record zones
+	 */
+	static void SetProfilerEnabled(bool enabled);
+
+	/** @return whether the built-in profiler is recording */
+	static bool IsProfilerEnabled();
+
+	/**
+	 * RAII timer that records the time spent in a named zone of the current frame.
+	 * Zones can be nested and are recorded from any thread.
+	 */
+	class ZoneScope {
+	public:
+		/**
+		 * Starts a zone.
+		 *
+		 * @param name zone name, must be a string with static lifetime
+		 */
+		explicit ZoneScope(const char* name);
+
+		ZoneScope(const ZoneScope&) = delete;
+		ZoneScope& operator=(const ZoneScope&) = delete;
+
+		/** Ends the zone */
+		~ZoneScope();
+	private:
+		const char* name = nullptr;
+		clock::time_point start;
+	};
+
+	/** Average time spent per frame in a zone */
+	struct ZoneSummary {
+		const char* name;
+		/** nesting depth of the zone */
+		int depth;
+		/** average time per frame */
+		std::chrono::microseconds time;
+		/** average calls per frame */
+		float calls;
+	};
+
+	/**
+	 * Summarizes all frames in the ring buffer.
+	 *
+	 * @param frame_time receives the average time per frame
+	 * @return per zone averages ordered by first appearance
+	 */
+	static std::vector<ZoneSummary> GetSummary(std::chrono::microseconds& frame_time);
+
+	/**
+	 * Writes all frames in the ring buffer in the Chrome Trace Event format
+	 * (viewable in chrome://tracing or Perfetto).
+	 *
+	 * @param os output stream
+	 * @return whether writing succeeded
+	 */
+	static bool WriteChromeTrace(std::ostream& os);
+
 private:
+	static void ProfilerFrameBegin();
+	static void ProfilerFrameEnd();
+	static void RecordZone(const char* name, clock::time_point start, clock::time_point end);
+
+	static std::atomic<bool> profiler_enabled;
+
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 	static __itt_domain* domain;
 #endif
 };
 
+inline bool Instrumentation::IsProfilerEnabled() {
+	return profiler_enabled.load(std::memory_order_relaxed);
+}
+
 inline void Instrumentation::FrameBegin() {
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 	assert(domain);
 	__itt_frame_begin_v3(domain, nullptr);
 #endif
+	if (IsProfilerEnabled()) {
+		ProfilerFrameBegin();
+	}
 }
 inline void Instrumentation::FrameEnd() {
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 	assert(domain);
 	__itt_frame_end_v3(domain, nullptr);
 #endif
+	if (IsProfilerEnabled()) {
+		ProfilerFrameEnd();
+	}
+}
+
+inline Instrumentation::ZoneScope::ZoneScope(const char* name) {
+	if (IsProfilerEnabled()) {
+		this->name = name;
+		start = clock::now();
+	}
+}
+
+inline Instrumentation::ZoneScope::~ZoneScope() {
+	if (name) {
+		RecordZone(name, start, clock::now());
+	}
 }
 
 inline Instrumentation::FrameScope::FrameScope(bool frame_begin)
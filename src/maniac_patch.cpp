@@ -30,6 +30,9 @@
 #include "player.h"
 
 #include <lcf/reader_util.h>
+#include <algorithm>
+#include <array>
+#include <unordered_map>
 #include <vector>
 
 /*
@@ -172,6 +175,213 @@ struct ProcessAssignmentRet {
 	}
 };
 
+namespace {
+	struct FnInfo {
+		const char* name;
+		int num_args;
+	};
+
+	// Indexed by Fn
+	constexpr std::array<FnInfo, 19> fn_info = {{
+		{"rnd", 2}, {"item", 2}, {"event", 2}, {"actor", 2}, {"member", 2}, {"enemy", 2}, {"misc", 1},
+		{"pow", 2}, {"sqrt", 2}, {"sin", 3}, {"cos", 3}, {"atan2", 3}, {"min", 2}, {"max", 2}, {"abs", 1},
+		{"clamp", 3}, {"muldiv", 3}, {"divmul", 3}, {"between", 3}
+	}};
+
+	constexpr int max_fn_args = 3;
+
+	int32_t ClampAdd(int64_t value) {
+		return static_cast<int32_t>(Utils::Clamp<int64_t>(value, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
+	}
+
+	bool IsLoad(Op op) {
+		return op == Op::Var || op == Op::Switch || op == Op::VarIndirect || op == Op::SwitchIndirect;
+	}
+
+	bool IsUnary(Op op) {
+		return op == Op::Negate || op == Op::Not || op == Op::Flip;
+	}
+
+	bool IsInplace(Op op) {
+		return op >= Op::AssignInplace && op <= Op::BitShiftRightInplace;
+	}
+
+	bool IsBinary(Op op) {
+		return op >= Op::Add && op <= Op::And;
+	}
+
+	int Load(Op op, int imm) {
+		switch (op) {
+			case Op::Var:
+				return Main_Data::game_variables->Get(imm);
+			case Op::Switch:
+				return Main_Data::game_switches->GetInt(imm);
+			case Op::VarIndirect:
+				return Main_Data::game_variables->GetIndirect(imm);
+			case Op::SwitchIndirect:
+				return Main_Data::game_switches->GetInt(Main_Data::game_variables->Get(imm));
+			default:
+				return 0;
+		}
+	}
+
+	int Unary(Op op, int imm) {
+		switch (op) {
+			case Op::Negate:
+				return -imm;
+			case Op::Not:
+				return !imm ? 0 : 1;
+			case Op::Flip:
+				return ~imm;
+			default:
+				return 0;
+		}
+	}
+
+	int Binary(Op op, int imm, int imm2) {
+		switch (op) {
+			case Op::Add:
+				return ClampAdd(static_cast<int64_t>(imm) + imm2);
+			case Op::Sub:
+				return ClampAdd(static_cast<int64_t>(imm) - imm2);
+			case Op::Mul:
+				return ClampAdd(static_cast<int64_t>(imm) * imm2);
+			case Op::Div:
+				if (imm2 == 0) {
+					return imm;
+				}
+				return imm / imm2;
+			case Op::Mod:
+				if (imm2 == 0) {
+					return imm;
+				}
+				return imm % imm2;
+			case Op::BitOr:
+				return imm | imm2;
+			case Op::BitAnd:
+				return imm & imm2;
+			case Op::BitXor:
+				return imm ^ imm2;
+			case Op::BitShiftLeft:
+				return imm << imm2;
+			case Op::BitShiftRight:
+				return imm >> imm2;
+			case Op::Equal:
+				return imm == imm2 ? 1 : 0;
+			case Op::GreaterEqual:
+				return imm >= imm2 ? 1 : 0;
+			case Op::LessEqual:
+				return imm <= imm2 ? 1 : 0;
+			case Op::Greater:
+				return imm > imm2 ? 1 : 0;
+			case Op::Less:
+				return imm < imm2 ? 1 : 0;
+			case Op::NotEqual:
+				return imm != imm2 ? 1 : 0;
+			case Op::Or:
+				return !!imm || !!imm2 ? 1 : 0;
+			case Op::And:
+				return !!imm && !!imm2 ? 1 : 0;
+			default:
+				return 0;
+		}
+	}
+
+	int Inplace(Op op, const ProcessAssignmentRet& ret, int imm2) {
+		switch (op) {
+			case Op::AssignInplace:
+				return ret.assign(imm2);
+			case Op::AddInplace:
+				return ret.assign(ClampAdd(static_cast<int64_t>(ret.fetch()) + imm2));
+			case Op::SubInplace:
+				return ret.assign(ClampAdd(static_cast<int64_t>(ret.fetch()) - imm2));
+			case Op::MulInplace:
+				return ret.assign(ClampAdd(static_cast<int64_t>(ret.fetch()) * imm2));
+			case Op::DivInplace:
+				if (imm2 == 0) {
+					return ret.fetch();
+				}
+				return ret.assign(ret.fetch() / imm2);
+			case Op::ModInplace:
+				if (imm2 == 0) {
+					return ret.fetch();
+				}
+				return ret.assign(ret.fetch() % imm2);
+			case Op::BitOrInplace:
+				return ret.assign(ret.fetch() | imm2);
+			case Op::BitAndInplace:
+				return ret.assign(ret.fetch() & imm2);
+			case Op::BitXorInplace:
+				return ret.assign(ret.fetch() ^ imm2);
+			case Op::BitShiftLeftInplace:
+				return ret.assign(ret.fetch() << imm2);
+			case Op::BitShiftRightInplace:
+				return ret.assign(ret.fetch() >> imm2);
+			default:
+				return 0;
+		}
+	}
+
+	// The arguments are stored in reverse order: The first parsed argument is the last parameter.
+	int Call(Fn fn, const int* args, const Game_BaseInterpreterContext& ip) {
+		switch (fn) {
+			case Fn::Rand:
+				return ControlVariables::Random(args[0], args[1]);
+			case Fn::Item:
+				return ControlVariables::Item(args[0], args[1]);
+			case Fn::Event:
+				return ControlVariables::Event(args[0], args[1], ip);
+			case Fn::Actor:
+				return ControlVariables::Actor(args[0], args[1]);
+			case Fn::Party:
+				return ControlVariables::Party(args[0], args[1]);
+			case Fn::Enemy:
+				return ControlVariables::Enemy(args[0], args[1]);
+			case Fn::Misc:
+				return ControlVariables::Other(args[0]);
+			case Fn::Pow:
+				return ControlVariables::Pow(args[0], args[1]);
+			case Fn::Sqrt:
+				return ControlVariables::Sqrt(args[0], args[1]);
+			case Fn::Sin:
+				return ControlVariables::Sin(args[0], args[1], args[2]);
+			case Fn::Cos:
+				return ControlVariables::Cos(args[0], args[1], args[2]);
+			case Fn::Atan2:
+				return ControlVariables::Atan2(args[0], args[1], args[2]);
+			case Fn::Min:
+				return ControlVariables::Min(args[0], args[1]);
+			case Fn::Max:
+				return ControlVariables::Max(args[0], args[1]);
+			case Fn::Abs:
+				return ControlVariables::Abs(args[0]);
+			case Fn::Clamp:
+				return ControlVariables::Clamp(args[0], args[1], args[2]);
+			case Fn::Muldiv:
+				return ControlVariables::Muldiv(args[0], args[1], args[2]);
+			case Fn::Divmul:
+				return ControlVariables::Divmul(args[0], args[1], args[2]);
+			case Fn::Between:
+				return ControlVariables::Between(args[0], args[1], args[2]);
+			default:
+				return 0;
+		}
+	}
+
+	std::vector<int32_t> DecodeOpCodes(Span<const int32_t> op_codes) {
+		std::vector<int32_t> ops;
+		ops.reserve(op_codes.size() * 4);
+		for (auto& o : op_codes) {
+			auto uo = static_cast<uint32_t>(o);
+			ops.push_back(static_cast<int32_t>(uo & 0x000000FF));
+			ops.push_back(static_cast<int32_t>((uo & 0x0000FF00) >> 8));
+			ops.push_back(static_cast<int32_t>((uo & 0x00FF0000) >> 16));
+			ops.push_back(static_cast<int32_t>((uo & 0xFF000000) >> 24));
+		}
+		return ops;
+	}
+}
+
 ProcessAssignmentRet ProcessAssignment(std::vector<int32_t>::iterator& it, std::vector<int32_t>::iterator end, const Game_BaseInterpreterContext& ip);
 
 int Process(std::vector<int32_t>::iterator& it, std::vector<int32_t>::iterator end, const Game_BaseInterpreterContext& ip) {
@@ -187,17 +397,44 @@ int Process(std::vector<int32_t>::iterator& it, std::vector<int32_t>::iterator e
 	auto op = static_cast<Op>(*it);
 	++it;
 
+	if (IsLoad(op)) {
+		imm = Process(it, end, ip);
+		return Load(op, imm);
+	}
+	if (IsUnary(op)) {
+		imm = Process(it, end, ip);
+		return Unary(op, imm);
+	}
+	if (IsInplace(op)) {
+		auto ret = ProcessAssignment(it, end, ip);
+		imm2 = Process(it, end, ip);
+		return Inplace(op, ret, imm2);
+	}
+	if (IsBinary(op)) {
+		imm = Process(it, end, ip);
+		imm2 = Process(it, end, ip);
+		return Binary(op, imm, imm2);
+	}
+
 	// When entering the switch it is on the first argument
 	switch (op) {
 		case Op::Null:
-			it++;
+			if (it != end) {
+				it++;
+			}
 			return 0;
 		case Op::U8:
 		case Op::UX8:
+			if (it == end) {
+				return 0;
+			}
 			value = *it++;
 			return value;
 		case Op::U16:
 		case Op::UX16:
+			if (it == end) {
+				return 0;
+			}
 			imm = *it++;
 			if (it == end) {
 				return 0;
@@ -207,6 +444,9 @@ int Process(std::vector<int32_t>::iterator& it, std::vector<int32_t>::iterator e
 			return value;
 		case Op::S32:
 		case Op::SX32:
+			if (it == end) {
+				return 0;
+			}
 			imm = *it++;
 			if (it == end) {
 				return 0;
@@ -222,173 +462,19 @@ int Process(std::vector<int32_t>::iterator& it, std::vector<int32_t>::iterator e
 			value = *it++;
 			value = (value << 24) + (imm3 << 16) + (imm2 << 8) + imm;
 			return value;
-		case Op::Var:
-			imm = Process(it, end, ip);
-			return Main_Data::game_variables->Get(imm);
-		case Op::Switch:
-			imm = Process(it, end, ip);
-			return Main_Data::game_switches->GetInt(imm);
-		case Op::VarIndirect:
-			imm = Process(it, end, ip);
-			return Main_Data::game_variables->GetIndirect(imm);
-		case Op::SwitchIndirect:
-			imm = Process(it, end, ip);
-			return Main_Data::game_switches->GetInt(Main_Data::game_variables->Get(imm));
-		case Op::Negate:
-			imm = Process(it, end, ip);
-			return -imm;
-		case Op::Not:
-			imm = Process(it, end, ip);
-			return !imm ? 0 : 1;
-		case Op::Flip:
-			imm = Process(it, end, ip);
-			return ~imm;
-		case Op::AssignInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return ret.assign(imm2);
-		}
-		case Op::AddInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return ret.assign(static_cast<int32_t>(Utils::Clamp<int64_t>(static_cast<int64_t>(ret.fetch()) + imm2, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max())));
-		}
-		case Op::SubInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return ret.assign(static_cast<int32_t>(Utils::Clamp<int64_t>(static_cast<int64_t>(ret.fetch()) - imm2, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max())));
-		}
-		case Op::MulInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return ret.assign(static_cast<int32_t>(Utils::Clamp<int64_t>(static_cast<int64_t>(ret.fetch()) * imm2, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max())));
-		}
-		case Op::DivInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			if (imm2 == 0) {
-				return ret.fetch();
-			}
-			return ret.assign(ret.fetch() / imm2);
-		}
-		case Op::ModInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			if (imm2 == 0) {
-				return ret.fetch();
-			}
-			return ret.assign(ret.fetch() % imm2);
-		}
-		case Op::BitOrInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return ret.assign(ret.fetch() | imm2);
-		}
-		case Op::BitAndInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return ret.assign(ret.fetch() & imm2);
-		}
-		case Op::BitXorInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return ret.assign(ret.fetch() ^ imm2);
-		}
-		case Op::BitShiftLeftInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return ret.assign(ret.fetch() << imm2);
-		}
-		case Op::BitShiftRightInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return ret.assign(ret.fetch() >> imm2);
-		}
-		case Op::Add:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return static_cast<int32_t>(Utils::Clamp<int64_t>(static_cast<int64_t>(imm) + imm2, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
-		case Op::Sub:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return static_cast<int32_t>(Utils::Clamp<int64_t>(static_cast<int64_t>(imm) - imm2, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
-		case Op::Mul:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return static_cast<int32_t>(Utils::Clamp<int64_t>(static_cast<int64_t>(imm) * imm2, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
-		case Op::Div:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			if (imm2 == 0) {
-				return imm;
-			}
-			return imm / imm2;
-		case Op::Mod:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			if (imm2 == 0) {
-				return imm;
-			}
-			return imm % imm2;
-		case Op::BitOr:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm | imm2;
-		case Op::BitAnd:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm & imm2;
-		case Op::BitXor:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm ^ imm2;
-		case Op::BitShiftLeft:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm << imm2;
-		case Op::BitShiftRight:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm >> imm2;
-		case Op::Equal:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm == imm2 ? 1 : 0;
-		case Op::GreaterEqual:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm >= imm2 ? 1 : 0;
-		case Op::LessEqual:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm <= imm2 ? 1 : 0;
-		case Op::Greater:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm > imm2 ? 1 : 0;
-		case Op::Less:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm < imm2 ? 1 : 0;
-		case Op::NotEqual:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm != imm2 ? 1 : 0;
-		case Op::Or:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return !!imm || !!imm2 ? 1 : 0;
-		case Op::And:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return !!imm && !!imm2 ? 1 : 0;
 		case Op::Ternary:
 			imm = Process(it, end, ip);
 			imm2 = Process(it, end, ip);
 			imm3 = Process(it, end, ip);
 			return imm != 0 ? imm2 : imm3;
-		case Op::Function:
+		case Op::Function: {
+			if (it == end) {
+				return 0;
+			}
 			imm = *it++; // function
+			if (it == end) {
+				return 0;
+			}
 			imm2 = *it++; // arguments
 
 			if ((imm2 & 0x80) != 0) {
@@ -397,135 +483,26 @@ int Process(std::vector<int32_t>::iterator& it, std::vector<int32_t>::iterator e
 				return 0;
 			}
 
-			switch (static_cast<Fn>(imm)) {
-				case Fn::Rand:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression rnd args {} != 2", imm2);
-						return 0;
-					}
-					imm3 = Process(it, end, ip);
-					return ControlVariables::Random(Process(it, end, ip), imm3);
-				case Fn::Item:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression item args {} != 2", imm2);
-						return 0;
-					}
-					imm3 = Process(it, end, ip);
-					return ControlVariables::Item(Process(it, end, ip), imm3);
-				case Fn::Event:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression event args {} != 2", imm2);
-						return 0;
-					}
-					imm3 = Process(it, end, ip);
-					return ControlVariables::Event(Process(it, end, ip), imm3, ip);
-				case Fn::Actor:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression actor args {} != 2", imm2);
-						return 0;
-					}
-					imm3 = Process(it, end, ip);
-					return ControlVariables::Actor(Process(it, end, ip), imm3);
-				case Fn::Party:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression member args {} != 2", imm2);
-						return 0;
-					}
-					imm3 = Process(it, end, ip);
-					return ControlVariables::Party(Process(it, end, ip), imm3);
-				case Fn::Enemy:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression enemy args {} != 2", imm2);
-						return 0;
-					}
-					imm3 = Process(it, end, ip);
-					return ControlVariables::Enemy(Process(it, end, ip), imm3);
-					break;
-				case Fn::Misc:
-					if (imm2 != 1) {
-						Output::Warning("Maniac: Expression misc args {} != 1", imm2);
-						return 0;
-					}
-					return ControlVariables::Other(Process(it, end, ip));
-				case Fn::Pow:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression pow args {} != 2", imm2);
-						return 0;
-					}
-					return ControlVariables::Pow(Process(it, end, ip), Process(it, end, ip));
-				case Fn::Sqrt:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression sqrt args {} != 2", imm2);
-						return 0;
-					}
-					return ControlVariables::Sqrt(Process(it, end, ip), Process(it, end, ip));
-				case Fn::Sin:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression sin args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Sin(Process(it, end, ip), Process(it, end, ip), Process(it, end, ip));
-				case Fn::Cos:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression cos args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Cos(Process(it, end, ip), Process(it, end, ip), Process(it, end, ip));
-				case Fn::Atan2:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression atan2 args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Atan2(Process(it, end, ip), Process(it, end, ip), Process(it, end, ip));
-				case Fn::Min:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression min args {} != 2", imm2);
-						return 0;
-					}
-					return ControlVariables::Min(Process(it, end, ip), Process(it, end, ip));
-				case Fn::Max:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression max args {} != 2", imm2);
-						return 0;
-					}
-					return ControlVariables::Max(Process(it, end, ip), Process(it, end, ip));
-				case Fn::Abs:
-					if (imm2 != 1) {
-						Output::Warning("Maniac: Expression abs args {} != 1", imm2);
-						return 0;
-					}
-					return ControlVariables::Abs(Process(it, end, ip));
-				case Fn::Clamp:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression clamp args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Clamp(Process(it, end, ip), Process(it, end, ip), Process(it, end, ip));
-				case Fn::Muldiv:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression muldiv args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Muldiv(Process(it, end, ip), Process(it, end, ip), Process(it, end, ip));
-				case Fn::Divmul:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression divmul args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Divmul(Process(it, end, ip), Process(it, end, ip), Process(it, end, ip));
-				case Fn::Between:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression between args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Between(Process(it, end, ip), Process(it, end, ip), Process(it, end, ip));
-				default:
-					Output::Warning("Maniac: Expression Unknown Func {}", imm);
-					for (int i = 0; i < imm2; ++i) {
-						Process(it, end, ip);
-					}
-					return 0;
+			if (imm < 0 || imm >= static_cast<int>(fn_info.size())) {
+				Output::Warning("Maniac: Expression Unknown Func {}", imm);
+				for (int i = 0; i < imm2; ++i) {
+					Process(it, end, ip);
+				}
+				return 0;
+			}
+
+			const auto& info = fn_info[imm];
+			if (imm2 != info.num_args) {
+				Output::Warning("Maniac: Expression {} args {} != {}", info.name, imm2, info.num_args);
+				return 0;
+			}
+
+			std::array<int, max_fn_args> args = {};
+			for (int i = imm2 - 1; i >= 0; --i) {
+				args[i] = Process(it, end, ip);
 			}
+			return Call(static_cast<Fn>(imm), args.data(), ip);
+		}
 		default:
 			Output::Warning("Maniac: Expression contains unsupported operation {}", static_cast<int>(op));
 			return 0;
@@ -558,37 +535,369 @@ ProcessAssignmentRet ProcessAssignment(std::vector<int32_t>::iterator& it, std::
 	}
 }
 
-int32_t ManiacPatch::ParseExpression(Span<const int32_t> op_codes, const Game_BaseInterpreterContext& interpreter) {
-	std::vector<int32_t> ops;
-	for (auto &o: op_codes) {
-		auto uo = static_cast<uint32_t>(o);
-		ops.push_back(static_cast<int32_t>(uo & 0x000000FF));
-		ops.push_back(static_cast<int32_t>((uo & 0x0000FF00) >> 8));
-		ops.push_back(static_cast<int32_t>((uo & 0x00FF0000) >> 16));
-		ops.push_back(static_cast<int32_t>((uo & 0xFF000000) >> 24));
+/**
+ * Translates the op-code stream into a postfix program.
+ * Mirrors Process: The stream position never depends on evaluated values.
+ */
+class ManiacPatch::Expression::Compiler {
+public:
+	using Insn = ManiacPatch::Expression::Instruction;
+	using Code = ManiacPatch::Expression::Code;
+
+	Compiler(std::vector<int32_t>::iterator it, std::vector<int32_t>::iterator end, ManiacPatch::Expression& expr)
+		: it(it), end(end), expr(expr) {}
+
+	void Compile() {
+		if (it == end) {
+			Emit({Code::Push, 0, 0}, 1);
+			return;
+		}
+
+		auto op = static_cast<Op>(*it);
+		++it;
+
+		if (IsLoad(op)) {
+			Compile();
+			Emit({Code::Load, static_cast<int>(op), 0}, 0);
+			return;
+		}
+		if (IsUnary(op)) {
+			Compile();
+			Emit({Code::Unary, static_cast<int>(op), 0}, 0);
+			return;
+		}
+		if (IsInplace(op)) {
+			Op target = CompileAssignment();
+			Compile();
+			Emit({Code::Inplace, static_cast<int>(op), static_cast<int>(target)}, -1);
+			return;
+		}
+		if (IsBinary(op)) {
+			Compile();
+			Compile();
+			Emit({Code::Binary, static_cast<int>(op), 0}, -1);
+			return;
+		}
+
+		switch (op) {
+			case Op::Null:
+				if (it != end) {
+					it++;
+				}
+				Emit({Code::Push, 0, 0}, 1);
+				return;
+			case Op::U8:
+			case Op::UX8:
+				Emit({Code::Push, Read(1), 0}, 1);
+				return;
+			case Op::U16:
+			case Op::UX16:
+				Emit({Code::Push, Read(2), 0}, 1);
+				return;
+			case Op::S32:
+			case Op::SX32:
+				Emit({Code::Push, Read(4), 0}, 1);
+				return;
+			case Op::Ternary:
+				Compile();
+				Compile();
+				Compile();
+				Emit({Code::Ternary, 0, 0}, -2);
+				return;
+			case Op::Function: {
+				if (it == end) {
+					Emit({Code::Push, 0, 0}, 1);
+					return;
+				}
+				int fn = *it++;
+				if (it == end) {
+					Emit({Code::Push, 0, 0}, 1);
+					return;
+				}
+				int num_args = *it++;
+
+				if ((num_args & 0x80) != 0) {
+					Fail("Maniac: Expression func long args unsupported", 0);
+					return;
+				}
+
+				if (fn < 0 || fn >= static_cast<int>(fn_info.size())) {
+					for (int i = 0; i < num_args; ++i) {
+						Compile();
+					}
+					Fail(fmt::format("Maniac: Expression Unknown Func {}", fn), num_args);
+					return;
+				}
+
+				const auto& info = fn_info[fn];
+				if (num_args != info.num_args) {
+					Fail(fmt::format("Maniac: Expression {} args {} != {}", info.name, num_args, info.num_args), 0);
+					return;
+				}
+
+				for (int i = 0; i < num_args; ++i) {
+					Compile();
+				}
+				Emit({Code::Call, fn, num_args}, 1 - num_args);
+				return;
+			}
+			default:
+				Fail(fmt::format("Maniac: Expression contains unsupported operation {}", static_cast<int>(op)), 0);
+				return;
+		}
+	}
+
+	bool AtEnd() const {
+		return it == end || static_cast<Op>(*it) == Op::Null;
+	}
+
+	/** The stack is emptied after each expression */
+	void EndExpression() {
+		depth = 0;
+	}
+
+private:
+	/** Mirrors ProcessAssignment, the target id is pushed */
+	Op CompileAssignment() {
+		if (it == end) {
+			Emit({Code::Push, 0, 0}, 1);
+			return Op::Null;
+		}
+
+		auto op = static_cast<Op>(*it);
+		if (!IsLoad(op)) {
+			// Not a lvalue: Evaluated as a whole, the assignment fails at runtime
+			Compile();
+			return op;
+		}
+		++it;
+		Compile();
+		return op;
+	}
+
+	/** Reads a little endian immediate of the given size, 0 when the stream ends early */
+	int Read(int bytes) {
+		int value = 0;
+		for (int i = 0; i < bytes; ++i) {
+			if (it == end) {
+				return 0;
+			}
+			value += *it++ << (i * 8);
+		}
+		return value;
+	}
+
+	void Fail(std::string msg, int num_pop) {
+		expr.warnings.push_back(std::move(msg));
+		Emit({Code::Fail, static_cast<int>(expr.warnings.size() - 1), num_pop}, 1 - num_pop);
+	}
+
+	void Emit(Insn insn, int stack_change) {
+		if (insn.code != Code::Push && insn.code != Code::Unary && insn.code != Code::Binary && insn.code != Code::Ternary) {
+			expr.constant = false;
+		}
+		expr.code.push_back(insn);
+		depth += stack_change;
+		expr.max_depth = std::max(expr.max_depth, depth);
+	}
+
+	std::vector<int32_t>::iterator it;
+	std::vector<int32_t>::iterator end;
+	ManiacPatch::Expression& expr;
+	int depth = 0;
+};
+
+ManiacPatch::Expression::Expression(Span<const int32_t> op_codes, bool multiple) {
+	auto ops = DecodeOpCodes(op_codes);
+	Compiler compiler(ops.begin(), ops.end(), *this);
+
+	if (!multiple) {
+		compiler.Compile();
+		ends.push_back(code.size());
+		compiler.EndExpression();
+	} else if (!ops.empty()) {
+		while (true) {
+			compiler.Compile();
+			ends.push_back(code.size());
+			compiler.EndExpression();
+			if (compiler.AtEnd()) {
+				break;
+			}
+		}
+	}
+
+	if (constant && !code.empty()) {
+		// No reads and no side effects: Fold into one push per result
+		std::vector<int32_t> values;
+		Run(nullptr, values);
+
+		code.clear();
+		ends.clear();
+		for (auto value: values) {
+			code.push_back({Code::Push, value, 0});
+			ends.push_back(code.size());
+		}
+		max_depth = 1;
 	}
-	auto beg = ops.begin();
-	return Process(beg, ops.end(), interpreter);
 }
 
-std::vector<int32_t> ManiacPatch::ParseExpressions(Span<const int32_t> op_codes, const Game_BaseInterpreterContext& interpreter) {
-	std::vector<int32_t> ops;
-	for (auto& o : op_codes) {
-		auto uo = static_cast<uint32_t>(o);
-		ops.push_back(static_cast<int32_t>(uo & 0x000000FF));
-		ops.push_back(static_cast<int32_t>((uo & 0x0000FF00) >> 8));
-		ops.push_back(static_cast<int32_t>((uo & 0x00FF0000) >> 16));
-		ops.push_back(static_cast<int32_t>((uo & 0xFF000000) >> 24));
+int32_t ManiacPatch::Expression::Evaluate(const Game_BaseInterpreterContext& interpreter) const {
+	if (constant && !code.empty()) {
+		return code.front().arg;
+	}
+	std::vector<int32_t> values;
+	Run(&interpreter, values);
+	return values.empty() ? 0 : values.front();
+}
+
+std::vector<int32_t> ManiacPatch::Expression::EvaluateAll(const Game_BaseInterpreterContext& interpreter) const {
+	std::vector<int32_t> values;
+	Run(&interpreter, values);
+	return values;
+}
+
+void ManiacPatch::Expression::Run(const Game_BaseInterpreterContext* interpreter, std::vector<int32_t>& values) const {
+	std::array<int32_t, 64> small_stack;
+	std::vector<int32_t> large_stack;
+	int32_t* stack = small_stack.data();
+	if (max_depth > static_cast<int>(small_stack.size())) {
+		large_stack.resize(max_depth);
+		stack = large_stack.data();
 	}
 
+	int sp = 0;
+	size_t next_end = 0;
+	for (size_t pc = 0; pc < code.size(); ++pc) {
+		const auto& insn = code[pc];
+		switch (insn.code) {
+			case Code::Push:
+				stack[sp++] = insn.arg;
+				break;
+			case Code::Load:
+				stack[sp - 1] = Load(static_cast<Op>(insn.arg), stack[sp - 1]);
+				break;
+			case Code::Unary:
+				stack[sp - 1] = Unary(static_cast<Op>(insn.arg), stack[sp - 1]);
+				break;
+			case Code::Binary:
+				--sp;
+				stack[sp - 1] = Binary(static_cast<Op>(insn.arg), stack[sp - 1], stack[sp]);
+				break;
+			case Code::Ternary:
+				sp -= 2;
+				stack[sp - 1] = stack[sp - 1] != 0 ? stack[sp] : stack[sp + 1];
+				break;
+			case Code::Inplace: {
+				--sp;
+				ProcessAssignmentRet ret = {static_cast<Op>(insn.arg2), stack[sp - 1]};
+				stack[sp - 1] = Inplace(static_cast<Op>(insn.arg), ret, stack[sp]);
+				break;
+			}
+			case Code::Call: {
+				// Reverse the parsed order into parameter order
+				std::array<int, max_fn_args> args = {};
+				for (int i = 0; i < insn.arg2; ++i) {
+					args[i] = stack[--sp];
+				}
+				stack[sp++] = Call(static_cast<Fn>(insn.arg), args.data(), *interpreter);
+				break;
+			}
+			case Code::Fail:
+				sp -= insn.arg2;
+				Output::WarningStr(warnings[insn.arg]);
+				stack[sp++] = 0;
+				break;
+		}
+
+		if (next_end < ends.size() && pc + 1 == ends[next_end]) {
+			values.push_back(stack[sp - 1]);
+			sp = 0;
+			++next_end;
+		}
+	}
+}
+
+namespace {
+	/** Hashes the content of the op-codes, copies of a command list (e.g. of called events) share one cache entry */
+	uint64_t HashOpCodes(Span<const int32_t> op_codes, bool multiple) {
+		auto mix = [](uint64_t h) {
+			// splitmix64 finalizer
+			h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+			h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+			return h ^ (h >> 31);
+		};
+
+		uint64_t hash = mix(op_codes.size() * 2 + (multiple ? 1 : 0));
+		for (int32_t o : op_codes) {
+			hash = mix(hash ^ static_cast<uint32_t>(o));
+		}
+		return hash;
+	}
+
+	struct CachedExpression {
+		std::vector<int32_t> op_codes;
+		bool multiple = false;
+		ManiacPatch::Expression expr;
+	};
+
+	ManiacPatch::ExpressionHash expression_hash = HashOpCodes;
+	// Bucketed by expression_hash, the entries of a bucket are compared by content
+	std::unordered_map<uint64_t, std::vector<CachedExpression>> expression_cache;
+	size_t expression_cache_size = 0;
+	// Only reached by games with an unusual amount of distinct expressions
+	constexpr size_t expression_cache_limit = 4096;
+
+	const ManiacPatch::Expression& GetExpression(Span<const int32_t> op_codes, bool multiple) {
+		const uint64_t key = expression_hash(op_codes, multiple);
+		auto it = expression_cache.find(key);
+		if (it != expression_cache.end()) {
+			for (auto& entry : it->second) {
+				if (entry.multiple == multiple && std::equal(entry.op_codes.begin(), entry.op_codes.end(), op_codes.begin(), op_codes.end())) {
+					return entry.expr;
+				}
+			}
+		}
+
+		if (expression_cache_size >= expression_cache_limit) {
+			expression_cache.clear();
+			expression_cache_size = 0;
+		}
+
+		auto& bucket = expression_cache[key];
+		bucket.push_back({ std::vector<int32_t>(op_codes.begin(), op_codes.end()), multiple, ManiacPatch::Expression(op_codes, multiple) });
+		++expression_cache_size;
+		return bucket.back().expr;
+	}
+}
+
+void ManiacPatch::SetExpressionHash(ExpressionHash hash) {
+	expression_hash = hash ? hash : HashOpCodes;
+	expression_cache.clear();
+	expression_cache_size = 0;
+}
+
+int32_t ManiacPatch::ParseExpression(Span<const int32_t> op_codes, const Game_BaseInterpreterContext& interpreter) {
+	return GetExpression(op_codes, false).Evaluate(interpreter);
+}
+
+std::vector<int32_t> ManiacPatch::ParseExpressions(Span<const int32_t> op_codes, const Game_BaseInterpreterContext& interpreter) {
+	return GetExpression(op_codes, true).EvaluateAll(interpreter);
+}
+
+int32_t ManiacPatch::InterpretExpression(Span<const int32_t> op_codes, const Game_BaseInterpreterContext& interpreter) {
+	auto ops = DecodeOpCodes(op_codes);
+	auto beg = ops.begin();
+	return Process(beg, ops.end(), interpreter);
+}
+
+std::vector<int32_t> ManiacPatch::InterpretExpressions(Span<const int32_t> op_codes, const Game_BaseInterpreterContext& interpreter) {
+	auto ops = DecodeOpCodes(op_codes);
 	if (ops.empty()) {
 		return {};
 	}
 
-	auto it = ops.begin();
-
 	std::vector<int32_t> results;
-
+	auto it = ops.begin();
 	while (true) {
 		results.push_back(Process(it, ops.end(), interpreter));
 
@@ -596,7 +905,6 @@ std::vector<int32_t> ManiacPatch::ParseExpressions(Span<const int32_t> op_codes,
 			break;
 		}
 	}
-
 	return results;
 }
 
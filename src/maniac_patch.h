@@ -21,6 +21,7 @@
 
 #include <array>
 #include <cstdint>
+#include <string>
 #include <vector>
 #include "span.h"
 
@@ -29,9 +30,88 @@
 class Game_BaseInterpreterContext;
 
 namespace ManiacPatch {
+	/**
+	 * A Maniac expression translated into a postfix program.
+	 * Compiling once avoids decoding and walking the op-code stream on every evaluation.
+	 */
+	class Expression {
+	public:
+		enum class Code : uint8_t {
+			/** Push arg */
+			Push,
+			/** Replace top with the variable or switch of kind arg */
+			Load,
+			/** Apply unary op arg to top */
+			Unary,
+			/** Apply binary op arg to the two top values */
+			Binary,
+			/** Select between the two top values by the third value */
+			Ternary,
+			/** Inplace op arg on a target of kind arg2, target id and value on the stack */
+			Inplace,
+			/** Call function arg with arg2 arguments */
+			Call,
+			/** Pop arg2 values, report warning arg and push 0 */
+			Fail
+		};
+
+		struct Instruction {
+			Code code;
+			int32_t arg;
+			int32_t arg2;
+		};
+
+		Expression() = default;
+
+		/**
+		 * Compiles the op-codes of an expression.
+		 *
+		 * @param op_codes op-codes as stored in the event command
+		 * @param multiple when true the op-codes contain a list of expressions (see ParseExpressions)
+		 */
+		Expression(Span<const int32_t> op_codes, bool multiple);
+
+		/** @return result of the first expression */
+		int32_t Evaluate(const Game_BaseInterpreterContext& interpreter) const;
+
+		/** @return results of all expressions */
+		std::vector<int32_t> EvaluateAll(const Game_BaseInterpreterContext& interpreter) const;
+
+	private:
+		class Compiler;
+
+		void Run(const Game_BaseInterpreterContext* interpreter, std::vector<int32_t>& values) const;
+
+		std::vector<Instruction> code;
+		/** Instruction index after the end of each expression */
+		std::vector<size_t> ends;
+		std::vector<std::string> warnings;
+		int max_depth = 0;
+		/** Expression has no reads and no side effects */
+		bool constant = true;
+	};
+
+	/**
+	 * Evaluates an expression.
+	 * The compiled program is cached, keyed by the content of the op-codes.
+	 */
 	int32_t ParseExpression(Span<const int32_t> op_codes, const Game_BaseInterpreterContext& interpreter);
 	std::vector<int32_t> ParseExpressions(Span<const int32_t> op_codes, const Game_BaseInterpreterContext& interpreter);
 
+	using ExpressionHash = uint64_t(*)(Span<const int32_t> op_codes, bool multiple);
+
+	/**
+	 * Replaces the hash function of the expression cache and clears the cache.
+	 * Used by the tests to force collisions.
+	 *
+	 * @param hash hash function, nullptr restores the default
+	 */
+	void SetExpressionHash(ExpressionHash hash);
+
+	/** Evaluates an expression by walking the op-codes without compiling or caching them */
+	int32_t InterpretExpression(Span<const int32_t> op_codes, const Game_BaseInterpreterContext& interpreter);
+	std::vector<int32_t> InterpretExpressions(Span<const int32_t> op_codes, const Game_BaseInterpreterContext& interpreter);
+
 
 	std::array<bool, 50> GetKeyRange();
 
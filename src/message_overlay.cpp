@@ -60,6 +60,14 @@ void MessageOverlay::Draw(Bitmap& dst) {
 	dirty = false;
 }
 
+bool MessageOverlay::GetDamage(Rect& damage) {
+	const bool draw = (IsAnyMessageVisible() || show_all) && bitmap;
+	damage_tracker.Begin(*this) << draw << bitmap << dirty << ox << oy;
+
+	damage = damage_tracker.End(draw ? Rect(ox, oy, bitmap->GetWidth(), bitmap->GetHeight()) : Rect());
+	return true;
+}
+
 void MessageOverlay::AddMessage(const std::string& message, Color color) {
 	if (message.empty()) {
 		return;
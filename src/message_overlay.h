@@ -21,6 +21,7 @@
 #include <deque>
 #include <string>
 #include "color.h"
+#include "damage_tracker.h"
 #include "drawable.h"
 #include "memory_management.h"
 #include "tone.h"
@@ -45,6 +46,8 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	bool GetDamage(Rect& damage) override;
+
 	void Update();
 
 	void AddMessage(const std::string& message, Color color);
@@ -74,6 +77,8 @@ private:
 	int counter = 0;
 
 	bool show_all = false;
+
+	DamageTracker damage_tracker;
 };
 
 #endif
@@ -90,3 +90,15 @@ void Plane::Draw(Bitmap& dst) {
 	dst.TiledBlit(src_x, src_y, source->GetRect(), *source, dst_rect, 255);
 }
 
+bool Plane::GetDamage(Rect& damage) {
+	damage_tracker.Begin(*this) << bitmap << tone_effect << ox << oy << needs_refresh;
+
+	if (bitmap && IsVisible()) {
+		damage_tracker << Main_Data::game_screen->GetShakeOffsetX() << Main_Data::game_screen->GetShakeOffsetY()
+			<< Game_Map::LoopHorizontal() << Game_Map::GetDisplayX() << Game_Map::GetTilesX();
+	}
+
+	// The panorama covers the whole screen
+	damage = damage_tracker.End(Rect(0, 0, Player::screen_width, Player::screen_height));
+	return true;
+}
@@ -21,6 +21,7 @@
 // Headers
 #include "system.h"
 #include "color.h"
+#include "damage_tracker.h"
 #include "drawable.h"
 #include "tone.h"
 
@@ -33,6 +34,8 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	bool GetDamage(Rect& damage) override;
+
 	BitmapRef const& GetBitmap() const;
 	void SetBitmap(BitmapRef const& bitmap);
 	int GetOx() const;
@@ -51,6 +54,8 @@ private:
 	int ox = 0;
 	int oy = 0;
 	bool needs_refresh = false;
+
+	DamageTracker damage_tracker;
 };
 
 inline BitmapRef const& Plane::GetBitmap() const {
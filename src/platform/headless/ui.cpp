@@ -0,0 +1,135 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "ui.h"
+#include "audio.h"
+#include "bitmap.h"
+#include "output.h"
+#include "player.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+	// Interval in which the frame statistics are logged
+	constexpr auto report_interval = std::chrono::seconds(10);
+}
+
+#ifdef SUPPORT_AUDIO
+AudioInterface& HeadlessUi::GetAudio() {
+	return *audio_;
+}
+#endif
+
+HeadlessUi::HeadlessUi(int width, int height, const Game_Config& cfg) : BaseUi(cfg)
+{
+	// There is no window
+	SetIsFullscreen(false);
+
+	current_display_mode.width = width;
+	current_display_mode.height = height;
+	current_display_mode.bpp = 32;
+
+	// The UI drives the game clock: One logical frame per main loop iteration
+	SetFrameRateSynchronized(true);
+	Game_Clock::SetFixedTimeStep(true);
+
+	const DynamicFormat format(
+		32,
+		0x00FF0000,
+		0x0000FF00,
+		0x000000FF,
+		0xFF000000,
+		PF::NoAlpha);
+
+	Bitmap::SetFormat(Bitmap::ChooseFormat(format));
+
+	main_surface = Bitmap::Create(current_display_mode.width,
+		current_display_mode.height,
+		false,
+		current_display_mode.bpp
+	);
+
+#ifdef SUPPORT_AUDIO
+	audio_ = std::make_unique<EmptyAudio>(cfg.audio);
+#endif
+
+	screenshot_frames = Player::headless_screenshot_frames;
+	std::sort(screenshot_frames.begin(), screenshot_frames.end());
+	exit_frame = Player::headless_exit_frame;
+
+	start_time = Game_Clock::now();
+	last_report_time = start_time;
+
+	Output::Debug("Headless: Rendering into {}x{} surface", width, height);
+}
+
+HeadlessUi::~HeadlessUi() {
+	PrintStatistics("Headless: Finished,");
+	Game_Clock::SetFixedTimeStep(false);
+}
+
+bool HeadlessUi::vChangeDisplaySurfaceResolution(int new_width, int new_height) {
+	BitmapRef new_main_surface = Bitmap::Create(new_width, new_height, false, current_display_mode.bpp);
+
+	if (!new_main_surface) {
+		Output::Warning("ChangeDisplaySurfaceResolution Bitmap::Create failed");
+		return false;
+	}
+
+	main_surface = new_main_surface;
+
+	current_display_mode.width = new_width;
+	current_display_mode.height = new_height;
+
+	return true;
+}
+
+void HeadlessUi::UpdateDisplay() {
+	++rendered_frames;
+
+	const int frame = Player::GetFrames();
+	while (next_screenshot < screenshot_frames.size() && screenshot_frames[next_screenshot] <= frame) {
+		Output::TakeScreenshot(fmt::format("headless_{:06d}.png", frame));
+		++next_screenshot;
+	}
+
+	auto now = Game_Clock::now();
+	if (now - last_report_time >= report_interval) {
+		last_report_time = now;
+		PrintStatistics("Headless:");
+	}
+}
+
+bool HeadlessUi::ProcessEvents() {
+	// No input devices, input is provided by --replay-input
+	return exit_frame <= 0 || Player::GetFrames() < exit_frame;
+}
+
+void HeadlessUi::vGetConfig(Game_ConfigVideo& cfg) const {
+	cfg.renderer.Lock("Headless (Software)");
+	cfg.game_resolution.SetOptionVisible(true);
+}
+
+void HeadlessUi::PrintStatistics(const char* prefix) const {
+	auto elapsed = std::chrono::duration<double>(Game_Clock::now() - start_time).count();
+	double fps = elapsed > 0.0 ? rendered_frames / elapsed : 0.0;
+
+	Output::Info("{} {} frames ({} logical) in {:.2f}s, {:.1f} FPS",
+		prefix, rendered_frames, Player::GetFrames(), elapsed, fps);
+}
@@ -0,0 +1,85 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_PLATFORM_HEADLESS_UI_H
+#define EP_PLATFORM_HEADLESS_UI_H
+
+// Headers
+#include "baseui.h"
+#include "game_clock.h"
+#include "system.h"
+#include <vector>
+
+/**
+ * HeadlessUi class.
+ *
+ * Renders into an in-memory surface and discards all audio.
+ * The game clock advances by exactly one logical frame per main loop
+ * iteration, so the Player runs as fast as the CPU allows.
+ * Intended for automated runs (e.g. --replay-input) without a display.
+ */
+class HeadlessUi final : public BaseUi {
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param width display surface width.
+	 * @param height display surface height.
+	 * @param cfg config options
+	 */
+	HeadlessUi(int width, int height, const Game_Config& cfg);
+
+	/**
+	 * Destructor.
+	 */
+	~HeadlessUi() override;
+
+	/**
+	 * Inherited from BaseUi.
+	 */
+	/** @{ */
+	bool vChangeDisplaySurfaceResolution(int new_width, int new_height) override;
+	void UpdateDisplay() override;
+	bool ProcessEvents() override;
+	void vGetConfig(Game_ConfigVideo& cfg) const override;
+
+#ifdef SUPPORT_AUDIO
+	AudioInterface& GetAudio() override;
+#endif
+	/** @} */
+
+private:
+	/** Logs the amount of rendered frames and the achieved frames per second */
+	void PrintStatistics(const char* prefix) const;
+
+#ifdef SUPPORT_AUDIO
+	std::unique_ptr<AudioInterface> audio_;
+#endif
+
+	/** Frames (sorted ascending) at which a screenshot is taken */
+	std::vector<int> screenshot_frames;
+	size_t next_screenshot = 0;
+
+	/** Player exits when this frame is reached, 0 to run until the game ends */
+	int exit_frame = 0;
+
+	Game_Clock::time_point start_time;
+	Game_Clock::time_point last_report_time;
+	int rendered_frames = 0;
+};
+
+#endif
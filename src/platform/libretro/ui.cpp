@@ -19,6 +19,7 @@
 #include "ui.h"
 #include "clock.h"
 #include "bitmap.h"
+#include "bitmap_scaler.h"
 #include "color.h"
 #include "filefinder.h"
 #include "graphics.h"
@@ -31,6 +32,7 @@
 #include "scene.h"
 #include "utils.h"
 
+#include <algorithm>
 #include <cstring>
 #include <cstdio>
 #include <cstdint>
@@ -41,6 +43,7 @@
 
 namespace Options {
 	const char* debug_mode = "easyrpg_debug_mode";
+	const char* upscale = "easyrpg_upscale";
 }
 
 #ifdef SUPPORT_AUDIO
@@ -106,9 +109,35 @@ void LibretroUi::UpdateDisplay() {
 		return;
 	}
 
+	if (upscaled_surface) {
+		BitmapScaler::Scale(*upscaled_surface, *main_surface, ConfigEnum::ScalingMode::Integer, true);
+		UpdateWindow(upscaled_surface->pixels(), upscaled_surface->width(), upscaled_surface->height(), upscaled_surface->pitch());
+		return;
+	}
+
 	UpdateWindow(main_surface->pixels(), current_display_mode.width, current_display_mode.height, main_surface->pitch());
 }
 
+bool LibretroUi::UpdateGeometry(int width, int height) {
+	// The framebuffer must fit into the maximum size reported in av_info
+	const int factor = std::clamp(std::min({ upscale, fb_max_width / width, fb_max_height / height }), 1, BitmapScaler::max_factor);
+
+	retro_game_geometry geom = {};
+	geom.base_width = width * factor;
+	geom.base_height = height * factor;
+	if (!LibretroUi::environ_cb(RETRO_ENVIRONMENT_SET_GEOMETRY, &geom)) {
+		Output::Warning("UpdateGeometry: SET_GEOMETRY failed");
+		return false;
+	}
+
+	upscaled_surface.reset();
+	if (factor > 1) {
+		upscaled_surface = Bitmap::Create(width * factor, height * factor, false, current_display_mode.bpp);
+	}
+
+	return true;
+}
+
 bool LibretroUi::vChangeDisplaySurfaceResolution(int new_width, int new_height) {
 	if (new_width > fb_max_width || new_height > fb_max_height) {
 		Output::Warning("ChangeDisplaySurfaceResolution: {}x{} is too large", new_width, new_height);
@@ -122,11 +151,7 @@ bool LibretroUi::vChangeDisplaySurfaceResolution(int new_width, int new_height)
 		return false;
 	}
 
-	retro_game_geometry geom = {};
-	geom.base_width = new_width;
-	geom.base_height = new_height;
-	if (!LibretroUi::environ_cb(RETRO_ENVIRONMENT_SET_GEOMETRY, &geom)) {
-		Output::Warning("ChangeDisplaySurfaceResolution SET_GEOMETRY failed");
+	if (!UpdateGeometry(new_width, new_height)) {
 		return false;
 	}
 
@@ -203,6 +228,17 @@ void LibretroUi::UpdateVariables() {
 
 	LibretroUi::environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &debug);
 	Player::debug_flag = strcmp(debug.value, "Enabled") == 0;
+
+	static struct retro_variable upscale_var = { Options::upscale, nullptr };
+
+	int new_upscale = 1;
+	if (LibretroUi::environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &upscale_var) && upscale_var.value) {
+		new_upscale = std::max(atoi(upscale_var.value), 1);
+	}
+	if (new_upscale != upscale) {
+		upscale = new_upscale;
+		UpdateGeometry(current_display_mode.width, current_display_mode.height);
+	}
 }
 
 #if defined(USE_JOYSTICK) && defined(SUPPORT_JOYSTICK)
@@ -313,6 +349,7 @@ RETRO_API void retro_set_environment(retro_environment_t cb) {
 
 	struct retro_variable variables[] = {
 		{ Options::debug_mode, "Debug menu and walk through walls; Disabled|Enabled" },
+		{ Options::upscale, "Upscale the output (integer nearest neighbour); 1x|2x|3x|4x|5x|6x" },
 		{ nullptr, nullptr }
 	};
 	cb(RETRO_ENVIRONMENT_SET_VARIABLES, variables);
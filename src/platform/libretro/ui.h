@@ -69,6 +69,21 @@ private:
 	static retro_input_state_t CheckInputState;
 
 	void UpdateVariables();
+
+	/**
+	 * Reports the framebuffer size to the frontend and prepares the upscaled surface.
+	 *
+	 * @param width width of main_surface
+	 * @param height height of main_surface
+	 * @return whether the frontend accepted the size
+	 */
+	bool UpdateGeometry(int width, int height);
+
+	/** Requested integer upscale factor of the output */
+	int upscale = 1;
+
+	/** main_surface scaled by the upscale factor, null when not scaled */
+	BitmapRef upscaled_surface;
 };
 
 #endif
@@ -41,6 +41,8 @@
 #include "output.h"
 #include "player.h"
 #include "bitmap.h"
+#include "bitmap_scaler.h"
+#include "instrumentation.h"
 #include "lcf/scope_guard.h"
 
 #if defined(__APPLE__) && TARGET_OS_OSX
@@ -114,6 +116,16 @@ static DynamicFormat GetDynamicFormat(uint32_t fmt) {
 	}
 }
 
+/**
+ * Whether the renderer is the software renderer. Its streaming textures are
+ * plain memory which is kept between locks and not uploaded again on unlock.
+ * Other renderers upload directly from the pointer passed to SDL_UpdateTexture,
+ * drawing into the locked texture saves nothing there.
+ */
+static bool IsSoftwareRenderer(const SDL_RendererInfo& rinfo) {
+	return rinfo.name && strcmp(rinfo.name, "software") == 0;
+}
+
 static uint32_t SelectFormat(const SDL_RendererInfo& rinfo, bool print_all) {
 	uint32_t current_fmt = SDL_PIXELFORMAT_UNKNOWN;
 	int current_rank = -1;
@@ -214,12 +226,19 @@ Sdl2Ui::~Sdl2Ui() {
 	if (sdl_joystick) {
 		SDL_JoystickClose(sdl_joystick);
 	}
+	if (texture_locked) {
+		// The surface uses the memory of the texture
+		main_surface.reset();
+	}
 	if (sdl_texture_game) {
 		SDL_DestroyTexture(sdl_texture_game);
 	}
 	if (sdl_texture_scaled) {
 		SDL_DestroyTexture(sdl_texture_scaled);
 	}
+	if (sdl_texture_upscaled) {
+		SDL_DestroyTexture(sdl_texture_upscaled);
+	}
 	if (sdl_renderer) {
 		SDL_DestroyRenderer(sdl_renderer);
 	}
@@ -250,6 +269,8 @@ bool Sdl2Ui::vChangeDisplaySurfaceResolution(int new_width, int new_height) {
 	}
 
 	sdl_texture_game = new_sdl_texture_game;
+	sdl_texture_game_outdated = true;
+	texture_locked = false;
 
 	BitmapRef new_main_surface = Bitmap::Create(new_width, new_height, Color(0, 0, 0, 255));
 
@@ -261,6 +282,10 @@ bool Sdl2Ui::vChangeDisplaySurfaceResolution(int new_width, int new_height) {
 	main_surface = new_main_surface;
 	window.size_changed = true;
 
+	if (draw_into_texture) {
+		LockGameTexture();
+	}
+
 	BeginDisplayModeChange();
 
 	current_display_mode.width = new_width;
@@ -408,6 +433,10 @@ bool Sdl2Ui::RefreshDisplayMode() {
 					!!(rinfo.flags & SDL_RENDERER_PRESENTVSYNC)
 					);
 			texture_format = SelectFormat(rinfo, false);
+#ifndef __WIIU__
+			software_renderer = IsSoftwareRenderer(rinfo);
+			draw_into_texture = software_renderer;
+#endif
 		} else {
 			Output::Debug("SDL_GetRendererInfo failed : {}", SDL_GetError());
 		}
@@ -433,6 +462,7 @@ bool Sdl2Ui::RefreshDisplayMode() {
 			texture_format,
 			SDL_TEXTUREACCESS_STREAMING,
 			display_width, display_height);
+		sdl_texture_game_outdated = true;
 
 		if (!sdl_texture_game) {
 			Output::Debug("SDL_CreateTexture failed : {}", SDL_GetError());
@@ -487,6 +517,54 @@ bool Sdl2Ui::RefreshDisplayMode() {
 			display_width, display_height, Color(0, 0, 0, 255));
 	}
 
+	if (draw_into_texture && !texture_locked) {
+		// Only possible when the texture has the layout of the surface, otherwise it is copied
+		const auto& surface_format = Bitmap::pixel_format;
+		if (format.bits == 32 && format.r.mask == surface_format.r.mask
+			&& format.g.mask == surface_format.g.mask && format.b.mask == surface_format.b.mask) {
+			LockGameTexture();
+		} else {
+			draw_into_texture = false;
+		}
+		Output::Debug("SDL2: Drawing into the texture: {}", draw_into_texture);
+	}
+
+	return true;
+}
+
+bool Sdl2Ui::LockGameTexture() {
+	void* pixels;
+	int pitch;
+	if (SDL_LockTexture(sdl_texture_game, nullptr, &pixels, &pitch) != 0) {
+		Output::Debug("SDL_LockTexture failed : {}", SDL_GetError());
+		draw_into_texture = false;
+		if (texture_locked) {
+			// Continue with a copy of the last frame and upload it every frame
+			BitmapRef surface = Bitmap::Create(main_surface->width(), main_surface->height(), true);
+			surface->BlitFast(0, 0, *main_surface, main_surface->GetRect(), Opacity::Opaque());
+			main_surface = surface;
+			texture_locked = false;
+			sdl_texture_game_outdated = true;
+		}
+		return false;
+	}
+
+	// The software renderer returns the same memory on every lock, the surface
+	// must only be replaced after the texture was recreated.
+	// Read through a const reference: Non-const pixel access counts as a modification
+	const Bitmap& current = *main_surface;
+	if (current.pixels() != pixels || current.pitch() != pitch) {
+		BitmapRef surface = Bitmap::Create(pixels, main_surface->width(), main_surface->height(), pitch, Bitmap::pixel_format);
+		if (texture_locked) {
+			// The old memory is gone, the next frame is drawn completely
+			surface->Fill(Color(0, 0, 0, 255));
+		} else {
+			surface->BlitFast(0, 0, *main_surface, main_surface->GetRect(), Opacity::Opaque());
+		}
+		main_surface = surface;
+	}
+
+	texture_locked = true;
 	return true;
 }
 
@@ -587,6 +665,8 @@ void Sdl2Ui::ToggleVsync() {
 }
 
 void Sdl2Ui::UpdateDisplay() {
+	Instrumentation::ZoneScope zone("Sdl2Ui::UpdateDisplay");
+
 #ifdef __WIIU__
 	if (vcfg.scaling_mode.Get() == ConfigEnum::ScalingMode::Bilinear && window.scale > 0.f) {
 		// Workaround WiiU bug: Bilinear uses a render target and for these the format is not converted
@@ -600,9 +680,31 @@ void Sdl2Ui::UpdateDisplay() {
 	} else {
 		SDL_UpdateTexture(sdl_texture_game, nullptr, main_surface->pixels(), main_surface->pitch());
 	}
+	// Always uploads the whole surface
+	TakeDisplayDamage();
 #else
-	// SDL_UpdateTexture was found to be faster than SDL_LockTexture / SDL_UnlockTexture.
-	SDL_UpdateTexture(sdl_texture_game, nullptr, main_surface->pixels(), main_surface->pitch());
+	// Only upload the parts of the surface which changed since the last frame
+	const auto& damage = TakeDisplayDamage();
+	// Read through a const reference: Non-const pixel access counts as a modification
+	const Bitmap& surface = *main_surface;
+
+	if (texture_locked) {
+		// The frame was drawn directly into the texture, nothing to upload
+		SDL_UnlockTexture(sdl_texture_game);
+		sdl_texture_game_outdated = false;
+	} else if (sdl_texture_game_outdated) {
+		SDL_UpdateTexture(sdl_texture_game, nullptr, surface.pixels(), surface.pitch());
+		sdl_texture_game_outdated = false;
+	} else {
+		for (const auto& damage_rect : damage) {
+			const auto* pixels = static_cast<const uint8_t*>(surface.pixels())
+				+ damage_rect.y * surface.pitch() + damage_rect.x * surface.bpp();
+			SDL_Rect rect = { damage_rect.x, damage_rect.y, damage_rect.width, damage_rect.height };
+
+			// SDL_UpdateTexture was found to be faster than SDL_LockTexture / SDL_UnlockTexture.
+			SDL_UpdateTexture(sdl_texture_game, &rect, pixels, surface.pitch());
+		}
+	}
 #endif
 
 	if (window.size_changed && window.width > 0 && window.height > 0) {
@@ -667,7 +769,7 @@ void Sdl2Ui::UpdateDisplay() {
 			SDL_RenderSetViewport(sdl_renderer, &viewport);
 		}
 
-		if (vcfg.scaling_mode.Get() == ConfigEnum::ScalingMode::Bilinear && window.scale > 0.f) {
+		if (!software_renderer && vcfg.scaling_mode.Get() == ConfigEnum::ScalingMode::Bilinear && window.scale > 0.f) {
 			if (sdl_texture_scaled) {
 				SDL_DestroyTexture(sdl_texture_scaled);
 			}
@@ -681,8 +783,14 @@ void Sdl2Ui::UpdateDisplay() {
 		}
 	}
 
+	// The scaling of the software renderer is slow and unfiltered, scale on the CPU instead
+	const bool upscale = software_renderer && window.scale > 0.f
+		&& (viewport.w != main_surface->width() || viewport.h != main_surface->height());
+
 	SDL_RenderClear(sdl_renderer);
-	if (vcfg.scaling_mode.Get() == ConfigEnum::ScalingMode::Bilinear && window.scale > 0.f) {
+	if (upscale && UpscaleFrame()) {
+		SDL_RenderCopy(sdl_renderer, sdl_texture_upscaled, nullptr, nullptr);
+	} else if (!software_renderer && vcfg.scaling_mode.Get() == ConfigEnum::ScalingMode::Bilinear && window.scale > 0.f) {
 		// Render game texture on the scaled texture
 		SDL_SetRenderTarget(sdl_renderer, sdl_texture_scaled);
 		SDL_RenderClear(sdl_renderer);
@@ -694,6 +802,49 @@ void Sdl2Ui::UpdateDisplay() {
 		SDL_RenderCopy(sdl_renderer, sdl_texture_game, nullptr, nullptr);
 	}
 	SDL_RenderPresent(sdl_renderer);
+	display_update_required = false;
+
+	if (texture_locked) {
+		LockGameTexture();
+	}
+}
+
+bool Sdl2Ui::UpscaleFrame() {
+	int w = 0;
+	int h = 0;
+	if (sdl_texture_upscaled) {
+		SDL_QueryTexture(sdl_texture_upscaled, nullptr, nullptr, &w, &h);
+	}
+
+	if (w != viewport.w || h != viewport.h) {
+		if (sdl_texture_upscaled) {
+			SDL_DestroyTexture(sdl_texture_upscaled);
+		}
+		sdl_texture_upscaled = SDL_CreateTexture(sdl_renderer, texture_format, SDL_TEXTUREACCESS_STREAMING, viewport.w, viewport.h);
+		if (!sdl_texture_upscaled) {
+			Output::Debug("SDL_CreateTexture failed : {}", SDL_GetError());
+			return false;
+		}
+	}
+
+	void* pixels;
+	int pitch;
+	if (SDL_LockTexture(sdl_texture_upscaled, nullptr, &pixels, &pitch) != 0) {
+		Output::Debug("SDL_LockTexture failed : {}", SDL_GetError());
+		return false;
+	}
+
+	// main_surface stays valid when it uses the memory of sdl_texture_game:
+	// The software renderer keeps the memory after unlocking
+	auto upscaled = Bitmap::Create(pixels, viewport.w, viewport.h, pitch, Bitmap::pixel_format);
+	BitmapScaler::Scale(*upscaled, *main_surface, vcfg.scaling_mode.Get(), true);
+
+	SDL_UnlockTexture(sdl_texture_upscaled);
+	return true;
+}
+
+bool Sdl2Ui::IsDisplayUpdateRequired() const {
+	return display_update_required || window.size_changed || sdl_texture_game_outdated;
 }
 
 void Sdl2Ui::SetTitle(const std::string &title) {
@@ -727,6 +878,12 @@ bool Sdl2Ui::HandleErrorOutput(const std::string &message) {
 
 void Sdl2Ui::ProcessEvent(SDL_Event &evnt) {
 	switch (evnt.type) {
+		case SDL_RENDER_TARGETS_RESET:
+		case SDL_RENDER_DEVICE_RESET:
+			// The presented image is lost
+			display_update_required = true;
+			return;
+
 		case SDL_WINDOWEVENT:
 			ProcessWindowEvent(evnt);
 			return;
@@ -782,6 +939,9 @@ void Sdl2Ui::ProcessEvent(SDL_Event &evnt) {
 }
 
 void Sdl2Ui::ProcessWindowEvent(SDL_Event &evnt) {
+	// The window content may need to be presented again
+	display_update_required = true;
+
 	int state = evnt.window.event;
 
 	if (state == SDL_WINDOWEVENT_FOCUS_LOST) {
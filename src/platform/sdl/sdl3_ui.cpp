@@ -43,6 +43,8 @@
 #include "output.h"
 #include "player.h"
 #include "bitmap.h"
+#include "bitmap_scaler.h"
+#include "instrumentation.h"
 #include "lcf/scope_guard.h"
 
 #if defined(__APPLE__) && TARGET_OS_OSX
@@ -69,6 +71,17 @@ static SDL_PixelFormat GetDefaultFormat() {
 #endif
 }
 
+/**
+ * Whether the renderer is the software renderer. Its streaming textures are
+ * plain memory which is kept between locks and not uploaded again on unlock.
+ * Other renderers upload directly from the pointer passed to SDL_UpdateTexture,
+ * drawing into the locked texture saves nothing there.
+ */
+static bool IsSoftwareRenderer(SDL_Renderer* renderer) {
+	const char* name = SDL_GetRendererName(renderer);
+	return name && strcmp(name, SDL_SOFTWARE_RENDERER) == 0;
+}
+
 static DynamicFormat GetDynamicFormat(uint32_t fmt) {
 	switch (fmt) {
 		case SDL_PIXELFORMAT_RGBA32:
@@ -160,12 +173,19 @@ Sdl3Ui::~Sdl3Ui() {
 	if (sdl_joystick) {
 		SDL_CloseJoystick(sdl_joystick);
 	}
+	if (texture_locked) {
+		// The surface uses the memory of the texture
+		main_surface.reset();
+	}
 	if (sdl_texture_game) {
 		SDL_DestroyTexture(sdl_texture_game);
 	}
 	if (sdl_texture_scaled) {
 		SDL_DestroyTexture(sdl_texture_scaled);
 	}
+	if (sdl_texture_upscaled) {
+		SDL_DestroyTexture(sdl_texture_upscaled);
+	}
 	if (sdl_renderer) {
 		SDL_DestroyRenderer(sdl_renderer);
 	}
@@ -196,6 +216,8 @@ bool Sdl3Ui::vChangeDisplaySurfaceResolution(int new_width, int new_height) {
 	}
 
 	sdl_texture_game = new_sdl_texture_game;
+	sdl_texture_game_outdated = true;
+	texture_locked = false;
 	SDL_SetTextureScaleMode(sdl_texture_game, SDL_SCALEMODE_NEAREST);
 
 	BitmapRef new_main_surface = Bitmap::Create(new_width, new_height, Color(0, 0, 0, 255));
@@ -208,6 +230,10 @@ bool Sdl3Ui::vChangeDisplaySurfaceResolution(int new_width, int new_height) {
 	main_surface = new_main_surface;
 	window.size_changed = true;
 
+	if (draw_into_texture) {
+		LockGameTexture();
+	}
+
 	BeginDisplayModeChange();
 
 	current_display_mode.width = new_width;
@@ -361,6 +387,10 @@ bool Sdl3Ui::RefreshDisplayMode() {
 				});
 
 		texture_format = GetDefaultFormat();
+#ifndef __WIIU__
+		software_renderer = IsSoftwareRenderer(sdl_renderer);
+		draw_into_texture = software_renderer;
+#endif
 
 		Output::Debug("SDL3: Selected Pixel Format {}", SDL_GetPixelFormatName(texture_format));
 
@@ -372,6 +402,7 @@ bool Sdl3Ui::RefreshDisplayMode() {
 			texture_format,
 			SDL_TEXTUREACCESS_STREAMING,
 			display_width, display_height);
+		sdl_texture_game_outdated = true;
 
 		if (!sdl_texture_game) {
 			Output::Debug("SDL_CreateTexture failed : {}", SDL_GetError());
@@ -422,6 +453,54 @@ bool Sdl3Ui::RefreshDisplayMode() {
 			display_width, display_height, Color(0, 0, 0, 255));
 	}
 
+	if (draw_into_texture && !texture_locked) {
+		// Only possible when the texture has the layout of the surface, otherwise it is copied
+		const auto& surface_format = Bitmap::pixel_format;
+		if (format.bits == 32 && format.r.mask == surface_format.r.mask
+			&& format.g.mask == surface_format.g.mask && format.b.mask == surface_format.b.mask) {
+			LockGameTexture();
+		} else {
+			draw_into_texture = false;
+		}
+		Output::Debug("SDL3: Drawing into the texture: {}", draw_into_texture);
+	}
+
+	return true;
+}
+
+bool Sdl3Ui::LockGameTexture() {
+	void* pixels;
+	int pitch;
+	if (!SDL_LockTexture(sdl_texture_game, nullptr, &pixels, &pitch)) {
+		Output::Debug("SDL_LockTexture failed : {}", SDL_GetError());
+		draw_into_texture = false;
+		if (texture_locked) {
+			// Continue with a copy of the last frame and upload it every frame
+			BitmapRef surface = Bitmap::Create(main_surface->width(), main_surface->height(), true);
+			surface->BlitFast(0, 0, *main_surface, main_surface->GetRect(), Opacity::Opaque());
+			main_surface = surface;
+			texture_locked = false;
+			sdl_texture_game_outdated = true;
+		}
+		return false;
+	}
+
+	// The software renderer returns the same memory on every lock, the surface
+	// must only be replaced after the texture was recreated.
+	// Read through a const reference: Non-const pixel access counts as a modification
+	const Bitmap& current = *main_surface;
+	if (current.pixels() != pixels || current.pitch() != pitch) {
+		BitmapRef surface = Bitmap::Create(pixels, main_surface->width(), main_surface->height(), pitch, Bitmap::pixel_format);
+		if (texture_locked) {
+			// The old memory is gone, the next frame is drawn completely
+			surface->Fill(Color(0, 0, 0, 255));
+		} else {
+			surface->BlitFast(0, 0, *main_surface, main_surface->GetRect(), Opacity::Opaque());
+		}
+		main_surface = surface;
+	}
+
+	texture_locked = true;
 	return true;
 }
 
@@ -518,6 +597,8 @@ void Sdl3Ui::ToggleVsync() {
 }
 
 void Sdl3Ui::UpdateDisplay() {
+	Instrumentation::ZoneScope zone("Sdl3Ui::UpdateDisplay");
+
 #ifdef __WIIU__
 	if (vcfg.scaling_mode.Get() == ConfigEnum::ScalingMode::Bilinear && window.scale > 0.f) {
 		// Workaround WiiU bug: Bilinear uses a render target and for these the format is not converted
@@ -531,9 +612,31 @@ void Sdl3Ui::UpdateDisplay() {
 	} else {
 		SDL_UpdateTexture(sdl_texture_game, nullptr, main_surface->pixels(), main_surface->pitch());
 	}
+	// Always uploads the whole surface
+	TakeDisplayDamage();
 #else
-	// SDL_UpdateTexture was found to be faster than SDL_LockTexture / SDL_UnlockTexture.
-	SDL_UpdateTexture(sdl_texture_game, nullptr, main_surface->pixels(), main_surface->pitch());
+	// Only upload the parts of the surface which changed since the last frame
+	const auto& damage = TakeDisplayDamage();
+	// Read through a const reference: Non-const pixel access counts as a modification
+	const Bitmap& surface = *main_surface;
+
+	if (texture_locked) {
+		// The frame was drawn directly into the texture, nothing to upload
+		SDL_UnlockTexture(sdl_texture_game);
+		sdl_texture_game_outdated = false;
+	} else if (sdl_texture_game_outdated) {
+		SDL_UpdateTexture(sdl_texture_game, nullptr, surface.pixels(), surface.pitch());
+		sdl_texture_game_outdated = false;
+	} else {
+		for (const auto& damage_rect : damage) {
+			const auto* pixels = static_cast<const uint8_t*>(surface.pixels())
+				+ damage_rect.y * surface.pitch() + damage_rect.x * surface.bpp();
+			SDL_Rect rect = { damage_rect.x, damage_rect.y, damage_rect.width, damage_rect.height };
+
+			// SDL_UpdateTexture was found to be faster than SDL_LockTexture / SDL_UnlockTexture.
+			SDL_UpdateTexture(sdl_texture_game, &rect, pixels, surface.pitch());
+		}
+	}
 #endif
 
 	if (window.size_changed && window.width > 0 && window.height > 0) {
@@ -598,7 +701,7 @@ void Sdl3Ui::UpdateDisplay() {
 			SDL_SetRenderViewport(sdl_renderer, &viewport);
 		}
 
-		if (vcfg.scaling_mode.Get() == ConfigEnum::ScalingMode::Bilinear && window.scale > 0.f) {
+		if (!software_renderer && vcfg.scaling_mode.Get() == ConfigEnum::ScalingMode::Bilinear && window.scale > 0.f) {
 			if (sdl_texture_scaled) {
 				SDL_DestroyTexture(sdl_texture_scaled);
 			}
@@ -610,8 +713,14 @@ void Sdl3Ui::UpdateDisplay() {
 		}
 	}
 
+	// The scaling of the software renderer is slow and unfiltered, scale on the CPU instead
+	const bool upscale = software_renderer && window.scale > 0.f
+		&& (viewport.w != main_surface->width() || viewport.h != main_surface->height());
+
 	SDL_RenderClear(sdl_renderer);
-	if (vcfg.scaling_mode.Get() == ConfigEnum::ScalingMode::Bilinear && window.scale > 0.f) {
+	if (upscale && UpscaleFrame()) {
+		SDL_RenderTexture(sdl_renderer, sdl_texture_upscaled, nullptr, nullptr);
+	} else if (!software_renderer && vcfg.scaling_mode.Get() == ConfigEnum::ScalingMode::Bilinear && window.scale > 0.f) {
 		// Render game texture on the scaled texture
 		SDL_SetRenderTarget(sdl_renderer, sdl_texture_scaled);
 		SDL_RenderClear(sdl_renderer);
@@ -623,6 +732,43 @@ void Sdl3Ui::UpdateDisplay() {
 		SDL_RenderTexture(sdl_renderer, sdl_texture_game, nullptr, nullptr);
 	}
 	SDL_RenderPresent(sdl_renderer);
+	display_update_required = false;
+
+	if (texture_locked) {
+		LockGameTexture();
+	}
+}
+
+bool Sdl3Ui::UpscaleFrame() {
+	if (!sdl_texture_upscaled || sdl_texture_upscaled->w != viewport.w || sdl_texture_upscaled->h != viewport.h) {
+		if (sdl_texture_upscaled) {
+			SDL_DestroyTexture(sdl_texture_upscaled);
+		}
+		sdl_texture_upscaled = SDL_CreateTexture(sdl_renderer, texture_format, SDL_TEXTUREACCESS_STREAMING, viewport.w, viewport.h);
+		if (!sdl_texture_upscaled) {
+			Output::Debug("SDL_CreateTexture failed : {}", SDL_GetError());
+			return false;
+		}
+	}
+
+	void* pixels;
+	int pitch;
+	if (!SDL_LockTexture(sdl_texture_upscaled, nullptr, &pixels, &pitch)) {
+		Output::Debug("SDL_LockTexture failed : {}", SDL_GetError());
+		return false;
+	}
+
+	// main_surface stays valid when it uses the memory of sdl_texture_game:
+	// The software renderer keeps the memory after unlocking
+	auto upscaled = Bitmap::Create(pixels, viewport.w, viewport.h, pitch, Bitmap::pixel_format);
+	BitmapScaler::Scale(*upscaled, *main_surface, vcfg.scaling_mode.Get(), true);
+
+	SDL_UnlockTexture(sdl_texture_upscaled);
+	return true;
+}
+
+bool Sdl3Ui::IsDisplayUpdateRequired() const {
+	return display_update_required || window.size_changed || sdl_texture_game_outdated;
 }
 
 void Sdl3Ui::SetTitle(const std::string &title) {
@@ -660,6 +806,12 @@ bool Sdl3Ui::HandleErrorOutput(const std::string &message) {
 
 void Sdl3Ui::ProcessEvent(SDL_Event &evnt) {
 	switch (evnt.type) {
+		case SDL_EVENT_RENDER_TARGETS_RESET:
+		case SDL_EVENT_RENDER_DEVICE_RESET:
+			// The presented image is lost
+			display_update_required = true;
+			return;
+
 		case SDL_EVENT_QUIT:
 			Player::exit_flag = true;
 			return;
@@ -715,6 +867,9 @@ void Sdl3Ui::ProcessEvent(SDL_Event &evnt) {
 }
 
 void Sdl3Ui::ProcessWindowEvent(SDL_Event &evnt) {
+	// The window content may need to be presented again
+	display_update_required = true;
+
 	int state = evnt.type;
 
 	if (state == SDL_EVENT_WINDOW_FOCUS_LOST) {
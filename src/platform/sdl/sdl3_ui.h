@@ -63,6 +63,7 @@ public:
 	void ToggleFullscreen() override;
 	void ToggleZoom() override;
 	void UpdateDisplay() override;
+	bool IsDisplayUpdateRequired() const override;
 	void SetTitle(const std::string &title) override;
 	bool ShowCursor(bool flag) override;
 	bool ProcessEvents() override;
@@ -124,12 +125,40 @@ private:
 
 	void RequestVideoMode(int width, int height, int zoom, bool fullscreen, bool vsync);
 
+	/**
+	 * Locks sdl_texture_game and makes main_surface draw into its memory.
+	 * The surface is only replaced when the memory of the texture moved.
+	 *
+	 * @return whether the texture was locked
+	 */
+	bool LockGameTexture();
+
+	/**
+	 * Scales main_surface to the size of the viewport into sdl_texture_upscaled.
+	 * Used by the software renderer.
+	 *
+	 * @return whether sdl_texture_upscaled contains the frame
+	 */
+	bool UpscaleFrame();
+
 	/** Last display mode. */
 	DisplayMode last_display_mode;
 
 	/** Main SDL window. */
 	SDL_Texture* sdl_texture_game = nullptr;
 	SDL_Texture* sdl_texture_scaled = nullptr;
+	/** main_surface scaled to the viewport by BitmapScaler */
+	SDL_Texture* sdl_texture_upscaled = nullptr;
+	/** sdl_texture_game was recreated and needs a full upload */
+	bool sdl_texture_game_outdated = true;
+	/** The renderer is the SDL software renderer */
+	bool software_renderer = false;
+	/** Draw into the locked sdl_texture_game instead of copying main_surface */
+	bool draw_into_texture = false;
+	/** main_surface uses the memory of sdl_texture_game, unlocked only while presenting */
+	bool texture_locked = false;
+	/** The presented image was lost and must be presented again */
+	bool display_update_required = true;
 	SDL_Window* sdl_window = nullptr;
 	SDL_Renderer* sdl_renderer = nullptr;
 	SDL_Joystick *sdl_joystick = nullptr;
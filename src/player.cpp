@@ -131,6 +131,13 @@ namespace Player {
 	int frames;
 	std::string replay_input_path;
 	std::string record_input_path;
+	bool headless_flag;
+	std::vector<int> headless_screenshot_frames;
+	int headless_exit_frame;
+	bool turbo_flag;
+	int turbo_render_interval;
+	bool profile_flag;
+	std::string profile_trace_path;
 	std::string command_line;
 	int rng_seed = -1;
 	Game_ConfigPlayer player_config;
@@ -139,6 +146,7 @@ namespace Player {
 	std::string emscripten_game_name;
 #endif
 	Game_Clock::time_point last_auto_screenshot;
+	Game_Clock::time_point last_turbo_report;
 }
 
 namespace {
@@ -150,6 +158,12 @@ namespace {
 	FileRequestBinding system_request_id;
 	FileRequestBinding save_request_id;
 	FileRequestBinding map_request_id;
+
+	// Logical frames per main loop iteration in turbo mode when rendering is disabled
+	constexpr int turbo_frames_without_render = 60;
+
+	// Interval in which the turbo mode counters are logged
+	constexpr auto turbo_report_interval = std::chrono::seconds(5);
 }
 
 void Player::Init(std::vector<std::string> args) {
@@ -203,11 +217,18 @@ void Player::Init(std::vector<std::string> args) {
 
 	player_config = std::move(cfg.player);
 
+	if (turbo_flag) {
+		Game_Clock::SetTurboMode(turbo_render_interval > 0 ? turbo_render_interval : turbo_frames_without_render);
+		Output::Debug("Turbo mode enabled: Rendering {}", turbo_render_interval > 0 ? fmt::format("every {} frames", turbo_render_interval) : "disabled");
+	}
+
 	last_auto_screenshot = Game_Clock::now();
+	last_turbo_report = last_auto_screenshot;
 }
 
 void Player::Run() {
 	Instrumentation::Init("EasyRPG-Player");
+	Instrumentation::SetProfilerEnabled(profile_flag);
 
 	Scene::Push(std::make_shared<Scene_Logo>());
 	Graphics::UpdateSceneCallback();
@@ -258,6 +279,7 @@ void Player::MainLoop() {
 
 		Graphics::GetMessageOverlay().Update();
 
+		Game_Clock::OnLogicFrame();
 		++num_updates;
 	}
 	if (num_updates == 0) {
@@ -265,7 +287,22 @@ void Player::MainLoop() {
 		Input::UpdateSystem();
 	}
 
-	Player::Draw();
+	bool presented = true;
+	if (Game_Clock::IsTurboMode()) {
+		// The clock runs a batch of turbo_render_interval frames per loop iteration
+		if (turbo_render_interval > 0) {
+			Player::Draw();
+		}
+
+		auto now = Game_Clock::now();
+		if (now - last_turbo_report >= turbo_report_interval) {
+			last_turbo_report = now;
+			Output::Debug("Turbo: {:.0f} logic frames/s, {:.1f} rendered frames/s",
+				Game_Clock::GetLogicFPS(), Game_Clock::GetRenderFPS());
+		}
+	} else {
+		presented = Player::Draw();
+	}
 
 	Scene::old_instances.clear();
 
@@ -283,7 +320,11 @@ void Player::MainLoop() {
 	}
 
 	auto frame_limit = DisplayUi->GetFrameLimit();
-	if (frame_limit == Game_Clock::duration()) {
+	if (frame_limit == Game_Clock::duration() && !presented) {
+		// Nothing waited for the vertical sync: Sleep instead of spinning
+		frame_limit = Game_Clock::GetTargetGameTimeStep();
+	}
+	if (frame_limit == Game_Clock::duration() || Game_Clock::IsTurboMode()) {
 		return;
 	}
 
@@ -389,10 +430,18 @@ void Player::Update(bool update_scene) {
 #endif
 }
 
-void Player::Draw() {
+bool Player::Draw() {
 	Graphics::Update();
-	Graphics::Draw(*DisplayUi->GetDisplaySurface());
-	DisplayUi->UpdateDisplay();
+	bool changed = Graphics::Draw(*DisplayUi->GetDisplaySurface());
+
+	// Unchanged frames are neither uploaded nor presented again
+	bool presented = changed || DisplayUi->IsDisplayUpdateRequired();
+	if (presented) {
+		DisplayUi->UpdateDisplay();
+	}
+	Game_Clock::OnRenderFrame();
+
+	return presented;
 }
 
 void Player::IncFrame() {
@@ -422,6 +471,16 @@ void Player::Exit() {
 	auto ret = FileFinder::Root().OpenOutputStream("/tmp/message.png", std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
 	if (ret) Output::TakeScreenshot(ret);
 #endif
+	if (Instrumentation::IsProfilerEnabled() && !profile_trace_path.empty()) {
+		auto os = FileFinder::Root().OpenOutputStream(profile_trace_path, std::ios_base::out | std::ios_base::trunc);
+		if (os && Instrumentation::WriteChromeTrace(os)) {
+			Output::Debug("Profiler: Trace written to {}", profile_trace_path);
+		} else {
+			Output::Warning("Profiler: Writing trace to {} failed", profile_trace_path);
+		}
+	}
+	Instrumentation::SetProfilerEnabled(false);
+
 	Player::ResetGameObjects();
 	Font::Dispose();
 	Graphics::Quit();
@@ -441,6 +500,11 @@ Game_Config Player::ParseCommandLine() {
 	start_map_id = -1;
 	no_rtp_flag = false;
 	no_audio_flag = false;
+	headless_flag = false;
+	headless_exit_frame = 0;
+	turbo_flag = false;
+	turbo_render_interval = 0;
+	profile_flag = false;
 	is_easyrpg_project = false;
 	Game_Battle::battle_test.enabled = false;
 
@@ -625,6 +689,39 @@ Game_Config Player::ParseCommandLine() {
 			}
 			continue;
 		}
+		if (cp.ParseNext(arg, 0, "--headless")) {
+			headless_flag = true;
+			continue;
+		}
+		if (cp.ParseNext(arg, 1, "--headless-frames")) {
+			if (arg.ParseValue(0, li_value) && li_value > 0) {
+				headless_exit_frame = li_value;
+			}
+			continue;
+		}
+		if (cp.ParseNext(arg, std::numeric_limits<int>::max(), "--screenshot-frames")) {
+			for (int i = 0; i < arg.NumValues(); ++i) {
+				if (arg.ParseValue(i, li_value) && li_value >= 0) {
+					headless_screenshot_frames.push_back(li_value);
+				}
+			}
+			continue;
+		}
+		if (cp.ParseNext(arg, 1, "--profile")) {
+			profile_flag = true;
+			if (arg.NumValues() > 0) {
+				profile_trace_path = arg.Value(0);
+			}
+			continue;
+		}
+		if (cp.ParseNext(arg, 1, "--turbo")) {
+			turbo_flag = true;
+			turbo_render_interval = 0;
+			if (arg.ParseValue(0, li_value) && li_value > 0) {
+				turbo_render_interval = li_value;
+			}
+			continue;
+		}
 		if (cp.ParseNext(arg, 1, "--encoding")) {
 			if (arg.NumValues() > 0) {
 				forced_encoding = arg.Value(0);
@@ -1543,8 +1640,19 @@ Debug options:
                       Providing a single N sets the monster party.
                       Providing four N sets: monster party, formation,
                       condition and terrain ID.
+ --headless           Run without a window and without audio output. The game
+                      runs as fast as possible, one logical frame per rendered
+                      frame. Intended for use with --replay-input.
+ --headless-frames N  In headless mode exit after N frames.
  --hide-title         Hide the title background image and center the command
                       menu.
+ --screenshot-frames N...
+                      In headless mode save a screenshot when frame N is
+                      reached. The files are stored in the save directory.
+ --profile [FILE]     Enable the built-in frame profiler. The average time spent
+                      in each subsystem is shown in the FPS overlay. When FILE
+                      is given the last frames are written to FILE on exit in
+                      the Chrome trace format (chrome://tracing, Perfetto).
  --start-map-id N     Overwrite the map used for new games and use MapN.lmu
                       instead (N is padded to four digits).
                       Incompatible with --load-game-id.
@@ -1555,6 +1663,10 @@ Debug options:
                       position (X, Y).
                       Incompatible with --load-game-id.
  --test-play          Enable TestPlay (Debug) mode.
+ --turbo [N]          Run the game logic as fast as possible without frame
+                      pacing. Only every Nth frame is rendered. Without N
+                      nothing is rendered. The achieved logic and rendered
+                      frames per second are logged periodically.
 
 Other options:
  -v, --version        Display program version and exit.
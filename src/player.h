@@ -101,8 +101,10 @@ namespace Player {
 
 	/**
 	 * Renders EasyRPG Player state to the screen
+	 *
+	 * @return false when the frame was unchanged and presentation was skipped
 	 */
-	void Draw();
+	bool Draw();
 
 	/**
 	 * Returns executed game frames since player start.
@@ -400,6 +402,27 @@ namespace Player {
 	/** Path to record input log to */
 	extern std::string record_input_path;
 
+	/** Run without window and audio device, see HeadlessUi */
+	extern bool headless_flag;
+
+	/** Frames at which the headless UI takes a screenshot */
+	extern std::vector<int> headless_screenshot_frames;
+
+	/** Frame after which the headless UI exits, 0 to run until the game ends */
+	extern int headless_exit_frame;
+
+	/** Turbo mode: logical frames run back-to-back without frame pacing */
+	extern bool turbo_flag;
+
+	/** In turbo mode only every Nth logical frame is rendered, 0 to never render */
+	extern int turbo_render_interval;
+
+	/** Enables the built-in frame profiler */
+	extern bool profile_flag;
+
+	/** Path the profiler writes a Chrome trace to on exit */
+	extern std::string profile_trace_path;
+
 	/** The concatenated command line */
 	extern std::string command_line;
 
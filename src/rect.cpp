@@ -17,6 +17,7 @@
 
 // Headers
 #include "rect.h"
+#include <algorithm>
 
 void Rect::Adjust(int max_width, int max_height) {
 	if (x < 0) {
@@ -96,6 +97,21 @@ Rect Rect::GetSubRect(const Rect src_rect) const {
 	return rect;
 }
 
+Rect Rect::GetUnion(Rect const& rect) const {
+	if (rect.IsEmpty()) {
+		return *this;
+	}
+	if (IsEmpty()) {
+		return rect;
+	}
+
+	const int x1 = std::min(x, rect.x);
+	const int y1 = std::min(y, rect.y);
+	const int x2 = std::max(x + width, rect.x + rect.width);
+	const int y2 = std::max(y + height, rect.y + rect.height);
+	return Rect(x1, y1, x2 - x1, y2 - y1);
+}
+
 bool Rect::AdjustRectangles(Rect& src, Rect& dst, const Rect& ref) {
 	if (src.x < ref.x) {
 		int dx = ref.x - src.x;
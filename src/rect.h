@@ -89,6 +89,15 @@ public:
 	 */
 	Rect GetSubRect(Rect rect) const;
 
+	/**
+	 * Gets the smallest rect containing this and the given rect.
+	 * Empty rects are ignored.
+	 *
+	 * @param rect rect.
+	 * @return bounding rect of both rects.
+	 */
+	Rect GetUnion(Rect const& rect) const;
+
 	/** X coordinate. */
 	int x = 0;
 
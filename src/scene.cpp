@@ -34,6 +34,7 @@
 #include "scene_settings.h"
 #include "scene_title.h"
 #include "game_map.h"
+#include "instrumentation.h"
 
 #ifndef NDEBUG
 #define DEBUG_VALIDATE(x) Scene::DebugValidate(x)
@@ -143,6 +144,8 @@ void Scene::ScheduleTransitionIn(Scene::SceneType prev_scene_type) {
 }
 
 void Scene::MainFunction() {
+	Instrumentation::ZoneScope zone("Scene::MainFunction");
+
 	static bool init = false;
 
 	if (IsAsyncPending()) {
@@ -52,6 +52,10 @@ Scene_Title::Scene_Title() {
 void Scene_Title::Start() {
 	Main_Data::game_system->ResetSystemGraphic();
 
+	if (Audio().GetConfig().se_preload.Get()) {
+		Main_Data::game_system->PreloadSe();
+	}
+
 	// Change the resolution of the window
 	if (Player::has_custom_resolution) {
 		Player::ChangeResolution(Player::screen_width, Player::screen_height);
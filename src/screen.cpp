@@ -21,6 +21,7 @@
 #include "color.h"
 #include "game_screen.h"
 #include "main_data.h"
+#include "player.h"
 #include "screen.h"
 #include "drawable_mgr.h"
 
@@ -59,3 +60,14 @@ void Screen::Draw(Bitmap& dst) {
 		}
 	}
 }
+
+bool Screen::GetDamage(Rect& damage) {
+	if (!Main_Data::game_screen) {
+		return false;
+	}
+
+	damage_tracker.Begin(*this) << Main_Data::game_screen->GetFlashColor() << viewport;
+
+	damage = damage_tracker.End(Rect(0, 0, Player::screen_width, Player::screen_height));
+	return true;
+}
@@ -21,6 +21,7 @@
 // Headers
 #include <string>
 #include "bitmap.h"
+#include "damage_tracker.h"
 #include "drawable.h"
 #include "system.h"
 
@@ -38,6 +39,8 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	bool GetDamage(Rect& damage) override;
+
 	Rect GetViewport() const;
 	void SetViewport(const Rect& rect);
 
@@ -45,6 +48,8 @@ private:
 	BitmapRef flash;
 
 	Rect viewport;
+
+	DamageTracker damage_tracker;
 };
 
 inline Rect Screen::GetViewport() const {
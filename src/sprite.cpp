@@ -16,6 +16,7 @@
  */
 
 // Headers
+#include <cmath>
 #include <string>
 #include "sprite.h"
 #include "player.h"
@@ -23,9 +24,10 @@
 #include "bitmap.h"
 #include "cache.h"
 #include "drawable_mgr.h"
+#include "sprite_batch.h"
 
 // Constructor
-Sprite::Sprite(Drawable::Flags flags) : Drawable(0, flags)
+Sprite::Sprite(Drawable::Flags flags) : Drawable(0, flags | Drawable::Flags::Batched)
 {
 	DrawableMgr::Register(this);
 }
@@ -37,6 +39,40 @@ void Sprite::Draw(Bitmap& dst) {
 	BlitScreen(dst);
 }
 
+bool Sprite::GetDamage(Rect& damage) {
+	damage_tracker.Begin(*this) << bitmap << src_rect << src_rect_effect
+		<< x << y << ox << oy
+		<< opacity_top_effect << opacity_bottom_effect << bush_effect
+		<< tone_effect << flash_effect << flipx_effect << flipy_effect
+		<< zoom_x_effect << zoom_y_effect << angle_effect
+		<< waver_effect_depth << waver_effect_phase
+		<< blend_type_effect << blend_color_effect;
+
+	damage = damage_tracker.End(GetScreenBounds());
+	return true;
+}
+
+Rect Sprite::GetScreenBounds() const {
+	if (angle_effect != 0.0 || waver_effect_depth != 0 || zoom_x_effect < 0.0 || zoom_y_effect < 0.0) {
+		// Not worth calculating the exact area
+		return Rect(0, 0, Player::screen_width, Player::screen_height);
+	}
+
+	const int draw_ox = ox - GetRenderOx();
+	const int draw_oy = oy - GetRenderOy();
+
+	if (zoom_x_effect == 1.0 && zoom_y_effect == 1.0) {
+		return Rect(x - draw_ox, y - draw_oy, src_rect.width, src_rect.height);
+	}
+
+	// Add one pixel on each side to compensate rounding
+	const int left = x - static_cast<int>(std::floor(draw_ox * zoom_x_effect)) - 1;
+	const int top = y - static_cast<int>(std::floor(draw_oy * zoom_y_effect)) - 1;
+	return Rect(left, top,
+		static_cast<int>(std::ceil(src_rect.width * zoom_x_effect)) + 2,
+		static_cast<int>(std::ceil(src_rect.height * zoom_y_effect)) + 2);
+}
+
 void Sprite::BlitScreen(Bitmap& dst) {
 	if (!bitmap || (opacity_top_effect <= 0 && opacity_bottom_effect <= 0))
 		return;
@@ -64,6 +100,25 @@ void Sprite::BlitScreen(Bitmap& dst) {
 		}
 	}
 
+	if (auto* batch = SpriteBatch::GetActive(dst)) {
+		SpriteBatch::Command cmd;
+		cmd.src = std::move(draw_bitmap);
+		cmd.src_rect = rect;
+		cmd.x = x;
+		cmd.y = y;
+		cmd.ox = ox - GetRenderOx();
+		cmd.oy = oy - GetRenderOy();
+		cmd.opacity = Opacity(opacity_top_effect, opacity_bottom_effect, bush_effect);
+		cmd.zoom_x = zoom_x_effect;
+		cmd.zoom_y = zoom_y_effect;
+		cmd.angle = angle_effect;
+		cmd.waver_depth = waver_effect_depth;
+		cmd.waver_phase = waver_effect_phase;
+		cmd.blend_mode = static_cast<Bitmap::BlendMode>(blend_type_effect);
+		batch->Add(std::move(cmd));
+		return;
+	}
+
 	BlitScreenIntern(dst, *draw_bitmap, rect);
 }
 
@@ -20,6 +20,7 @@
 
 // Headers
 #include "color.h"
+#include "damage_tracker.h"
 #include "drawable.h"
 #include "memory_management.h"
 #include "rect.h"
@@ -34,6 +35,8 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	bool GetDamage(Rect& damage) override;
+
 	virtual int GetWidth() const;
 	virtual int GetHeight() const;
 
@@ -138,10 +141,15 @@ private:
 	bool current_flip_y = false;
 	bool bitmap_changed = true;
 
+	DamageTracker damage_tracker;
+
 	void BlitScreen(Bitmap& dst);
 	void BlitScreenIntern(Bitmap& dst, Bitmap const& draw_bitmap,
 							Rect const& src_rect) const;
 	BitmapRef Refresh(Rect& rect);
+
+	/** @return screen area covered by the sprite */
+	Rect GetScreenBounds() const;
 };
 
 inline int Sprite::GetWidth() const {
@@ -299,6 +299,11 @@ void Sprite_Actor::Draw(Bitmap& dst) {
 	}
 }
 
+bool Sprite_Actor::GetDamage(Rect& /* damage */) {
+	// Draw modifies the sprite state: Not tracked
+	return false;
+}
+
 void Sprite_Actor::UpdatePosition() {
 	assert(!images.empty());
 	images.pop_back();
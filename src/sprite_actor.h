@@ -90,6 +90,7 @@ public:
 	int GetHeight() const override;
 
 	void Draw(Bitmap& dst) override;
+	bool GetDamage(Rect& damage) override;
 
 	Game_Actor* GetBattler() const;
 
@@ -56,6 +56,20 @@ void Sprite_AirshipShadow::RecreateShadow() {
 }
 
 void Sprite_AirshipShadow::Draw(Bitmap &dst) {
+	ApplyAirshipState();
+
+	Sprite::Draw(dst);
+}
+
+bool Sprite_AirshipShadow::GetDamage(Rect& damage) {
+	if (IsVisible()) {
+		ApplyAirshipState();
+	}
+
+	return Sprite::GetDamage(damage);
+}
+
+void Sprite_AirshipShadow::ApplyAirshipState() {
 	Game_Vehicle* airship = Game_Map::GetVehicle(Game_Vehicle::Airship);
 	const int altitude = airship->GetAltitude();
 	const int max_altitude = TILE_SIZE;
@@ -64,8 +78,6 @@ void Sprite_AirshipShadow::Draw(Bitmap &dst) {
 
 	SetX(Main_Data::game_player->GetScreenX() + x_offset);
 	SetY(Main_Data::game_player->GetScreenY() + y_offset + Main_Data::game_player->GetJumpHeight());
-
-	Sprite::Draw(dst);
 }
 
 void Sprite_AirshipShadow::Update() {
@@ -33,10 +33,13 @@ class Sprite_AirshipShadow : public Sprite {
 public:
 	Sprite_AirshipShadow(int x_offset = 0, int y_offset = 0);
 	void Draw(Bitmap& dst) override;
+	bool GetDamage(Rect& damage) override;
 	void Update();
 	void RecreateShadow();
 
 private:
+	void ApplyAirshipState();
+
 	int x_offset = 0;
 	int y_offset = 0;
 };
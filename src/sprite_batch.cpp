@@ -0,0 +1,150 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <cmath>
+#include "sprite_batch.h"
+#include "instrumentation.h"
+
+SpriteBatch* SpriteBatch::active = nullptr;
+bool SpriteBatch::enabled = true;
+
+/** Upper bound of the overlap checks done per command when sorting */
+static constexpr size_t max_segment_size = 64;
+
+SpriteBatch::SpriteBatch(Bitmap& dst) : dst(dst), previous(active) {
+	active = enabled ? this : nullptr;
+}
+
+SpriteBatch::~SpriteBatch() {
+	Flush();
+	active = previous;
+}
+
+void SpriteBatch::Add(Command cmd) {
+	if (cmd.opacity.IsTransparent() || !cmd.src) {
+		return;
+	}
+
+	if (cmd.angle != 0.0 || cmd.waver_depth != 0 || cmd.zoom_x < 0.0 || cmd.zoom_y < 0.0) {
+		// Not worth calculating the exact area
+		cmd.bounds = dst.GetRect();
+	} else if (cmd.zoom_x == 1.0 && cmd.zoom_y == 1.0) {
+		cmd.bounds = Rect(cmd.x - cmd.ox, cmd.y - cmd.oy, cmd.src_rect.width, cmd.src_rect.height);
+	} else {
+		// Add one pixel on each side to compensate rounding
+		cmd.bounds = Rect(
+			cmd.x - static_cast<int>(std::floor(cmd.ox * cmd.zoom_x)) - 1,
+			cmd.y - static_cast<int>(std::floor(cmd.oy * cmd.zoom_y)) - 1,
+			static_cast<int>(std::ceil(cmd.src_rect.width * cmd.zoom_x)) + 2,
+			static_cast<int>(std::ceil(cmd.src_rect.height * cmd.zoom_y)) + 2);
+	}
+
+	if (cmd.bounds.IsOutOfBounds(dst.GetRect())) {
+		return;
+	}
+
+	commands.push_back(std::move(cmd));
+}
+
+void SpriteBatch::Flush() {
+	if (commands.empty()) {
+		return;
+	}
+
+	Execute(dst, commands);
+	commands.clear();
+}
+
+namespace {
+	/**
+	 * Checks whether b continues a in the source and on the screen, both are
+	 * then drawn with a single blit.
+	 */
+	bool CanMerge(const SpriteBatch::Command& a, const SpriteBatch::Command& b) {
+		if (a.src != b.src || !a.IsSimple() || !b.IsSimple()
+			|| a.opacity.top != b.opacity.top || a.blend_mode != b.blend_mode) {
+			return false;
+		}
+
+		const Rect& sa = a.src_rect;
+		const Rect& sb = b.src_rect;
+		const Rect& da = a.bounds;
+		const Rect& db = b.bounds;
+
+		const bool horizontal = sa.y == sb.y && sa.height == sb.height && sa.x + sa.width == sb.x
+			&& da.y == db.y && da.x + da.width == db.x;
+		const bool vertical = sa.x == sb.x && sa.width == sb.width && sa.y + sa.height == sb.y
+			&& da.x == db.x && da.y + da.height == db.y;
+
+		return horizontal || vertical;
+	}
+
+	void Draw(Bitmap& dst, const SpriteBatch::Command& cmd) {
+		if (cmd.IsSimple() && dst.BlitDirect(cmd.bounds.x, cmd.bounds.y, *cmd.src, cmd.src_rect, cmd.opacity.Value())) {
+			return;
+		}
+
+		dst.EffectsBlit(cmd.x, cmd.y, cmd.ox, cmd.oy, *cmd.src, cmd.src_rect, cmd.opacity,
+			cmd.zoom_x, cmd.zoom_y, cmd.angle, cmd.waver_depth, cmd.waver_phase, cmd.blend_mode);
+	}
+} // anonymous namespace
+
+void SpriteBatch::Execute(Bitmap& dst, std::vector<Command>& commands) {
+	Instrumentation::ZoneScope zone("SpriteBatch::Execute");
+
+	size_t begin = 0;
+	while (begin < commands.size()) {
+		// Commands of different sources which do not overlap can be drawn in any order.
+		// Collect them until an overlap is found and sort them by source.
+		size_t end = begin + 1;
+		for (; end < commands.size() && end - begin < max_segment_size; ++end) {
+			const auto& cmd = commands[end];
+			const bool overlaps = std::any_of(commands.begin() + begin, commands.begin() + end, [&](const Command& other) {
+				return other.src != cmd.src && !other.bounds.IsOutOfBounds(cmd.bounds);
+			});
+			if (overlaps) {
+				break;
+			}
+		}
+
+		std::stable_sort(commands.begin() + begin, commands.begin() + end, [](const Command& a, const Command& b) {
+			return a.src.get() < b.src.get();
+		});
+
+		Command merged = commands[begin];
+		for (size_t i = begin + 1; i < end; ++i) {
+			const auto& cmd = commands[i];
+			if (CanMerge(merged, cmd)) {
+				merged.src_rect = merged.src_rect.GetUnion(cmd.src_rect);
+				merged.bounds = merged.bounds.GetUnion(cmd.bounds);
+				// ox and oy are already part of the bounds
+				merged.x = merged.bounds.x;
+				merged.y = merged.bounds.y;
+				merged.ox = 0;
+				merged.oy = 0;
+				continue;
+			}
+			Draw(dst, merged);
+			merged = cmd;
+		}
+		Draw(dst, merged);
+
+		begin = end;
+	}
+}
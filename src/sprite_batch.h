@@ -0,0 +1,149 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_SPRITE_BATCH_H
+#define EP_SPRITE_BATCH_H
+
+// Headers
+#include <cstdint>
+#include <vector>
+#include "bitmap.h"
+#include "memory_management.h"
+#include "opacity.h"
+#include "rect.h"
+
+/**
+ * Records the blits of sprites and executes them in batches.
+ *
+ * While a batch is active Sprite::Draw only records a command. Flush sorts
+ * the commands by source bitmap where this does not change the result,
+ * merges adjacent blits and draws the common unscaled and unrotated case
+ * without pixman. Anything not drawn through the batch must flush it first
+ * to keep the drawing order, DrawableList::Draw does this.
+ */
+class SpriteBatch {
+public:
+	/** A single recorded Bitmap::EffectsBlit call. */
+	struct Command {
+		BitmapRef src;
+		Rect src_rect;
+		int x = 0;
+		int y = 0;
+		int ox = 0;
+		int oy = 0;
+		Opacity opacity;
+		double zoom_x = 1.0;
+		double zoom_y = 1.0;
+		double angle = 0.0;
+		int waver_depth = 0;
+		double waver_phase = 0.0;
+		Bitmap::BlendMode blend_mode = Bitmap::BlendMode::Default;
+
+		/** Screen area covered by the command, filled in by Add */
+		Rect bounds;
+
+		/** @return whether the command is a plain blit with uniform opacity */
+		bool IsSimple() const;
+	};
+
+	/**
+	 * Makes a new batch drawing to dst the active batch.
+	 * The previously active batch is restored by the destructor.
+	 *
+	 * @param dst bitmap the commands are drawn to
+	 */
+	explicit SpriteBatch(Bitmap& dst);
+
+	SpriteBatch(const SpriteBatch&) = delete;
+	SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+	/** Flushes the batch and restores the previous batch */
+	~SpriteBatch();
+
+	/**
+	 * Returns the active batch when it draws to the given bitmap.
+	 *
+	 * @param dst bitmap the caller draws to
+	 * @return active batch or nullptr
+	 */
+	static SpriteBatch* GetActive(const Bitmap& dst);
+
+	/**
+	 * Records a command. The source bitmap is kept alive until the
+	 * batch is flushed.
+	 *
+	 * @param cmd command to record
+	 */
+	void Add(Command cmd);
+
+	/** Draws and removes all recorded commands. */
+	void Flush();
+
+	/** @return commands recorded since the last flush */
+	const std::vector<Command>& GetCommands() const;
+
+	/**
+	 * Draws a list of commands to a bitmap.
+	 *
+	 * @param dst destination bitmap
+	 * @param commands commands to draw, they are reordered and merged
+	 */
+	static void Execute(Bitmap& dst, std::vector<Command>& commands);
+
+	/**
+	 * Enables or disables batching globally.
+	 * When disabled every sprite is drawn immediately.
+	 *
+	 * @param enabled whether sprites are batched
+	 */
+	static void SetEnabled(bool enabled);
+
+	/** @return whether sprites are batched */
+	static bool IsEnabled();
+
+private:
+	Bitmap& dst;
+	SpriteBatch* previous = nullptr;
+	std::vector<Command> commands;
+
+	static SpriteBatch* active;
+	static bool enabled;
+};
+
+inline bool SpriteBatch::Command::IsSimple() const {
+	return zoom_x == 1.0 && zoom_y == 1.0 && angle == 0.0 && waver_depth == 0
+		&& !opacity.IsSplit()
+		&& (blend_mode == Bitmap::BlendMode::Default || blend_mode == Bitmap::BlendMode::Normal);
+}
+
+inline SpriteBatch* SpriteBatch::GetActive(const Bitmap& dst) {
+	return (active && &active->dst == &dst) ? active : nullptr;
+}
+
+inline const std::vector<SpriteBatch::Command>& SpriteBatch::GetCommands() const {
+	return commands;
+}
+
+inline void SpriteBatch::SetEnabled(bool enabled) {
+	SpriteBatch::enabled = enabled;
+}
+
+inline bool SpriteBatch::IsEnabled() {
+	return enabled;
+}
+
+#endif
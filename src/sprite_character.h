@@ -43,6 +43,8 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	bool GetDamage(Rect& damage) override;
+
 	/**
 	 * Updates sprite state.
 	 */
@@ -91,6 +93,9 @@ private:
 	/** Returns true for charset sprites; false for tiles. */
 	bool UsesCharset() const;
 
+	/** Copies the per-frame drawing state of the character into the sprite. */
+	void ApplyCharacterState();
+
 	int x_offset = 0;
 	int y_offset = 0;
 	bool refresh_bitmap = false;
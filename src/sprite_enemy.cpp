@@ -135,6 +135,11 @@ void Sprite_Enemy::Draw(Bitmap& dst) {
 	Sprite_Battler::Draw(dst);
 }
 
+bool Sprite_Enemy::GetDamage(Rect& /* damage */) {
+	// Draw modifies the sprite state: Not tracked
+	return false;
+}
+
 void Sprite_Enemy::Refresh() {
 	if (sprite_name != GetBattler()->GetSpriteName() || hue != GetBattler()->GetHue()) {
 		CreateSprite();
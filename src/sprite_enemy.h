@@ -41,6 +41,7 @@ public:
 	~Sprite_Enemy() override;
 
 	void Draw(Bitmap& dst) override;
+	bool GetDamage(Rect& damage) override;
 
 	Game_Enemy* GetBattler() const;
 
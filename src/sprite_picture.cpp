@@ -174,6 +174,11 @@ void Sprite_Picture::Draw(Bitmap& dst) {
 	Sprite::Draw(dst);
 }
 
+bool Sprite_Picture::GetDamage(Rect& /* damage */) {
+	// Draw modifies the sprite state: Not tracked
+	return false;
+}
+
 int Sprite_Picture::GetFrameWidth() const {
 	const auto& pic = Main_Data::game_pictures->GetPicture(pic_id);
 	const auto& data = pic.data;
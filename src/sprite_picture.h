@@ -35,6 +35,7 @@ public:
 	Sprite_Picture(int pic_id, Drawable::Flags flags = Drawable::Flags::Default);
 
 	void Draw(Bitmap& dst) override;
+	bool GetDamage(Rect& damage) override;
 
 	void OnPictureShow();
 
@@ -111,3 +111,8 @@ void Sprite_Timer::Draw(Bitmap& dst) {
 	Sprite::Draw(dst);
 }
 
+bool Sprite_Timer::GetDamage(Rect& /* damage */) {
+	// Draw modifies the sprite state: Not tracked
+	return false;
+}
+
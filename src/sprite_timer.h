@@ -37,6 +37,7 @@ public:
 
 protected:
 	void Draw(Bitmap& dst) override;
+	bool GetDamage(Rect& damage) override;
 
 	int which = 0;
 
@@ -142,3 +142,8 @@ void Sprite_Weapon::Draw(Bitmap& dst) {
 
 	Sprite::Draw(dst);
 }
+
+bool Sprite_Weapon::GetDamage(Rect& /* damage */) {
+	// Draw modifies the sprite state: Not tracked
+	return false;
+}
@@ -53,6 +53,7 @@ public:
 	void StopAttack();
 
 	void Draw(Bitmap& dst) override;
+	bool GetDamage(Rect& damage) override;
 
 protected:
 	void CreateSprite();
@@ -0,0 +1,117 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_SPSC_QUEUE_H
+#define EP_SPSC_QUEUE_H
+
+// Headers
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/**
+ * A bounded lock-free queue for passing values from exactly one producer
+ * thread to exactly one consumer thread.
+ * Neither side blocks or allocates, which makes it usable from real-time
+ * threads like audio callbacks.
+ *
+ * @tparam T element type, must be default constructible and movable
+ * @tparam N capacity, must be a power of two
+ */
+template <typename T, size_t N>
+class SpscQueue {
+	static_assert(N > 0 && (N & (N - 1)) == 0, "Capacity must be a power of two");
+public:
+	SpscQueue() = default;
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	/**
+	 * Appends a value. Must only be called by the producer.
+	 *
+	 * @param value value to append, only moved from when the call succeeds
+	 * @return false when the queue is full
+	 */
+	bool Push(T&& value);
+
+	/**
+	 * Removes the oldest value. Must only be called by the consumer.
+	 *
+	 * @param value receives the value
+	 * @return false when the queue is empty
+	 */
+	bool Pop(T& value);
+
+	/**
+	 * Must only be called by the producer. The result stays true until the
+	 * producer pushes.
+	 *
+	 * @return whether the next Push succeeds
+	 */
+	bool CanPush() const;
+
+	/** @return whether the queue was empty at the time of the call */
+	bool IsEmpty() const;
+
+	/** @return maximum number of elements */
+	static constexpr size_t GetCapacity() { return N; }
+
+private:
+	std::array<T, N> items = {};
+	/** Written by the producer only */
+	std::atomic<size_t> head = 0;
+	/** Written by the consumer only */
+	std::atomic<size_t> tail = 0;
+};
+
+template <typename T, size_t N>
+inline bool SpscQueue<T, N>::Push(T&& value) {
+	const size_t h = head.load(std::memory_order_relaxed);
+	if (h - tail.load(std::memory_order_acquire) == N) {
+		return false;
+	}
+
+	items[h & (N - 1)] = std::move(value);
+	head.store(h + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T, size_t N>
+inline bool SpscQueue<T, N>::Pop(T& value) {
+	const size_t t = tail.load(std::memory_order_relaxed);
+	if (t == head.load(std::memory_order_acquire)) {
+		return false;
+	}
+
+	value = std::move(items[t & (N - 1)]);
+	tail.store(t + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T, size_t N>
+inline bool SpscQueue<T, N>::CanPush() const {
+	return head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire) < N;
+}
+
+template <typename T, size_t N>
+inline bool SpscQueue<T, N>::IsEmpty() const {
+	return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+}
+
+#endif
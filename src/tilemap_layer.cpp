@@ -16,6 +16,7 @@
  */
 
 // Headers
+#include <algorithm>
 #include <cstring>
 #include <cmath>
 #include "tilemap_layer.h"
@@ -29,6 +30,15 @@
 #include "game_system.h"
 #include "drawable_mgr.h"
 #include "baseui.h"
+#include "instrumentation.h"
+#include "worker_pool.h"
+
+// Draw splits the screen into bands rendered in parallel when there is enough work
+static constexpr int min_band_rows = 4;
+static constexpr size_t min_parallel_tiles = 512;
+
+bool TilemapLayer::parallel_draw = true;
+bool TilemapLayer::chunk_cache = true;
 
 // Blocks subtiles IDs
 // Mess with this code and you will die in 3 days...
@@ -209,32 +219,40 @@ TilemapLayer::TilemapLayer(int ilayer) :
 // was created intentionally. Inlining the transparency check was measured and shown
 // to provide a performance improvement
 EP_ALWAYS_INLINE
-void TilemapLayer::DrawTile(Bitmap& dst, Bitmap& tileset, Bitmap& tone_tileset, int x, int y, int row, int col, uint32_t tone_hash, bool allow_fast_blit) {
+void TilemapLayer::DrawTile(Bitmap& tileset, Bitmap& tone_tileset, int x, int y, int row, int col, uint32_t tone_hash, bool allow_fast_blit) {
 	auto op = tileset.GetTileOpacity(col, row);
 	if (op != ImageOpacity::Transparent) {
-		DrawTileImpl(dst, tileset, tone_tileset, x, y, row, col, tone_hash, op, allow_fast_blit);
+		DrawTileImpl(tileset, tone_tileset, x, y, row, col, tone_hash, op, allow_fast_blit);
 	}
 }
 
-void TilemapLayer::DrawTileImpl(Bitmap& dst, Bitmap& tileset, Bitmap& tone_tileset, int x, int y, int row, int col, uint32_t tone_hash, ImageOpacity op, bool allow_fast_blit) {
-
-	auto rect = Rect{ col * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE };
-
+void TilemapLayer::DrawTileImpl(Bitmap& tileset, Bitmap& tone_tileset, int x, int y, int row, int col, uint32_t tone_hash, ImageOpacity op, bool allow_fast_blit) {
 	auto* src = &tileset;
 
 	// Create tone changed tile
+	// Happens here and not in BlitTiles because the tone tiles are shared by all threads
 	if (tone != Tone()) {
 		if (chipset_tone_tiles.insert(tone_hash).second) {
+			auto rect = Rect{ col * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE };
 			tone_tileset.ToneBlit(col * TILE_SIZE, row * TILE_SIZE, tileset, rect, tone, Opacity::Opaque());
 		}
 		src = &tone_tileset;
 	}
 
 	bool use_fast_blit = fast_blit && allow_fast_blit;
-	if (op == ImageOpacity::Opaque || use_fast_blit) {
-		dst.BlitFast(x, y, *src, rect, 255);
-	} else {
-		dst.Blit(x, y, *src, rect, 255);
+	tile_blits.push_back({ src, x, y, col, row, op == ImageOpacity::Opaque || use_fast_blit, op == ImageOpacity::Opaque });
+}
+
+void TilemapLayer::BlitTiles(Bitmap& dst, int first_row, int last_row, int offset_y) const {
+	for (size_t i = tile_row_begin[first_row]; i < tile_row_begin[last_row]; ++i) {
+		const auto& tile = tile_blits[i];
+		auto rect = Rect{ tile.col * TILE_SIZE, tile.row * TILE_SIZE, TILE_SIZE, TILE_SIZE };
+
+		if (tile.fast) {
+			dst.BlitFast(tile.x, tile.y - offset_y, *tile.src, rect, 255);
+		} else {
+			dst.Blit(tile.x, tile.y - offset_y, *tile.src, rect, 255);
+		}
 	}
 }
 
@@ -258,7 +276,97 @@ static uint32_t MakeAbTileHash(int id, int anim_step) {
 	return static_cast<uint32_t>((id + (anim_step << 12)) | (4 << 24));
 }
 
+void TilemapLayer::QueueMapTile(int map_x, int map_y, int map_draw_x, int map_draw_y, uint8_t z_order, uint32_t animation_step_c, uint32_t animation_step_ab) {
+	// Get the tile data
+	TileData &tile = GetDataCache(map_x, map_y);
+
+	// Draw the sublayer if its z is being draw now
+	if (z_order == tile.z) {
+		if (layer == 0) {
+			// If lower layer
+			bool allow_fast_blit = (tile.z == TileBelow);
+
+			if (tile.ID >= BLOCK_E && tile.ID < BLOCK_E + BLOCK_E_TILES) {
+				int id = substitutions[tile.ID - BLOCK_E];
+				// If Block E
+
+				int row, col;
+
+				// Get the tile coordinates from chipset
+				if (id < 96) {
+					// If from first column of the block
+					col = 12 + id % 6;
+					row = id / 6;
+				} else {
+					// If from second column of the block
+					col = 18 + (id - 96) % 6;
+					row = (id - 96) / 6;
+				}
+
+				auto tone_hash = MakeETileHash(id);
+				DrawTile(*chipset, *chipset_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
+			} else if (tile.ID >= BLOCK_C && tile.ID < BLOCK_D) {
+				// If Block C
+
+				// Get the tile coordinates from chipset
+				int col = 3 + (tile.ID - BLOCK_C) / 50;
+				int row = 4 + animation_step_c;
+
+				auto tone_hash = MakeCTileHash(tile.ID, animation_step_c);
+				DrawTile(*chipset, *chipset_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
+			} else if (tile.ID < BLOCK_C) {
+				// If Blocks A1, A2, B
+
+				// Draw the tile from autotile cache
+				TileXY pos = GetCachedAutotileAB(tile.ID, animation_step_ab);
+
+				int col = pos.x;
+				int row = pos.y;
+
+				// Create tone changed tile
+				auto tone_hash = MakeAbTileHash(tile.ID,  animation_step_ab);
+				DrawTile(*autotiles_ab_screen, *autotiles_ab_screen_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
+			} else {
+				// If blocks D1-D12
+
+				// Draw the tile from autotile cache
+				TileXY pos = GetCachedAutotileD(tile.ID);
+
+				int col = pos.x;
+				int row = pos.y;
+
+				auto tone_hash = MakeDTileHash(tile.ID);
+				DrawTile(*autotiles_d_screen, *autotiles_d_screen_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
+			}
+		} else {
+			// If upper layer
+
+			// Check that block F is being drawn
+			if (tile.ID >= BLOCK_F && tile.ID < BLOCK_F + BLOCK_F_TILES) {
+				int id = substitutions[tile.ID - BLOCK_F];
+				int row, col;
+
+				// Get the tile coordinates from chipset
+				if (id < 48) {
+					// If from first column of the block
+					col = 18 + id % 6;
+					row = 8 + id / 6;
+				} else {
+					// If from second column of the block
+					col = 24 + (id - 48) % 6;
+					row = (id - 48) / 6;
+				}
+
+				auto tone_hash = MakeFTileHash(id);
+				DrawTile(*chipset, *chipset_effect, map_draw_x, map_draw_y, row, col, tone_hash);
+			}
+		}
+	}
+}
+
 void TilemapLayer::Draw(Bitmap& dst, uint8_t z_order, int render_ox, int render_oy) {
+	Instrumentation::ZoneScope zone("TilemapLayer::Draw");
+
 	// Get the number of tiles that can be displayed on window
 	int tiles_x = (int)ceil(Player::screen_width / (float)TILE_SIZE);
 	int tiles_y = (int)ceil(Player::screen_height / (float)TILE_SIZE);
@@ -284,18 +392,8 @@ void TilemapLayer::Draw(Bitmap& dst, uint8_t z_order, int render_ox, int render_
 		return rem >= 0 ? rem : m + rem;
 	};
 
-	// FIXME: When Game_Map singleton is made an object we can remove this null check
-	const auto frames = Main_Data::game_system ? static_cast<uint32_t>(Main_Data::game_system->GetFrameCounter()) : 0u;
-	auto animation_step_c = (frames / 6) % 4;
-	auto animation_step_ab = frames / animation_speed;
-	if (animation_type) {
-		animation_step_ab %= 3;
-	} else {
-		animation_step_ab %= 4;
-		if (animation_step_ab == 3) {
-			animation_step_ab = 1;
-		}
-	}
+	uint32_t animation_step_c, animation_step_ab;
+	GetAnimationSteps(animation_step_c, animation_step_ab);
 
 	const int div_ox = div_rounding_down(ox - render_ox, TILE_SIZE);
 	const int div_oy = div_rounding_down(oy - render_oy, TILE_SIZE);
@@ -303,7 +401,55 @@ void TilemapLayer::Draw(Bitmap& dst, uint8_t z_order, int render_ox, int render_
 	const int mod_ox = mod(ox - render_ox, TILE_SIZE);
 	const int mod_oy = mod(oy - render_oy, TILE_SIZE);
 
+	++chunk_frame;
+
+	if (revision != chunks_revision) {
+		chunks.clear();
+		chunks_revision = revision;
+		chunks_stable_draws = 0;
+	}
+
+	// While the layer changes every frame (e.g. tone fading) building chunks is wasted work:
+	// Only use them after both sublayers were drawn once without a change.
+	chunks_stable_draws = std::min(chunks_stable_draws + 1, 3);
+	if (chunk_cache && chunks_stable_draws > 2) {
+		auto make_runs = [&](std::vector<TileRun>& runs, int tiles, int div_o, bool loop, int size) {
+			runs.clear();
+			for (int i = 0; i < tiles; ++i) {
+				int map = div_o + i;
+				if (loop) map = mod(map, size);
+
+				if (map < 0 || map >= size) {
+					continue;
+				}
+
+				if (!runs.empty()) {
+					auto& run = runs.back();
+					if (run.screen + run.count == i && run.map + run.count == map && map % CHUNK_TILES != 0) {
+						++run.count;
+						continue;
+					}
+				}
+				runs.push_back({ i, map, 1 });
+			}
+		};
+
+		make_runs(chunk_runs_x, tiles_x, div_ox, loop_h, width);
+		make_runs(chunk_runs_y, tiles_y, div_oy, loop_v, height);
+
+		// Room for every visible chunk in two z orders and two animation steps
+		max_chunks = std::max<size_t>(16, 4 * (tiles_x / CHUNK_TILES + 2) * (tiles_y / CHUNK_TILES + 2));
+
+		DrawChunks(dst, z_order, mod_ox, mod_oy, animation_step_c, animation_step_ab);
+		return;
+	}
+
+	tile_blits.clear();
+	tile_row_begin.clear();
+
 	for (int y = 0; y < tiles_y; y++) {
+		tile_row_begin.push_back(tile_blits.size());
+
 		for (int x = 0; x < tiles_x; x++) {
 
 			// Get the real maps tile coordinates
@@ -320,98 +466,172 @@ void TilemapLayer::Draw(Bitmap& dst, uint8_t z_order, int render_ox, int render_
 				continue;
 			}
 
-			int map_draw_x = x * TILE_SIZE - mod_ox;
-			int map_draw_y = y * TILE_SIZE - mod_oy;
-
-			// Get the tile data
-			TileData &tile = GetDataCache(map_x, map_y);
-
-			// Draw the sublayer if its z is being draw now
-			if (z_order == tile.z) {
-				if (layer == 0) {
-					// If lower layer
-					bool allow_fast_blit = (tile.z == TileBelow);
-
-					if (tile.ID >= BLOCK_E && tile.ID < BLOCK_E + BLOCK_E_TILES) {
-						int id = substitutions[tile.ID - BLOCK_E];
-						// If Block E
-
-						int row, col;
-
-						// Get the tile coordinates from chipset
-						if (id < 96) {
-							// If from first column of the block
-							col = 12 + id % 6;
-							row = id / 6;
-						} else {
-							// If from second column of the block
-							col = 18 + (id - 96) % 6;
-							row = (id - 96) / 6;
-						}
-
-						auto tone_hash = MakeETileHash(id);
-						DrawTile(dst, *chipset, *chipset_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
-					} else if (tile.ID >= BLOCK_C && tile.ID < BLOCK_D) {
-						// If Block C
-
-						// Get the tile coordinates from chipset
-						int col = 3 + (tile.ID - BLOCK_C) / 50;
-						int row = 4 + animation_step_c;
-
-						auto tone_hash = MakeCTileHash(tile.ID, animation_step_c);
-						DrawTile(dst, *chipset, *chipset_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
-					} else if (tile.ID < BLOCK_C) {
-						// If Blocks A1, A2, B
-
-						// Draw the tile from autotile cache
-						TileXY pos = GetCachedAutotileAB(tile.ID, animation_step_ab);
-
-						int col = pos.x;
-						int row = pos.y;
-
-						// Create tone changed tile
-						auto tone_hash = MakeAbTileHash(tile.ID,  animation_step_ab);
-						DrawTile(dst, *autotiles_ab_screen, *autotiles_ab_screen_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
-					} else {
-						// If blocks D1-D12
-
-						// Draw the tile from autotile cache
-						TileXY pos = GetCachedAutotileD(tile.ID);
-
-						int col = pos.x;
-						int row = pos.y;
-
-						auto tone_hash = MakeDTileHash(tile.ID);
-						DrawTile(dst, *autotiles_d_screen, *autotiles_d_screen_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
-					}
-				} else {
-					// If upper layer
-
-					// Check that block F is being drawn
-					if (tile.ID >= BLOCK_F && tile.ID < BLOCK_F + BLOCK_F_TILES) {
-						int id = substitutions[tile.ID - BLOCK_F];
-						int row, col;
-
-						// Get the tile coordinates from chipset
-						if (id < 48) {
-							// If from first column of the block
-							col = 18 + id % 6;
-							row = 8 + id / 6;
-						} else {
-							// If from second column of the block
-							col = 24 + (id - 48) % 6;
-							row = (id - 48) / 6;
-						}
-
-						auto tone_hash = MakeFTileHash(id);
-						DrawTile(dst, *chipset, *chipset_effect, map_draw_x, map_draw_y, row, col, tone_hash);
-					}
+			QueueMapTile(map_x, map_y, x * TILE_SIZE - mod_ox, y * TILE_SIZE - mod_oy, z_order, animation_step_c, animation_step_ab);
+		}
+	}
+	tile_row_begin.push_back(tile_blits.size());
+
+	auto& pool = WorkerPool::Instance();
+	const int num_bands = parallel_draw ? std::min(pool.GetNumThreads(), tiles_y / min_band_rows) : 1;
+
+	if (num_bands <= 1 || tile_blits.size() < min_parallel_tiles) {
+		BlitTiles(dst, 0, tiles_y, 0);
+		return;
+	}
+
+	// The bands consist of whole tile rows: No tile crosses a band border and every
+	// band is written by one thread only, so the result matches the serial path.
+	struct Band {
+		BitmapRef view;
+		int first_row;
+		int last_row;
+		int top;
+	};
+	std::vector<Band> bands(num_bands);
+
+	for (int i = 0; i < num_bands; ++i) {
+		auto& band = bands[i];
+		band.first_row = tiles_y * i / num_bands;
+		band.last_row = tiles_y * (i + 1) / num_bands;
+		band.top = std::clamp(band.first_row * TILE_SIZE - mod_oy, 0, dst.height());
+		const int bottom = std::clamp(band.last_row * TILE_SIZE - mod_oy, 0, dst.height());
+
+		if (bottom > band.top) {
+			band.view = dst.CreateRowView(band.top, bottom - band.top);
+		}
+	}
+
+	pool.ParallelFor(num_bands, [&](int i) {
+		const auto& band = bands[i];
+		if (band.view) {
+			BlitTiles(*band.view, band.first_row, band.last_row, band.top);
+		}
+	});
+}
+
+void TilemapLayer::DrawChunks(Bitmap& dst, uint8_t z_order, int mod_ox, int mod_oy, uint32_t animation_step_c, uint32_t animation_step_ab) {
+	for (const auto& run_y : chunk_runs_y) {
+		for (const auto& run_x : chunk_runs_x) {
+			const auto& chunk = GetChunk(run_x.map / CHUNK_TILES, run_y.map / CHUNK_TILES, z_order, animation_step_c, animation_step_ab);
+			if (!chunk.bitmap) {
+				continue;
+			}
+
+			const int tile_x = run_x.map % CHUNK_TILES;
+			const int tile_y = run_y.map % CHUNK_TILES;
+			const int dst_x = run_x.screen * TILE_SIZE - mod_ox;
+			const int dst_y = run_y.screen * TILE_SIZE - mod_oy;
+
+			auto rect = Rect{ tile_x * TILE_SIZE, tile_y * TILE_SIZE, run_x.count * TILE_SIZE, run_y.count * TILE_SIZE };
+			if (chunk.opaque) {
+				dst.BlitFast(dst_x, dst_y, *chunk.bitmap, rect, 255);
+			} else {
+				dst.Blit(dst_x, dst_y, *chunk.bitmap, rect, 255);
+			}
+
+			for (const auto& tile : chunk.replace_tiles) {
+				if (tile.x < tile_x || tile.x >= tile_x + run_x.count || tile.y < tile_y || tile.y >= tile_y + run_y.count) {
+					continue;
 				}
+
+				auto tile_rect = Rect{ tile.x * TILE_SIZE, tile.y * TILE_SIZE, TILE_SIZE, TILE_SIZE };
+				dst.BlitFast(dst_x + (tile.x - tile_x) * TILE_SIZE, dst_y + (tile.y - tile_y) * TILE_SIZE, *chunk.bitmap, tile_rect, 255);
 			}
 		}
 	}
 }
 
+const TilemapLayer::Chunk& TilemapLayer::GetChunk(int chunk_x, int chunk_y, uint8_t z_order, uint32_t animation_step_c, uint32_t animation_step_ab) {
+	const int chunks_x = (width + CHUNK_TILES - 1) / CHUNK_TILES;
+	const auto animation = chunk_animations[chunk_x + chunk_y * chunks_x];
+
+	// Chunks with animated tiles are cached for every animation step
+	const uint64_t key = static_cast<uint64_t>(chunk_x)
+		| (static_cast<uint64_t>(chunk_y) << 16)
+		| (static_cast<uint64_t>(z_order) << 32)
+		| (static_cast<uint64_t>((animation & ChunkAnimation_C) ? animation_step_c : 0) << 40)
+		| (static_cast<uint64_t>((animation & ChunkAnimation_AB) ? animation_step_ab : 0) << 48);
+
+	auto it = chunks.find(key);
+	if (it != chunks.end()) {
+		it->second.last_used = chunk_frame;
+		return it->second;
+	}
+
+	if (chunks.size() >= max_chunks) {
+		// Evict the least recently used chunk
+		auto lru = std::min_element(chunks.begin(), chunks.end(), [](const auto& a, const auto& b) {
+			return a.second.last_used < b.second.last_used;
+		});
+		chunks.erase(lru);
+	}
+
+	auto& chunk = chunks[key];
+	chunk.last_used = chunk_frame;
+
+	const int first_x = chunk_x * CHUNK_TILES;
+	const int first_y = chunk_y * CHUNK_TILES;
+	const int last_x = std::min(first_x + CHUNK_TILES, width);
+	const int last_y = std::min(first_y + CHUNK_TILES, height);
+
+	tile_blits.clear();
+	for (int y = first_y; y < last_y; ++y) {
+		for (int x = first_x; x < last_x; ++x) {
+			QueueMapTile(x, y, (x - first_x) * TILE_SIZE, (y - first_y) * TILE_SIZE, z_order, animation_step_c, animation_step_ab);
+		}
+	}
+
+	if (tile_blits.empty()) {
+		return chunk;
+	}
+
+	// The chunk stores the tile pixels unmodified, blending happens when drawing the chunk
+	chunk.bitmap = Bitmap::Create(CHUNK_TILES * TILE_SIZE, CHUNK_TILES * TILE_SIZE, true);
+
+	int opaque_tiles = 0;
+	for (const auto& tile : tile_blits) {
+		auto rect = Rect{ tile.col * TILE_SIZE, tile.row * TILE_SIZE, TILE_SIZE, TILE_SIZE };
+		chunk.bitmap->BlitFast(tile.x, tile.y, *tile.src, rect, 255);
+
+		if (tile.opaque) {
+			++opaque_tiles;
+		} else if (tile.fast) {
+			chunk.replace_tiles.push_back({ static_cast<uint8_t>(tile.x / TILE_SIZE), static_cast<uint8_t>(tile.y / TILE_SIZE) });
+		}
+	}
+	chunk.opaque = (opaque_tiles == CHUNK_TILES * CHUNK_TILES);
+
+	tile_blits.clear();
+
+	return chunk;
+}
+
+void TilemapLayer::GetAnimationSteps(uint32_t& step_c, uint32_t& step_ab) const {
+	// FIXME: When Game_Map singleton is made an object we can remove this null check
+	const auto frames = Main_Data::game_system ? static_cast<uint32_t>(Main_Data::game_system->GetFrameCounter()) : 0u;
+	step_c = (frames / 6) % 4;
+	step_ab = frames / animation_speed;
+	if (animation_type) {
+		step_ab %= 3;
+	} else {
+		step_ab %= 4;
+		if (step_ab == 3) {
+			step_ab = 1;
+		}
+	}
+}
+
+void TilemapLayer::RecordDamageState(DamageTracker& tracker) const {
+	tracker << revision << chipset << tone << ox << oy << width << height << fast_blit
+		<< Game_Map::LoopHorizontal() << Game_Map::LoopVertical();
+
+	if (has_animated_tiles) {
+		uint32_t step_c, step_ab;
+		GetAnimationSteps(step_c, step_ab);
+		tracker << step_c << step_ab;
+	}
+}
+
 TilemapLayer::TileXY TilemapLayer::GetCachedAutotileAB(short ID, short animID) {
 	short block = ID / 1000;
 	short b_subtile = (ID - block * 1000) / 50;
@@ -426,11 +646,23 @@ TilemapLayer::TileXY TilemapLayer::GetCachedAutotileD(short ID) {
 }
 
 void TilemapLayer::CreateTileCache(const std::vector<short>& nmap_data) {
+	++revision;
+	has_animated_tiles = false;
+
+	const int chunks_x = (width + CHUNK_TILES - 1) / CHUNK_TILES;
+	const int chunks_y = (height + CHUNK_TILES - 1) / CHUNK_TILES;
+	chunk_animations.assign(chunks_x * chunks_y, 0);
+
 	data_cache_vec.resize(width * height);
 	for (int x = 0; x < width; x++) {
 		for (int y = 0; y < height; y++) {
 			auto tile_id = nmap_data[x + y * width];
 			CreateTileCacheAt(x, y, tile_id);
+
+			if (layer == 0 && tile_id < BLOCK_D) {
+				has_animated_tiles = true;
+				chunk_animations[x / CHUNK_TILES + (y / CHUNK_TILES) * chunks_x] |= (tile_id < BLOCK_C ? ChunkAnimation_AB : ChunkAnimation_C);
+			}
 		}
 	}
 }
@@ -670,6 +902,7 @@ BitmapRef TilemapLayer::GenerateAutotiles(int count, const std::unordered_map<ui
 }
 
 void TilemapLayer::SetChipset(BitmapRef const& nchipset) {
+	++revision;
 	chipset = nchipset;
 	chipset_effect = Bitmap::Create(chipset->width(), chipset->height());
 	chipset_tone_tiles.clear();
@@ -887,12 +1120,21 @@ void TilemapSubLayer::Draw(Bitmap& dst) {
 	tilemap->Draw(dst, internal_z, GetRenderOx(), GetRenderOy());
 }
 
+bool TilemapSubLayer::GetDamage(Rect& damage) {
+	tilemap->RecordDamageState(damage_tracker.Begin(*this));
+
+	// Scrolling moves every tile on the screen
+	damage = damage_tracker.End(Rect(0, 0, Player::screen_width, Player::screen_height));
+	return true;
+}
+
 void TilemapLayer::SetTone(Tone tone) {
 	if (tone == this->tone) {
 		return;
 	}
 
 	this->tone = tone;
+	++revision;
 
 	if (autotiles_d_screen_effect) {
 		autotiles_d_screen_effect->Clear();
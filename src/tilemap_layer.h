@@ -25,6 +25,7 @@
 #include <unordered_set>
 #include <unordered_map>
 #include "system.h"
+#include "damage_tracker.h"
 #include "drawable.h"
 #include "tone.h"
 #include "opacity.h"
@@ -41,11 +42,15 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	bool GetDamage(Rect& damage) override;
+
 private:
 	TilemapLayer* tilemap = nullptr;
 
 	// z value truncated to lower 8 bits for tile cache
 	uint8_t internal_z = 0;
+
+	DamageTracker damage_tracker;
 };
 
 /**
@@ -99,6 +104,31 @@ public:
 
 	void SetTone(Tone tone);
 
+	/**
+	 * Records everything the drawing of the layer depends on.
+	 * Used by the sublayers to report their damage.
+	 *
+	 * @param tracker damage tracker of the sublayer
+	 */
+	void RecordDamageState(DamageTracker& tracker) const;
+
+	/**
+	 * Enables splitting Draw into horizontal bands which are rendered in
+	 * parallel. The result is identical to rendering serially.
+	 *
+	 * @param enabled whether to render in parallel (default: enabled)
+	 */
+	static void SetParallelDraw(bool enabled);
+
+	/**
+	 * Enables caching the rendered tiles in chunks of 16x16 tiles.
+	 * While the layer does not change a frame only blits the visible chunks.
+	 * The result is identical to rendering the tiles directly.
+	 *
+	 * @param enabled whether to use the chunk cache (default: enabled)
+	 */
+	static void SetChunkCache(bool enabled);
+
 private:
 	BitmapRef chipset;
 	BitmapRef chipset_effect;
@@ -115,16 +145,25 @@ private:
 	int layer = 0;
 	bool fast_blit = false;
 
+	/** Incremented whenever the rendered tiles change */
+	uint32_t revision = 0;
+	/** Whether the layer contains tiles of the animated blocks A, B and C */
+	bool has_animated_tiles = false;
+
 	void CreateTileCache(const std::vector<short>& nmap_data);
 	void CreateTileCacheAt(int x, int y, int tile_id);
 	void RecreateTileDataAt(int x, int y, int tile_id);
 	void GenerateAutotileAB(short ID, short animID);
 	void GenerateAutotileD(short ID);
-	void DrawTile(Bitmap& dst, Bitmap& tile, Bitmap& tone_tile, int x, int y, int row, int col, uint32_t tone_hash, bool allow_fast_blit = true);
-	void DrawTileImpl(Bitmap& dst, Bitmap& tile, Bitmap& tone_tile, int x, int y, int row, int col, uint32_t tone_hash, ImageOpacity op, bool allow_fast_blit);
+	void DrawTile(Bitmap& tile, Bitmap& tone_tile, int x, int y, int row, int col, uint32_t tone_hash, bool allow_fast_blit = true);
+	void DrawTileImpl(Bitmap& tile, Bitmap& tone_tile, int x, int y, int row, int col, uint32_t tone_hash, ImageOpacity op, bool allow_fast_blit);
+	void BlitTiles(Bitmap& dst, int first_row, int last_row, int offset_y) const;
+	void QueueMapTile(int map_x, int map_y, int map_draw_x, int map_draw_y, uint8_t z_order, uint32_t animation_step_c, uint32_t animation_step_ab);
 	void RecalculateAutotile(int x, int y, int tile_id);
+	void GetAnimationSteps(uint32_t& step_c, uint32_t& step_ab) const;
 
 	static const int TILES_PER_ROW = 64;
+	static const int CHUNK_TILES = 16;
 
 	struct TileXY {
 		uint8_t x;
@@ -161,6 +200,69 @@ private:
 
 	std::vector<TileData> data_cache_vec;
 
+	/** A tile queued by DrawTile */
+	struct TileBlit {
+		const Bitmap* src;
+		int x;
+		int y;
+		int col;
+		int row;
+		bool fast;
+		bool opaque;
+	};
+
+	/** Tiles of the current Draw call, ordered by screen row */
+	std::vector<TileBlit> tile_blits;
+	/** Index of the first tile_blits entry of every screen row */
+	std::vector<size_t> tile_row_begin;
+
+	static bool parallel_draw;
+
+	/** A consecutive range of screen tiles showing consecutive map tiles of one chunk */
+	struct TileRun {
+		int screen;
+		int map;
+		int count;
+	};
+
+	struct ChunkTile {
+		uint8_t x;
+		uint8_t y;
+	};
+
+	/** Prerendered tiles of one z order in a 16x16 tiles area of the map */
+	struct Chunk {
+		/** Null when the area has no tiles of this z order */
+		BitmapRef bitmap;
+		/** Fast blitted tiles with transparency: They replace the destination instead of blending */
+		std::vector<ChunkTile> replace_tiles;
+		/** Every tile of the chunk is opaque */
+		bool opaque = false;
+		uint32_t last_used = 0;
+	};
+
+	enum ChunkAnimation : uint8_t {
+		ChunkAnimation_C = 1,
+		ChunkAnimation_AB = 2
+	};
+
+	const Chunk& GetChunk(int chunk_x, int chunk_y, uint8_t z_order, uint32_t animation_step_c, uint32_t animation_step_ab);
+	void DrawChunks(Bitmap& dst, uint8_t z_order, int mod_ox, int mod_oy, uint32_t animation_step_c, uint32_t animation_step_ab);
+
+	std::unordered_map<uint64_t, Chunk> chunks;
+	/** ChunkAnimation flags of every chunk */
+	std::vector<uint8_t> chunk_animations;
+	std::vector<TileRun> chunk_runs_x;
+	std::vector<TileRun> chunk_runs_y;
+	/** Layer revision the cached chunks belong to */
+	uint32_t chunks_revision = 0;
+	/** Draw calls since the layer revision changed */
+	int chunks_stable_draws = 0;
+	uint32_t chunk_frame = 0;
+	size_t max_chunks = 0;
+
+	static bool chunk_cache;
+
 	TilemapSubLayer lower_layer;
 	TilemapSubLayer upper_layer;
 
@@ -257,8 +359,19 @@ inline void TilemapLayer::SetAnimationType(int type) {
 	animation_type = type;
 }
 
+inline void TilemapLayer::SetParallelDraw(bool enabled) {
+	parallel_draw = enabled;
+}
+
+inline void TilemapLayer::SetChunkCache(bool enabled) {
+	chunk_cache = enabled;
+}
+
 inline void TilemapLayer::SetFastBlit(bool fast) {
-	fast_blit = fast;
+	if (fast != fast_blit) {
+		fast_blit = fast;
+		++revision;
+	}
 }
 
 inline TilemapLayer::TileData& TilemapLayer::GetDataCache(int x, int y) {
@@ -174,6 +174,14 @@ void Transition::SetAttributesTransitions() {
 	}
 }
 
+bool Transition::GetDamage(Rect& damage) {
+	// While active the compositor redraws the whole screen anyway
+	damage_tracker.Begin(*this) << IsActive() << IsErasedNotActive();
+
+	damage = damage_tracker.End(Rect(0, 0, Player::screen_width, Player::screen_height));
+	return true;
+}
+
 void Transition::Draw(Bitmap& dst) {
 	if (!IsActive())
 		return;
@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <vector>
 #include <string>
+#include "damage_tracker.h"
 #include "drawable.h"
 #include "system.h"
 #include "scene.h"
@@ -108,6 +109,7 @@ public:
 	void PrependFlashes(int r, int g, int b, int power, int duration, int iterations);
 
 	void Draw(Bitmap& dst) override;
+	bool GetDamage(Rect& damage) override;
 	void Update();
 
 	bool IsActive() const;
@@ -150,6 +152,8 @@ private:
 	std::vector<uint32_t> random_blocks;
 	uint32_t current_blocks_print;
 
+	DamageTracker damage_tracker;
+
 	void SetAttributesTransitions();
 };
 
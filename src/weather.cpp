@@ -62,6 +62,23 @@ void Weather::Draw(Bitmap& dst) {
 	}
 }
 
+bool Weather::GetDamage(Rect& damage) {
+	if (!Main_Data::game_screen) {
+		return false;
+	}
+
+	const int type = Main_Data::game_screen->GetWeatherType();
+	damage_tracker.Begin(*this) << type;
+
+	const Rect screen_rect(0, 0, Player::screen_width, Player::screen_height);
+	damage = damage_tracker.End(screen_rect);
+	if (type != Game_Screen::Weather_None) {
+		// The particles move every frame
+		damage = screen_rect;
+	}
+	return true;
+}
+
 static constexpr int num_strength = 3;
 static constexpr int num_rain_or_snow_particles[] = { 20, 60, 100 };
 static constexpr auto rain_bitmap_rect = Rect{ 0, 0, 6, 24 };
@@ -20,6 +20,7 @@
 
 // Headers
 #include <string>
+#include "damage_tracker.h"
 #include "drawable.h"
 #include "system.h"
 #include "tone.h"
@@ -33,6 +34,7 @@ public:
 	Weather();
 
 	void Draw(Bitmap& dst) override;
+	bool GetDamage(Rect& damage) override;
 	void Update();
 
 	Tone GetTone() const;
@@ -70,6 +72,8 @@ private:
 	Tone tone_effect;
 
 	bool tone_dirty = true;
+
+	DamageTracker damage_tracker;
 };
 
 inline Tone Weather::GetTone() const {
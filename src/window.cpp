@@ -175,6 +175,24 @@ void Window::Draw(Bitmap& dst) {
 	}
 }
 
+bool Window::GetDamage(Rect& damage) {
+	const bool arrow_phase = arrow_animation_frame < arrow_animation_frames;
+	const bool cursor_phase = cursor_frame <= 10;
+	const int ianimation_count = animation_frames > 0 ? (int)animation_count : -1;
+
+	damage_tracker.Begin(*this) << windowskin << contents
+		<< x << y << width << height << ox << oy << border_x << border_y
+		<< opacity << frame_opacity << back_opacity << contents_opacity
+		<< stretch << background_alpha << cursor_rect << cursor_phase
+		<< background_needs_refresh << frame_needs_refresh << cursor_needs_refresh
+		<< pause << up_arrow << down_arrow << left_arrow << right_arrow
+		<< animate_arrows << arrow_phase << ianimation_count;
+
+	// The rotated left and right arrows are drawn partially outside of the window
+	damage = damage_tracker.End(Rect(x - 16, y - 16, width + 32, height + 32));
+	return true;
+}
+
 void Window::RefreshBackground() {
 	background_needs_refresh = false;
 
@@ -21,6 +21,7 @@
 // Headers
 #include "system.h"
 #include "bitmap.h"
+#include "damage_tracker.h"
 #include "drawable.h"
 #include "rect.h"
 
@@ -33,6 +34,8 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	bool GetDamage(Rect& damage) override;
+
 	virtual void Update();
 	BitmapRef const& GetWindowskin() const;
 	void SetWindowskin(BitmapRef const& nwindowskin, bool transparent = false);
@@ -130,9 +133,9 @@ private:
 	void RefreshCursor();
 
 	bool background_alpha = false;
-	bool background_needs_refresh;
-	bool frame_needs_refresh;
-	bool cursor_needs_refresh;
+	bool background_needs_refresh = true;
+	bool frame_needs_refresh = true;
+	bool cursor_needs_refresh = true;
 	bool pause = false;
 
 	int cursor_frame = 0;
@@ -140,6 +143,8 @@ private:
 	int animation_frames = 0;
 	double animation_count = 0.0;
 	double animation_increment = 0.0;
+
+	DamageTracker damage_tracker;
 };
 
 inline bool Window::IsOpening() const {
@@ -0,0 +1,131 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <atomic>
+#include <system_error>
+#include "worker_pool.h"
+#include "output.h"
+
+struct WorkerPool::Job {
+	const std::function<void(int)>* func = nullptr;
+	int count = 0;
+	std::atomic<int> next_index{0};
+	std::atomic<int> pending{0};
+	WorkerPool* pool = nullptr;
+};
+
+WorkerPool::WorkerPool(int num_workers) {
+	for (int i = 0; i < num_workers; ++i) {
+		try {
+			workers.emplace_back(&WorkerPool::WorkerFunction, this);
+		} catch (const std::system_error& e) {
+			Output::Debug("WorkerPool: Starting thread failed: {}", e.what());
+			break;
+		}
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+	work_cv.notify_all();
+
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+WorkerPool& WorkerPool::Instance() {
+#if defined(EMSCRIPTEN) && !defined(__EMSCRIPTEN_PTHREADS__)
+	static WorkerPool pool(0);
+#else
+	// A few threads are enough, the work is usually memory bound
+	static WorkerPool pool(std::clamp(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0, 3));
+#endif
+	return pool;
+}
+
+void WorkerPool::ParallelFor(int count, const std::function<void(int)>& func) {
+	if (count <= 0) {
+		return;
+	}
+
+	if (workers.empty() || count == 1) {
+		for (int i = 0; i < count; ++i) {
+			func(i);
+		}
+		return;
+	}
+
+	// Every call gets its own job: Workers waking up late only see a finished job
+	auto job = std::make_shared<Job>();
+	job->func = &func;
+	job->count = count;
+	job->pending = count;
+	job->pool = this;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		current_job = job;
+	}
+	work_cv.notify_all();
+
+	RunJob(*job);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done_cv.wait(lock, [&]() { return job->pending == 0; });
+	current_job.reset();
+}
+
+void WorkerPool::RunJob(Job& job) {
+	for (;;) {
+		int i = job.next_index.fetch_add(1);
+		if (i >= job.count) {
+			return;
+		}
+
+		(*job.func)(i);
+
+		if (job.pending.fetch_sub(1) == 1) {
+			std::lock_guard<std::mutex> lock(job.pool->mutex);
+			job.pool->done_cv.notify_all();
+		}
+	}
+}
+
+void WorkerPool::WorkerFunction() {
+	std::shared_ptr<Job> last_job;
+
+	for (;;) {
+		std::shared_ptr<Job> job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			work_cv.wait(lock, [&]() { return stop || (current_job && current_job != last_job); });
+			if (stop) {
+				return;
+			}
+			job = current_job;
+		}
+
+		RunJob(*job);
+		last_job = std::move(job);
+	}
+}
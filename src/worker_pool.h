@@ -0,0 +1,86 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_WORKER_POOL_H
+#define EP_WORKER_POOL_H
+
+// Headers
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A small pool of threads for splitting work of the main thread.
+ *
+ * The calling thread takes part in the work and the call blocks until all
+ * work items are finished. On platforms without thread support the pool has
+ * no workers and everything runs on the calling thread.
+ */
+class WorkerPool {
+public:
+	/**
+	 * Creates a pool.
+	 *
+	 * @param num_workers number of threads started in addition to the calling thread
+	 */
+	explicit WorkerPool(int num_workers);
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	/**
+	 * The pool shared by the renderer. Its size depends on the CPU core count.
+	 *
+	 * @return shared pool
+	 */
+	static WorkerPool& Instance();
+
+	/** @return number of threads working on a ParallelFor, including the caller */
+	int GetNumThreads() const;
+
+	/**
+	 * Calls func(i) for every i in [0, count) and waits until all calls returned.
+	 * The calls happen in unspecified order on the workers and the calling thread.
+	 *
+	 * @param count number of work items
+	 * @param func function invoked for every work item
+	 */
+	void ParallelFor(int count, const std::function<void(int)>& func);
+
+private:
+	struct Job;
+
+	void WorkerFunction();
+	static void RunJob(Job& job);
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable work_cv;
+	std::condition_variable done_cv;
+	std::shared_ptr<Job> current_job;
+	bool stop = false;
+};
+
+inline int WorkerPool::GetNumThreads() const {
+	return static_cast<int>(workers.size()) + 1;
+}
+
+#endif
@@ -0,0 +1,127 @@
+#include "audio_mixer.h"
+#include "doctest.h"
+#include <cstdint>
+#include <vector>
+
+TEST_SUITE_BEGIN("AudioMixer");
+
+namespace {
+
+template <typename T>
+const uint8_t* Bytes(const std::vector<T>& samples) {
+	return reinterpret_cast<const uint8_t*>(samples.data());
+}
+
+}
+
+TEST_CASE("ConvertS16Stereo") {
+	// Odd frame count, the last frame is converted by the scalar loop
+	std::vector<int16_t> src = { 0, -32768, 16384, -16384, 32767, 1, -1, 8192, 100, -100, 2000, -2000, 7, -7 };
+	const int frames = static_cast<int>(src.size() / 2);
+	std::vector<float> dst(frames * 2);
+
+	AudioMixer::ConvertToStereo(dst.data(), Bytes(src), frames, AudioDecoder::Format::S16, 2, 0.5f, 0.5f);
+	for (size_t i = 0; i < src.size(); ++i) {
+		REQUIRE_EQ(dst[i], src[i] / 32768.0f * 0.5f);
+	}
+}
+
+TEST_CASE("ConvertMono") {
+	std::vector<float> src = { 0.0f, 0.25f, -0.5f, 1.0f, -1.0f, 0.125f, 0.75f };
+	const int frames = static_cast<int>(src.size());
+	std::vector<float> dst(frames * 2);
+
+	AudioMixer::ConvertToStereo(dst.data(), Bytes(src), frames, AudioDecoder::Format::F32, 1, 1.0f, 1.0f);
+	for (int i = 0; i < frames; ++i) {
+		REQUIRE_EQ(dst[i * 2], src[i]);
+		REQUIRE_EQ(dst[i * 2 + 1], src[i]);
+	}
+}
+
+TEST_CASE("ConvertUnsigned") {
+	std::vector<uint8_t> src = { 128, 0, 255, 64 };
+	std::vector<float> dst(4);
+
+	AudioMixer::ConvertToStereo(dst.data(), src.data(), 2, AudioDecoder::Format::U8, 2, 1.0f, 1.0f);
+	REQUIRE_EQ(dst[0], 0.0f);
+	REQUIRE_EQ(dst[1], -1.0f);
+	REQUIRE_EQ(dst[2], doctest::Approx(127.0f / 128.0f));
+	REQUIRE_EQ(dst[3], -0.5f);
+}
+
+TEST_CASE("ConvertMultichannel") {
+	// Only the first two channels are used
+	std::vector<int16_t> src = { 16384, -16384, 100, 8192, -8192, 100 };
+	std::vector<float> dst(4);
+
+	AudioMixer::ConvertToStereo(dst.data(), Bytes(src), 2, AudioDecoder::Format::S16, 3, 1.0f, 1.0f);
+	REQUIRE_EQ(dst[0], 0.5f);
+	REQUIRE_EQ(dst[1], -0.5f);
+	REQUIRE_EQ(dst[2], 0.25f);
+	REQUIRE_EQ(dst[3], -0.25f);
+}
+
+TEST_CASE("GainRamp") {
+	constexpr int frames = 13;
+	std::vector<int16_t> stereo(frames * 2, 16384);
+	std::vector<int16_t> mono(frames, 16384);
+	std::vector<float> dst(frames * 2);
+
+	AudioMixer::ConvertToStereo(dst.data(), Bytes(stereo), frames, AudioDecoder::Format::S16, 2, 0.0f, 1.0f);
+	for (int i = 0; i < frames; ++i) {
+		REQUIRE_EQ(dst[i * 2], doctest::Approx(0.5f * i / frames));
+		REQUIRE_EQ(dst[i * 2 + 1], doctest::Approx(0.5f * i / frames));
+	}
+
+	AudioMixer::ConvertToStereo(dst.data(), Bytes(mono), frames, AudioDecoder::Format::S16, 1, 1.0f, 0.0f);
+	for (int i = 0; i < frames; ++i) {
+		REQUIRE_EQ(dst[i * 2], doctest::Approx(0.5f * (frames - i) / frames));
+		REQUIRE_EQ(dst[i * 2 + 1], doctest::Approx(0.5f * (frames - i) / frames));
+	}
+}
+
+TEST_CASE("MixStereo") {
+	constexpr int frames = 5;
+	std::vector<float> mix(frames * 2, 1.0f);
+	std::vector<float> src(frames * 2);
+	for (int i = 0; i < frames * 2; ++i) {
+		src[i] = i * 0.1f;
+	}
+
+	AudioMixer::MixStereo(mix.data(), src.data(), frames, 2.0f, 2.0f);
+	for (int i = 0; i < frames * 2; ++i) {
+		REQUIRE_EQ(mix[i], 1.0f + src[i] * 2.0f);
+	}
+
+	std::fill(mix.begin(), mix.end(), 0.0f);
+	std::fill(src.begin(), src.end(), 1.0f);
+	AudioMixer::MixStereo(mix.data(), src.data(), frames, 1.0f, 0.0f);
+	for (int i = 0; i < frames; ++i) {
+		REQUIRE_EQ(mix[i * 2], doctest::Approx(1.0f - i / static_cast<float>(frames)));
+		REQUIRE_EQ(mix[i * 2 + 1], doctest::Approx(1.0f - i / static_cast<float>(frames)));
+	}
+}
+
+TEST_CASE("ConvertToS16") {
+	std::vector<float> mix = { 0.0f, 0.5f, -0.5f, 1.0f, -1.0f, 2.0f, -2.0f, 0.25f, 1.4f };
+	std::vector<int16_t> dst(mix.size());
+
+	SUBCASE("clip") {
+		AudioMixer::ConvertToS16(dst.data(), mix.data(), static_cast<int>(mix.size()), 1.0f);
+		REQUIRE_EQ(dst, std::vector<int16_t>{ 0, 16384, -16384, 32767, -32768, 32767, -32768, 8192, 32767 });
+	}
+
+	SUBCASE("compress") {
+		// 0.8 stays, 2.0 becomes full scale and 1.4 is halfway between
+		AudioMixer::ConvertToS16(dst.data(), mix.data(), static_cast<int>(mix.size()), 2.0f);
+		REQUIRE_EQ(dst[1], 16384);
+		REQUIRE_EQ(dst[2], -16384);
+		REQUIRE_EQ(dst[3], doctest::Approx(32768 * (0.8 + 0.2 * 0.2 / 1.2)).epsilon(0.0001));
+		REQUIRE_EQ(dst[5], 32767);
+		REQUIRE_EQ(dst[6], -32768);
+		REQUIRE_EQ(dst[7], 8192);
+		REQUIRE_EQ(dst[8], doctest::Approx(32768 * 0.9).epsilon(0.0001));
+	}
+}
+
+TEST_SUITE_END();
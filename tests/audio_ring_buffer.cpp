@@ -0,0 +1,181 @@
+#include "audio_ring_buffer.h"
+#include "spsc_queue.h"
+#include "doctest.h"
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+TEST_SUITE_BEGIN("AudioRingBuffer");
+
+namespace {
+
+std::vector<float> MakeFrames(int count, float start) {
+	std::vector<float> frames(count * 2);
+	for (int i = 0; i < count; ++i) {
+		frames[i * 2] = start + i;
+		frames[i * 2 + 1] = -(start + i);
+	}
+	return frames;
+}
+
+}
+
+TEST_CASE("SpscQueue") {
+	SpscQueue<std::unique_ptr<int>, 4> queue;
+	REQUIRE(queue.IsEmpty());
+
+	for (int i = 0; i < 4; ++i) {
+		REQUIRE(queue.CanPush());
+		REQUIRE(queue.Push(std::make_unique<int>(i)));
+	}
+	REQUIRE_FALSE(queue.CanPush());
+
+	auto rejected = std::make_unique<int>(4);
+	REQUIRE_FALSE(queue.Push(std::move(rejected)));
+	REQUIRE(rejected);
+
+	std::unique_ptr<int> value;
+	for (int i = 0; i < 4; ++i) {
+		REQUIRE(queue.Pop(value));
+		REQUIRE_EQ(*value, i);
+	}
+	REQUIRE_FALSE(queue.Pop(value));
+	REQUIRE(queue.IsEmpty());
+}
+
+TEST_CASE("SpscQueueThreaded") {
+	constexpr int count = 100000;
+	SpscQueue<int, 64> queue;
+
+	std::thread producer([&]() {
+		for (int i = 0; i < count; ++i) {
+			int value = i;
+			while (!queue.Push(std::move(value))) {
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	int expected = 0;
+	while (expected < count) {
+		int value;
+		if (queue.Pop(value)) {
+			REQUIRE_EQ(value, expected);
+			++expected;
+		} else {
+			std::this_thread::yield();
+		}
+	}
+	producer.join();
+}
+
+TEST_CASE("Capacity") {
+	AudioRingBuffer ring;
+	ring.Resize(1000);
+	REQUIRE_EQ(ring.GetCapacity(), 1024);
+	REQUIRE_EQ(ring.GetFree(), 1024);
+	REQUIRE_EQ(ring.GetAvailable(), 0);
+}
+
+TEST_CASE("WrapAround") {
+	AudioRingBuffer ring;
+	ring.Resize(8);
+
+	std::vector<float> mix(12);
+	for (int round = 0; round < 5; ++round) {
+		auto frames = MakeFrames(6, round * 10.0f);
+		ring.Write(frames.data(), 6);
+		REQUIRE_EQ(ring.GetAvailable(), 6);
+		REQUIRE_EQ(ring.GetFree(), 2);
+
+		std::fill(mix.begin(), mix.end(), 1.0f);
+		ring.MixInto(mix.data(), 6, 0.5f);
+		for (int i = 0; i < 12; ++i) {
+			REQUIRE_EQ(mix[i], 1.0f + frames[i] * 0.5f);
+		}
+		REQUIRE_EQ(ring.GetAvailable(), 0);
+	}
+}
+
+TEST_CASE("VolumeRampWrapAround") {
+	AudioRingBuffer ring;
+	ring.Resize(8);
+
+	std::vector<float> mix(16);
+	auto frames = MakeFrames(6, 0.0f);
+	ring.Write(frames.data(), 6);
+	ring.MixInto(mix.data(), 6, 1.0f);
+
+	// Two frames before the end of the buffer, six after it
+	frames.assign(16, 1.0f);
+	ring.Write(frames.data(), 8);
+	std::fill(mix.begin(), mix.end(), 0.0f);
+	ring.MixInto(mix.data(), 8, 0.0f, 1.0f);
+	for (int i = 0; i < 8; ++i) {
+		REQUIRE_EQ(mix[i * 2], doctest::Approx(i / 8.0f));
+		REQUIRE_EQ(mix[i * 2 + 1], doctest::Approx(i / 8.0f));
+	}
+}
+
+TEST_CASE("Flush") {
+	AudioRingBuffer ring;
+	ring.Resize(16);
+
+	auto frames = MakeFrames(10, 1.0f);
+	ring.Write(frames.data(), 10);
+
+	ring.RequestFlush(1);
+	REQUIRE_FALSE(ring.IsFlushed(1));
+	REQUIRE_EQ(ring.GetAvailable(), 10);
+
+	REQUIRE_EQ(ring.Sync(), 1);
+	REQUIRE(ring.IsFlushed(1));
+	REQUIRE_EQ(ring.GetAvailable(), 0);
+	REQUIRE_EQ(ring.GetFree(), 16);
+
+	// Nothing changes without a new request
+	ring.Write(frames.data(), 4);
+	REQUIRE_EQ(ring.Sync(), 1);
+	REQUIRE_EQ(ring.GetAvailable(), 4);
+}
+
+TEST_CASE("Threaded") {
+	constexpr int count = 200000;
+	AudioRingBuffer ring;
+	ring.Resize(256);
+
+	std::thread producer([&]() {
+		int written = 0;
+		while (written < count) {
+			const int n = std::min({ ring.GetFree(), 37, count - written });
+			if (n == 0) {
+				std::this_thread::yield();
+				continue;
+			}
+			auto frames = MakeFrames(n, static_cast<float>(written));
+			ring.Write(frames.data(), n);
+			written += n;
+		}
+	});
+
+	int read = 0;
+	std::vector<float> mix;
+	while (read < count) {
+		const int n = std::min(ring.GetAvailable(), 53);
+		if (n == 0) {
+			std::this_thread::yield();
+			continue;
+		}
+		mix.assign(n * 2, 0.0f);
+		ring.MixInto(mix.data(), n, 1.0f);
+		for (int i = 0; i < n; ++i) {
+			REQUIRE_EQ(mix[i * 2], static_cast<float>(read + i));
+			REQUIRE_EQ(mix[i * 2 + 1], -static_cast<float>(read + i));
+		}
+		read += n;
+	}
+	producer.join();
+}
+
+TEST_SUITE_END();
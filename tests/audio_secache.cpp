@@ -0,0 +1,194 @@
+#include "system.h"
+#include "doctest.h"
+
+#ifdef WANT_DRWAV
+
+#include "audio_secache.h"
+#include "filesystem_stream.h"
+#include <cstdint>
+#include <vector>
+
+TEST_SUITE_BEGIN("AudioSeCache");
+
+namespace {
+
+constexpr int frequency = 22050;
+// 16 bit mono: Every sample uses 2000 bytes
+constexpr int frames = 1000;
+constexpr size_t sample_size = frames * 2;
+
+std::vector<uint8_t> MakeWav() {
+	std::vector<uint8_t> wav;
+	auto put = [&](uint32_t value, int bytes) {
+		for (int i = 0; i < bytes; ++i) {
+			wav.push_back(static_cast<uint8_t>(value >> (i * 8)));
+		}
+	};
+	auto tag = [&](const char* id) {
+		wav.insert(wav.end(), id, id + 4);
+	};
+
+	tag("RIFF");
+	put(36 + sample_size, 4);
+	tag("WAVE");
+	tag("fmt ");
+	put(16, 4);
+	put(1, 2); // PCM
+	put(1, 2); // mono
+	put(frequency, 4);
+	put(frequency * 2, 4);
+	put(2, 2);
+	put(16, 2);
+	tag("data");
+	put(sample_size, 4);
+	for (int i = 0; i < frames; ++i) {
+		put(static_cast<uint16_t>(i * 31), 2);
+	}
+	return wav;
+}
+
+std::unique_ptr<AudioSeCache> Open(std::string_view name) {
+	if (auto se = AudioSeCache::GetCachedSe(name)) {
+		return se;
+	}
+
+	Filesystem_Stream::InputStream is(new Filesystem_Stream::InputMemoryStreamBuf(MakeWav()), ToString(name));
+	return AudioSeCache::Create(std::move(is), name);
+}
+
+// Plays the SE once, the sample is not in use afterwards
+void Play(std::string_view name) {
+	auto se = Open(name);
+	REQUIRE(se);
+	REQUIRE(se->CreateSeDecoder());
+}
+
+void PlayConverted(std::string_view name) {
+	auto se = Open(name);
+	REQUIRE(se);
+	auto dec = se->CreateSeDecoder(100, frequency, AudioDecoder::Format::S16, 1);
+	REQUIRE(dec);
+	REQUIRE_EQ(dec->DecodeAll().size(), sample_size);
+}
+
+bool IsCached(std::string_view name) {
+	return AudioSeCache::GetCachedSe(name) != nullptr;
+}
+
+struct CacheGuard {
+	size_t budget = AudioSeCache::GetBudget();
+
+	CacheGuard() {
+		AudioSeCache::Clear();
+	}
+
+	~CacheGuard() {
+		AudioSeCache::Clear();
+		AudioSeCache::SetBudget(budget);
+	}
+};
+
+}
+
+TEST_CASE("Stats") {
+	const CacheGuard guard;
+	const auto before = AudioSeCache::GetStats();
+
+	Play("a");
+	auto stats = AudioSeCache::GetStats();
+	REQUIRE_EQ(stats.misses - before.misses, 1u);
+	REQUIRE_EQ(stats.hits - before.hits, 0u);
+	REQUIRE_EQ(stats.entries, 1u);
+	REQUIRE_EQ(stats.size, sample_size);
+
+	Play("a");
+	stats = AudioSeCache::GetStats();
+	REQUIRE_EQ(stats.misses - before.misses, 1u);
+	REQUIRE_EQ(stats.hits - before.hits, 1u);
+	REQUIRE_EQ(stats.entries, 1u);
+}
+
+TEST_CASE("StatsConverted") {
+	const CacheGuard guard;
+	const auto before = AudioSeCache::GetStats();
+
+	// Decoding the source and converting it is one lookup
+	PlayConverted("a");
+	auto stats = AudioSeCache::GetStats();
+	REQUIRE_EQ(stats.misses - before.misses, 1u);
+	REQUIRE_EQ(stats.hits - before.hits, 0u);
+	REQUIRE_EQ(stats.entries, 2u);
+	REQUIRE_EQ(stats.size, sample_size * 2);
+
+	PlayConverted("a");
+	stats = AudioSeCache::GetStats();
+	REQUIRE_EQ(stats.misses - before.misses, 1u);
+	REQUIRE_EQ(stats.hits - before.hits, 1u);
+
+	// Another pitch converts the cached source
+	auto dec = Open("a")->CreateSeDecoder(100, frequency, AudioDecoder::Format::S16, 2);
+	REQUIRE(dec);
+	stats = AudioSeCache::GetStats();
+	REQUIRE_EQ(stats.misses - before.misses, 2u);
+	REQUIRE_EQ(stats.hits - before.hits, 1u);
+	REQUIRE_EQ(stats.entries, 3u);
+}
+
+TEST_CASE("BudgetLeastRecentlyUsed") {
+	const CacheGuard guard;
+	const auto before = AudioSeCache::GetStats();
+	AudioSeCache::SetBudget(sample_size * 2);
+
+	Play("a");
+	Play("b");
+	Play("a");
+	Play("c");
+
+	auto stats = AudioSeCache::GetStats();
+	REQUIRE_EQ(stats.evictions - before.evictions, 1u);
+	REQUIRE_EQ(stats.size, sample_size * 2);
+	REQUIRE(IsCached("a"));
+	REQUIRE_FALSE(IsCached("b"));
+	REQUIRE(IsCached("c"));
+
+	// Playing samples are not evicted even when they are the oldest
+	auto playing = Open("a")->CreateSeDecoder();
+	Play("c");
+	Play("d");
+	REQUIRE(IsCached("a"));
+	REQUIRE_FALSE(IsCached("c"));
+	REQUIRE(IsCached("d"));
+
+	// Shrinking the budget evicts immediately
+	playing.reset();
+	AudioSeCache::SetBudget(sample_size);
+	stats = AudioSeCache::GetStats();
+	REQUIRE_EQ(stats.entries, 1u);
+	REQUIRE(IsCached("d"));
+}
+
+TEST_CASE("BudgetConvertedKeepsSource") {
+	const CacheGuard guard;
+	AudioSeCache::SetBudget(sample_size * 3);
+
+	PlayConverted("a");
+	Play("b");
+
+	// Only the converted copy is used, the source must stay cached as well
+	PlayConverted("a");
+	Play("c");
+
+	REQUIRE(IsCached("a"));
+	REQUIRE_FALSE(IsCached("b"));
+	REQUIRE(IsCached("c"));
+
+	const auto before = AudioSeCache::GetStats();
+	PlayConverted("a");
+	const auto stats = AudioSeCache::GetStats();
+	REQUIRE_EQ(stats.hits - before.hits, 1u);
+	REQUIRE_EQ(stats.misses - before.misses, 0u);
+}
+
+TEST_SUITE_END();
+
+#endif
@@ -0,0 +1,272 @@
+#include <random>
+#include <vector>
+#include "bitmap_kernels.h"
+#include "bitmap.h"
+#include "pixel_format.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("BitmapKernels");
+
+namespace {
+
+using BitmapKernels::Isa;
+using BitmapKernels::Layout;
+
+std::vector<Isa> GetVectorIsas() {
+	std::vector<Isa> isas;
+	for (auto isa: { Isa::SSE2, Isa::AVX2, Isa::NEON }) {
+		if (BitmapKernels::IsSupported(isa)) {
+			isas.push_back(isa);
+		}
+	}
+	return isas;
+}
+
+constexpr Layout layouts[] = {
+	{ 24, 16, 8, 0 },
+	{ 0, 8, 16, 24 },
+	{ 16, 8, 0, 24 },
+};
+
+/** Random premultiplied pixels, a third of them transparent and a third opaque */
+std::vector<uint32_t> MakePixels(std::mt19937& rng, int count, const Layout& layout) {
+	std::vector<uint32_t> pixels(count);
+	for (auto& pixel: pixels) {
+		const uint32_t kind = rng() % 3;
+		const uint32_t a = kind == 0 ? 0 : kind == 1 ? 255 : rng() % 256;
+		const uint32_t r = (rng() % 256) * a / 255;
+		const uint32_t g = (rng() % 256) * a / 255;
+		const uint32_t b = (rng() % 256) * a / 255;
+		pixel = (r << layout.r_shift) | (g << layout.g_shift) | (b << layout.b_shift) | (a << layout.a_shift);
+	}
+	return pixels;
+}
+
+/** Runs kernel with the scalar and every vectorized version and compares the output */
+template <typename F>
+void RequireSameAsScalar(const std::vector<uint32_t>& input, F&& kernel) {
+	const auto best = BitmapKernels::GetIsa();
+
+	auto expected = input;
+	BitmapKernels::SetIsa(Isa::Scalar);
+	kernel(expected.data());
+
+	for (auto isa: GetVectorIsas()) {
+		auto pixels = input;
+		BitmapKernels::SetIsa(isa);
+		kernel(pixels.data());
+
+		INFO(BitmapKernels::GetIsaName(isa));
+		REQUIRE(pixels == expected);
+	}
+
+	BitmapKernels::SetIsa(best);
+}
+
+}
+
+TEST_CASE("Isa") {
+	REQUIRE(BitmapKernels::IsSupported(Isa::Scalar));
+	REQUIRE(BitmapKernels::IsSupported(BitmapKernels::GetBestIsa()));
+	REQUIRE(BitmapKernels::IsSupported(BitmapKernels::GetIsa()));
+}
+
+TEST_CASE("Tone") {
+	std::mt19937 rng(17);
+
+	const Tone tones[] = {
+		Tone(255, 0, 128, 128),
+		Tone(0, 64, 200, 128),
+		Tone(128, 128, 128, 0),
+		Tone(128, 128, 128, 255),
+		Tone(128, 128, 128, 50),
+		Tone(30, 129, 250, 90),
+		Tone(200, 100, 127, 200),
+	};
+
+	for (const auto& layout: layouts) {
+		for (const auto& tone: tones) {
+			for (auto opacity: { ImageOpacity::Opaque, ImageOpacity::Alpha_1Bit, ImageOpacity::Alpha_8Bit }) {
+				// Odd length, the last pixels are done by the scalar version
+				auto pixels = MakePixels(rng, 67, layout);
+				RequireSameAsScalar(pixels, [&](uint32_t* p) {
+					BitmapKernels::ToneRow(p, static_cast<int>(pixels.size()), layout, tone, opacity);
+				});
+			}
+		}
+	}
+}
+
+TEST_CASE("Hue") {
+	std::mt19937 rng(42);
+
+	for (const auto& layout: layouts) {
+		for (int hue: { 0, 1, 0x80, 0x100, 0x2AB, 0x3FF, 0x5FF, 0x600 }) {
+			auto pixels = MakePixels(rng, 131, layout);
+			RequireSameAsScalar(pixels, [&](uint32_t* p) {
+				BitmapKernels::HueRow(p, static_cast<int>(pixels.size()), layout, hue);
+			});
+		}
+	}
+
+	// All grays and fully saturated colors
+	std::vector<uint32_t> pixels;
+	for (uint32_t i = 0; i < 256; ++i) {
+		pixels.push_back((i << 24) | (i << 16) | (i << 8) | 0xFF);
+		pixels.push_back((i << 24) | (255u << 16) | 0xFF);
+		pixels.push_back((255u << 16) | (i << 8) | 0xFF);
+	}
+	RequireSameAsScalar(pixels, [&](uint32_t* p) {
+		BitmapKernels::HueRow(p, static_cast<int>(pixels.size()), layouts[0], 0x123);
+	});
+}
+
+TEST_CASE("Blend") {
+	std::mt19937 rng(7);
+
+	for (const auto& layout: layouts) {
+		for (int i = 0; i < 8; ++i) {
+			const uint32_t a = i == 0 ? 255 : rng() % 256;
+			const uint32_t color = (((rng() % 256) * a / 255) << layout.r_shift) | (a << layout.a_shift);
+
+			auto pixels = MakePixels(rng, 45, layout);
+			auto mask = MakePixels(rng, 45, layout);
+			RequireSameAsScalar(pixels, [&](uint32_t* p) {
+				BitmapKernels::BlendRow(p, mask.data(), static_cast<int>(pixels.size()), layout.a_shift, color, layout.a_shift);
+			});
+
+			// The image is its own mask
+			RequireSameAsScalar(pixels, [&](uint32_t* p) {
+				BitmapKernels::BlendRow(p, p, static_cast<int>(pixels.size()), layout.a_shift, color, layout.a_shift);
+			});
+		}
+	}
+}
+
+TEST_CASE("Blit") {
+	std::mt19937 rng(3);
+
+	for (const auto& layout: layouts) {
+		const uint32_t a_mask = 0xFFu << layout.a_shift;
+		auto src = MakePixels(rng, 53, layout);
+		auto pixels = MakePixels(rng, 53, layout);
+
+		for (int opacity: { 0, 1, 128, 254, 255 }) {
+			for (uint32_t alpha_fill: { 0u, a_mask }) {
+				RequireSameAsScalar(pixels, [&](uint32_t* p) {
+					BitmapKernels::SrcRow(p, src.data(), static_cast<int>(pixels.size()), opacity, alpha_fill);
+				});
+				RequireSameAsScalar(pixels, [&](uint32_t* p) {
+					BitmapKernels::OverRow(p, src.data(), static_cast<int>(pixels.size()), opacity, alpha_fill, layout.a_shift);
+				});
+			}
+		}
+	}
+}
+
+TEST_CASE("Lerp") {
+	std::mt19937 rng(11);
+
+	for (int weight: { 0, 1, 77, 128, 255, 256 }) {
+		auto a = MakePixels(rng, 41, layouts[0]);
+		auto b = MakePixels(rng, 41, layouts[0]);
+		RequireSameAsScalar(a, [&](uint32_t* p) {
+			BitmapKernels::LerpRow(p, p, b.data(), static_cast<int>(a.size()), weight);
+		});
+	}
+
+	REQUIRE(BitmapKernels::LerpUn8x4(0x00FF4080, 0xFF00C080, 0) == 0x00FF4080);
+	REQUIRE(BitmapKernels::LerpUn8x4(0x00FF4080, 0xFF00C080, 256) == 0xFF00C080);
+	REQUIRE(BitmapKernels::LerpUn8x4(0x00FF4080, 0xFF00C080, 128) == 0x7F7F8080);
+}
+
+TEST_CASE("BitmapBlits") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+
+	auto src = Bitmap::Create(37, 23, true);
+	auto opaque_src = Bitmap::Create(37, 23, false);
+	for (int y = 0; y < 23; ++y) {
+		for (int x = 0; x < 37; ++x) {
+			const int alpha = (x + y) % 3 == 0 ? 0 : (x * 7 + y) % 256;
+			src->FillRect(Rect(x, y, 1, 1), Color(x * 6, y * 11, (x * y) % 256, alpha));
+			opaque_src->FillRect(Rect(x, y, 1, 1), Color(y * 5, x * 3, (x + y) % 256, 255));
+		}
+	}
+
+	auto draw = [&](Bitmap& s) {
+		auto dst = Bitmap::Create(60, 50, Color(20, 40, 60, 200));
+		dst->SetClipRect(Rect(2, 1, 55, 47));
+		const Rect rect(3, 2, 30, 19);
+		dst->Blit(-5, 4, s, rect, Opacity::Opaque());
+		dst->Blit(20, 30, s, rect, Opacity(100));
+		dst->Blit(40, -3, s, rect, Opacity::Opaque(), Bitmap::BlendMode::NormalWithoutAlpha);
+		dst->BlitFast(50, 40, s, rect, Opacity::Opaque());
+		dst->TiledBlit(-7, 12, rect, s, Rect(5, 5, 50, 40), Opacity(180));
+		dst->FlipBlit(10, 10, s, rect, true, false, Opacity(220));
+		dst->FlipBlit(25, 20, s, rect, true, true, Opacity::Opaque());
+		dst->StretchBlit(Rect(0, 0, 60, 38), s, rect, Opacity(90));
+		dst->ZoomOpacityBlit(30, 25, 10, 5, s, rect, 0.5, 2.0, Opacity(200));
+		dst->ZoomOpacityBlit(5, 5, 0, 0, s, s.GetRect(), 1.5, 1.5, Opacity::Opaque());
+		dst->WaverBlit(4, -2, 1.0, 1.0, s, rect, 3, 0.7, Opacity(150));
+		return dst;
+	};
+
+	for (auto* s: { src.get(), opaque_src.get() }) {
+		Bitmap::SetDirectBlitEnabled(false);
+		auto expected = draw(*s);
+		Bitmap::SetDirectBlitEnabled(true);
+		auto dst = draw(*s);
+
+		for (int y = 0; y < dst->GetHeight(); ++y) {
+			for (int x = 0; x < dst->GetWidth(); ++x) {
+				auto a = dst->GetColorAt(x, y);
+				auto b = expected->GetColorAt(x, y);
+				INFO("x=", x, " y=", y);
+				REQUIRE(a == b);
+			}
+		}
+	}
+}
+
+TEST_CASE("BitmapEffects") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+
+	auto src = Bitmap::Create(37, 23, true);
+	for (int y = 0; y < 23; ++y) {
+		for (int x = 0; x < 37; ++x) {
+			const int alpha = (x + y) % 3 == 0 ? 0 : (x * 7 + y) % 256;
+			src->FillRect(Rect(x, y, 1, 1), Color(x * 6, y * 11, (x * y) % 256, alpha));
+		}
+	}
+
+	auto draw = [&]() {
+		auto dst = Bitmap::Create(40, 30, Color(20, 40, 60, 255));
+		dst->ToneBlit(1, 2, *src, src->GetRect(), Tone(200, 60, 128, 40), Opacity::Opaque());
+		dst->HueChangeBlit(3, 0, *src, src->GetRect(), 137.0);
+		dst->BlendBlit(0, 5, *src, src->GetRect(), Color(255, 0, 128, 100), Opacity::Opaque());
+		return dst;
+	};
+
+	const auto best = BitmapKernels::GetIsa();
+	BitmapKernels::SetIsa(Isa::Scalar);
+	auto expected = draw();
+
+	for (auto isa: GetVectorIsas()) {
+		BitmapKernels::SetIsa(isa);
+		auto dst = draw();
+
+		INFO(BitmapKernels::GetIsaName(isa));
+		for (int y = 0; y < dst->GetHeight(); ++y) {
+			for (int x = 0; x < dst->GetWidth(); ++x) {
+				auto a = dst->GetColorAt(x, y);
+				auto b = expected->GetColorAt(x, y);
+				INFO("x=", x, " y=", y);
+				REQUIRE(a == b);
+			}
+		}
+	}
+
+	BitmapKernels::SetIsa(best);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,107 @@
+#include "bitmap_scaler.h"
+#include "bitmap.h"
+#include "pixel_format.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("BitmapScaler");
+
+namespace {
+
+BitmapRef MakeSource(int width, int height) {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+
+	auto src = Bitmap::Create(width, height, false);
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			src->FillRect(Rect(x, y, 1, 1), Color(x * 13 % 256, y * 7 % 256, (x * y) % 256, 255));
+		}
+	}
+	return src;
+}
+
+void RequireEqual(const Bitmap& a, const Bitmap& b) {
+	REQUIRE(a.GetWidth() == b.GetWidth());
+	REQUIRE(a.GetHeight() == b.GetHeight());
+	for (int y = 0; y < a.GetHeight(); ++y) {
+		for (int x = 0; x < a.GetWidth(); ++x) {
+			INFO("x=", x, " y=", y);
+			REQUIRE(a.GetColorAt(x, y) == b.GetColorAt(x, y));
+		}
+	}
+}
+
+}
+
+TEST_CASE("IntegerFactor") {
+	REQUIRE(BitmapScaler::GetIntegerFactor(320, 240, 320, 240) == 1);
+	REQUIRE(BitmapScaler::GetIntegerFactor(320, 240, 100, 100) == 1);
+	REQUIRE(BitmapScaler::GetIntegerFactor(320, 240, 1920, 1080) == 4);
+	REQUIRE(BitmapScaler::GetIntegerFactor(320, 240, 1000, 2000) == 3);
+	REQUIRE(BitmapScaler::GetIntegerFactor(320, 240, 7680, 4320) == BitmapScaler::max_factor);
+}
+
+TEST_CASE("Nearest") {
+	auto src = MakeSource(23, 17);
+
+	for (auto mode: { ConfigEnum::ScalingMode::Nearest, ConfigEnum::ScalingMode::Integer }) {
+		for (int factor = 1; factor <= BitmapScaler::max_factor; ++factor) {
+			auto dst = Bitmap::Create(23 * factor, 17 * factor, false);
+			BitmapScaler::Scale(*dst, *src, mode);
+
+			for (int y = 0; y < dst->GetHeight(); ++y) {
+				for (int x = 0; x < dst->GetWidth(); ++x) {
+					INFO("factor=", factor, " x=", x, " y=", y);
+					REQUIRE(dst->GetColorAt(x, y) == src->GetColorAt(x / factor, y / factor));
+				}
+			}
+		}
+	}
+
+	// Not a multiple: Every pixel is one of the source
+	auto dst = Bitmap::Create(50, 30, false);
+	BitmapScaler::Scale(*dst, *src, ConfigEnum::ScalingMode::Nearest);
+	REQUIRE(dst->GetColorAt(0, 0) == src->GetColorAt(0, 0));
+	REQUIRE(dst->GetColorAt(49, 29) == src->GetColorAt(22, 16));
+}
+
+TEST_CASE("SharpBilinear") {
+	auto src = MakeSource(23, 17);
+
+	// Integer factors are not filtered
+	for (int factor = 1; factor <= 4; ++factor) {
+		auto expected = Bitmap::Create(23 * factor, 17 * factor, false);
+		BitmapScaler::Scale(*expected, *src, ConfigEnum::ScalingMode::Nearest);
+		auto dst = Bitmap::Create(23 * factor, 17 * factor, false);
+		BitmapScaler::Scale(*dst, *src, ConfigEnum::ScalingMode::Bilinear);
+		RequireEqual(*dst, *expected);
+	}
+
+	// Only the edges of the source pixels are blended
+	auto uniform = Bitmap::Create(10, 10, Color(40, 80, 120, 255));
+	auto dst = Bitmap::Create(37, 29, false);
+	BitmapScaler::Scale(*dst, *uniform, ConfigEnum::ScalingMode::Bilinear);
+	for (int y = 0; y < dst->GetHeight(); ++y) {
+		for (int x = 0; x < dst->GetWidth(); ++x) {
+			REQUIRE(dst->GetColorAt(x, y) == Color(40, 80, 120, 255));
+		}
+	}
+
+	auto scaled = Bitmap::Create(75, 40, false);
+	BitmapScaler::Scale(*scaled, *src, ConfigEnum::ScalingMode::Bilinear);
+	REQUIRE(scaled->GetColorAt(0, 0) == src->GetColorAt(0, 0));
+	REQUIRE(scaled->GetColorAt(74, 39) == src->GetColorAt(22, 16));
+}
+
+TEST_CASE("Threaded") {
+	auto src = MakeSource(64, 48);
+
+	for (auto mode: { ConfigEnum::ScalingMode::Nearest, ConfigEnum::ScalingMode::Bilinear }) {
+		auto expected = Bitmap::Create(301, 230, false);
+		BitmapScaler::Scale(*expected, *src, mode, false);
+		auto dst = Bitmap::Create(301, 230, false);
+		BitmapScaler::Scale(*dst, *src, mode, true);
+		RequireEqual(*dst, *expected);
+	}
+}
+
+TEST_SUITE_END();
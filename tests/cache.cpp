@@ -0,0 +1,53 @@
+#include "cache.h"
+#include "bitmap.h"
+#include "pixel_format.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("Cache");
+
+TEST_CASE("SpriteEffectHit") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	Cache::Clear();
+
+	auto src = Bitmap::Create(64, 64, Color(100, 150, 200, 255));
+	const auto before = Cache::GetEffectCacheStats();
+
+	auto a = Cache::SpriteEffect(src, Rect(0, 0, 32, 32), false, false, Tone(50, 50, 50, 128), Color());
+	auto b = Cache::SpriteEffect(src, Rect(0, 0, 32, 32), false, false, Tone(50, 50, 50, 128), Color());
+	REQUIRE(a == b);
+
+	auto stats = Cache::GetEffectCacheStats();
+	REQUIRE_EQ(stats.misses - before.misses, 1u);
+	REQUIRE_EQ(stats.hits - before.hits, 1u);
+	REQUIRE_EQ(stats.entries, 1u);
+
+	// Modifying the source invalidates the effect
+	src->FillRect(Rect(0, 0, 8, 8), Color(0, 0, 0, 255));
+	auto c = Cache::SpriteEffect(src, Rect(0, 0, 32, 32), false, false, Tone(50, 50, 50, 128), Color());
+	REQUIRE(a != c);
+
+	Cache::Clear();
+}
+
+TEST_CASE("SpriteEffectBudget") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	Cache::Clear();
+
+	auto src = Bitmap::Create(256, 256, Color(100, 150, 200, 255));
+	const auto before = Cache::GetEffectCacheStats();
+
+	// A tone fade: Every frame requests a new tone
+	for (int frame = 0; frame < 60; ++frame) {
+		Cache::SpriteEffect(src, src->GetRect(), false, false, Tone(frame * 4, 100, 128, 128), Color());
+	}
+
+	auto stats = Cache::GetEffectCacheStats();
+	REQUIRE_EQ(stats.misses - before.misses, 60u);
+	REQUIRE_GT(stats.evictions, before.evictions);
+	REQUIRE_GT(stats.recycled, before.recycled);
+	REQUIRE_LE(stats.size, 8u * 1024 * 1024);
+
+	Cache::Clear();
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,103 @@
+#include "damage_tracker.h"
+#include "bitmap.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("DamageTracker");
+
+namespace {
+
+class TestSprite : public Drawable {
+	public:
+		TestSprite(Drawable::Z_t z = 0) : Drawable(z, Drawable::Flags::Global) {}
+		void Draw(Bitmap&) override {}
+};
+
+}
+
+TEST_CASE("Union") {
+	REQUIRE_EQ(Rect(0, 0, 4, 4).GetUnion(Rect(8, 2, 4, 8)), Rect(0, 0, 12, 10));
+	REQUIRE_EQ(Rect(8, 2, 4, 8).GetUnion(Rect()), Rect(8, 2, 4, 8));
+	REQUIRE_EQ(Rect().GetUnion(Rect(8, 2, 4, 8)), Rect(8, 2, 4, 8));
+	REQUIRE(Rect().GetUnion(Rect()).IsEmpty());
+}
+
+TEST_CASE("FirstFrame") {
+	TestSprite sprite;
+	DamageTracker tracker;
+
+	REQUIRE_EQ(tracker.Begin(sprite).End(Rect(1, 2, 3, 4)), Rect(1, 2, 3, 4));
+	REQUIRE(tracker.Begin(sprite).End(Rect(1, 2, 3, 4)).IsEmpty());
+}
+
+TEST_CASE("StateChange") {
+	TestSprite sprite;
+	DamageTracker tracker;
+
+	int x = 0;
+	tracker.Begin(sprite) << x;
+	tracker.End(Rect(0, 0, 4, 4));
+
+	x = 1;
+	tracker.Begin(sprite) << x;
+	REQUIRE_EQ(tracker.End(Rect(0, 0, 4, 4)), Rect(0, 0, 4, 4));
+
+	tracker.Begin(sprite) << x;
+	REQUIRE(tracker.End(Rect(0, 0, 4, 4)).IsEmpty());
+}
+
+TEST_CASE("Move") {
+	TestSprite sprite;
+	DamageTracker tracker;
+
+	tracker.Begin(sprite).End(Rect(0, 0, 4, 4));
+	REQUIRE_EQ(tracker.Begin(sprite).End(Rect(8, 0, 4, 4)), Rect(0, 0, 12, 4));
+}
+
+TEST_CASE("Visibility") {
+	TestSprite sprite;
+	DamageTracker tracker;
+
+	tracker.Begin(sprite).End(Rect(0, 0, 4, 4));
+
+	sprite.SetVisible(false);
+	REQUIRE_EQ(tracker.Begin(sprite).End(Rect(0, 0, 4, 4)), Rect(0, 0, 4, 4));
+	REQUIRE(tracker.Begin(sprite).End(Rect(0, 0, 4, 4)).IsEmpty());
+
+	sprite.SetVisible(true);
+	REQUIRE_EQ(tracker.Begin(sprite).End(Rect(0, 0, 4, 4)), Rect(0, 0, 4, 4));
+}
+
+TEST_CASE("BitmapRevision") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	auto bitmap = Bitmap::Create(16, 16, true);
+
+	TestSprite sprite;
+	DamageTracker tracker;
+
+	tracker.Begin(sprite) << bitmap;
+	tracker.End(bitmap->GetRect());
+
+	tracker.Begin(sprite) << bitmap;
+	REQUIRE(tracker.End(bitmap->GetRect()).IsEmpty());
+
+	bitmap->Fill(Color(255, 0, 0, 255));
+	tracker.Begin(sprite) << bitmap;
+	REQUIRE_EQ(tracker.End(bitmap->GetRect()), bitmap->GetRect());
+}
+
+TEST_CASE("ClipRect") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	Bitmap bitmap(4, 4, true);
+
+	bitmap.Fill(Color(255, 0, 0, 255));
+	bitmap.SetClipRect(Rect(0, 0, 2, 2));
+	bitmap.Clear();
+	bitmap.ClearClipRect();
+
+	REQUIRE_EQ(bitmap.GetColorAt(0, 0), Color(0, 0, 0, 0));
+	REQUIRE_EQ(bitmap.GetColorAt(1, 1), Color(0, 0, 0, 0));
+	REQUIRE_EQ(bitmap.GetColorAt(2, 2), Color(255, 0, 0, 255));
+	REQUIRE_EQ(bitmap.GetColorAt(3, 0), Color(255, 0, 0, 255));
+}
+
+TEST_SUITE_END();
@@ -6,6 +6,7 @@
 
 #define ZIP_PATH EP_TEST_PATH "/filesystem/test.zip"
 #define ZIP_FOLDER_PATH EP_TEST_PATH "/filesystem/folder.zip"
+#define ZIP_STREAM_PATH EP_TEST_PATH "/filesystem/stream.zip"
 
 TEST_SUITE_BEGIN("Filesystem ZIP");
 
@@ -60,6 +61,46 @@ TEST_CASE("File reading") {
 	CHECK(line_out == "lo");
 }
 
+static int StreamPattern(int pos) {
+	return (pos * 31 + (pos >> 10)) & 0xFF;
+}
+
+static void CheckStreamedFile(std::string_view name, int size) {
+	auto fs = FileFinder::Root().Create(ZIP_STREAM_PATH);
+	auto is = fs.OpenInputStream(name);
+	REQUIRE(is);
+	CHECK(is.GetSize() == size);
+
+	// Sequential read
+	std::vector<char> data(size);
+	CHECK(is.read(data.data(), size).gcount() == size);
+	for (int i = 0; i < size; ++i) {
+		if (static_cast<uint8_t>(data[i]) != StreamPattern(i)) {
+			FAIL("Mismatch at " << i);
+		}
+	}
+
+	// Backward and forward seeks
+	for (int pos: {size - 1, 5, size / 2 + 3, 70000, 1, size / 3}) {
+		is.clear();
+		is.seekg(pos, std::ios_base::beg);
+		CHECK(is.get() == StreamPattern(pos));
+	}
+
+	is.seekg(-2, std::ios_base::end);
+	CHECK(is.get() == StreamPattern(size - 2));
+	CHECK(is.get() == StreamPattern(size - 1));
+	CHECK(is.get() == EOF);
+}
+
+TEST_CASE("Streaming deflated file") {
+	CheckStreamedFile("deflated", 1536 * 1024);
+}
+
+TEST_CASE("Streaming stored file") {
+	CheckStreamedFile("stored", 96 * 1024);
+}
+
 TEST_CASE("File IO error") {
 	auto fs = FileFinder::Root().Create(ZIP_PATH);
 	CHECK(!fs.OpenInputStream("game"));
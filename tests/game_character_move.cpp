@@ -7,6 +7,7 @@
 #include "game_switches.h"
 #include <climits>
 #include <initializer_list>
+#include <lcf/rpg/movecommand.h>
 
 #include "mock_game.h"
 
@@ -301,4 +302,39 @@ TEST_CASE("StopCountMoveFail") { testStop(false, false, 16, 16); }
 TEST_CASE("StopCountJump") { testStop(true, true, 4, 4); }
 TEST_CASE("StopCountJumpFail") { testStop(false, true, 16, 16); }
 
+static lcf::rpg::MoveRoute MakeMoveRoute(lcf::rpg::MoveCommand::Code code) {
+	lcf::rpg::MoveRoute mr;
+	lcf::rpg::MoveCommand mc;
+	mc.command_id = static_cast<int>(code);
+	mr.move_commands = { mc };
+	return mr;
+}
+
+TEST_CASE("MakeWayEventMovedOntoTarget") {
+	const MockGame mg(MockMap::ePass40x30, 2);
+
+	// Event 1 stands on the target below the player and walks right. This pushes
+	// event 2 out of its way, which walks left onto the target.
+	auto& ev1 = *MockGame::GetEvent(1);
+	ev1.SetX(2);
+	ev1.SetY(0);
+	ev1.SetLayer(lcf::rpg::EventPage::Layers_below);
+	ev1.ForceMoveRoute(MakeMoveRoute(lcf::rpg::MoveCommand::Code::move_right), 3);
+
+	auto& ev2 = *MockGame::GetEvent(2);
+	ev2.SetX(3);
+	ev2.SetY(0);
+	ev2.SetLayer(lcf::rpg::EventPage::Layers_same);
+	ev2.ForceMoveRoute(MakeMoveRoute(lcf::rpg::MoveCommand::Code::move_left), 3);
+
+	auto& player = *MockGame::GetPlayer();
+	player.SetX(1);
+	player.SetY(0);
+
+	// Event 2 arrived after event 1 was checked and blocks the player
+	REQUIRE_FALSE(Game_Map::MakeWay(player, 1, 0, 2, 0));
+	REQUIRE_EQ(ev1.GetX(), 3);
+	REQUIRE_EQ(ev2.GetX(), 2);
+}
+
 TEST_SUITE_END();
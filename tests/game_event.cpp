@@ -3,6 +3,7 @@
 #include "options.h"
 #include "game_map.h"
 #include "main_data.h"
+#include "mock_game.h"
 #include <climits>
 
 TEST_SUITE_BEGIN("Game_Event");
@@ -28,4 +29,23 @@ TEST_CASE("IdName") {
 	}
 }
 
+TEST_CASE("TileIndex") {
+	const MockGame mg(MockMap::ePass40x30);
+
+	auto& ev = *MockGame::GetEvent(1);
+	REQUIRE_EQ(Game_Map::GetEventAt(0, 0, false), &ev);
+
+	ev.SetX(5);
+	ev.SetY(7);
+	REQUIRE_EQ(Game_Map::GetEventAt(0, 0, false), nullptr);
+	REQUIRE_EQ(Game_Map::GetEventAt(5, 7, false), &ev);
+	REQUIRE_EQ(Game_Map::GetEventsAt(5, 7).size(), 1);
+
+	// Positions outside of the map are still found
+	ev.SetX(-1);
+	REQUIRE_EQ(Game_Map::GetEventAt(5, 7, false), nullptr);
+	REQUIRE_EQ(Game_Map::GetEventAt(-1, 7, false), &ev);
+	REQUIRE_EQ(Game_Map::GetEventAt(-1, 8, false), nullptr);
+}
+
 TEST_SUITE_END();
@@ -0,0 +1,186 @@
+#include "game_map.h"
+#include "doctest.h"
+#include "game_actors.h"
+#include "game_party.h"
+#include "game_switches.h"
+#include "game_variables.h"
+#include "main_data.h"
+#include "mock_game.h"
+#include <lcf/data.h>
+
+TEST_SUITE_BEGIN("Game_Map");
+
+namespace {
+
+enum EventId {
+	eSwitch1 = 1,
+	eSwitch2,
+	eVariable1,
+	eItem1,
+	eActor1,
+	eWeapon2
+};
+
+/** Actor 1 starts with item 2 equipped */
+struct MockDatabase {
+	MockDatabase() {
+		lcf::Data::actors.resize(1);
+		auto& actor = lcf::Data::actors[0];
+		actor.ID = 1;
+		actor.initial_level = 1;
+		actor.final_level = 99;
+		actor.parameters.Setup(actor.final_level);
+		actor.initial_equipment.weapon_id = 2;
+
+		lcf::Data::items.resize(2);
+		lcf::Data::items[0].ID = 1;
+		lcf::Data::items[1].ID = 2;
+		lcf::Data::items[1].type = lcf::rpg::Item::Type_weapon;
+	}
+
+	~MockDatabase() {
+		lcf::Data::actors.clear();
+		lcf::Data::items.clear();
+	}
+};
+
+/** Every event switches to its second page when its condition is met */
+struct MockRefreshGame {
+	MockDatabase db;
+	MockGame mg { MockMap::ePass40x30 };
+
+	MockRefreshGame() {
+		auto map = MakeMockMap(MockMap::ePass40x30, 0);
+		auto add_event = [&](int id, auto set_condition) {
+			map->events.push_back({});
+			auto& ev = map->events.back();
+			ev.ID = id;
+			ev.pages.resize(2);
+			ev.pages[0].ID = 1;
+			ev.pages[1].ID = 2;
+			set_condition(ev.pages[1].condition);
+		};
+
+		add_event(eSwitch1, [](auto& cond) { cond.flags.switch_a = true; cond.switch_a_id = 1; });
+		add_event(eSwitch2, [](auto& cond) { cond.flags.switch_a = true; cond.switch_a_id = 2; });
+		add_event(eVariable1, [](auto& cond) {
+			cond.flags.variable = true;
+			cond.variable_id = 1;
+			cond.variable_value = 1;
+			cond.compare_operator = 1;
+		});
+		add_event(eItem1, [](auto& cond) { cond.flags.item = true; cond.item_id = 1; });
+		add_event(eActor1, [](auto& cond) { cond.flags.actor = true; cond.actor_id = 1; });
+		add_event(eWeapon2, [](auto& cond) { cond.flags.item = true; cond.item_id = 2; });
+
+		Game_Map::Setup(std::move(map));
+		Game_Map::SetNeedRefresh(true);
+		Game_Map::Refresh();
+	}
+};
+
+int GetPageId(int event_id) {
+	const auto* page = Game_Map::GetEvent(event_id)->GetActivePage();
+	return page ? page->ID : 0;
+}
+
+}
+
+TEST_CASE("RefreshSwitch") {
+	const MockRefreshGame m;
+	REQUIRE_EQ(GetPageId(eSwitch1), 1);
+	REQUIRE_EQ(GetPageId(eSwitch2), 1);
+
+	// Nobody observes switch 3
+	Main_Data::game_switches->Set(3, true);
+	Game_Map::SetNeedRefreshForSwitchChange(3);
+	REQUIRE_FALSE(Game_Map::GetNeedRefresh());
+
+	// Switch 2 changes without a notification, only a full refresh picks it up
+	Main_Data::game_switches->Set(2, true);
+	Main_Data::game_switches->Set(1, true);
+	Game_Map::SetNeedRefreshForSwitchChange(1);
+	REQUIRE(Game_Map::GetNeedRefresh());
+	Game_Map::Refresh();
+	REQUIRE_FALSE(Game_Map::GetNeedRefresh());
+	REQUIRE_EQ(GetPageId(eSwitch1), 2);
+	REQUIRE_EQ(GetPageId(eSwitch2), 1);
+
+	Game_Map::SetNeedRefresh(true);
+	Game_Map::Refresh();
+	REQUIRE_EQ(GetPageId(eSwitch2), 2);
+
+	// Range operations
+	Main_Data::game_switches->SetRange(1, 10, false);
+	Game_Map::SetNeedRefreshForSwitchRangeChange(1, 10);
+	Game_Map::Refresh();
+	REQUIRE_EQ(GetPageId(eSwitch1), 1);
+	REQUIRE_EQ(GetPageId(eSwitch2), 1);
+}
+
+TEST_CASE("RefreshVariable") {
+	const MockRefreshGame m;
+	REQUIRE_EQ(GetPageId(eVariable1), 1);
+
+	Main_Data::game_variables->Set(2, 5);
+	Game_Map::SetNeedRefreshForVarChange(2);
+	REQUIRE_FALSE(Game_Map::GetNeedRefresh());
+
+	Main_Data::game_variables->Set(1, 5);
+	Game_Map::SetNeedRefreshForVarChange(1);
+	Game_Map::Refresh();
+	REQUIRE_EQ(GetPageId(eVariable1), 2);
+
+	Main_Data::game_variables->Set(1, 0);
+	Game_Map::SetNeedRefreshForVarRangeChange(1, 100);
+	Game_Map::Refresh();
+	REQUIRE_EQ(GetPageId(eVariable1), 1);
+}
+
+TEST_CASE("RefreshItem") {
+	const MockRefreshGame m;
+	REQUIRE_EQ(GetPageId(eItem1), 1);
+
+	Main_Data::game_party->AddItem(1, 1);
+	Game_Map::SetNeedRefreshForItemChange(1);
+	Game_Map::Refresh();
+	REQUIRE_EQ(GetPageId(eItem1), 2);
+	REQUIRE_EQ(GetPageId(eWeapon2), 1);
+
+	Main_Data::game_party->RemoveItem(1, 1);
+	Game_Map::SetNeedRefreshForItemChange(1);
+	Game_Map::Refresh();
+	REQUIRE_EQ(GetPageId(eItem1), 1);
+}
+
+TEST_CASE("RefreshActor") {
+	const MockRefreshGame m;
+	REQUIRE_EQ(GetPageId(eActor1), 1);
+
+	Main_Data::game_party->AddActor(1);
+	Game_Map::SetNeedRefreshForActorChange(1);
+	Game_Map::Refresh();
+	REQUIRE_EQ(GetPageId(eActor1), 2);
+}
+
+TEST_CASE("RefreshPartyChange") {
+	const MockRefreshGame m;
+	REQUIRE_EQ(GetPageId(eActor1), 1);
+	REQUIRE_EQ(GetPageId(eWeapon2), 1);
+
+	// The equipment of the new member counts for the item conditions
+	Main_Data::game_party->AddActor(1);
+	Game_Map::SetNeedRefreshForPartyChange(1);
+	Game_Map::Refresh();
+	REQUIRE_EQ(GetPageId(eActor1), 2);
+	REQUIRE_EQ(GetPageId(eWeapon2), 2);
+	REQUIRE_EQ(GetPageId(eItem1), 1);
+
+	Main_Data::game_party->RemoveActor(1);
+	Game_Map::SetNeedRefreshForPartyChange(1);
+	Game_Map::Refresh();
+	REQUIRE_EQ(GetPageId(eActor1), 1);
+	REQUIRE_EQ(GetPageId(eWeapon2), 1);
+}
+
+TEST_SUITE_END();
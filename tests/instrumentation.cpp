@@ -0,0 +1,79 @@
+#include "instrumentation.h"
+#include "doctest.h"
+#include <sstream>
+#include <string_view>
+
+TEST_SUITE_BEGIN("Instrumentation");
+
+TEST_CASE("DisabledRecordsNothing") {
+	Instrumentation::SetProfilerEnabled(false);
+
+	Instrumentation::FrameBegin();
+	{
+		Instrumentation::ZoneScope zone("Zone");
+	}
+	Instrumentation::FrameEnd();
+
+	Instrumentation::SetProfilerEnabled(true);
+	std::chrono::microseconds frame_time;
+	REQUIRE(Instrumentation::GetSummary(frame_time).empty());
+	REQUIRE_EQ(frame_time.count(), 0);
+	Instrumentation::SetProfilerEnabled(false);
+}
+
+TEST_CASE("NestedZones") {
+	Instrumentation::SetProfilerEnabled(true);
+
+	for (int i = 0; i < 4; ++i) {
+		Instrumentation::FrameBegin();
+		{
+			Instrumentation::ZoneScope outer("Outer");
+			{
+				Instrumentation::ZoneScope inner("Inner");
+			}
+			{
+				Instrumentation::ZoneScope inner("Inner");
+			}
+		}
+		Instrumentation::FrameEnd();
+	}
+
+	std::chrono::microseconds frame_time;
+	auto summary = Instrumentation::GetSummary(frame_time);
+	REQUIRE_EQ(summary.size(), 2);
+
+	REQUIRE_EQ(std::string_view(summary[0].name), "Outer");
+	REQUIRE_EQ(summary[0].depth, 0);
+	REQUIRE_EQ(summary[0].calls, doctest::Approx(1.0f));
+
+	REQUIRE_EQ(std::string_view(summary[1].name), "Inner");
+	REQUIRE_EQ(summary[1].depth, 1);
+	REQUIRE_EQ(summary[1].calls, doctest::Approx(2.0f));
+
+	REQUIRE_LE(summary[1].time, summary[0].time);
+	REQUIRE_LE(summary[0].time, frame_time);
+
+	Instrumentation::SetProfilerEnabled(false);
+}
+
+TEST_CASE("ChromeTrace") {
+	Instrumentation::SetProfilerEnabled(true);
+
+	Instrumentation::FrameBegin();
+	{
+		Instrumentation::ZoneScope zone("Zone");
+	}
+	Instrumentation::FrameEnd();
+
+	std::stringstream ss;
+	REQUIRE(Instrumentation::WriteChromeTrace(ss));
+
+	auto trace = ss.str();
+	REQUIRE_EQ(trace.rfind("{\"traceEvents\":[", 0), 0);
+	REQUIRE_NE(trace.find("\"name\":\"Frame\""), std::string::npos);
+	REQUIRE_NE(trace.find("\"name\":\"Zone\""), std::string::npos);
+
+	Instrumentation::SetProfilerEnabled(false);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,315 @@
+#include "test_mock_actor.h"
+#include "game_interpreter_shared.h"
+#include "maniac_patch.h"
+#include "rand.h"
+#include "doctest.h"
+#include <lcf/rpg/saveeventexecstate.h>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+TEST_SUITE_BEGIN("ManiacPatch");
+
+namespace {
+
+class Context : public Game_BaseInterpreterContext {
+public:
+	int GetThisEventId() const override { return 0; }
+	Game_Character* GetCharacter(int, std::string_view) const override { return nullptr; }
+	const lcf::rpg::SaveEventExecState& GetState() const override { return state; }
+	const lcf::rpg::SaveEventExecFrame& GetFrame() const override { return frame; }
+
+	lcf::rpg::SaveEventExecState state;
+	lcf::rpg::SaveEventExecFrame frame;
+};
+
+using Bytes = std::vector<uint8_t>;
+
+Bytes Seq(std::initializer_list<Bytes> parts) {
+	Bytes bytes;
+	for (auto& part: parts) {
+		bytes.insert(bytes.end(), part.begin(), part.end());
+	}
+	return bytes;
+}
+
+// Operand encodings of the op-code stream
+Bytes Const(int32_t value) {
+	if (value >= 0 && value < 256) {
+		return { 1, static_cast<uint8_t>(value) };
+	}
+	if (value >= 0 && value < 65536) {
+		return { 2, static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8) };
+	}
+	const auto v = static_cast<uint32_t>(value);
+	return { 3, static_cast<uint8_t>(v), static_cast<uint8_t>(v >> 8), static_cast<uint8_t>(v >> 16), static_cast<uint8_t>(v >> 24) };
+}
+
+Bytes Op(uint8_t op, std::initializer_list<Bytes> operands) {
+	return Seq({ Bytes{ op }, Seq(operands) });
+}
+
+Bytes Fn(uint8_t fn, std::initializer_list<Bytes> args) {
+	return Seq({ Bytes{ 78, fn, static_cast<uint8_t>(args.size()) }, Seq(args) });
+}
+
+Bytes Var(int id) { return Op(8, { Const(id) }); }
+Bytes Sw(int id) { return Op(9, { Const(id) }); }
+
+// Packs the op-code bytes into int32 like they are stored in the event command
+std::vector<int32_t> Pack(const Bytes& bytes) {
+	std::vector<int32_t> op_codes((bytes.size() + 3) / 4);
+	for (size_t i = 0; i < bytes.size(); ++i) {
+		op_codes[i / 4] |= static_cast<int32_t>(static_cast<uint32_t>(bytes[i]) << ((i % 4) * 8));
+	}
+	return op_codes;
+}
+
+std::string Dump(const Bytes& bytes) {
+	std::string s;
+	for (auto b: bytes) {
+		s += std::to_string(b) + " ";
+	}
+	return s;
+}
+
+constexpr int num_state = 10;
+
+void ResetState() {
+	const int values[num_state] = { 7, -3, 0, 2, 100000, -2147483647, 5, 1, 3, 9 };
+	for (int i = 0; i < num_state; ++i) {
+		Main_Data::game_variables->Set(i + 1, values[i]);
+		Main_Data::game_switches->Set(i + 1, i % 2 == 0);
+	}
+	Rand::SeedRandomNumberGenerator(1234);
+}
+
+std::vector<int> GetState() {
+	std::vector<int> state;
+	for (int i = 1; i <= num_state; ++i) {
+		state.push_back(Main_Data::game_variables->Get(i));
+		state.push_back(Main_Data::game_switches->GetInt(i));
+	}
+	return state;
+}
+
+// Compiled (first and cached evaluation) and interpreted results must match,
+// including the side effects on variables and switches
+void CheckSame(const Bytes& bytes) {
+	const auto op_codes = Pack(bytes);
+	const Context ctx;
+	CAPTURE(Dump(bytes));
+
+	ResetState();
+	const int expected = ManiacPatch::InterpretExpression(MakeSpan(op_codes), ctx);
+	const auto expected_state = GetState();
+
+	for (int i = 0; i < 2; ++i) {
+		ResetState();
+		REQUIRE_EQ(ManiacPatch::ParseExpression(MakeSpan(op_codes), ctx), expected);
+		REQUIRE(GetState() == expected_state);
+	}
+}
+
+void CheckSameMultiple(const Bytes& bytes) {
+	const auto op_codes = Pack(bytes);
+	const Context ctx;
+	CAPTURE(Dump(bytes));
+
+	ResetState();
+	const auto expected = ManiacPatch::InterpretExpressions(MakeSpan(op_codes), ctx);
+	const auto expected_state = GetState();
+
+	for (int i = 0; i < 2; ++i) {
+		ResetState();
+		REQUIRE(ManiacPatch::ParseExpressions(MakeSpan(op_codes), ctx) == expected);
+		REQUIRE(GetState() == expected_state);
+	}
+}
+
+struct MockManiac : MockActor {
+	MockManiac() {
+		Main_Data::game_party->AddActor(1);
+		Main_Data::game_party->AddActor(2);
+		Main_Data::game_party->AddItem(3, 4);
+		Main_Data::game_party->GainGold(123);
+	}
+};
+
+}
+
+TEST_CASE("CompiledOperands") {
+	const MockManiac m;
+
+	CheckSame({});
+	CheckSame(Const(0));
+	CheckSame(Const(200));
+	CheckSame(Const(1000));
+	CheckSame(Const(-5));
+	CheckSame(Const(123456789));
+	CheckSame({ 4, 17 });
+	CheckSame({ 5, 1, 2 });
+	CheckSame({ 6, 1, 2, 3, 4 });
+
+	for (int id = 0; id <= num_state + 1; ++id) {
+		CheckSame(Var(id));
+		CheckSame(Sw(id));
+		CheckSame(Op(13, { Const(id) }));
+		CheckSame(Op(14, { Const(id) }));
+	}
+	CheckSame(Var(-1));
+
+	// Stream ends inside of an operand
+	CheckSame({ 2, 1 });
+	CheckSame({ 3, 1, 2 });
+	CheckSame({ 48, 8 });
+	CheckSame({ 78, 12 });
+}
+
+TEST_CASE("CompiledOperators") {
+	const MockManiac m;
+
+	for (uint8_t op: { 24, 25, 26 }) {
+		CheckSame(Op(op, { Var(2) }));
+		CheckSame(Op(op, { Const(0) }));
+		CheckSame(Op(op, { Const(9) }));
+	}
+
+	const Bytes operands[] = { Var(1), Var(2), Var(3), Var(5), Var(6), Const(0), Const(3), Const(-1) };
+	for (int op = 48; op <= 65; ++op) {
+		CAPTURE(op);
+		for (auto& a: operands) {
+			for (auto& b: operands) {
+				CheckSame(Op(op, { a, b }));
+			}
+		}
+	}
+
+	// Division and modulo by zero return the dividend
+	CheckSame(Op(51, { Const(7), Const(0) }));
+	CheckSame(Op(52, { Const(7), Const(0) }));
+	CheckSame(Op(51, { Var(6), Const(-1) }));
+
+	CheckSame(Op(72, { Sw(1), Var(1), Var(2) }));
+	CheckSame(Op(72, { Sw(2), Var(1), Var(2) }));
+	CheckSame(Op(72, { Op(61, { Var(1), Const(3) }), Op(50, { Var(4), Var(9) }), Op(52, { Var(10), Var(9) }) }));
+
+	// Nested expressions
+	CheckSame(Op(48, { Op(50, { Var(1), Op(49, { Var(2), Op(24, { Var(4) }) }) }), Op(72, { Sw(3), Const(1), Op(13, { Const(8) }) }) }));
+}
+
+TEST_CASE("CompiledInplace") {
+	const MockManiac m;
+
+	for (int op = 34; op <= 44; ++op) {
+		CAPTURE(op);
+		CheckSame(Op(op, { Var(1), Const(3) }));
+		CheckSame(Op(op, { Var(1), Const(0) }));
+		CheckSame(Op(op, { Sw(2), Const(1) }));
+		CheckSame(Op(op, { Op(13, { Const(9) }), Var(4) }));
+		CheckSame(Op(op, { Op(14, { Const(9) }), Const(0) }));
+		// Not a lvalue
+		CheckSame(Op(op, { Const(5), Const(2) }));
+		// Assignment inside of an expression
+		CheckSame(Op(48, { Op(op, { Var(1), Const(2) }), Var(1) }));
+	}
+}
+
+TEST_CASE("CompiledFunctions") {
+	const MockManiac m;
+
+	// Every function with its expected argument count
+	const Bytes args[] = { Const(1), Const(2), Const(3) };
+	const Bytes neg_args[] = { Var(2), Var(6), Const(0) };
+	const int num_args[] = { 2, 2, 2, 2, 2, 2, 1, 2, 2, 3, 3, 3, 2, 2, 1, 3, 3, 3, 3 };
+	for (uint8_t fn = 0; fn < 19; ++fn) {
+		CAPTURE(fn);
+		switch (num_args[fn]) {
+			case 1:
+				CheckSame(Fn(fn, { args[0] }));
+				CheckSame(Fn(fn, { neg_args[0] }));
+				break;
+			case 2:
+				CheckSame(Fn(fn, { args[0], args[1] }));
+				CheckSame(Fn(fn, { args[1], args[0] }));
+				CheckSame(Fn(fn, { neg_args[0], neg_args[1] }));
+				CheckSame(Fn(fn, { neg_args[2], neg_args[2] }));
+				break;
+			case 3:
+				CheckSame(Fn(fn, { args[0], args[1], args[2] }));
+				CheckSame(Fn(fn, { args[2], args[1], args[0] }));
+				CheckSame(Fn(fn, { neg_args[0], neg_args[1], neg_args[2] }));
+				break;
+		}
+	}
+
+	// Game state queries
+	for (int op = 0; op <= 9; ++op) {
+		if (op != 8) {
+			CheckSame(Fn(6, { Const(op) }));
+		}
+		CheckSame(Fn(1, { Const(op % 2), Const(3) }));
+		CheckSame(Fn(3, { Const(op), Const(1) }));
+		CheckSame(Fn(4, { Const(op), Const(1) }));
+		CheckSame(Fn(5, { Const(op), Const(0) }));
+		CheckSame(Fn(2, { Const(op), Const(0) }));
+	}
+
+	// Wrong argument count, unknown function and unsupported long argument count
+	CheckSame(Fn(12, { Const(1) }));
+	CheckSame(Fn(14, { Const(1), Const(2) }));
+	CheckSame(Fn(40, { Const(1), Var(1) }));
+	CheckSame({ 78, 12, 0x82, 1, 1, 1, 2 });
+
+	// Function results as operands
+	CheckSame(Op(48, { Fn(0, { Const(1), Const(100) }), Fn(13, { Var(1), Fn(14, { Var(2) }) }) }));
+}
+
+TEST_CASE("CompiledUnsupported") {
+	const MockManiac m;
+
+	// Arrays, ranges and subscripts are not supported and evaluate to 0
+	CheckSame(Op(19, { Const(1), Const(2) }));
+	CheckSame(Op(70, { Var(1), Var(2) }));
+	CheckSame(Op(71, { Var(1), Const(2) }));
+	CheckSame(Op(48, { Op(70, { Op(70, { Const(1), Const(2) }), Const(3) }), Const(4) }));
+	CheckSame({ 200, 1, 2 });
+}
+
+TEST_CASE("CompiledMultiple") {
+	const MockManiac m;
+
+	CheckSameMultiple({});
+	CheckSameMultiple(Const(5));
+	CheckSameMultiple(Seq({ Const(5), Var(1), Op(48, { Var(1), Var(2) }) }));
+	CheckSameMultiple(Seq({ Op(34, { Var(1), Const(2) }), Var(1), Op(35, { Var(1), Var(1) }) }));
+	CheckSameMultiple(Seq({ Fn(0, { Const(1), Const(6) }), Fn(0, { Const(1), Const(6) }) }));
+	// Terminated by Null
+	CheckSameMultiple(Seq({ Const(5), Bytes{ 0 }, Const(6) }));
+	// Unsupported operations in between
+	CheckSameMultiple(Seq({ Const(5), Op(70, { Op(70, { Const(1), Const(2) }), Const(3) }), Var(2) }));
+	CheckSameMultiple(Seq({ Var(1), Fn(12, { Const(1) }), Const(3), Var(4) }));
+}
+
+TEST_CASE("CacheHashCollision") {
+	const MockManiac m;
+	const Context ctx;
+
+	// Every expression lands in the same bucket
+	ManiacPatch::SetExpressionHash([](Span<const int32_t>, bool) -> uint64_t { return 0; });
+
+	const auto a = Pack(Const(5));
+	const auto b = Pack(Op(48, { Const(6), Const(1) }));
+	const auto c = Pack(Seq({ Const(5), Const(8) }));
+	for (int i = 0; i < 2; ++i) {
+		REQUIRE_EQ(ManiacPatch::ParseExpression(MakeSpan(a), ctx), 5);
+		REQUIRE_EQ(ManiacPatch::ParseExpression(MakeSpan(b), ctx), 7);
+		REQUIRE(ManiacPatch::ParseExpressions(MakeSpan(a), ctx) == std::vector<int32_t>{ 5 });
+		REQUIRE(ManiacPatch::ParseExpressions(MakeSpan(c), ctx) == std::vector<int32_t>{ 5, 8 });
+		REQUIRE_EQ(ManiacPatch::ParseExpression(MakeSpan(c), ctx), 5);
+	}
+
+	ManiacPatch::SetExpressionHash(nullptr);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,83 @@
+#include "system.h"
+#include "doctest.h"
+
+#ifdef WANT_FMMIDI
+
+#include "decoder_fmmidi.h"
+#include "worker_pool.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+TEST_SUITE_BEGIN("MidiSynth");
+
+namespace {
+
+void PlayChords(FmMidiDecoder& fmmidi, int root) {
+	for (uint32_t ch = 0; ch < 16; ++ch) {
+		for (uint32_t note : { 0, 4, 7, 12 }) {
+			fmmidi.SendMidiMessage(0x90 | ch | (root + ch + note) << 8 | 100 << 16);
+		}
+	}
+}
+
+void ReleaseChords(FmMidiDecoder& fmmidi, int root) {
+	for (uint32_t ch = 0; ch < 16; ++ch) {
+		for (uint32_t note : { 0, 4, 7, 12 }) {
+			fmmidi.SendMidiMessage(0x80 | ch | (root + ch + note) << 8);
+		}
+	}
+}
+
+std::vector<int16_t> Render(FmMidiDecoder& fmmidi) {
+	fmmidi.SetFormat(44100, AudioDecoderBase::Format::S16, 2);
+	for (uint32_t ch = 0; ch < 16; ++ch) {
+		fmmidi.SendMidiMessage(0xC0 | ch | (ch * 7) << 8);
+		// Spread the channels, so that both outputs differ
+		fmmidi.SendMidiMessage(0xB0 | ch | 10 << 8 | (ch * 8) << 16);
+	}
+
+	std::vector<int16_t> samples;
+	std::vector<int16_t> buffer(64 * 2);
+	auto render = [&](int blocks) {
+		for (int i = 0; i < blocks; ++i) {
+			fmmidi.FillBuffer(reinterpret_cast<uint8_t*>(buffer.data()), buffer.size() * sizeof(int16_t));
+			samples.insert(samples.end(), buffer.begin(), buffer.end());
+		}
+	};
+
+	PlayChords(fmmidi, 40);
+	render(50);
+	PlayChords(fmmidi, 45);
+	ReleaseChords(fmmidi, 40);
+	render(50);
+	ReleaseChords(fmmidi, 45);
+	// Notes finish during the release
+	render(400);
+	return samples;
+}
+
+}
+
+TEST_CASE("ParallelMatchesSerial") {
+	FmMidiDecoder serial;
+	serial.synth->set_parallel_for(nullptr, 1);
+
+	WorkerPool pool(3);
+	FmMidiDecoder parallel;
+	parallel.synth->set_parallel_for([&pool](int count, const std::function<void(int)>& func) {
+		pool.ParallelFor(count, func);
+	}, pool.GetNumThreads());
+
+	auto expected = Render(serial);
+	auto result = Render(parallel);
+
+	REQUIRE(expected.size() == result.size());
+	CHECK(expected == result);
+	CHECK(std::any_of(expected.begin(), expected.end(), [](int16_t s) { return s != 0; }));
+}
+
+TEST_SUITE_END();
+
+#endif
@@ -16,7 +16,7 @@ static lcf::rpg::Chipset MakeChipset() {
 	return chipset;
 }
 
-MockGame::MockGame(MockMap maptag) {
+MockGame::MockGame(MockMap maptag, int num_events) {
 	Input::ResetKeys();
 
 	lcf::Data::terrains.push_back(MakeTerrain());
@@ -44,7 +44,7 @@ MockGame::MockGame(MockMap maptag) {
 	Main_Data::game_player = std::make_unique<Game_Player>();
 	Main_Data::game_player->SetMapId(1);
 
-	Game_Map::Setup(MakeMockMap(maptag));
+	Game_Map::Setup(MakeMockMap(maptag, num_events));
 }
 
 Game_Player* MockGame::GetPlayer() {
@@ -79,7 +79,7 @@ void MockGame::DoReset() {
 	Input::ResetKeys();
 }
 
-std::unique_ptr<lcf::rpg::Map> MakeMockMap(MockMap maptag) {
+std::unique_ptr<lcf::rpg::Map> MakeMockMap(MockMap maptag, int num_events) {
 	auto map = std::make_unique<lcf::rpg::Map>();
 
 	auto w = 20;
@@ -99,12 +99,14 @@ std::unique_ptr<lcf::rpg::Map> MakeMockMap(MockMap maptag) {
 	map->upper_layer.resize(w * h, BLOCK_F);
 	map->lower_layer.resize(w * h, BLOCK_E);
 
-	map->events.push_back({});
-	map->events.back().ID = 1;
-	map->events.back().pages.push_back({});
-	map->events.back().pages.back().ID = 1;
-	map->events.back().pages.back().move_type = lcf::rpg::EventPage::MoveType_stationary;
-	map->events.back().pages.back().character_pattern = 1;
+	for (int id = 1; id <= num_events; ++id) {
+		map->events.push_back({});
+		map->events.back().ID = id;
+		map->events.back().pages.push_back({});
+		map->events.back().pages.back().ID = 1;
+		map->events.back().pages.back().move_type = lcf::rpg::EventPage::MoveType_stationary;
+		map->events.back().pages.back().character_pattern = 1;
+	}
 
 	switch (maptag) {
 		case MockMap::eNone:
@@ -25,11 +25,11 @@ enum class MockMap {
 	eMapCount
 };
 
-std::unique_ptr<lcf::rpg::Map> MakeMockMap(MockMap maptag);
+std::unique_ptr<lcf::rpg::Map> MakeMockMap(MockMap maptag, int num_events = 1);
 
 class MockGame {
 public:
-	explicit MockGame(MockMap maptag);
+	explicit MockGame(MockMap maptag, int num_events = 1);
 
 	MockGame(const MockGame&) = delete;
 	MockGame& operator=(const MockGame&) = delete;
@@ -0,0 +1,202 @@
+#include <cstdlib>
+#include "sprite_batch.h"
+#include "bitmap.h"
+#include "pixel_format.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("SpriteBatch");
+
+namespace {
+
+BitmapRef MakeSource(int seed) {
+	auto bitmap = Bitmap::Create(64, 64, true);
+	for (int y = 0; y < 64; y += 4) {
+		for (int x = 0; x < 64; x += 4) {
+			auto c = static_cast<uint8_t>(x * 5 + y * 3 + seed * 41);
+			uint8_t alpha = (x + y + seed) % 3 == 0 ? 255 : ((x + y) % 3 == 1 ? 90 : 0);
+			bitmap->FillRect(Rect(x, y, 4, 4), Color(c, 255 - c, c / 2, alpha));
+		}
+	}
+	return bitmap;
+}
+
+BitmapRef MakeBackground() {
+	auto bitmap = Bitmap::Create(160, 120, true);
+	bitmap->FillRect(bitmap->GetRect(), Color(30, 60, 90, 255));
+	bitmap->FillRect(Rect(40, 20, 60, 60), Color(200, 10, 10, 128));
+	return bitmap;
+}
+
+SpriteBatch::Command MakeCommand(BitmapRef src, Rect src_rect, int x, int y, int opacity = 255) {
+	SpriteBatch::Command cmd;
+	cmd.src = std::move(src);
+	cmd.src_rect = src_rect;
+	cmd.x = x;
+	cmd.y = y;
+	cmd.opacity = Opacity(opacity);
+	return cmd;
+}
+
+void DrawDirect(Bitmap& dst, const std::vector<SpriteBatch::Command>& commands) {
+	for (const auto& cmd : commands) {
+		dst.EffectsBlit(cmd.x, cmd.y, cmd.ox, cmd.oy, *cmd.src, cmd.src_rect, cmd.opacity,
+			cmd.zoom_x, cmd.zoom_y, cmd.angle, cmd.waver_depth, cmd.waver_phase, cmd.blend_mode);
+	}
+}
+
+void DrawBatched(Bitmap& dst, const std::vector<SpriteBatch::Command>& commands) {
+	SpriteBatch batch(dst);
+	for (const auto& cmd : commands) {
+		batch.Add(cmd);
+	}
+}
+
+void RequireSimilar(const Bitmap& a, const Bitmap& b) {
+	REQUIRE_EQ(a.GetWidth(), b.GetWidth());
+	REQUIRE_EQ(a.GetHeight(), b.GetHeight());
+
+	for (int y = 0; y < a.GetHeight(); ++y) {
+		for (int x = 0; x < a.GetWidth(); ++x) {
+			auto ca = a.GetColorAt(x, y);
+			auto cb = b.GetColorAt(x, y);
+			INFO("x=", x, " y=", y);
+			REQUIRE_LE(std::abs(ca.red - cb.red), 1);
+			REQUIRE_LE(std::abs(ca.green - cb.green), 1);
+			REQUIRE_LE(std::abs(ca.blue - cb.blue), 1);
+			REQUIRE_LE(std::abs(ca.alpha - cb.alpha), 1);
+		}
+	}
+}
+
+void TestMatchesDirect(const std::vector<SpriteBatch::Command>& commands) {
+	auto direct = MakeBackground();
+	auto batched = MakeBackground();
+
+	DrawDirect(*direct, commands);
+	DrawBatched(*batched, commands);
+
+	RequireSimilar(*direct, *batched);
+}
+
+}
+
+TEST_CASE("Simple") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+
+	auto a = MakeSource(1);
+	auto b = MakeSource(2);
+
+	TestMatchesDirect({
+		MakeCommand(a, Rect(0, 0, 24, 32), 4, 4),
+		MakeCommand(b, Rect(8, 8, 24, 32), 60, 4, 128),
+		MakeCommand(a, Rect(24, 0, 24, 32), 100, 50, 200),
+		// Partially outside of the screen
+		MakeCommand(b, Rect(0, 0, 64, 64), 130, 90),
+		MakeCommand(a, Rect(0, 0, 64, 64), -30, -20, 60),
+	});
+}
+
+TEST_CASE("Overlap") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+
+	auto a = MakeSource(1);
+	auto b = MakeSource(2);
+
+	// Sorting by source must not change the order of overlapping sprites
+	TestMatchesDirect({
+		MakeCommand(a, Rect(0, 0, 32, 32), 10, 10),
+		MakeCommand(b, Rect(0, 0, 32, 32), 20, 20),
+		MakeCommand(a, Rect(16, 16, 32, 32), 30, 30, 180),
+		MakeCommand(b, Rect(0, 0, 32, 32), 90, 10),
+		MakeCommand(a, Rect(0, 0, 32, 32), 70, 30),
+	});
+}
+
+TEST_CASE("Merge") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+
+	auto a = MakeSource(3);
+
+	std::vector<SpriteBatch::Command> commands;
+	for (int i = 0; i < 4; ++i) {
+		commands.push_back(MakeCommand(a, Rect(i * 16, 0, 16, 16), 10 + i * 16, 10, 220));
+	}
+	for (int i = 0; i < 4; ++i) {
+		commands.push_back(MakeCommand(a, Rect(0, i * 16, 16, 16), 100, 20 + i * 16));
+	}
+
+	TestMatchesDirect(commands);
+}
+
+TEST_CASE("Effects") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+
+	auto a = MakeSource(4);
+	auto b = MakeSource(5);
+
+	auto zoom = MakeCommand(a, Rect(0, 0, 32, 32), 40, 40, 200);
+	zoom.ox = 16;
+	zoom.oy = 16;
+	zoom.zoom_x = 1.5;
+	zoom.zoom_y = 0.5;
+
+	auto rotate = MakeCommand(b, Rect(0, 0, 32, 32), 80, 60);
+	rotate.ox = 16;
+	rotate.oy = 16;
+	rotate.angle = 0.7;
+
+	auto bush = MakeCommand(a, Rect(0, 0, 32, 32), 110, 10);
+	bush.opacity = Opacity(255, 100, 12);
+
+	auto additive = MakeCommand(b, Rect(0, 0, 32, 32), 120, 70);
+	additive.blend_mode = Bitmap::BlendMode::Additive;
+
+	TestMatchesDirect({
+		MakeCommand(b, Rect(0, 0, 32, 32), 30, 30),
+		zoom,
+		rotate,
+		bush,
+		additive,
+		MakeCommand(a, Rect(0, 0, 32, 32), 100, 60, 128),
+	});
+}
+
+TEST_CASE("Active") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+
+	auto dst = MakeBackground();
+	auto other = MakeBackground();
+
+	REQUIRE(SpriteBatch::GetActive(*dst) == nullptr);
+	{
+		SpriteBatch batch(*dst);
+		REQUIRE(SpriteBatch::GetActive(*dst) == &batch);
+		REQUIRE(SpriteBatch::GetActive(*other) == nullptr);
+
+		{
+			SpriteBatch inner(*other);
+			REQUIRE(SpriteBatch::GetActive(*dst) == nullptr);
+			REQUIRE(SpriteBatch::GetActive(*other) == &inner);
+		}
+
+		REQUIRE(SpriteBatch::GetActive(*dst) == &batch);
+
+		batch.Add(MakeCommand(MakeSource(1), Rect(0, 0, 16, 16), 0, 0));
+		// Not visible
+		batch.Add(MakeCommand(MakeSource(1), Rect(0, 0, 16, 16), 200, 0));
+		REQUIRE_EQ(batch.GetCommands().size(), 1u);
+
+		batch.Flush();
+		REQUIRE(batch.GetCommands().empty());
+	}
+	REQUIRE(SpriteBatch::GetActive(*dst) == nullptr);
+
+	SpriteBatch::SetEnabled(false);
+	{
+		SpriteBatch batch(*dst);
+		REQUIRE(SpriteBatch::GetActive(*dst) == nullptr);
+	}
+	SpriteBatch::SetEnabled(true);
+}
+
+TEST_SUITE_END();
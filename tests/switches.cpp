@@ -123,6 +123,52 @@ TEST_CASE("FlipRange") {
 	REQUIRE_FALSE(s.Get(n + 1));
 }
 
+TEST_CASE("RangeWordBoundaries") {
+	constexpr int n = 200;
+	auto s = make();
+	std::vector<bool> expected(n + 1);
+
+	auto check = [&]() {
+		for (int i = 1; i <= n; ++i) {
+			REQUIRE_EQ(s.Get(i), static_cast<bool>(expected[i]));
+		}
+	};
+
+	s.SetRange(60, 130, true);
+	for (int i = 60; i <= 130; ++i) {
+		expected[i] = true;
+	}
+	check();
+
+	s.FlipRange(1, 64);
+	for (int i = 1; i <= 64; ++i) {
+		expected[i] = !expected[i];
+	}
+	check();
+
+	s.SetRange(65, 128, false);
+	for (int i = 65; i <= 128; ++i) {
+		expected[i] = false;
+	}
+	check();
+
+	s.FlipRange(100, n);
+	for (int i = 100; i <= n; ++i) {
+		expected[i] = !expected[i];
+	}
+	check();
+
+	s.SetRange(3, 3, false);
+	expected[3] = false;
+	check();
+
+	auto data = s.GetData();
+	REQUIRE_EQ(data.size(), static_cast<size_t>(n));
+	for (int i = 1; i <= n; ++i) {
+		REQUIRE_EQ(static_cast<bool>(data[i - 1]), static_cast<bool>(expected[i]));
+	}
+}
+
 TEST_CASE("GetSize") {
 	auto s = make();
 	REQUIRE_EQ(s.GetSizeWithLimit(), max_switches);
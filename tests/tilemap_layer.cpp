@@ -0,0 +1,166 @@
+#include <cstring>
+#include "tilemap_layer.h"
+#include "drawable_list.h"
+#include "drawable_mgr.h"
+#include "map_data.h"
+#include "mock_game.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("TilemapLayer");
+
+namespace {
+
+struct ScreenSizeGuard {
+	ScreenSizeGuard(int width, int height) : width(Player::screen_width), height(Player::screen_height) {
+		Player::screen_width = width;
+		Player::screen_height = height;
+	}
+	~ScreenSizeGuard() {
+		Player::screen_width = width;
+		Player::screen_height = height;
+	}
+	int width;
+	int height;
+};
+
+BitmapRef MakeChipset() {
+	auto chipset = Bitmap::Create(480, 256, true);
+	for (int y = 0; y < 256; y += TILE_SIZE / 2) {
+		for (int x = 0; x < 480; x += TILE_SIZE / 2) {
+			auto c = static_cast<uint8_t>(x * 7 + y * 13);
+			chipset->FillRect(Rect(x, y, TILE_SIZE / 2, TILE_SIZE / 2), Color(c, 255 - c, c / 2, (x + y) % 3 ? 255 : 128));
+		}
+	}
+	return chipset;
+}
+
+std::vector<short> MakeMapData(int layer, int w, int h) {
+	std::vector<short> data(w * h);
+	for (int i = 0; i < w * h; ++i) {
+		if (layer == 0) {
+			data[i] = static_cast<short>(i % 5 ? BLOCK_E + i % BLOCK_E_TILES : BLOCK_C + (i % BLOCK_C_TILES) * BLOCK_C_STRIDE);
+		} else {
+			data[i] = static_cast<short>(BLOCK_F + i % BLOCK_F_TILES);
+		}
+	}
+	return data;
+}
+
+void DrawLayer(TilemapLayer& layer, Bitmap& dst, bool parallel, bool chunk_cache) {
+	TilemapLayer::SetParallelDraw(parallel);
+	TilemapLayer::SetChunkCache(chunk_cache);
+	dst.Fill(Color(10, 20, 30, 255));
+	for (uint8_t z = 0; z < 3; ++z) {
+		layer.Draw(dst, z, 0, 0);
+	}
+	TilemapLayer::SetParallelDraw(true);
+	TilemapLayer::SetChunkCache(true);
+}
+
+void SetupLayer(TilemapLayer& layer, int layer_id) {
+	layer.SetWidth(40);
+	layer.SetHeight(30);
+	layer.SetChipset(MakeChipset());
+	layer.SetMapData(MakeMapData(layer_id, 40, 30));
+}
+
+bool SamePixels(const Bitmap& a, const Bitmap& b) {
+	return std::memcmp(a.pixels(), b.pixels(), a.height() * a.pitch()) == 0;
+}
+
+void TestParallelMatchesSerial(int layer_id, Tone tone, bool clip) {
+	const MockGame mg(MockMap::ePass40x30);
+	const ScreenSizeGuard screen(640, 480);
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+
+	DrawableList list;
+	DrawableMgr::SetLocalList(&list);
+
+	TilemapLayer layer(layer_id);
+	SetupLayer(layer, layer_id);
+	layer.SetTone(tone);
+
+	Bitmap serial(640, 480, true);
+	Bitmap parallel(640, 480, true);
+
+	for (int o : { 0, 5, 16, 37 }) {
+		layer.SetOx(o);
+		layer.SetOy(o * 2);
+
+		if (clip) {
+			serial.SetClipRect(Rect(30, 50, 200, 300));
+			parallel.SetClipRect(Rect(30, 50, 200, 300));
+		}
+
+		DrawLayer(layer, serial, false, false);
+		DrawLayer(layer, parallel, true, false);
+
+		REQUIRE(SamePixels(serial, parallel));
+	}
+}
+
+}
+
+TEST_CASE("ParallelLower") {
+	TestParallelMatchesSerial(0, Tone(), false);
+}
+
+TEST_CASE("ParallelUpper") {
+	TestParallelMatchesSerial(1, Tone(), false);
+}
+
+TEST_CASE("ParallelTone") {
+	TestParallelMatchesSerial(0, Tone(100, 50, 200, 80), false);
+}
+
+TEST_CASE("ParallelClip") {
+	TestParallelMatchesSerial(0, Tone(), true);
+}
+
+namespace {
+
+void TestChunkCacheMatchesDirect(int layer_id, bool fast_blit) {
+	const MockGame mg(MockMap::ePass40x30);
+	const ScreenSizeGuard screen(320, 240);
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+
+	DrawableList list;
+	DrawableMgr::SetLocalList(&list);
+
+	TilemapLayer layer(layer_id);
+	SetupLayer(layer, layer_id);
+	layer.SetFastBlit(fast_blit);
+
+	Bitmap direct(320, 240, true);
+	Bitmap cached(320, 240, true);
+
+	for (int frame = 0; frame < 12; ++frame) {
+		// Scroll across chunk borders and step the tile animation
+		layer.SetOx(frame * 29);
+		layer.SetOy(frame * 11);
+		for (int i = 0; i < 7; ++i) {
+			Main_Data::game_system->IncFrameCounter();
+		}
+
+		DrawLayer(layer, direct, false, false);
+		DrawLayer(layer, cached, false, true);
+
+		REQUIRE(SamePixels(direct, cached));
+	}
+}
+
+}
+
+TEST_CASE("ChunkCacheLower") {
+	TestChunkCacheMatchesDirect(0, false);
+}
+
+TEST_CASE("ChunkCacheLowerFastBlit") {
+	TestChunkCacheMatchesDirect(0, true);
+}
+
+TEST_CASE("ChunkCacheUpper") {
+	TestChunkCacheMatchesDirect(1, false);
+}
+
+TEST_SUITE_END();
@@ -555,6 +555,52 @@ TEST_CASE("Overflow/Underflow") {
 	REQUIRE(v.Get(1) == _min);
 }
 
+TEST_CASE("Range Overflow/Underflow") {
+	// Long enough to cover the vectorized path and the remainder
+	constexpr int n = 11;
+	lcf::Data::variables.resize(n);
+
+	auto _min = std::numeric_limits<Game_Variables::Var_t>::min();
+	auto _max = std::numeric_limits<Game_Variables::Var_t>::max();
+
+	Game_Variables v(_min, _max);
+	v.SetWarning(0);
+
+	v.SetRange(1, n, _max);
+	v.AddRange(1, n, 1);
+	for (int i = 1; i <= n; ++i) {
+		REQUIRE(v.Get(i) == _max);
+	}
+
+	v.SetRange(1, n, _min);
+	v.SubRange(1, n, 1);
+	for (int i = 1; i <= n; ++i) {
+		REQUIRE(v.Get(i) == _min);
+	}
+
+	v.SetRange(1, n, _max);
+	v.SubRange(1, n, -1);
+	for (int i = 1; i <= n; ++i) {
+		REQUIRE(v.Get(i) == _max);
+	}
+
+	Game_Variables c(minval, maxval);
+	c.SetWarning(0);
+	c.SetRange(1, n, maxval - 5);
+	c.AddRange(2, n - 1, 10);
+	REQUIRE_EQ(c.Get(1), maxval - 5);
+	for (int i = 2; i <= n - 1; ++i) {
+		REQUIRE_EQ(c.Get(i), maxval);
+	}
+	REQUIRE_EQ(c.Get(n), maxval - 5);
+
+	c.SetRange(1, n, -1);
+	c.BitXorRange(1, n, _max);
+	for (int i = 1; i <= n; ++i) {
+		REQUIRE_EQ(c.Get(i), minval);
+	}
+}
+
 TEST_CASE("Enumerate") {
 	auto s = make();
 